@@ -145,6 +145,18 @@ bool Application::OnTouchFirstMove(const std::vector<Vector2>& locations)
 
 bool Application::OnSizeChanged(const int32 width, const int32 height)
 {
+    if (m_Window)
+    {
+        m_Window->ReshapeWindow(m_Window->GetX(), m_Window->GetY(), width, height);
+    }
+
+    // 只做标记，拖动窗口时的多次事件合并为一次重建
+    std::shared_ptr<VulkanRHI> vulkanRHI = m_Engine ? m_Engine->GetVulkanRHI() : nullptr;
+    if (vulkanRHI)
+    {
+        vulkanRHI->SetSwapChainDirty(true);
+    }
+
     return true;
 }
 
@@ -0,0 +1,380 @@
+﻿#include "DVKAnimationCompressor.h"
+#include "DVKModel.h"
+
+#include <algorithm>
+
+// 关键帧的时间存储为uint16的帧序号
+#define ANIM_COMPRESS_MAX_FRAMES        65535
+// 位移与缩放按通道范围量化为16位
+#define ANIM_COMPRESS_VECTOR_STEPS      65535.0f
+// smallest three每个分量15位，取值范围为[-1/sqrt(2), 1/sqrt(2)]
+#define ANIM_COMPRESS_QUAT_STEPS        32767.0f
+#define ANIM_COMPRESS_QUAT_RANGE        0.70710678f
+
+namespace vk_demo
+{
+    static FORCE_INLINE float VectorError(const Vector3& a, const Vector3& b)
+    {
+        return (a - b).Size();
+    }
+
+    // 两个单位四元数表示的旋转之间的夹角，q与-q表示相同的旋转。由弦长计算，小角度时比acos精确
+    static FORCE_INLINE float QuatError(const Quat& a, const Quat& b)
+    {
+        Quat  delta = (a | b) < 0.0f ? a + b : a - b;
+        float chord = MMath::Min(delta.Size() * 0.5f, 1.0f);
+        return 4.0f * MMath::Asin(chord);
+    }
+
+    static FORCE_INLINE Quat QuatLerp(const Quat& a, const Quat& b, float alpha)
+    {
+        // 选择较短的路径，编码时可能翻转了符号
+        float sign = (a | b) < 0.0f ? -1.0f : 1.0f;
+        Quat result(
+            a.x + (b.x * sign - a.x) * alpha,
+            a.y + (b.y * sign - a.y) * alpha,
+            a.z + (b.z * sign - a.z) * alpha,
+            a.w + (b.w * sign - a.w) * alpha
+        );
+        result.Normalize();
+        return result;
+    }
+
+    static FORCE_INLINE uint16 QuantizeUnit(float value, float steps)
+    {
+        return (uint16)MMath::Clamp<int32>((int32)(value * steps + 0.5f), 0, (int32)steps);
+    }
+
+    int32 DVKAnimationCompressor::FindFrame(const std::vector<uint16>& frames, float frame, int32& cursor)
+    {
+        int32 last  = (int32)frames.size() - 2;
+        int32 index = MMath::Min(cursor, last);
+        bool before = frame < frames[index];
+        bool after  = frame >= frames[index + 1];
+        if (after && index < last && frame < frames[index + 2])
+        {
+            index += 1;
+        }
+        else if (before || after)
+        {
+            index = (int32)(std::upper_bound(frames.begin() + 1, frames.end() - 1, frame) - frames.begin()) - 1;
+        }
+        cursor = index;
+        return index;
+    }
+
+    void DVKAnimationCompressor::EncodeQuat(const Quat& quat, uint16* outPacked)
+    {
+        float components[4] = { quat.x, quat.y, quat.z, quat.w };
+
+        int32 largest = 0;
+        for (int32 i = 1; i < 4; ++i)
+        {
+            if (MMath::Abs(components[i]) > MMath::Abs(components[largest]))
+            {
+                largest = i;
+            }
+        }
+
+        // 最大的分量取正，解码时由其余三个分量还原
+        float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+        uint16 packed[3];
+        for (int32 i = 0, j = 0; i < 4; ++i)
+        {
+            if (i == largest)
+            {
+                continue;
+            }
+            float unit = (components[i] * sign / ANIM_COMPRESS_QUAT_RANGE + 1.0f) * 0.5f;
+            packed[j++] = QuantizeUnit(MMath::Clamp(unit, 0.0f, 1.0f), ANIM_COMPRESS_QUAT_STEPS);
+        }
+
+        outPacked[0] = packed[0] | (uint16)((largest >> 1) << 15);
+        outPacked[1] = packed[1] | (uint16)((largest &  1) << 15);
+        outPacked[2] = packed[2];
+    }
+
+    Quat DVKAnimationCompressor::DecodeQuat(const uint16* packed)
+    {
+        int32 largest = ((packed[0] >> 15) << 1) | (packed[1] >> 15);
+
+        float smallest[3];
+        float sum = 0.0f;
+        for (int32 i = 0; i < 3; ++i)
+        {
+            float unit  = (packed[i] & 0x7FFF) / ANIM_COMPRESS_QUAT_STEPS;
+            smallest[i] = (unit * 2.0f - 1.0f) * ANIM_COMPRESS_QUAT_RANGE;
+            sum += smallest[i] * smallest[i];
+        }
+
+        float components[4];
+        for (int32 i = 0, j = 0; i < 4; ++i)
+        {
+            components[i] = i == largest ? MMath::Sqrt(MMath::Max(1.0f - sum, 0.0f)) : smallest[j++];
+        }
+
+        return Quat(components[0], components[1], components[2], components[3]);
+    }
+
+    void DVKCompressedVectorTrack::Sample(float frame, int32& cursor, Vector3& outValue) const
+    {
+        if (frames.size() == 0)
+        {
+            return;
+        }
+
+        int32 index = 0;
+        float alpha = 0.0f;
+        if (frames.size() > 1 && frame >= frames.back())
+        {
+            index = (int32)frames.size() - 1;
+        }
+        else if (frames.size() > 1 && frame > frames.front())
+        {
+            index = DVKAnimationCompressor::FindFrame(frames, frame, cursor);
+            alpha = (frame - frames[index]) / (float)(frames[index + 1] - frames[index]);
+        }
+
+        const uint16* prev = &values[index * 3];
+        outValue.x = min.x + prev[0] * scale.x;
+        outValue.y = min.y + prev[1] * scale.y;
+        outValue.z = min.z + prev[2] * scale.z;
+
+        if (alpha > 0.0f)
+        {
+            const uint16* next = prev + 3;
+            outValue.x += (next[0] - (float)prev[0]) * scale.x * alpha;
+            outValue.y += (next[1] - (float)prev[1]) * scale.y * alpha;
+            outValue.z += (next[2] - (float)prev[2]) * scale.z * alpha;
+        }
+    }
+
+    void DVKCompressedQuatTrack::Sample(float frame, int32& cursor, Quat& outValue) const
+    {
+        if (frames.size() == 0)
+        {
+            return;
+        }
+
+        int32 index = 0;
+        float alpha = 0.0f;
+        if (frames.size() > 1 && frame >= frames.back())
+        {
+            index = (int32)frames.size() - 1;
+        }
+        else if (frames.size() > 1 && frame > frames.front())
+        {
+            index = DVKAnimationCompressor::FindFrame(frames, frame, cursor);
+            alpha = (frame - frames[index]) / (float)(frames[index + 1] - frames[index]);
+        }
+
+        Quat prev = DVKAnimationCompressor::DecodeQuat(&values[index * 3]);
+        outValue  = alpha > 0.0f ? QuatLerp(prev, DVKAnimationCompressor::DecodeQuat(&values[index * 3 + 3]), alpha) : prev;
+    }
+
+    // 贪心地延长每一段，段内所有帧的线性插值误差都不超过maxError时才接受，返回保留的帧序号
+    template <class ValueType, class LerpFunc, class ErrorFunc>
+    static void FitKeys(const std::vector<ValueType>& reference, const std::vector<ValueType>& decoded, float maxError, LerpFunc lerpFunc, ErrorFunc errorFunc, std::vector<int32>& outFrames)
+    {
+        int32 count = (int32)reference.size();
+
+        outFrames.clear();
+        outFrames.push_back(0);
+
+        // 整条通道都不变时只保留一个关键帧
+        bool constant = true;
+        for (int32 i = 1; i < count && constant; ++i)
+        {
+            constant = errorFunc(decoded[0], reference[i]) <= maxError;
+        }
+        if (constant)
+        {
+            return;
+        }
+
+        int32 start = 0;
+        while (start < count - 1)
+        {
+            int32 end = start + 1;
+            while (end + 1 < count)
+            {
+                int32 candidate = end + 1;
+                bool  valid     = true;
+                for (int32 i = start + 1; i < candidate && valid; ++i)
+                {
+                    float alpha = (i - start) / (float)(candidate - start);
+                    valid = errorFunc(lerpFunc(decoded[start], decoded[candidate], alpha), reference[i]) <= maxError;
+                }
+                if (!valid)
+                {
+                    break;
+                }
+                end = candidate;
+            }
+            outFrames.push_back(end);
+            start = end;
+        }
+    }
+
+    static void CompressVectorChannel(DVKAnimChannel<Vector3>& channel, int32 frameCount, float frameRate, float maxError, DVKCompressedVectorTrack& outTrack, DVKAnimationCompressStats& stats, float& outMaxError)
+    {
+        outTrack = DVKCompressedVectorTrack();
+        if (channel.keys.size() == 0)
+        {
+            return;
+        }
+
+        stats.keyCountBefore += (uint32)channel.keys.size();
+        stats.sizeBefore     += (uint32)(channel.keys.size() * (sizeof(float) + sizeof(Vector3)));
+
+        // 按帧重新采样，与GotoAnimation的插值方式一致
+        std::vector<Vector3> reference(frameCount);
+        Vector3 minValue(MAX_flt, MAX_flt, MAX_flt);
+        Vector3 maxValue(-MAX_flt, -MAX_flt, -MAX_flt);
+        int32 cursor = 0;
+        for (int32 i = 0; i < frameCount; ++i)
+        {
+            Vector3 prevValue;
+            Vector3 nextValue;
+            float alpha = 0.0f;
+            channel.GetValue(i / frameRate, cursor, prevValue, nextValue, alpha);
+            reference[i] = MMath::Lerp(prevValue, nextValue, alpha);
+            minValue = minValue.ComponentMin(reference[i]);
+            maxValue = maxValue.ComponentMax(reference[i]);
+        }
+
+        outTrack.min   = minValue;
+        outTrack.scale = (maxValue - minValue) * (1.0f / ANIM_COMPRESS_VECTOR_STEPS);
+
+        // 先量化，拟合时直接使用解码之后的数值，误差包含量化误差
+        std::vector<uint16>  quantized(frameCount * 3);
+        std::vector<Vector3> decoded(frameCount);
+        for (int32 i = 0; i < frameCount; ++i)
+        {
+            for (int32 c = 0; c < 3; ++c)
+            {
+                float unit = outTrack.scale[c] > 0.0f ? (reference[i][c] - minValue[c]) / (maxValue[c] - minValue[c]) : 0.0f;
+                quantized[i * 3 + c] = QuantizeUnit(unit, ANIM_COMPRESS_VECTOR_STEPS);
+                decoded[i][c] = minValue[c] + quantized[i * 3 + c] * outTrack.scale[c];
+            }
+        }
+
+        std::vector<int32> frames;
+        FitKeys(reference, decoded, maxError, [](const Vector3& a, const Vector3& b, float alpha) { return MMath::Lerp(a, b, alpha); }, VectorError, frames);
+
+        outTrack.frames.resize(frames.size());
+        outTrack.values.resize(frames.size() * 3);
+        for (int32 i = 0; i < frames.size(); ++i)
+        {
+            outTrack.frames[i] = (uint16)frames[i];
+            outTrack.values[i * 3 + 0] = quantized[frames[i] * 3 + 0];
+            outTrack.values[i * 3 + 1] = quantized[frames[i] * 3 + 1];
+            outTrack.values[i * 3 + 2] = quantized[frames[i] * 3 + 2];
+        }
+
+        // 统计最终的误差
+        cursor = 0;
+        for (int32 i = 0; i < frameCount; ++i)
+        {
+            Vector3 value;
+            outTrack.Sample((float)i, cursor, value);
+            outMaxError = MMath::Max(outMaxError, VectorError(value, reference[i]));
+        }
+
+        stats.keyCountAfter += (uint32)outTrack.frames.size();
+        stats.sizeAfter     += outTrack.GetMemorySize();
+
+        channel.keys.clear();
+        channel.keys.shrink_to_fit();
+        channel.values.clear();
+        channel.values.shrink_to_fit();
+    }
+
+    static void CompressQuatChannel(DVKAnimChannel<Quat>& channel, int32 frameCount, float frameRate, float maxError, DVKCompressedQuatTrack& outTrack, DVKAnimationCompressStats& stats, float& outMaxError)
+    {
+        outTrack = DVKCompressedQuatTrack();
+        if (channel.keys.size() == 0)
+        {
+            return;
+        }
+
+        stats.keyCountBefore += (uint32)channel.keys.size();
+        stats.sizeBefore     += (uint32)(channel.keys.size() * (sizeof(float) + sizeof(Quat)));
+
+        std::vector<Quat>   reference(frameCount);
+        std::vector<uint16> quantized(frameCount * 3);
+        std::vector<Quat>   decoded(frameCount);
+        int32 cursor = 0;
+        for (int32 i = 0; i < frameCount; ++i)
+        {
+            Quat prevValue(0, 0, 0, 1);
+            Quat nextValue(0, 0, 0, 1);
+            float alpha = 0.0f;
+            channel.GetValue(i / frameRate, cursor, prevValue, nextValue, alpha);
+            reference[i] = MMath::Lerp(prevValue, nextValue, alpha);
+            reference[i].Normalize();
+
+            DVKAnimationCompressor::EncodeQuat(reference[i], &quantized[i * 3]);
+            decoded[i] = DVKAnimationCompressor::DecodeQuat(&quantized[i * 3]);
+        }
+
+        std::vector<int32> frames;
+        FitKeys(reference, decoded, maxError, QuatLerp, QuatError, frames);
+
+        outTrack.frames.resize(frames.size());
+        outTrack.values.resize(frames.size() * 3);
+        for (int32 i = 0; i < frames.size(); ++i)
+        {
+            outTrack.frames[i] = (uint16)frames[i];
+            outTrack.values[i * 3 + 0] = quantized[frames[i] * 3 + 0];
+            outTrack.values[i * 3 + 1] = quantized[frames[i] * 3 + 1];
+            outTrack.values[i * 3 + 2] = quantized[frames[i] * 3 + 2];
+        }
+
+        cursor = 0;
+        for (int32 i = 0; i < frameCount; ++i)
+        {
+            Quat value;
+            outTrack.Sample((float)i, cursor, value);
+            outMaxError = MMath::Max(outMaxError, QuatError(value, reference[i]));
+        }
+
+        stats.keyCountAfter += (uint32)outTrack.frames.size();
+        stats.sizeAfter     += outTrack.GetMemorySize();
+
+        channel.keys.clear();
+        channel.keys.shrink_to_fit();
+        channel.values.clear();
+        channel.values.shrink_to_fit();
+    }
+
+    void DVKAnimationCompressor::Compress(DVKAnimation& animation, const DVKAnimationCompressSettings& settings, DVKAnimationCompressStats& stats)
+    {
+        if (animation.compressed)
+        {
+            return;
+        }
+
+        // 帧数超过uint16的范围时降低采样率
+        float frameRate  = settings.frameRate;
+        int32 frameCount = (int32)MMath::CeilToInt(animation.duration * frameRate) + 1;
+        if (frameCount > ANIM_COMPRESS_MAX_FRAMES)
+        {
+            frameRate  = (ANIM_COMPRESS_MAX_FRAMES - 1) / animation.duration;
+            frameCount = ANIM_COMPRESS_MAX_FRAMES;
+        }
+
+        for (auto it = animation.clips.begin(); it != animation.clips.end(); ++it)
+        {
+            DVKAnimationClip& clip = it->second;
+            CompressVectorChannel(clip.positions, frameCount, frameRate, settings.positionError, clip.compressedPositions, stats, stats.maxPositionError);
+            CompressVectorChannel(clip.scales,    frameCount, frameRate, settings.scaleError,    clip.compressedScales,    stats, stats.maxScaleError);
+            CompressQuatChannel(clip.rotations,   frameCount, frameRate, settings.rotationError, clip.compressedRotations, stats, stats.maxRotationError);
+        }
+
+        animation.frameRate  = frameRate;
+        animation.compressed = true;
+    }
+
+}
@@ -0,0 +1,105 @@
+﻿#pragma once
+
+#include "Engine.h"
+
+#include "Common/Common.h"
+#include "Math/Math.h"
+#include "Math/Vector3.h"
+#include "Math/Quat.h"
+
+#include <vector>
+
+namespace vk_demo
+{
+    struct DVKAnimation;
+
+    // 压缩的误差上限，位移的单位与模型一致，旋转为弧度，均为节点的局部空间
+    struct DVKAnimationCompressSettings
+    {
+        float   frameRate = 30.0f;
+        float   positionError = 0.001f;
+        float   rotationError = 0.0005f;
+        float   scaleError = 0.0001f;
+    };
+
+    // 压缩前后的关键帧数量、内存以及按帧采样得到的最大误差
+    struct DVKAnimationCompressStats
+    {
+        uint32  keyCountBefore = 0;
+        uint32  keyCountAfter = 0;
+        uint32  sizeBefore = 0;
+        uint32  sizeAfter = 0;
+        float   maxPositionError = 0.0f;
+        float   maxRotationError = 0.0f;
+        float   maxScaleError = 0.0f;
+
+        void Add(const DVKAnimationCompressStats& other)
+        {
+            keyCountBefore  += other.keyCountBefore;
+            keyCountAfter   += other.keyCountAfter;
+            sizeBefore      += other.sizeBefore;
+            sizeAfter       += other.sizeAfter;
+            maxPositionError = MMath::Max(maxPositionError, other.maxPositionError);
+            maxRotationError = MMath::Max(maxRotationError, other.maxRotationError);
+            maxScaleError    = MMath::Max(maxScaleError, other.maxScaleError);
+        }
+    };
+
+    // 压缩之后的位移或者缩放通道。关键帧时间为帧序号，数值按通道自身的范围量化为16位：min + q * scale
+    struct DVKCompressedVectorTrack
+    {
+        std::vector<uint16> frames;
+        std::vector<uint16> values;
+        Vector3             min = Vector3(0.0f, 0.0f, 0.0f);
+        Vector3             scale = Vector3(0.0f, 0.0f, 0.0f);
+
+        FORCE_INLINE bool IsEmpty() const
+        {
+            return frames.size() == 0;
+        }
+
+        FORCE_INLINE uint32 GetMemorySize() const
+        {
+            return (uint32)(frames.size() * sizeof(uint16) + values.size() * sizeof(uint16) + sizeof(Vector3) * 2);
+        }
+
+        // frame为浮点的帧序号，cursor为上次采样所在的关键帧，没有关键帧时保持outValue不变
+        void Sample(float frame, int32& cursor, Vector3& outValue) const;
+    };
+
+    // 压缩之后的旋转通道，每个四元数48位：最大分量的序号占2位，其余三个分量各15位(smallest three)
+    struct DVKCompressedQuatTrack
+    {
+        std::vector<uint16> frames;
+        std::vector<uint16> values;
+
+        FORCE_INLINE bool IsEmpty() const
+        {
+            return frames.size() == 0;
+        }
+
+        FORCE_INLINE uint32 GetMemorySize() const
+        {
+            return (uint32)(frames.size() * sizeof(uint16) + values.size() * sizeof(uint16));
+        }
+
+        void Sample(float frame, int32& cursor, Quat& outValue) const;
+    };
+
+    // 动画压缩：按frameRate重新采样，误差范围内删除可以由相邻关键帧线性插值得到的关键帧，之后量化。
+    // 压缩之后DVKAnimationClip中的float通道被清空，GotoAnimation改为采样压缩通道。
+    class DVKAnimationCompressor
+    {
+    public:
+
+        static void Compress(DVKAnimation& animation, const DVKAnimationCompressSettings& settings, DVKAnimationCompressStats& stats);
+
+        // 找到frames[i] <= frame < frames[i + 1]的i，顺序播放时从cursor向后查找，否则二分查找
+        static int32 FindFrame(const std::vector<uint16>& frames, float frame, int32& cursor);
+
+        static void EncodeQuat(const Quat& quat, uint16* outPacked);
+
+        static Quat DecodeQuat(const uint16* packed);
+    };
+
+}
@@ -0,0 +1,374 @@
+﻿#include "DVKAnimationTexture.h"
+#include "DVKModel.h"
+#include "FileManager.h"
+
+#include "Common/Log.h"
+#include "Utils/Crc.h"
+#include "Vulkan/VulkanDevice.h"
+
+#include "meshoptimizer.h"
+
+#include <cstring>
+#include <cctype>
+
+#define ANIM_TEXTURE_MAGIC      0x58455441
+#define ANIM_TEXTURE_VERSION    1
+
+namespace vk_demo
+{
+    struct AnimTextureHeader
+    {
+        uint32  magic;
+        uint32  version;
+        uint32  contentHash;
+        uint32  paletteFormat;
+        uint32  format;
+        int32   width;
+        int32   height;
+        int32   boneCount;
+        int32   animCount;
+        float   sampleRate;
+        uint64  dataSize;
+    };
+
+    template <class T>
+    static FORCE_INLINE uint32 HashArray(const std::vector<T>& values, uint32 hash)
+    {
+        uint32 count = (uint32)values.size();
+        hash = Crc::MemCrc32(&count, sizeof(uint32), hash);
+        if (count > 0)
+        {
+            hash = Crc::MemCrc32(values.data(), (int32)(count * sizeof(T)), hash);
+        }
+        return hash;
+    }
+
+    template <class T>
+    static FORCE_INLINE uint32 HashValue(const T& value, uint32 hash)
+    {
+        return Crc::MemCrc32(&value, sizeof(T), hash);
+    }
+
+    DVKAnimationTexture::~DVKAnimationTexture()
+    {
+        delete texture;
+        texture = nullptr;
+
+        animations.clear();
+        datas.clear();
+    }
+
+    DVKAnimationTexture* DVKAnimationTexture::Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, DVKModel* model, const std::vector<int32>& bones, const DVKAnimationBakeSettings& settings, const std::string& cachePath)
+    {
+        DVKAnimationTexture* animTexture = Bake(model, bones, settings, cachePath);
+        if (animTexture->datas.size() == 0)
+        {
+            return animTexture;
+        }
+
+        uint32 maxDimension = vulkanDevice->GetLimits().maxImageDimension2D;
+        if ((uint32)animTexture->width > maxDimension || (uint32)animTexture->height > maxDimension)
+        {
+            MLOGE("Animation texture too large : %dx%d", animTexture->width, animTexture->height);
+            return animTexture;
+        }
+
+        animTexture->texture = DVKTexture::Create2D(
+            animTexture->datas.data(),
+            (uint32)animTexture->datas.size(),
+            animTexture->format,
+            animTexture->width,
+            animTexture->height,
+            vulkanDevice,
+            cmdBuffer
+        );
+        animTexture->texture->UpdateSampler(
+            VK_FILTER_NEAREST,
+            VK_FILTER_NEAREST,
+            VK_SAMPLER_MIPMAP_MODE_NEAREST,
+            VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+            VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+            VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
+        );
+
+        animTexture->datas.clear();
+        animTexture->datas.shrink_to_fit();
+
+        return animTexture;
+    }
+
+    DVKAnimationTexture* DVKAnimationTexture::Bake(DVKModel* model, const std::vector<int32>& bones, const DVKAnimationBakeSettings& settings, const std::string& cachePath)
+    {
+        DVKAnimationTexture* animTexture = new DVKAnimationTexture();
+        animTexture->sampleRate    = settings.sampleRate;
+        animTexture->format        = settings.format;
+        animTexture->paletteFormat = settings.paletteFormat;
+        animTexture->boneCount     = (int32)bones.size();
+
+        if (settings.paletteFormat == BPF_Matrix4x4 || settings.sampleRate <= 0.0f)
+        {
+            MLOGE("Animation texture needs BPF_DualQuat or BPF_Matrix3x4 and a positive sample rate.");
+            return animTexture;
+        }
+
+        if (settings.format != VK_FORMAT_R16G16B16A16_SFLOAT && settings.format != VK_FORMAT_R32G32B32A32_SFLOAT)
+        {
+            MLOGE("Animation texture only supports RGBA16F and RGBA32F.");
+            return animTexture;
+        }
+
+        if (bones.size() == 0 || model->animations.size() == 0)
+        {
+            MLOGE("Model has no bones or animations to bake.");
+            return animTexture;
+        }
+
+        // 骨骼、节点、动画数据以及烘焙参数都参与哈希，任何一项变化都会生成新的缓存文件，写入成功之后删除旧的文件
+        uint32 hash = ComputeContentHash(model, bones, settings);
+        std::string path;
+        if (cachePath.size() > 0)
+        {
+            char suffix[32];
+            snprintf(suffix, sizeof(suffix), ".%08x.atex", hash);
+            path = cachePath + suffix;
+
+            if (animTexture->LoadCache(path, hash))
+            {
+                return animTexture;
+            }
+        }
+
+        animTexture->Evaluate(model, bones, settings);
+
+        if (path.size() > 0 && animTexture->SaveCache(path, hash))
+        {
+            RemoveStaleCaches(cachePath, path);
+        }
+
+        return animTexture;
+    }
+
+    uint32 DVKAnimationTexture::ComputeContentHash(DVKModel* model, const std::vector<int32>& bones, const DVKAnimationBakeSettings& settings)
+    {
+        uint32 hash = HashValue((uint32)ANIM_TEXTURE_VERSION, 0);
+        hash = HashValue(settings.sampleRate, hash);
+        hash = HashValue(settings.paletteFormat, hash);
+        hash = HashValue(settings.format, hash);
+        hash = HashValue(settings.postMatrix, hash);
+        hash = HashArray(bones, hash);
+
+        for (int32 i = 0; i < bones.size(); ++i)
+        {
+            hash = HashValue(model->bones[bones[i]]->inverseBindPose, hash);
+        }
+
+        // 没有动画的节点使用当前的localMatrix
+        for (int32 i = 0; i < model->linearNodes.size(); ++i)
+        {
+            hash = HashValue(model->linearNodes[i]->localMatrix, hash);
+        }
+
+        for (int32 i = 0; i < model->animations.size(); ++i)
+        {
+            const DVKAnimation& animation = model->animations[i];
+            hash = HashValue(animation.duration, hash);
+            hash = HashValue(animation.compressed, hash);
+            hash = HashValue(animation.frameRate, hash);
+
+            for (int32 j = 0; j < animation.linearClips.size(); ++j)
+            {
+                const DVKAnimationClip* clip = animation.linearClips[j];
+                hash = HashValue(clip->nodeIndex, hash);
+                hash = HashArray(clip->positions.keys, hash);
+                hash = HashArray(clip->positions.values, hash);
+                hash = HashArray(clip->rotations.keys, hash);
+                hash = HashArray(clip->rotations.values, hash);
+                hash = HashArray(clip->scales.keys, hash);
+                hash = HashArray(clip->scales.values, hash);
+                hash = HashArray(clip->compressedPositions.frames, hash);
+                hash = HashArray(clip->compressedPositions.values, hash);
+                hash = HashValue(clip->compressedPositions.min, hash);
+                hash = HashValue(clip->compressedPositions.scale, hash);
+                hash = HashArray(clip->compressedScales.frames, hash);
+                hash = HashArray(clip->compressedScales.values, hash);
+                hash = HashValue(clip->compressedScales.min, hash);
+                hash = HashValue(clip->compressedScales.scale, hash);
+                hash = HashArray(clip->compressedRotations.frames, hash);
+                hash = HashArray(clip->compressedRotations.values, hash);
+            }
+        }
+
+        return hash;
+    }
+
+    void DVKAnimationTexture::Evaluate(DVKModel* model, const std::vector<int32>& bones, const DVKAnimationBakeSettings& settings)
+    {
+        // 每帧一个实例，最后一帧固定在duration
+        std::vector<DVKSkeletonInstance> instances;
+        for (int32 i = 0; i < model->animations.size(); ++i)
+        {
+            const DVKAnimation& animation = model->animations[i];
+
+            DVKBakedAnimation baked;
+            baked.firstFrame = (int32)instances.size();
+            baked.frameCount = MMath::CeilToInt(animation.duration * sampleRate) + 1;
+            baked.duration   = animation.duration;
+            animations.push_back(baked);
+
+            for (int32 frame = 0; frame < baked.frameCount; ++frame)
+            {
+                DVKSkeletonInstance instance;
+                instance.animIndex = i;
+                instance.time      = MMath::Min(frame / sampleRate, animation.duration);
+                instances.push_back(instance);
+            }
+        }
+
+        width  = boneCount * GetTexelsPerBone();
+        height = (int32)instances.size();
+
+        DVKSkeletonBatch* skeletonBatch = DVKSkeletonBatch::Create(model, bones, paletteFormat, settings.postMatrix, settings.numThreads);
+
+        // 一帧的Palette正好是一行
+        uint32 rowFloats = skeletonBatch->GetPaletteSize() / sizeof(float);
+        std::vector<float> palettes((size_t)rowFloats * height);
+        skeletonBatch->Evaluate(instances.data(), (int32)instances.size(), palettes.data(), skeletonBatch->GetPaletteSize());
+        delete skeletonBatch;
+
+        if (format == VK_FORMAT_R32G32B32A32_SFLOAT)
+        {
+            datas.resize(palettes.size() * sizeof(float));
+            memcpy(datas.data(), palettes.data(), datas.size());
+            return;
+        }
+
+        datas.resize(palettes.size() * sizeof(uint16));
+        uint16* halfs = (uint16*)datas.data();
+        for (size_t i = 0; i < palettes.size(); ++i)
+        {
+            halfs[i] = meshopt_quantizeHalf(palettes[i]);
+        }
+    }
+
+    bool DVKAnimationTexture::LoadCache(const std::string& path, uint32 hash)
+    {
+        uint32 dataSize = 0;
+        uint8* dataPtr  = nullptr;
+        if (!FileManager::ReadFile(path, dataPtr, dataSize))
+        {
+            return false;
+        }
+
+        bool valid = dataSize >= sizeof(AnimTextureHeader);
+
+        AnimTextureHeader header;
+        memset(&header, 0, sizeof(AnimTextureHeader));
+        if (valid)
+        {
+            memcpy(&header, dataPtr, sizeof(AnimTextureHeader));
+        }
+
+        uint64 animSize = (uint64)header.animCount * sizeof(DVKBakedAnimation);
+        valid = valid &&
+                header.magic == ANIM_TEXTURE_MAGIC &&
+                header.version == ANIM_TEXTURE_VERSION &&
+                header.contentHash == hash &&
+                header.animCount >= 0 &&
+                sizeof(AnimTextureHeader) + animSize + header.dataSize == dataSize;
+
+        if (!valid)
+        {
+            MLOG("Animation texture cache outdated :%s", path.c_str());
+            delete[] dataPtr;
+            return false;
+        }
+
+        const uint8* ptr = dataPtr + sizeof(AnimTextureHeader);
+        animations.resize(header.animCount);
+        memcpy(animations.data(), ptr, animSize);
+        ptr += animSize;
+        datas.assign(ptr, ptr + header.dataSize);
+
+        width     = header.width;
+        height    = header.height;
+        fromCache = true;
+
+        delete[] dataPtr;
+
+        return true;
+    }
+
+    bool DVKAnimationTexture::SaveCache(const std::string& path, uint32 hash)
+    {
+        AnimTextureHeader header;
+        memset(&header, 0, sizeof(AnimTextureHeader));
+        header.magic         = ANIM_TEXTURE_MAGIC;
+        header.version       = ANIM_TEXTURE_VERSION;
+        header.contentHash   = hash;
+        header.paletteFormat = paletteFormat;
+        header.format        = format;
+        header.width         = width;
+        header.height        = height;
+        header.boneCount     = boneCount;
+        header.animCount     = (int32)animations.size();
+        header.sampleRate    = sampleRate;
+        header.dataSize      = datas.size();
+
+        uint64 animSize = animations.size() * sizeof(DVKBakedAnimation);
+        std::vector<uint8> fileData(sizeof(AnimTextureHeader) + animSize + datas.size());
+        memcpy(fileData.data(), &header, sizeof(AnimTextureHeader));
+        memcpy(fileData.data() + sizeof(AnimTextureHeader), animations.data(), animSize);
+        memcpy(fileData.data() + sizeof(AnimTextureHeader) + animSize, datas.data(), datas.size());
+
+        if (!FileManager::WriteFile(path, fileData.data(), (uint32)fileData.size()))
+        {
+            return false;
+        }
+
+        MLOG("Animation texture cache saved :%s", path.c_str());
+        return true;
+    }
+
+    void DVKAnimationTexture::RemoveStaleCaches(const std::string& cachePath, const std::string& keepPath)
+    {
+        size_t slash = cachePath.find_last_of("/\\");
+        std::string directory = slash == std::string::npos ? "" : cachePath.substr(0, slash);
+        std::string baseName  = slash == std::string::npos ? cachePath : cachePath.substr(slash + 1);
+        std::string keepName  = keepPath.substr(slash == std::string::npos ? 0 : slash + 1);
+
+        std::vector<std::string> files;
+        if (!FileManager::ListFiles(directory, files))
+        {
+            return;
+        }
+
+        // 只匹配 baseName.xxxxxxxx.atex
+        const std::string suffix = ".atex";
+        for (int32 i = 0; i < files.size(); ++i)
+        {
+            const std::string& name = files[i];
+            if (name == keepName || name.size() != baseName.size() + 9 + suffix.size())
+            {
+                continue;
+            }
+
+            if (name.compare(0, baseName.size(), baseName) != 0 || name[baseName.size()] != '.' || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+            {
+                continue;
+            }
+
+            bool hexHash = true;
+            for (size_t j = baseName.size() + 1; j < baseName.size() + 9; ++j)
+            {
+                hexHash = hexHash && isxdigit((uint8)name[j]);
+            }
+
+            std::string stalePath = directory.size() > 0 ? directory + "/" + name : name;
+            if (hexHash && FileManager::RemoveFile(stalePath))
+            {
+                MLOG("Animation texture cache removed :%s", stalePath.c_str());
+            }
+        }
+    }
+
+}
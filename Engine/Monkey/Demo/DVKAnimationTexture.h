@@ -0,0 +1,106 @@
+﻿#pragma once
+
+#include "Engine.h"
+#include "DVKTexture.h"
+#include "DVKCommand.h"
+#include "DVKSkeletonBatch.h"
+
+#include "Common/Common.h"
+#include "Math/Math.h"
+#include "Math/Matrix4x4.h"
+#include "Vulkan/VulkanCommon.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace vk_demo
+{
+    class DVKModel;
+
+    struct DVKAnimationBakeSettings
+    {
+        // 每秒采样的帧数
+        float               sampleRate = 30.0f;
+        // BPF_DualQuat每个骨骼2个像素，BPF_Matrix3x4每个骨骼3个像素，不支持BPF_Matrix4x4
+        BonePaletteFormat   paletteFormat = BPF_DualQuat;
+        // VK_FORMAT_R16G16B16A16_SFLOAT或者VK_FORMAT_R32G32B32A32_SFLOAT，half的平移精度随模型尺寸下降
+        VkFormat            format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        // 追加在finalTransform之后，例如linkNode的逆矩阵
+        Matrix4x4           postMatrix;
+        // 0时使用所有核心
+        int32               numThreads = 0;
+    };
+
+    // 一个动画在Texture中占用的连续行
+    struct DVKBakedAnimation
+    {
+        int32   firstFrame = 0;
+        int32   frameCount = 0;
+        float   duration = 0.0f;
+    };
+
+    // 把模型的全部动画烘焙进一张Texture：每帧一行，每个骨骼连续的2个(对偶四元数)或者3个(3x4矩阵)像素。
+    // 采样在工作线程中并行完成，cachePath不为空时结果按内容缓存到磁盘，之后每帧不再需要CPU计算骨骼。
+    class DVKAnimationTexture
+    {
+    private:
+
+        DVKAnimationTexture()
+        {
+
+        }
+
+    public:
+
+        ~DVKAnimationTexture();
+
+        // bones为需要输出的骨骼，通常为DVKMesh::bones
+        static DVKAnimationTexture* Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, DVKModel* model, const std::vector<int32>& bones, const DVKAnimationBakeSettings& settings, const std::string& cachePath = "");
+
+        // 只在CPU上烘焙，结果保留在datas中，不创建Texture
+        static DVKAnimationTexture* Bake(DVKModel* model, const std::vector<int32>& bones, const DVKAnimationBakeSettings& settings, const std::string& cachePath = "");
+
+        // 动画在time时刻对应的行，小数部分用于相邻两行之间插值
+        FORCE_INLINE float GetFrame(int32 animIndex, float time) const
+        {
+            const DVKBakedAnimation& animation = animations[animIndex];
+            float frame = MMath::Clamp(time * sampleRate, 0.0f, (float)(animation.frameCount - 1));
+            return animation.firstFrame + frame;
+        }
+
+        FORCE_INLINE int32 GetTexelsPerBone() const
+        {
+            return paletteFormat == BPF_Matrix3x4 ? 3 : 2;
+        }
+
+    private:
+
+        static uint32 ComputeContentHash(DVKModel* model, const std::vector<int32>& bones, const DVKAnimationBakeSettings& settings);
+
+        bool LoadCache(const std::string& path, uint32 hash);
+
+        bool SaveCache(const std::string& path, uint32 hash);
+
+        // 删除同一个资源之前写入的其它哈希的缓存文件
+        static void RemoveStaleCaches(const std::string& cachePath, const std::string& keepPath);
+
+        void Evaluate(DVKModel* model, const std::vector<int32>& bones, const DVKAnimationBakeSettings& settings);
+
+    public:
+
+        DVKTexture*                     texture = nullptr;
+        std::vector<DVKBakedAnimation>  animations;
+        // 按format排布好的像素数据，上传之后清空
+        std::vector<uint8>              datas;
+
+        int32                           width = 0;
+        int32                           height = 0;
+        int32                           boneCount = 0;
+        float                           sampleRate = 30.0f;
+        VkFormat                        format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        BonePaletteFormat               paletteFormat = BPF_DualQuat;
+        bool                            fromCache = false;
+    };
+
+}
@@ -4,6 +4,69 @@
 namespace vk_demo
 {
 
+    void DVKFrustum::Build(const Matrix4x4& viewProj)
+    {
+        // 裁剪面由M的列组合得到
+        Vector4 col[4];
+        for (int32 i = 0; i < 4; ++i)
+        {
+            col[i] = Vector4(viewProj.m[0][i], viewProj.m[1][i], viewProj.m[2][i], viewProj.m[3][i]);
+        }
+
+        Vector4 clipPlanes[FP_Count];
+        clipPlanes[FP_Left]   = col[3] + col[0];
+        clipPlanes[FP_Right]  = col[3] - col[0];
+        clipPlanes[FP_Bottom] = col[3] + col[1];
+        clipPlanes[FP_Top]    = col[3] - col[1];
+        clipPlanes[FP_Near]   = col[2];
+        clipPlanes[FP_Far]    = col[3] - col[2];
+
+        // dot(n, p) + d >= 0转换为Plane的dot(n, p) - w >= 0。远平面的法线长度约为near/far，不能使用默认的容差
+        for (int32 i = 0; i < FP_Count; ++i)
+        {
+            planes[i] = Plane(clipPlanes[i].x, clipPlanes[i].y, clipPlanes[i].z, -clipPlanes[i].w);
+            planes[i].Normalize(0.0f);
+        }
+    }
+
+    void DVKFrustum::GetPlanes(Vector4* outPlanes) const
+    {
+        for (int32 i = 0; i < FP_Count; ++i)
+        {
+            outPlanes[i] = Vector4(planes[i].x, planes[i].y, planes[i].z, -planes[i].w);
+        }
+    }
+
+    bool DVKFrustum::IsSphereVisible(const Vector3& center, float radius) const
+    {
+        for (int32 i = 0; i < FP_Count; ++i)
+        {
+            if (planes[i].PlaneDot(center) < -radius)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool DVKFrustum::IsBoxVisible(const Vector3& min, const Vector3& max) const
+    {
+        for (int32 i = 0; i < FP_Count; ++i)
+        {
+            const Plane& plane = planes[i];
+            Vector3 farthest(
+                plane.x >= 0.0f ? max.x : min.x,
+                plane.y >= 0.0f ? max.y : min.y,
+                plane.z >= 0.0f ? max.z : min.z
+            );
+            if (plane.PlaneDot(farthest) < 0.0f)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
     DVKCamera::DVKCamera()
     {
         freeze = Vector3(0, 0, 0);
@@ -6,10 +6,39 @@
 #include "Math/Vector3.h"
 #include "Math/Vector4.h"
 #include "Math/Vector2.h"
+#include "Math/Plane.h"
 
 namespace vk_demo
 {
 
+    // 视锥体的6个平面，法线朝向内侧，Plane::PlaneDot(p) >= 0为内侧
+    struct DVKFrustum
+    {
+        enum PlaneIndex
+        {
+            FP_Left = 0,
+            FP_Right,
+            FP_Bottom,
+            FP_Top,
+            FP_Near,
+            FP_Far,
+            FP_Count
+        };
+
+        Plane planes[FP_Count];
+
+        // 行向量约定clip = p * M，Vulkan的深度范围为[0, w]
+        void Build(const Matrix4x4& viewProj);
+
+        // 着色器使用的(n, d)形式，dot(n, p) + d >= 0为内侧
+        void GetPlanes(Vector4* outPlanes) const;
+
+        bool IsSphereVisible(const Vector3& center, float radius) const;
+
+        // 只测试沿法线最远的角点，与视锥体的角相交的情况会保守地判定为可见
+        bool IsBoxVisible(const Vector3& min, const Vector3& max) const;
+    };
+
     class DVKCamera
     {
     public:
@@ -134,6 +163,13 @@ namespace vk_demo
             return m_ViewProjection;
         }
 
+        // 由当前的ViewProjection计算
+        FORCE_INLINE const DVKFrustum& GetFrustum()
+        {
+            m_Frustum.Build(GetViewProjection());
+            return m_Frustum;
+        }
+
         FORCE_INLINE void SetTransform(const Matrix4x4& world)
         {
             m_World = world;
@@ -154,6 +190,12 @@ namespace vk_demo
             m_Projection.Perspective(fovy, width, height, zNear, zFar);
         }
 
+        // 窗口尺寸变化时只更新宽高比，视角与远近平面保持不变
+        FORCE_INLINE void SetAspect(float width, float height)
+        {
+            Perspective(m_Fov, width, height, m_Near, m_Far);
+        }
+
         FORCE_INLINE void Orthographic(float left, float right, float bottom, float top, float minZ, float maxZ)
         {
             m_Near   = minZ;
@@ -227,6 +269,7 @@ namespace vk_demo
         Matrix4x4   m_View;
         Matrix4x4   m_Projection;
         Matrix4x4   m_ViewProjection;
+        DVKFrustum  m_Frustum;
 
         float       m_Near = 1.0f;
         float       m_Far = 3000.0f;
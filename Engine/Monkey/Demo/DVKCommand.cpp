@@ -52,6 +52,22 @@ namespace vk_demo
         vkWaitForFences(vulkanDevice->GetInstanceHandle(), 1, &fence, true, MAX_uint64);
     }
 
+    uint64 DVKCommandBuffer::SubmitAsync(DVKFrameScheduler* frameScheduler, DVKFrameScheduler::QueueType frameQueueType, VkSemaphore signalSemaphore)
+    {
+        End();
+
+        for (int32 i = 0; i < waitSemaphores.size(); ++i)
+        {
+            frameScheduler->AddWaitSemaphore(frameQueueType, waitSemaphores[i], waitFlags[i]);
+        }
+
+        scheduler      = frameScheduler;
+        queueType      = frameQueueType;
+        submittedValue = frameScheduler->Submit(frameQueueType, &cmdBuffer, 1, signalSemaphore);
+
+        return submittedValue;
+    }
+
     void DVKCommandBuffer::Begin()
     {
         if (isBegun)
@@ -60,6 +76,12 @@ namespace vk_demo
         }
         isBegun = true;
 
+        // CommandBuffer重新录制之前必须等待上一次提交执行完毕
+        if (scheduler && submittedValue > 0)
+        {
+            scheduler->Wait(queueType, submittedValue);
+        }
+
         VkCommandBufferBeginInfo cmdBufBeginInfo;
         ZeroVulkanStruct(cmdBufBeginInfo, VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO);
         cmdBufBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
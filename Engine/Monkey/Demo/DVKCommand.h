@@ -7,6 +7,8 @@
 
 #include "Vulkan/VulkanCommon.h"
 
+#include "DVKFrameScheduler.h"
+
 #include <string>
 #include <cstring>
 #include <vector>
@@ -32,6 +34,9 @@ namespace vk_demo
 
         void Submit(VkSemaphore* signalSemaphore = nullptr);
 
+        // 通过调度器提交，不阻塞，返回timeline值。再次Begin时才等待上一次提交完成。
+        uint64 SubmitAsync(DVKFrameScheduler* frameScheduler, DVKFrameScheduler::QueueType frameQueueType, VkSemaphore signalSemaphore = VK_NULL_HANDLE);
+
         static DVKCommandBuffer* Create(std::shared_ptr<VulkanDevice> vulkanDevice, VkCommandPool commandPool, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY, std::shared_ptr<VulkanQueue> queue = nullptr);
 
     public:
@@ -45,6 +50,10 @@ namespace vk_demo
         std::vector<VkSemaphore>            waitSemaphores;
 
         bool                                isBegun;
+
+        DVKFrameScheduler*                  scheduler = nullptr;
+        DVKFrameScheduler::QueueType        queueType = DVKFrameScheduler::QueueType::Graphics;
+        uint64                              submittedValue = 0;
     };
 
 }
@@ -7,13 +7,27 @@
 #include "DVKIndexBuffer.h"
 #include "DVKVertexBuffer.h"
 #include "DVKModel.h"
+#include "DVKMeshCache.h"
+#include "DVKMeshOptimizer.h"
 #include "DVKPipeline.h"
 #include "DVKTexture.h"
 #include "DVKShader.h"
 #include "DVKDefaultRes.h"
 #include "DVKMaterial.h"
 #include "DVKCamera.h"
+#include "DVKLodSelector.h"
+#include "DVKMeshletCuller.h"
+#include "DVKGLTFLoader.h"
+#include "DVKAnimationCompressor.h"
+#include "DVKSkeletonBatch.h"
+#include "DVKComputeSkinner.h"
+#include "DVKAnimationTexture.h"
+#include "DVKFrustumCuller.h"
+#include "DVKSceneBVH.h"
 #include "DVKRenderTarget.h"
 #include "DVKCompute.h"
+#include "DVKQuery.h"
+#include "DVKReadback.h"
+#include "DVKFrameScheduler.h"
 #include "FileManager.h"
 #include "ImageGUIContext.h"
\ No newline at end of file
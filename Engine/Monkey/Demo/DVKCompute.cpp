@@ -261,4 +261,110 @@ namespace vk_demo
         }
     }
 
+    static void OwnershipBufferBarrier(VkCommandBuffer commandBuffer, DVKBuffer* buffer, uint32 srcFamily, uint32 dstFamily, VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage)
+    {
+        VkBufferMemoryBarrier bufferBarrier;
+        ZeroVulkanStruct(bufferBarrier, VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER);
+        bufferBarrier.buffer = buffer->buffer;
+        bufferBarrier.offset = 0;
+        bufferBarrier.size   = VK_WHOLE_SIZE;
+        bufferBarrier.srcAccessMask = srcAccess;
+        bufferBarrier.dstAccessMask = dstAccess;
+        bufferBarrier.srcQueueFamilyIndex = srcFamily;
+        bufferBarrier.dstQueueFamilyIndex = dstFamily;
+
+        vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 1, &bufferBarrier, 0, nullptr);
+    }
+
+    static VkImageAspectFlags GetImageAspect(VkFormat format)
+    {
+        switch (format)
+        {
+            case VK_FORMAT_D16_UNORM:
+            case VK_FORMAT_X8_D24_UNORM_PACK32:
+            case VK_FORMAT_D32_SFLOAT:
+                return VK_IMAGE_ASPECT_DEPTH_BIT;
+            case VK_FORMAT_S8_UINT:
+                return VK_IMAGE_ASPECT_STENCIL_BIT;
+            case VK_FORMAT_D16_UNORM_S8_UINT:
+            case VK_FORMAT_D24_UNORM_S8_UINT:
+            case VK_FORMAT_D32_SFLOAT_S8_UINT:
+                return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+            default:
+                return VK_IMAGE_ASPECT_COLOR_BIT;
+        }
+    }
+
+    static void OwnershipImageBarrier(VkCommandBuffer commandBuffer, DVKTexture* texture, uint32 srcFamily, uint32 dstFamily, VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage)
+    {
+        VkImageMemoryBarrier imageBarrier;
+        ZeroVulkanStruct(imageBarrier, VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER);
+        imageBarrier.image         = texture->image;
+        imageBarrier.oldLayout     = texture->imageLayout;
+        imageBarrier.newLayout     = texture->imageLayout;
+        imageBarrier.srcAccessMask = srcAccess;
+        imageBarrier.dstAccessMask = dstAccess;
+        imageBarrier.srcQueueFamilyIndex = srcFamily;
+        imageBarrier.dstQueueFamilyIndex = dstFamily;
+        imageBarrier.subresourceRange.aspectMask     = GetImageAspect(texture->format);
+        imageBarrier.subresourceRange.baseMipLevel   = 0;
+        imageBarrier.subresourceRange.levelCount     = VK_REMAINING_MIP_LEVELS;
+        imageBarrier.subresourceRange.baseArrayLayer = 0;
+        imageBarrier.subresourceRange.layerCount     = VK_REMAINING_ARRAY_LAYERS;
+
+        vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+    }
+
+    void DVKCompute::ReleaseBuffer(VkCommandBuffer commandBuffer, DVKBuffer* buffer, uint32 srcFamily, uint32 dstFamily, VkAccessFlags srcAccess, VkPipelineStageFlags srcStage)
+    {
+        if (srcFamily == dstFamily)
+        {
+            return;
+        }
+        // Release的dstAccess会被忽略
+        OwnershipBufferBarrier(commandBuffer, buffer, srcFamily, dstFamily, srcAccess, 0, srcStage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    }
+
+    void DVKCompute::AcquireBuffer(VkCommandBuffer commandBuffer, DVKBuffer* buffer, uint32 srcFamily, uint32 dstFamily, VkAccessFlags dstAccess, VkPipelineStageFlags dstStage)
+    {
+        if (srcFamily == dstFamily)
+        {
+            return;
+        }
+        // Acquire的srcAccess会被忽略，执行依赖由semaphore提供
+        OwnershipBufferBarrier(commandBuffer, buffer, srcFamily, dstFamily, 0, dstAccess, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dstStage);
+    }
+
+    void DVKCompute::ReleaseImage(VkCommandBuffer commandBuffer, DVKTexture* texture, uint32 srcFamily, uint32 dstFamily, VkAccessFlags srcAccess, VkPipelineStageFlags srcStage)
+    {
+        if (srcFamily == dstFamily)
+        {
+            return;
+        }
+        OwnershipImageBarrier(commandBuffer, texture, srcFamily, dstFamily, srcAccess, 0, srcStage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    }
+
+    void DVKCompute::AcquireImage(VkCommandBuffer commandBuffer, DVKTexture* texture, uint32 srcFamily, uint32 dstFamily, VkAccessFlags dstAccess, VkPipelineStageFlags dstStage)
+    {
+        if (srcFamily == dstFamily)
+        {
+            return;
+        }
+        OwnershipImageBarrier(commandBuffer, texture, srcFamily, dstFamily, 0, dstAccess, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dstStage);
+    }
+
+    uint64 DVKCompute::SubmitAsync(DVKCommandBuffer* cmdBuffer, DVKFrameScheduler* scheduler, VkPipelineStageFlags graphicsWaitStage)
+    {
+        uint64 computeValue = cmdBuffer->SubmitAsync(scheduler, DVKFrameScheduler::QueueType::Compute);
+
+        scheduler->AddWait(
+            DVKFrameScheduler::QueueType::Graphics,
+            DVKFrameScheduler::QueueType::Compute,
+            computeValue,
+            graphicsWaitStage
+        );
+
+        return computeValue;
+    }
+
 }
@@ -11,6 +11,8 @@
 #include "DVKShader.h"
 #include "DVKPipeline.h"
 #include "DVKMaterial.h"
+#include "DVKCommand.h"
+#include "DVKFrameScheduler.h"
 
 #include "Math/Math.h"
 #include "Vulkan/VulkanCommon.h"
@@ -48,6 +50,20 @@ namespace vk_demo
 
         void SetStorageBuffer(const std::string& name, DVKBuffer* buffer);
 
+        // 队列族所有权转移：Release在源队列上录制，Acquire在目标队列上录制，两者参数需一致。
+        // 队列族相同时不需要转移，由semaphore保证可见性。
+        static void ReleaseBuffer(VkCommandBuffer commandBuffer, DVKBuffer* buffer, uint32 srcFamily, uint32 dstFamily, VkAccessFlags srcAccess, VkPipelineStageFlags srcStage);
+
+        static void AcquireBuffer(VkCommandBuffer commandBuffer, DVKBuffer* buffer, uint32 srcFamily, uint32 dstFamily, VkAccessFlags dstAccess, VkPipelineStageFlags dstStage);
+
+        // Image的layout在转移前后保持不变
+        static void ReleaseImage(VkCommandBuffer commandBuffer, DVKTexture* texture, uint32 srcFamily, uint32 dstFamily, VkAccessFlags srcAccess, VkPipelineStageFlags srcStage);
+
+        static void AcquireImage(VkCommandBuffer commandBuffer, DVKTexture* texture, uint32 srcFamily, uint32 dstFamily, VkAccessFlags dstAccess, VkPipelineStageFlags dstStage);
+
+        // 在异步计算队列上提交，下一次图形队列的提交在graphicsWaitStage等待计算完成，返回计算队列的timeline值
+        static uint64 SubmitAsync(DVKCommandBuffer* cmdBuffer, DVKFrameScheduler* scheduler, VkPipelineStageFlags graphicsWaitStage);
+
         FORCE_INLINE VkPipeline GetPipeline() const
         {
             return pipeline;
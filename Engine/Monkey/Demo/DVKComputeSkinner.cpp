@@ -0,0 +1,449 @@
+﻿#include "DVKComputeSkinner.h"
+#include "DVKModel.h"
+
+#include "Vulkan/VulkanDevice.h"
+
+// 与SkinCompute.comp的local_size_x一致
+#define SKIN_COMPUTE_GROUP_SIZE     64
+// vkCmdUpdateBuffer单次最多写入的字节数
+#define SKIN_UPDATE_MAX_SIZE        65536
+
+namespace vk_demo
+{
+
+    static FORCE_INLINE bool IsSkinAttribute(VertexAttribute attribute)
+    {
+        return attribute == VertexAttribute::VA_SkinIndex ||
+               attribute == VertexAttribute::VA_SkinWeight ||
+               attribute == VertexAttribute::VA_SkinPack ||
+               attribute == VertexAttribute::VA_SkinIndexU8 ||
+               attribute == VertexAttribute::VA_SkinWeightUN8 ||
+               attribute == VertexAttribute::VA_SkinWeightUN16;
+    }
+
+    static FORCE_INLINE Vector3 DecodeOctahedron(const int16* src)
+    {
+        float u = MMath::Clamp(src[0] / 32767.0f, -1.0f, 1.0f);
+        float v = MMath::Clamp(src[1] / 32767.0f, -1.0f, 1.0f);
+        float z = 1.0f - MMath::Abs(u) - MMath::Abs(v);
+        if (z < 0.0f)
+        {
+            float fu = (1.0f - MMath::Abs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+            float fv = (1.0f - MMath::Abs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+            u = fu;
+            v = fv;
+        }
+
+        Vector3 normal(u, v, z);
+        normal.Normalize();
+        return normal;
+    }
+
+    DVKComputeSkinner::~DVKComputeSkinner()
+    {
+        delete compute;
+        delete sourceBuffer;
+        delete boneBuffer;
+        delete skinnedBuffer;
+
+        compute       = nullptr;
+        sourceBuffer  = nullptr;
+        boneBuffer    = nullptr;
+        skinnedBuffer = nullptr;
+
+        attributes.clear();
+        ranges.clear();
+        boneOffsets.clear();
+        bones.clear();
+
+        model        = nullptr;
+        vulkanDevice = nullptr;
+    }
+
+    DVKComputeSkinner* DVKComputeSkinner::Create(std::shared_ptr<VulkanDevice> vulkanDevice, VkPipelineCache pipelineCache, DVKShader* shader, DVKModel* model, DVKCommandBuffer* cmdBuffer)
+    {
+        DVKComputeSkinner* skinner = new DVKComputeSkinner();
+        skinner->vulkanDevice = vulkanDevice;
+        skinner->model        = model;
+
+        if (!skinner->PrepareBuffers(cmdBuffer))
+        {
+            return skinner;
+        }
+
+        skinner->compute = DVKCompute::Create(vulkanDevice, pipelineCache, shader);
+        skinner->compute->SetStorageBuffer("inVertices", skinner->sourceBuffer);
+        skinner->compute->SetStorageBuffer("inBones", skinner->boneBuffer);
+        skinner->compute->SetStorageBuffer("outVertices", skinner->skinnedBuffer);
+
+        return skinner;
+    }
+
+    bool DVKComputeSkinner::PrepareBuffers(DVKCommandBuffer* cmdBuffer)
+    {
+        // 各属性在源顶点中的偏移(float)，-1表示不存在
+        int32 offsets[VertexAttribute::VA_Count];
+        for (int32 i = 0; i < VertexAttribute::VA_Count; ++i)
+        {
+            offsets[i] = -1;
+        }
+
+        int32 srcStride = 0;
+        int32 dstStride = 0;
+        std::vector<int32> copyOffsets;
+        std::vector<int32> copySizes;
+        for (int32 i = 0; i < model->attributes.size(); ++i)
+        {
+            VertexAttribute attribute = model->attributes[i];
+            int32 size = VertexAttributeToSize(attribute) / sizeof(float);
+            offsets[attribute] = srcStride;
+
+            if (!IsSkinAttribute(attribute))
+            {
+                attributes.push_back(attribute);
+                copyOffsets.push_back(srcStride);
+                copySizes.push_back(size);
+                dstStride += size;
+            }
+
+            srcStride += size;
+        }
+
+        if (offsets[VertexAttribute::VA_Position] < 0)
+        {
+            MLOGE("Compute skinning needs float positions(VA_Position).");
+            return false;
+        }
+
+        memset(&param, 0, sizeof(SkinParam));
+        param.info[1] = dstStride;
+        for (int32 i = 0, offset = 0; i < attributes.size(); ++i)
+        {
+            if (attributes[i] == VertexAttribute::VA_Position)
+            {
+                param.info[2] = offset;
+            }
+            else if (attributes[i] == VertexAttribute::VA_Normal)
+            {
+                param.info[3] = offset;
+                param.format[0] = 1;
+            }
+            else if (attributes[i] == VertexAttribute::VA_NormalOct)
+            {
+                param.info[3] = offset;
+                param.format[0] = 2;
+            }
+            else if (attributes[i] == VertexAttribute::VA_Tangent)
+            {
+                param.format[1] = 1;
+                param.format[2] = offset;
+            }
+            else if (attributes[i] == VertexAttribute::VA_TangentSN16)
+            {
+                param.format[1] = 2;
+                param.format[2] = offset;
+            }
+            offset += VertexAttributeToSize(attributes[i]) / sizeof(float);
+        }
+
+        std::vector<SkinVertex> skinVertices;
+        std::vector<float> dstVertices;
+        int32 boneCount = 0;
+
+        for (int32 i = 0; i < model->meshes.size(); ++i)
+        {
+            DVKMesh* mesh = model->meshes[i];
+
+            // 没有骨骼的Mesh占用一个矩阵，即节点的全局矩阵
+            int32 meshBones = MMath::Max<int32>(1, (int32)mesh->bones.size());
+            boneOffsets.push_back(boneCount);
+
+            for (int32 j = 0; j < mesh->primitives.size(); ++j)
+            {
+                DVKPrimitive* primitive = mesh->primitives[j];
+                if (primitive->vertices.size() == 0)
+                {
+                    continue;
+                }
+
+                DrawRange range;
+                range.primitive    = primitive;
+                range.vertexOffset = (int32)skinVertices.size();
+                ranges.push_back(range);
+
+                int32 count = (int32)primitive->vertices.size() / srcStride;
+                for (int32 k = 0; k < count; ++k)
+                {
+                    const float* src = primitive->vertices.data() + k * srcStride;
+
+                    for (int32 a = 0; a < copyOffsets.size(); ++a)
+                    {
+                        dstVertices.insert(dstVertices.end(), src + copyOffsets[a], src + copyOffsets[a] + copySizes[a]);
+                    }
+
+                    int32 indices[4] = { 0, 0, 0, 0 };
+                    float weights[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+
+                    if (offsets[VertexAttribute::VA_SkinPack] >= 0)
+                    {
+                        const float* pack = src + offsets[VertexAttribute::VA_SkinPack];
+                        uint32 packIndex = (uint32)pack[0];
+                        uint32 weight01  = (uint32)pack[1];
+                        uint32 weight23  = (uint32)pack[2];
+                        indices[0] = (packIndex >> 24) & 0xFF;
+                        indices[1] = (packIndex >> 16) & 0xFF;
+                        indices[2] = (packIndex >>  8) & 0xFF;
+                        indices[3] = (packIndex >>  0) & 0xFF;
+                        weights[0] = (weight01 >> 16) / 65535.0f;
+                        weights[1] = (weight01 & 0xFFFF) / 65535.0f;
+                        weights[2] = (weight23 >> 16) / 65535.0f;
+                        weights[3] = (weight23 & 0xFFFF) / 65535.0f;
+                    }
+
+                    if (offsets[VertexAttribute::VA_SkinIndex] >= 0)
+                    {
+                        const float* index = src + offsets[VertexAttribute::VA_SkinIndex];
+                        for (int32 n = 0; n < 4; ++n)
+                        {
+                            indices[n] = (int32)index[n];
+                        }
+                    }
+                    else if (offsets[VertexAttribute::VA_SkinIndexU8] >= 0)
+                    {
+                        uint8 index[4];
+                        memcpy(index, src + offsets[VertexAttribute::VA_SkinIndexU8], sizeof(index));
+                        for (int32 n = 0; n < 4; ++n)
+                        {
+                            indices[n] = index[n];
+                        }
+                    }
+
+                    if (offsets[VertexAttribute::VA_SkinWeight] >= 0)
+                    {
+                        memcpy(weights, src + offsets[VertexAttribute::VA_SkinWeight], sizeof(weights));
+                    }
+                    else if (offsets[VertexAttribute::VA_SkinWeightUN8] >= 0)
+                    {
+                        uint8 weight[4];
+                        memcpy(weight, src + offsets[VertexAttribute::VA_SkinWeightUN8], sizeof(weight));
+                        for (int32 n = 0; n < 4; ++n)
+                        {
+                            weights[n] = weight[n] / 255.0f;
+                        }
+                    }
+                    else if (offsets[VertexAttribute::VA_SkinWeightUN16] >= 0)
+                    {
+                        uint16 weight[4];
+                        memcpy(weight, src + offsets[VertexAttribute::VA_SkinWeightUN16], sizeof(weight));
+                        for (int32 n = 0; n < 4; ++n)
+                        {
+                            weights[n] = weight[n] / 65535.0f;
+                        }
+                    }
+
+                    SkinVertex vertex;
+                    vertex.position   = Vector3(src[offsets[VertexAttribute::VA_Position] + 0], src[offsets[VertexAttribute::VA_Position] + 1], src[offsets[VertexAttribute::VA_Position] + 2]);
+                    vertex.boneOffset = boneCount;
+                    vertex.normal     = Vector3::ZeroVector;
+                    vertex.indices    = 0;
+                    vertex.weights    = Vector4(weights[0], weights[1], weights[2], weights[3]);
+                    vertex.tangent    = Vector4(1.0f, 0.0f, 0.0f, 1.0f);
+
+                    if (offsets[VertexAttribute::VA_Normal] >= 0)
+                    {
+                        const float* normal = src + offsets[VertexAttribute::VA_Normal];
+                        vertex.normal = Vector3(normal[0], normal[1], normal[2]);
+                    }
+                    else if (offsets[VertexAttribute::VA_NormalOct] >= 0)
+                    {
+                        int16 packed[2];
+                        memcpy(packed, src + offsets[VertexAttribute::VA_NormalOct], sizeof(packed));
+                        vertex.normal = DecodeOctahedron(packed);
+                    }
+
+                    if (offsets[VertexAttribute::VA_Tangent] >= 0)
+                    {
+                        const float* tangent = src + offsets[VertexAttribute::VA_Tangent];
+                        vertex.tangent = Vector4(tangent[0], tangent[1], tangent[2], tangent[3]);
+                    }
+                    else if (offsets[VertexAttribute::VA_TangentSN16] >= 0)
+                    {
+                        int16 packed[4];
+                        memcpy(packed, src + offsets[VertexAttribute::VA_TangentSN16], sizeof(packed));
+                        vertex.tangent = Vector4(
+                            MMath::Clamp(packed[0] / 32767.0f, -1.0f, 1.0f),
+                            MMath::Clamp(packed[1] / 32767.0f, -1.0f, 1.0f),
+                            MMath::Clamp(packed[2] / 32767.0f, -1.0f, 1.0f),
+                            packed[3] < 0 ? -1.0f : 1.0f
+                        );
+                    }
+
+                    for (int32 n = 0; n < 4; ++n)
+                    {
+                        uint32 index = (uint32)MMath::Clamp(indices[n], 0, meshBones - 1);
+                        vertex.indices |= index << (n * 8);
+                    }
+
+                    skinVertices.push_back(vertex);
+                }
+            }
+
+            boneCount += meshBones;
+        }
+
+        vertexCount = (uint32)skinVertices.size();
+        if (vertexCount == 0)
+        {
+            MLOGE("Model has no vertex datas to skin.");
+            return false;
+        }
+
+        param.info[0] = vertexCount;
+        bones.resize(boneCount);
+
+        VkDeviceSize srcSize = skinVertices.size() * sizeof(SkinVertex);
+        VkDeviceSize dstSize = dstVertices.size() * sizeof(float);
+
+        DVKBuffer* stagingBuffer = DVKBuffer::CreateBuffer(
+            vulkanDevice,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            srcSize + dstSize
+        );
+        stagingBuffer->Map();
+        memcpy(stagingBuffer->mapped, skinVertices.data(), srcSize);
+        memcpy((uint8*)stagingBuffer->mapped + srcSize, dstVertices.data(), dstSize);
+        stagingBuffer->UnMap();
+
+        sourceBuffer = DVKBuffer::CreateBuffer(
+            vulkanDevice,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            srcSize
+        );
+
+        boneBuffer = DVKBuffer::CreateBuffer(
+            vulkanDevice,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            bones.size() * sizeof(Matrix4x4)
+        );
+
+        // 不参与蒙皮的属性(UV、Color等)只在这里写入一次，之后每帧只覆盖Position、Normal与Tangent
+        skinnedBuffer = DVKBuffer::CreateBuffer(
+            vulkanDevice,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            dstSize
+        );
+
+        cmdBuffer->Begin();
+
+        VkBufferCopy copyRegion = {};
+        copyRegion.size = srcSize;
+        vkCmdCopyBuffer(cmdBuffer->cmdBuffer, stagingBuffer->buffer, sourceBuffer->buffer, 1, &copyRegion);
+
+        copyRegion.srcOffset = srcSize;
+        copyRegion.size      = dstSize;
+        vkCmdCopyBuffer(cmdBuffer->cmdBuffer, stagingBuffer->buffer, skinnedBuffer->buffer, 1, &copyRegion);
+
+        cmdBuffer->End();
+        cmdBuffer->Submit();
+
+        delete stagingBuffer;
+
+        return true;
+    }
+
+    void DVKComputeSkinner::Skin(VkCommandBuffer commandBuffer)
+    {
+        if (vertexCount == 0)
+        {
+            return;
+        }
+
+        model->UpdateTransforms();
+
+        // finalTransform已经变换到模型空间，输出的顶点不再需要Mesh节点的矩阵
+        for (int32 i = 0; i < model->meshes.size(); ++i)
+        {
+            DVKMesh* mesh = model->meshes[i];
+            Matrix4x4* dst = bones.data() + boneOffsets[i];
+
+            if (mesh->bones.size() == 0)
+            {
+                dst[0] = mesh->linkNode ? model->GetGlobalMatrix(mesh->linkNode) : Matrix4x4::Identity;
+                continue;
+            }
+
+            for (int32 j = 0; j < mesh->bones.size(); ++j)
+            {
+                dst[j] = model->bones[mesh->bones[j]]->finalTransform;
+            }
+        }
+
+        compute->SetUniform("param", &param, sizeof(SkinParam));
+
+        // 上一帧的绘制读取顶点以及蒙皮读取骨骼完成之后才能覆盖
+        VkMemoryBarrier memoryBarrier;
+        ZeroVulkanStruct(memoryBarrier, VK_STRUCTURE_TYPE_MEMORY_BARRIER);
+        memoryBarrier.srcAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+        // 骨骼矩阵随命令缓冲一起提交，不需要区分飞行中的帧
+        const uint8* boneData = (const uint8*)bones.data();
+        VkDeviceSize boneSize = bones.size() * sizeof(Matrix4x4);
+        for (VkDeviceSize offset = 0; offset < boneSize; offset += SKIN_UPDATE_MAX_SIZE)
+        {
+            VkDeviceSize size = MMath::Min<VkDeviceSize>(boneSize - offset, SKIN_UPDATE_MAX_SIZE);
+            vkCmdUpdateBuffer(commandBuffer, boneBuffer->buffer, offset, size, boneData + offset);
+        }
+
+        memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+        compute->BindDispatch(commandBuffer, (vertexCount + SKIN_COMPUTE_GROUP_SIZE - 1) / SKIN_COMPUTE_GROUP_SIZE, 1, 1);
+
+        memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+    }
+
+    void DVKComputeSkinner::Draw(VkCommandBuffer commandBuffer)
+    {
+        if (vertexCount == 0)
+        {
+            return;
+        }
+
+        VkDeviceSize offset = 0;
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &(skinnedBuffer->buffer), &offset);
+
+        DVKIndexBuffer* boundIndex = nullptr;
+        for (int32 i = 0; i < ranges.size(); ++i)
+        {
+            const DrawRange& range = ranges[i];
+            DVKPrimitive* primitive = range.primitive;
+
+            if (primitive->indexBuffer == nullptr)
+            {
+                vkCmdDraw(commandBuffer, primitive->vertexCount, 1, range.vertexOffset, 0);
+                continue;
+            }
+
+            // 共用Buffer时所有Primitive的索引在同一个IndexBuffer中，只需要绑定一次
+            if (primitive->indexBuffer != boundIndex)
+            {
+                boundIndex = primitive->indexBuffer;
+                boundIndex->Bind(commandBuffer);
+            }
+
+            VkDrawIndexedIndirectCommand command;
+            primitive->GetDrawCommand(command);
+            vkCmdDrawIndexed(commandBuffer, command.indexCount, 1, command.firstIndex, range.vertexOffset, 0);
+        }
+    }
+
+}
@@ -0,0 +1,111 @@
+﻿#pragma once
+
+#include "Engine.h"
+#include "DVKBuffer.h"
+#include "DVKShader.h"
+#include "DVKCompute.h"
+#include "DVKCommand.h"
+
+#include "Common/Common.h"
+#include "Math/Math.h"
+#include "Math/Vector3.h"
+#include "Math/Vector4.h"
+#include "Math/Matrix4x4.h"
+#include "Vulkan/VulkanCommon.h"
+
+#include <vector>
+#include <memory>
+
+namespace vk_demo
+{
+    class DVKModel;
+    struct DVKPrimitive;
+
+    // GPU上预先蒙皮：每帧用计算着色器把蒙皮后的Position、Normal与Tangent写入一个临时VertexBuffer，
+    // 之后的Shadow、深度预渲染以及主Pass都把它当作静态模型绘制，避免每个Pass重复蒙皮。
+    // 输出顶点格式为GetAttributes()，即模型的attributes去掉骨骼相关的属性，顶点位于模型空间。
+    // Skin需要在RenderPass之外录制，Draw在RenderPass之内录制。
+    class DVKComputeSkinner
+    {
+    private:
+
+        // 与SkinCompute.comp中的SkinVertex一致，std430
+        struct SkinVertex
+        {
+            Vector3 position;
+            // 所属Mesh在骨骼矩阵中的起始位置
+            uint32  boneOffset;
+            Vector3 normal;
+            // 4个uint8骨骼索引
+            uint32  indices;
+            Vector4 weights;
+            // w为副切线方向
+            Vector4 tangent;
+        };
+
+        struct SkinParam
+        {
+            // x:顶点数 y:输出顶点跨度(float) z:Position偏移 w:Normal偏移
+            uint32  info[4];
+            // x:Normal格式 0无 1float3 2八面体 y:Tangent格式 0无 1float4 2snorm16x4 z:Tangent偏移
+            uint32  format[4];
+        };
+
+        struct DrawRange
+        {
+            DVKPrimitive*   primitive = nullptr;
+            int32           vertexOffset = 0;
+        };
+
+        DVKComputeSkinner()
+        {
+
+        }
+
+    public:
+
+        ~DVKComputeSkinner();
+
+        static DVKComputeSkinner* Create(std::shared_ptr<VulkanDevice> vulkanDevice, VkPipelineCache pipelineCache, DVKShader* shader, DVKModel* model, DVKCommandBuffer* cmdBuffer);
+
+        // 上传当前帧的骨骼矩阵并蒙皮，调用之前需要先更新模型的动画
+        void Skin(VkCommandBuffer commandBuffer);
+
+        // 外部绑定静态Pipeline与DescriptorSet之后调用，可以在多个Pass中重复调用
+        void Draw(VkCommandBuffer commandBuffer);
+
+        FORCE_INLINE const std::vector<VertexAttribute>& GetAttributes() const
+        {
+            return attributes;
+        }
+
+        FORCE_INLINE uint32 GetVertexCount() const
+        {
+            return vertexCount;
+        }
+
+    private:
+
+        bool PrepareBuffers(DVKCommandBuffer* cmdBuffer);
+
+    public:
+
+        std::shared_ptr<VulkanDevice>   vulkanDevice = nullptr;
+        DVKModel*                       model = nullptr;
+        DVKCompute*                     compute = nullptr;
+
+        DVKBuffer*                      sourceBuffer = nullptr;
+        DVKBuffer*                      boneBuffer = nullptr;
+        DVKBuffer*                      skinnedBuffer = nullptr;
+
+    private:
+
+        std::vector<VertexAttribute>    attributes;
+        std::vector<DrawRange>          ranges;
+        std::vector<int32>              boneOffsets;
+        std::vector<Matrix4x4>          bones;
+        SkinParam                       param;
+        uint32                          vertexCount = 0;
+    };
+
+}
@@ -0,0 +1,334 @@
+﻿#include "DVKFrameScheduler.h"
+
+#include "Vulkan/VulkanDevice.h"
+#include "Vulkan/VulkanQueue.h"
+
+#include "Math/Math.h"
+
+namespace vk_demo
+{
+
+    DVKFrameScheduler::~DVKFrameScheduler()
+    {
+        VkDevice device = vulkanDevice->GetInstanceHandle();
+
+        WaitIdle();
+        Update();
+
+        for (int32 i = 0; i < (int32)QueueType::Count; ++i)
+        {
+            QueueTimeline& timeline = timelines[i];
+            if (timeline.semaphore != VK_NULL_HANDLE)
+            {
+                vkDestroySemaphore(device, timeline.semaphore, VULKAN_CPU_ALLOCATOR);
+                timeline.semaphore = VK_NULL_HANDLE;
+            }
+            for (int32 j = 0; j < timeline.pendingFences.size(); ++j)
+            {
+                vkDestroyFence(device, timeline.pendingFences[j].fence, VULKAN_CPU_ALLOCATOR);
+            }
+            timeline.pendingFences.clear();
+            timeline.queue = nullptr;
+        }
+
+        for (int32 i = 0; i < freeFences.size(); ++i)
+        {
+            vkDestroyFence(device, freeFences[i], VULKAN_CPU_ALLOCATOR);
+        }
+        freeFences.clear();
+
+        vulkanDevice = nullptr;
+    }
+
+    DVKFrameScheduler* DVKFrameScheduler::Create(std::shared_ptr<VulkanDevice> vulkanDevice)
+    {
+        VkDevice device = vulkanDevice->GetInstanceHandle();
+
+        DVKFrameScheduler* scheduler = new DVKFrameScheduler();
+        scheduler->vulkanDevice = vulkanDevice;
+        scheduler->timelines[(int32)QueueType::Graphics].queue = vulkanDevice->GetGraphicsQueue();
+        scheduler->timelines[(int32)QueueType::Compute].queue  = vulkanDevice->GetComputeQueue();
+        scheduler->timelines[(int32)QueueType::Transfer].queue = vulkanDevice->GetTransferQueue();
+
+        if (vulkanDevice->IsTimelineSemaphoreSupported())
+        {
+            scheduler->vkWaitSemaphoresFunc           = (PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr(device, "vkWaitSemaphoresKHR");
+            scheduler->vkGetSemaphoreCounterValueFunc = (PFN_vkGetSemaphoreCounterValueKHR)vkGetDeviceProcAddr(device, "vkGetSemaphoreCounterValueKHR");
+            scheduler->timelineSupported = scheduler->vkWaitSemaphoresFunc != nullptr && scheduler->vkGetSemaphoreCounterValueFunc != nullptr;
+        }
+
+        if (scheduler->timelineSupported)
+        {
+            VkSemaphoreTypeCreateInfoKHR typeCreateInfo;
+            ZeroVulkanStruct(typeCreateInfo, VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR);
+            typeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+            typeCreateInfo.initialValue  = 0;
+
+            VkSemaphoreCreateInfo createInfo;
+            ZeroVulkanStruct(createInfo, VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO);
+            createInfo.pNext = &typeCreateInfo;
+
+            for (int32 i = 0; i < (int32)QueueType::Count; ++i)
+            {
+                VERIFYVULKANRESULT(vkCreateSemaphore(device, &createInfo, VULKAN_CPU_ALLOCATOR, &(scheduler->timelines[i].semaphore)));
+            }
+        }
+        else
+        {
+            MLOG("Timeline semaphore not supported, fallback to fences.");
+        }
+
+        return scheduler;
+    }
+
+    VkFence DVKFrameScheduler::AcquireFence()
+    {
+        if (freeFences.size() > 0)
+        {
+            VkFence fence = freeFences.back();
+            freeFences.pop_back();
+            return fence;
+        }
+
+        VkFence fence = VK_NULL_HANDLE;
+        VkFenceCreateInfo fenceCreateInfo;
+        ZeroVulkanStruct(fenceCreateInfo, VK_STRUCTURE_TYPE_FENCE_CREATE_INFO);
+        VERIFYVULKANRESULT(vkCreateFence(vulkanDevice->GetInstanceHandle(), &fenceCreateInfo, VULKAN_CPU_ALLOCATOR, &fence));
+        return fence;
+    }
+
+    void DVKFrameScheduler::AddWait(QueueType queueType, QueueType waitQueue, uint64 value, VkPipelineStageFlags waitStage)
+    {
+        if (value == 0 || IsCompleted(waitQueue, value))
+        {
+            return;
+        }
+
+        // 不支持timeline时只能在CPU端等待
+        if (!timelineSupported)
+        {
+            Wait(waitQueue, value);
+            return;
+        }
+
+        QueueTimeline& timeline = timelines[(int32)queueType];
+        timeline.waitSemaphores.push_back(timelines[(int32)waitQueue].semaphore);
+        timeline.waitValues.push_back(value);
+        timeline.waitStages.push_back(waitStage);
+    }
+
+    void DVKFrameScheduler::AddWaitSemaphore(QueueType queueType, VkSemaphore semaphore, VkPipelineStageFlags waitStage)
+    {
+        QueueTimeline& timeline = timelines[(int32)queueType];
+        timeline.waitSemaphores.push_back(semaphore);
+        timeline.waitValues.push_back(0);
+        timeline.waitStages.push_back(waitStage);
+    }
+
+    uint64 DVKFrameScheduler::Submit(QueueType queueType, const VkCommandBuffer* cmdBuffers, uint32 count, VkSemaphore signalSemaphore)
+    {
+        QueueTimeline& timeline = timelines[(int32)queueType];
+        uint64 value = timeline.submittedValue + 1;
+
+        VkSemaphore signalSemaphores[2];
+        uint64_t    signalValues[2];
+        uint32      signalCount = 0;
+
+        if (timelineSupported)
+        {
+            signalSemaphores[signalCount] = timeline.semaphore;
+            signalValues[signalCount]     = value;
+            signalCount += 1;
+        }
+
+        if (signalSemaphore != VK_NULL_HANDLE)
+        {
+            signalSemaphores[signalCount] = signalSemaphore;
+            signalValues[signalCount]     = 0;
+            signalCount += 1;
+        }
+
+        // binary semaphore对应的值会被忽略
+        VkTimelineSemaphoreSubmitInfoKHR timelineSubmitInfo;
+        ZeroVulkanStruct(timelineSubmitInfo, VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR);
+        timelineSubmitInfo.waitSemaphoreValueCount   = (uint32)timeline.waitValues.size();
+        timelineSubmitInfo.pWaitSemaphoreValues      = timeline.waitValues.data();
+        timelineSubmitInfo.signalSemaphoreValueCount = signalCount;
+        timelineSubmitInfo.pSignalSemaphoreValues    = signalValues;
+
+        VkSubmitInfo submitInfo;
+        ZeroVulkanStruct(submitInfo, VK_STRUCTURE_TYPE_SUBMIT_INFO);
+        submitInfo.pNext                = timelineSupported ? &timelineSubmitInfo : nullptr;
+        submitInfo.commandBufferCount   = count;
+        submitInfo.pCommandBuffers      = cmdBuffers;
+        submitInfo.waitSemaphoreCount   = (uint32)timeline.waitSemaphores.size();
+        submitInfo.pWaitSemaphores      = timeline.waitSemaphores.data();
+        submitInfo.pWaitDstStageMask    = timeline.waitStages.data();
+        submitInfo.signalSemaphoreCount = signalCount;
+        submitInfo.pSignalSemaphores    = signalSemaphores;
+
+        VkFence fence = VK_NULL_HANDLE;
+        if (!timelineSupported)
+        {
+            fence = AcquireFence();
+            PendingFence pending;
+            pending.value = value;
+            pending.fence = fence;
+            timeline.pendingFences.push_back(pending);
+        }
+
+        VERIFYVULKANRESULT(vkQueueSubmit(timeline.queue->GetHandle(), 1, &submitInfo, fence));
+
+        timeline.waitSemaphores.clear();
+        timeline.waitValues.clear();
+        timeline.waitStages.clear();
+        timeline.submittedValue = value;
+
+        return value;
+    }
+
+    uint64 DVKFrameScheduler::GetCompletedValue(QueueType queueType)
+    {
+        VkDevice device = vulkanDevice->GetInstanceHandle();
+        QueueTimeline& timeline = timelines[(int32)queueType];
+
+        if (timelineSupported)
+        {
+            uint64_t value = 0;
+            VERIFYVULKANRESULT(vkGetSemaphoreCounterValueFunc(device, timeline.semaphore, &value));
+            timeline.completedValue = value;
+            return value;
+        }
+
+        // 按提交顺序检查Fence
+        while (timeline.pendingFences.size() > 0)
+        {
+            PendingFence& pending = timeline.pendingFences.front();
+            if (vkGetFenceStatus(device, pending.fence) != VK_SUCCESS)
+            {
+                break;
+            }
+            timeline.completedValue = pending.value;
+            vkResetFences(device, 1, &pending.fence);
+            freeFences.push_back(pending.fence);
+            timeline.pendingFences.pop_front();
+        }
+
+        return timeline.completedValue;
+    }
+
+    bool DVKFrameScheduler::IsCompleted(QueueType queueType, uint64 value)
+    {
+        if (value <= timelines[(int32)queueType].completedValue)
+        {
+            return true;
+        }
+        return value <= GetCompletedValue(queueType);
+    }
+
+    void DVKFrameScheduler::Wait(QueueType queueType, uint64 value)
+    {
+        if (IsCompleted(queueType, value))
+        {
+            return;
+        }
+
+        VkDevice device = vulkanDevice->GetInstanceHandle();
+        QueueTimeline& timeline = timelines[(int32)queueType];
+
+        if (timelineSupported)
+        {
+            uint64_t waitValue = value;
+
+            VkSemaphoreWaitInfoKHR waitInfo;
+            ZeroVulkanStruct(waitInfo, VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR);
+            waitInfo.semaphoreCount = 1;
+            waitInfo.pSemaphores    = &timeline.semaphore;
+            waitInfo.pValues        = &waitValue;
+            VERIFYVULKANRESULT(vkWaitSemaphoresFunc(device, &waitInfo, MAX_uint64));
+            timeline.completedValue = MMath::Max(timeline.completedValue, value);
+            return;
+        }
+
+        for (int32 i = 0; i < timeline.pendingFences.size(); ++i)
+        {
+            if (timeline.pendingFences[i].value >= value)
+            {
+                vkWaitForFences(device, 1, &(timeline.pendingFences[i].fence), VK_TRUE, MAX_uint64);
+                break;
+            }
+        }
+
+        GetCompletedValue(queueType);
+    }
+
+    void DVKFrameScheduler::WaitIdle()
+    {
+        for (int32 i = 0; i < (int32)QueueType::Count; ++i)
+        {
+            Wait((QueueType)i, timelines[i].submittedValue);
+        }
+    }
+
+    void DVKFrameScheduler::DeferRelease(QueueType queueType, uint64 value, ReleaseFunc func)
+    {
+        DeferredRelease release;
+        for (int32 i = 0; i < (int32)QueueType::Count; ++i)
+        {
+            release.values[i] = 0;
+        }
+        release.values[(int32)queueType] = value;
+        release.func = func;
+        releases.push_back(release);
+    }
+
+    void DVKFrameScheduler::DeferRelease(ReleaseFunc func)
+    {
+        DeferredRelease release;
+        for (int32 i = 0; i < (int32)QueueType::Count; ++i)
+        {
+            release.values[i] = timelines[i].submittedValue;
+        }
+        release.func = func;
+        releases.push_back(release);
+    }
+
+    void DVKFrameScheduler::Update()
+    {
+        for (int32 i = 0; i < (int32)QueueType::Count; ++i)
+        {
+            GetCompletedValue((QueueType)i);
+        }
+
+        // 先挑出可以释放的，释放函数里可能会再次调用DeferRelease
+        std::vector<ReleaseFunc> readyFuncs;
+        int32 count = 0;
+        for (int32 i = 0; i < releases.size(); ++i)
+        {
+            bool completed = true;
+            for (int32 j = 0; j < (int32)QueueType::Count; ++j)
+            {
+                completed = completed && releases[i].values[j] <= timelines[j].completedValue;
+            }
+
+            if (completed)
+            {
+                readyFuncs.push_back(releases[i].func);
+            }
+            else
+            {
+                releases[count++] = releases[i];
+            }
+        }
+        releases.resize(count);
+
+        for (int32 i = 0; i < readyFuncs.size(); ++i)
+        {
+            if (readyFuncs[i])
+            {
+                readyFuncs[i]();
+            }
+        }
+    }
+
+}
@@ -0,0 +1,135 @@
+﻿#pragma once
+
+#include "Engine.h"
+
+#include "Common/Common.h"
+#include "Vulkan/VulkanCommon.h"
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+
+class VulkanDevice;
+class VulkanQueue;
+
+namespace vk_demo
+{
+    // 基于VK_KHR_timeline_semaphore的帧调度器：每个队列一个timeline，每次提交递增。
+    // 资源记录自己依赖的timeline值，只有真正需要时CPU才等待。
+    // 不支持timeline semaphore时退化为每次提交一个Fence。
+    class DVKFrameScheduler
+    {
+    public:
+
+        enum class QueueType
+        {
+            Graphics = 0,
+            Compute,
+            Transfer,
+            Count
+        };
+
+        typedef std::function<void()> ReleaseFunc;
+
+    private:
+
+        struct PendingFence
+        {
+            uint64      value;
+            VkFence     fence;
+        };
+
+        struct QueueTimeline
+        {
+            std::shared_ptr<VulkanQueue>        queue = nullptr;
+            VkSemaphore                         semaphore = VK_NULL_HANDLE;
+            uint64                              submittedValue = 0;
+            uint64                              completedValue = 0;
+
+            std::vector<VkSemaphore>            waitSemaphores;
+            std::vector<uint64_t>               waitValues;
+            std::vector<VkPipelineStageFlags>   waitStages;
+
+            std::deque<PendingFence>            pendingFences;
+        };
+
+        struct DeferredRelease
+        {
+            uint64      values[(int32)QueueType::Count];
+            ReleaseFunc func;
+        };
+
+        DVKFrameScheduler()
+        {
+
+        }
+
+    public:
+
+        ~DVKFrameScheduler();
+
+        static DVKFrameScheduler* Create(std::shared_ptr<VulkanDevice> vulkanDevice);
+
+        // 下一次在queueType上的提交需要等待waitQueue达到value
+        void AddWait(QueueType queueType, QueueType waitQueue, uint64 value, VkPipelineStageFlags waitStage);
+
+        // 下一次在queueType上的提交需要等待的binary semaphore，例如Swapchain的acquire
+        void AddWaitSemaphore(QueueType queueType, VkSemaphore semaphore, VkPipelineStageFlags waitStage);
+
+        // 提交并返回本次提交signal的timeline值，不会阻塞
+        uint64 Submit(QueueType queueType, const VkCommandBuffer* cmdBuffers, uint32 count, VkSemaphore signalSemaphore = VK_NULL_HANDLE);
+
+        uint64 GetCompletedValue(QueueType queueType);
+
+        bool IsCompleted(QueueType queueType, uint64 value);
+
+        void Wait(QueueType queueType, uint64 value);
+
+        void WaitIdle();
+
+        // 在queueType达到value之后释放资源
+        void DeferRelease(QueueType queueType, uint64 value, ReleaseFunc func);
+
+        // 在所有队列当前提交的工作完成之后释放资源
+        void DeferRelease(ReleaseFunc func);
+
+        // 更新完成的值并执行可以释放的资源
+        void Update();
+
+        FORCE_INLINE uint64 GetSubmittedValue(QueueType queueType) const
+        {
+            return timelines[(int32)queueType].submittedValue;
+        }
+
+        FORCE_INLINE std::shared_ptr<VulkanQueue> GetQueue(QueueType queueType) const
+        {
+            return timelines[(int32)queueType].queue;
+        }
+
+        FORCE_INLINE bool IsTimelineSupported() const
+        {
+            return timelineSupported;
+        }
+
+    private:
+
+        VkFence AcquireFence();
+
+    public:
+
+        std::shared_ptr<VulkanDevice>   vulkanDevice = nullptr;
+
+    private:
+
+        bool                            timelineSupported = false;
+        QueueTimeline                   timelines[(int32)QueueType::Count];
+
+        std::vector<VkFence>            freeFences;
+        std::vector<DeferredRelease>    releases;
+
+        PFN_vkWaitSemaphoresKHR             vkWaitSemaphoresFunc = nullptr;
+        PFN_vkGetSemaphoreCounterValueKHR   vkGetSemaphoreCounterValueFunc = nullptr;
+    };
+
+}
@@ -0,0 +1,204 @@
+﻿#include "DVKFrustumCuller.h"
+#include "DVKModel.h"
+#include "DVKCamera.h"
+
+#include <thread>
+#include <cstring>
+
+// 每个线程至少处理的Mesh数量，数量较少时创建线程的开销大于剔除本身
+#define FRUSTUM_CULL_THREAD_MESHES  2048
+
+namespace vk_demo
+{
+    void DVKFrustumCuller::Prepare(DVKModel* model)
+    {
+        cachedModel = model;
+
+        meshes.clear();
+        meshIndices.clear();
+        batches.clear();
+
+        // 按节点分组，没有linkNode的Mesh放在最后一组
+        std::vector<std::vector<int32>> nodeMeshes(model->linearNodes.size() + 1);
+        for (int32 i = 0; i < model->meshes.size(); ++i)
+        {
+            DVKMesh* mesh = model->meshes[i];
+            int32 node = mesh->linkNode ? mesh->linkNode->index : (int32)model->linearNodes.size();
+            nodeMeshes[node].push_back(i);
+        }
+
+        for (int32 i = 0; i < nodeMeshes.size(); ++i)
+        {
+            if (nodeMeshes[i].size() == 0)
+            {
+                continue;
+            }
+
+            MeshBatch batch;
+            batch.node  = i < model->linearNodes.size() ? i : -1;
+            batch.first = (int32)meshes.size();
+            batch.count = (int32)nodeMeshes[i].size();
+            batches.push_back(batch);
+
+            for (int32 j = 0; j < nodeMeshes[i].size(); ++j)
+            {
+                meshes.push_back(model->meshes[nodeMeshes[i][j]]);
+                meshIndices.push_back(nodeMeshes[i][j]);
+            }
+        }
+
+        localBounds.Resize((int32)meshes.size());
+        worldBounds.Resize((int32)meshes.size());
+        visible.resize(meshes.size());
+        meshVisible.resize(meshes.size(), 1);
+
+        for (int32 i = 0; i < meshes.size(); ++i)
+        {
+            localBounds.Set(i, meshes[i]->bounding.min, meshes[i]->bounding.max);
+        }
+
+        bvh.Clear();
+        bvhReady = false;
+        proxyIds.resize(meshes.size());
+        batchMatrices.resize(batches.size());
+    }
+
+    int32 DVKFrustumCuller::CullBatches(DVKModel* model, const DVKFrustum& frustum, const Matrix4x4& world, int32 begin, int32 end)
+    {
+        if (begin >= end)
+        {
+            return 0;
+        }
+
+        for (int32 i = begin; i < end; ++i)
+        {
+            const MeshBatch& batch = batches[i];
+            Matrix4x4 matrix = batch.node >= 0 ? model->GetGlobalMatrix(model->linearNodes[batch.node]) : Matrix4x4::Identity;
+            matrix.Append(world);
+            VectorBatch::TransformBounds(matrix, localBounds, worldBounds, batch.first, batch.count);
+        }
+
+        // 各组在meshes中连续，合并为一次测试
+        int32 first = batches[begin].first;
+        int32 count = batches[end - 1].first + batches[end - 1].count - first;
+        int32 visibleNum = VectorBatch::CullBounds(frustum.planes, DVKFrustum::FP_Count, worldBounds, first, count, visible.data());
+
+        for (int32 i = first; i < first + count; ++i)
+        {
+            meshVisible[meshIndices[i]] = visible[i];
+        }
+
+        return visibleNum;
+    }
+
+    int32 DVKFrustumCuller::CullBVH(DVKModel* model, const DVKFrustum& frustum, const Matrix4x4& world)
+    {
+        for (int32 i = 0; i < batches.size(); ++i)
+        {
+            const MeshBatch& batch = batches[i];
+            Matrix4x4 matrix = batch.node >= 0 ? model->GetGlobalMatrix(model->linearNodes[batch.node]) : Matrix4x4::Identity;
+            matrix.Append(world);
+
+            // 节点没有移动时代理保持不变
+            if (bvhReady && memcmp(&matrix, &batchMatrices[i], sizeof(Matrix4x4)) == 0)
+            {
+                continue;
+            }
+            batchMatrices[i] = matrix;
+
+            VectorBatch::TransformBounds(matrix, localBounds, worldBounds, batch.first, batch.count);
+
+            for (int32 j = batch.first; j < batch.first + batch.count; ++j)
+            {
+                Vector3 boundMin(worldBounds.min.x[j], worldBounds.min.y[j], worldBounds.min.z[j]);
+                Vector3 boundMax(worldBounds.max.x[j], worldBounds.max.y[j], worldBounds.max.z[j]);
+                if (bvhReady)
+                {
+                    bvh.MoveProxy(proxyIds[j], boundMin, boundMax);
+                }
+                else
+                {
+                    proxyIds[j] = bvh.AddProxy(boundMin, boundMax, (void*)(intptr_t)j);
+                }
+            }
+        }
+
+        bvhReady = true;
+        bvh.Update();
+
+        for (int32 i = 0; i < meshes.size(); ++i)
+        {
+            meshVisible[i] = 0;
+        }
+
+        bvh.QueryFrustum(frustum, queryResults);
+        for (int32 i = 0; i < queryResults.size(); ++i)
+        {
+            int32 index = (int32)(intptr_t)bvh.GetUserData(queryResults[i]);
+            meshVisible[meshIndices[index]] = 1;
+        }
+
+        return (int32)queryResults.size();
+    }
+
+    int32 DVKFrustumCuller::Cull(DVKModel* model, const DVKFrustum& frustum, const Matrix4x4& world)
+    {
+        if (model != cachedModel || model->meshes.size() != meshes.size())
+        {
+            Prepare(model);
+        }
+
+        model->UpdateTransforms();
+
+        if (useBVH)
+        {
+            visibleCount = CullBVH(model, frustum, world);
+            culledCount  = (int32)meshes.size() - visibleCount;
+            return visibleCount;
+        }
+
+        int32 threadCount = MMath::Min<int32>(numThreads, (int32)meshes.size() / FRUSTUM_CULL_THREAD_MESHES);
+        threadCount = MMath::Min<int32>(threadCount, (int32)batches.size());
+
+        if (threadCount <= 1)
+        {
+            visibleCount = CullBatches(model, frustum, world, 0, (int32)batches.size());
+        }
+        else
+        {
+            // 按Mesh数量把各组均匀分给各线程
+            std::vector<int32> splits(threadCount + 1, (int32)batches.size());
+            splits[0] = 0;
+            for (int32 i = 0, t = 1; i < batches.size() && t < threadCount; ++i)
+            {
+                if (batches[i].first >= (int64)meshes.size() * t / threadCount)
+                {
+                    splits[t++] = i;
+                }
+            }
+
+            std::vector<int32> results(threadCount, 0);
+            std::vector<std::thread> threads;
+            for (int32 t = 1; t < threadCount; ++t)
+            {
+                threads.push_back(std::thread([&, t]() {
+                    results[t] = CullBatches(model, frustum, world, splits[t], splits[t + 1]);
+                }));
+            }
+
+            results[0] = CullBatches(model, frustum, world, splits[0], splits[1]);
+
+            visibleCount = results[0];
+            for (int32 t = 1; t < threadCount; ++t)
+            {
+                threads[t - 1].join();
+                visibleCount += results[t];
+            }
+        }
+
+        culledCount = (int32)meshes.size() - visibleCount;
+
+        return visibleCount;
+    }
+
+}
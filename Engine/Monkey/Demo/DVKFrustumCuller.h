@@ -0,0 +1,95 @@
+﻿#pragma once
+
+#include "Engine.h"
+
+#include "Common/Common.h"
+#include "Math/Math.h"
+#include "Math/Matrix4x4.h"
+#include "Math/VectorBatch.h"
+
+#include "DVKSceneBVH.h"
+
+#include <vector>
+
+namespace vk_demo
+{
+    class DVKModel;
+    struct DVKMesh;
+    struct DVKFrustum;
+
+    // CPU视锥体剔除：Mesh的包围盒按所属节点变换到世界空间，再批量与视锥体测试。
+    // 结果只保存在剔除器中，按model->meshes的索引查询，由使用它的Pass显式传给绘制，不影响阴影等其它Pass。
+    // useBVH时只变换矩阵发生变化的节点下的Mesh，并通过场景BVH整棵子树地剔除。
+    // 蒙皮Mesh使用绑定姿势的包围盒，动画幅度较大时可能被错误剔除。
+    class DVKFrustumCuller
+    {
+    public:
+
+        DVKFrustumCuller()
+        {
+
+        }
+
+        // 更新模型所有Mesh的可见性，返回可见的数量。模型的Mesh变化之后会重新收集包围盒
+        int32 Cull(DVKModel* model, const DVKFrustum& frustum, const Matrix4x4& world = Matrix4x4::Identity);
+
+        // 上一次Cull的结果，meshIndex为model->meshes中的索引
+        FORCE_INLINE bool IsVisible(int32 meshIndex) const
+        {
+            return meshVisible[meshIndex] != 0;
+        }
+
+        // 按model->meshes顺序的可见性，可以直接传给DVKModel::UpdateIndirectCommands
+        FORCE_INLINE const uint8* GetVisibility() const
+        {
+            return meshVisible.data();
+        }
+
+    public:
+
+        // 大于1时Mesh数量足够多才会使用多个线程
+        int32   numThreads = 1;
+
+        // 大部分节点静止、Mesh数量较多时使用BVH，不使用多线程
+        bool    useBVH = false;
+
+        int32   visibleCount = 0;
+        int32   culledCount = 0;
+
+    private:
+
+        // 同一个节点下的Mesh共用一个矩阵，在meshes中连续存放
+        struct MeshBatch
+        {
+            int32   node = -1;
+            int32   first = 0;
+            int32   count = 0;
+        };
+
+        void Prepare(DVKModel* model);
+
+        int32 CullBatches(DVKModel* model, const DVKFrustum& frustum, const Matrix4x4& world, int32 begin, int32 end);
+
+        int32 CullBVH(DVKModel* model, const DVKFrustum& frustum, const Matrix4x4& world);
+
+    private:
+
+        DVKModel*               cachedModel = nullptr;
+
+        std::vector<DVKMesh*>   meshes;
+        // meshes中的Mesh在model->meshes中的索引
+        std::vector<int32>      meshIndices;
+        std::vector<uint8>      meshVisible;
+        std::vector<MeshBatch>  batches;
+        BoundsArray             localBounds;
+        BoundsArray             worldBounds;
+        std::vector<uint8>      visible;
+
+        DVKSceneBVH             bvh;
+        bool                    bvhReady = false;
+        std::vector<int32>      proxyIds;
+        std::vector<Matrix4x4>  batchMatrices;
+        std::vector<int32>      queryResults;
+    };
+
+}
@@ -0,0 +1,1705 @@
+﻿#include "DVKGLTFLoader.h"
+#include "DVKModel.h"
+#include "FileManager.h"
+
+#include "Common/Log.h"
+#include "Math/Math.h"
+#include "Math/Quat.h"
+#include "Math/Matrix4x4.h"
+
+#include "json.hpp"
+#include "meshoptimizer.h"
+
+#include <assimp/scene.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <list>
+#include <thread>
+
+#define GLTF_MAGIC                  0x46546C67
+#define GLTF_CHUNK_JSON             0x4E4F534A
+#define GLTF_CHUNK_BIN              0x004E4942
+
+#define GLTF_BYTE                   5120
+#define GLTF_UNSIGNED_BYTE          5121
+#define GLTF_SHORT                  5122
+#define GLTF_UNSIGNED_SHORT         5123
+#define GLTF_UNSIGNED_INT           5125
+#define GLTF_FLOAT                  5126
+
+#define GLTF_MODE_TRIANGLES         4
+#define GLTF_MODE_TRIANGLE_STRIP    5
+#define GLTF_MODE_TRIANGLE_FAN      6
+
+using json = nlohmann::json;
+
+namespace vk_demo
+{
+    // DVKModel.cpp
+    void SimplifyTexturePath(std::string& path);
+
+    struct GLTFBuffer
+    {
+        const uint8*    data = nullptr;
+        uint64          size = 0;
+    };
+
+    struct GLTFBufferView
+    {
+        const uint8*    data = nullptr;
+        uint64          size = 0;
+        uint32          stride = 0;
+    };
+
+    struct GLTFAccessor
+    {
+        // 第一个元素的位置，没有bufferView时为nullptr，所有元素为0
+        const uint8*    data = nullptr;
+        int32           view = -1;
+        uint32          offset = 0;
+        uint32          stride = 0;
+        uint32          count = 0;
+        int32           componentType = GLTF_FLOAT;
+        int32           components = 1;
+        bool            normalized = false;
+    };
+
+    // 每个glTF Primitive对应一个DVKMesh，与assimp的处理方式一致
+    struct GLTFPendingPrimitive
+    {
+        DVKMesh*        mesh;
+        int32           meshIndex;
+        int32           primitiveIndex;
+        int32           skin;
+    };
+
+    // 节点的初始TRS，动画缺少的通道使用它
+    struct GLTFNodeTRS
+    {
+        Vector3         translation = Vector3(0, 0, 0);
+        Quat            rotation = Quat(0, 0, 0, 1);
+        Vector3         scale = Vector3(1, 1, 1);
+    };
+
+    struct DVKGLTFLoader::Context
+    {
+        DVKModel*                           model = nullptr;
+        std::string                         directory;
+        json                                document;
+
+        // 源文件以及外部.bin的映射，加载结束之后释放
+        MappedFile                          file;
+        std::vector<MappedFile*>            mappedFiles;
+        // base64、解压之后的数据以及无法映射时读取的文件
+        std::list<std::vector<uint8>>       storages;
+
+        GLTFBuffer                          binaryChunk;
+        std::vector<GLTFBuffer>             buffers;
+        std::vector<GLTFBufferView>         views;
+        std::vector<GLTFAccessor>           accessors;
+
+        std::vector<std::string>            nodeNames;
+        std::vector<GLTFNodeTRS>            nodeTRS;
+        std::vector<uint8>                  nodeVisited;
+        std::vector<std::vector<int32>>     skinBones;
+        std::vector<GLTFPendingPrimitive>   pendings;
+
+        ~Context()
+        {
+            for (int32 i = 0; i < mappedFiles.size(); ++i)
+            {
+                delete mappedFiles[i];
+            }
+            mappedFiles.clear();
+        }
+    };
+
+    static const json* FindMember(const json& object, const char* name)
+    {
+        if (!object.is_object())
+        {
+            return nullptr;
+        }
+        auto it = object.find(name);
+        return it == object.end() ? nullptr : &(*it);
+    }
+
+    static const json& GetArray(const json& object, const char* name)
+    {
+        static const json empty = json::array();
+        const json* value = FindMember(object, name);
+        return value && value->is_array() ? *value : empty;
+    }
+
+    static const json& GetObject(const json& object, const char* name)
+    {
+        static const json empty = json::object();
+        const json* value = FindMember(object, name);
+        return value && value->is_object() ? *value : empty;
+    }
+
+    static int32 GetInt(const json& object, const char* name, int32 defaultValue)
+    {
+        const json* value = FindMember(object, name);
+        return value && value->is_number() ? value->get<int32>() : defaultValue;
+    }
+
+    static bool GetBool(const json& object, const char* name, bool defaultValue)
+    {
+        const json* value = FindMember(object, name);
+        return value && value->is_boolean() ? value->get<bool>() : defaultValue;
+    }
+
+    static std::string GetString(const json& object, const char* name)
+    {
+        const json* value = FindMember(object, name);
+        return value && value->is_string() ? value->get<std::string>() : std::string();
+    }
+
+    static bool GetFloats(const json& object, const char* name, float* outValues, int32 count)
+    {
+        const json& values = GetArray(object, name);
+        if (values.size() != count)
+        {
+            return false;
+        }
+        for (int32 i = 0; i < count; ++i)
+        {
+            outValues[i] = values[i].is_number() ? values[i].get<float>() : 0.0f;
+        }
+        return true;
+    }
+
+    static FORCE_INLINE uint32 ReadUInt32(const uint8* data)
+    {
+        uint32 value;
+        memcpy(&value, data, sizeof(uint32));
+        return value;
+    }
+
+    static uint32 ComponentSize(int32 componentType)
+    {
+        switch (componentType)
+        {
+            case GLTF_BYTE:
+            case GLTF_UNSIGNED_BYTE:
+                return 1;
+            case GLTF_SHORT:
+            case GLTF_UNSIGNED_SHORT:
+                return 2;
+            case GLTF_UNSIGNED_INT:
+            case GLTF_FLOAT:
+                return 4;
+            default:
+                return 0;
+        }
+    }
+
+    static int32 TypeComponents(const std::string& type)
+    {
+        if (type == "SCALAR")
+        {
+            return 1;
+        }
+        else if (type == "VEC2")
+        {
+            return 2;
+        }
+        else if (type == "VEC3")
+        {
+            return 3;
+        }
+        else if (type == "VEC4" || type == "MAT2")
+        {
+            return 4;
+        }
+        else if (type == "MAT3")
+        {
+            return 9;
+        }
+        else if (type == "MAT4")
+        {
+            return 16;
+        }
+        return 0;
+    }
+
+    // KHR_mesh_quantization：归一化的整数按glTF的规则还原，未归一化的整数直接转换为float，由节点的变换还原
+    static FORCE_INLINE float ReadComponent(const uint8* data, int32 componentType, bool normalized)
+    {
+        switch (componentType)
+        {
+            case GLTF_BYTE:
+            {
+                int8 value = *(const int8*)data;
+                return normalized ? MMath::Max(value / 127.0f, -1.0f) : (float)value;
+            }
+            case GLTF_UNSIGNED_BYTE:
+            {
+                uint8 value = *data;
+                return normalized ? value / 255.0f : (float)value;
+            }
+            case GLTF_SHORT:
+            {
+                int16 value;
+                memcpy(&value, data, sizeof(int16));
+                return normalized ? MMath::Max(value / 32767.0f, -1.0f) : (float)value;
+            }
+            case GLTF_UNSIGNED_SHORT:
+            {
+                uint16 value;
+                memcpy(&value, data, sizeof(uint16));
+                return normalized ? value / 65535.0f : (float)value;
+            }
+            case GLTF_UNSIGNED_INT:
+            {
+                return (float)ReadUInt32(data);
+            }
+            case GLTF_FLOAT:
+            {
+                float value;
+                memcpy(&value, data, sizeof(float));
+                return value;
+            }
+            default:
+                return 0.0f;
+        }
+    }
+
+    // 读取为紧凑排列的float，每个元素components个分量，不足的补0
+    static bool ReadAccessor(const std::vector<GLTFAccessor>& accessors, int32 index, int32 components, std::vector<float>& outValues)
+    {
+        if (index < 0 || index >= accessors.size())
+        {
+            return false;
+        }
+
+        const GLTFAccessor& accessor = accessors[index];
+        outValues.resize(accessor.count * components, 0.0f);
+
+        if (accessor.data == nullptr)
+        {
+            return true;
+        }
+
+        // float且分量一致时整块拷贝
+        if (accessor.componentType == GLTF_FLOAT && accessor.components == components && accessor.stride == components * sizeof(float))
+        {
+            memcpy(outValues.data(), accessor.data, outValues.size() * sizeof(float));
+            return true;
+        }
+
+        uint32 componentSize = ComponentSize(accessor.componentType);
+        int32  count = MMath::Min(components, accessor.components);
+        for (uint32 i = 0; i < accessor.count; ++i)
+        {
+            const uint8* src = accessor.data + i * accessor.stride;
+            float* dst = outValues.data() + i * components;
+            for (int32 c = 0; c < count; ++c)
+            {
+                dst[c] = ReadComponent(src + c * componentSize, accessor.componentType, accessor.normalized);
+            }
+        }
+
+        return true;
+    }
+
+    static bool ReadIndices(const std::vector<GLTFAccessor>& accessors, int32 index, std::vector<uint32>& outIndices)
+    {
+        if (index < 0 || index >= accessors.size())
+        {
+            return false;
+        }
+
+        const GLTFAccessor& accessor = accessors[index];
+        outIndices.resize(accessor.count, 0);
+
+        if (accessor.data == nullptr)
+        {
+            return true;
+        }
+
+        for (uint32 i = 0; i < accessor.count; ++i)
+        {
+            const uint8* src = accessor.data + i * accessor.stride;
+            switch (accessor.componentType)
+            {
+                case GLTF_UNSIGNED_BYTE:
+                    outIndices[i] = *src;
+                    break;
+                case GLTF_UNSIGNED_SHORT:
+                {
+                    uint16 value;
+                    memcpy(&value, src, sizeof(uint16));
+                    outIndices[i] = value;
+                    break;
+                }
+                case GLTF_UNSIGNED_INT:
+                    outIndices[i] = ReadUInt32(src);
+                    break;
+                default:
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    static bool DecodeBase64(const std::string& text, size_t start, std::vector<uint8>& outData)
+    {
+        uint32 buffer = 0;
+        int32  bits   = 0;
+        outData.reserve((text.size() - start) * 3 / 4);
+
+        for (size_t i = start; i < text.size(); ++i)
+        {
+            char c = text[i];
+            uint32 value = 0;
+            if (c >= 'A' && c <= 'Z')
+            {
+                value = c - 'A';
+            }
+            else if (c >= 'a' && c <= 'z')
+            {
+                value = c - 'a' + 26;
+            }
+            else if (c >= '0' && c <= '9')
+            {
+                value = c - '0' + 52;
+            }
+            else if (c == '+')
+            {
+                value = 62;
+            }
+            else if (c == '/')
+            {
+                value = 63;
+            }
+            else if (c == '=')
+            {
+                break;
+            }
+            else
+            {
+                return false;
+            }
+
+            buffer = (buffer << 6) | value;
+            bits  += 6;
+            if (bits >= 8)
+            {
+                bits -= 8;
+                outData.push_back((uint8)(buffer >> bits));
+            }
+        }
+
+        return true;
+    }
+
+    // uri中的%XX转义
+    static std::string DecodeUri(const std::string& uri)
+    {
+        std::string result;
+        result.reserve(uri.size());
+        for (size_t i = 0; i < uri.size(); ++i)
+        {
+            if (uri[i] == '%' && i + 2 < uri.size() && isxdigit((unsigned char)uri[i + 1]) && isxdigit((unsigned char)uri[i + 2]))
+            {
+                result.push_back((char)strtol(uri.substr(i + 1, 2).c_str(), nullptr, 16));
+                i += 2;
+            }
+            else
+            {
+                result.push_back(uri[i]);
+            }
+        }
+        return result;
+    }
+
+    // 优先内存映射，不支持映射的平台读取进storages
+    static bool OpenFile(const std::string& filename, MappedFile& mappedFile, std::list<std::vector<uint8>>& storages, GLTFBuffer& outBuffer)
+    {
+        if (mappedFile.Open(filename))
+        {
+            outBuffer.data = mappedFile.GetData();
+            outBuffer.size = mappedFile.GetSize();
+            return true;
+        }
+
+        uint32 dataSize = 0;
+        uint8* dataPtr  = nullptr;
+        if (!FileManager::ReadFile(filename, dataPtr, dataSize))
+        {
+            return false;
+        }
+
+        storages.push_back(std::vector<uint8>(dataPtr, dataPtr + dataSize));
+        delete[] dataPtr;
+
+        outBuffer.data = storages.back().data();
+        outBuffer.size = storages.back().size();
+        return true;
+    }
+
+    bool DVKGLTFLoader::IsGLTFFile(const std::string& filename)
+    {
+        const size_t periodIdx = filename.rfind('.');
+        if (std::string::npos == periodIdx)
+        {
+            return false;
+        }
+
+        std::string extension = filename.substr(periodIdx + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        return extension == "gltf" || extension == "glb";
+    }
+
+    bool DVKGLTFLoader::Load(DVKModel* model, const std::string& filename)
+    {
+        Context context;
+        context.model = model;
+
+        const size_t lastSlashIdx = filename.find_last_of("\\/");
+        if (std::string::npos != lastSlashIdx)
+        {
+            context.directory = filename.substr(0, lastSlashIdx + 1);
+        }
+
+        GLTFBuffer source;
+        if (!OpenFile(filename, context.file, context.storages, source))
+        {
+            MLOGE("Failed open glTF file %s", filename.c_str());
+            return false;
+        }
+
+        // GLB：12字节的文件头，之后是JSON以及可选的BIN两个chunk，均按4字节对齐
+        const uint8* jsonData = source.data;
+        uint64       jsonSize = source.size;
+        if (source.size >= 12 && ReadUInt32(source.data) == GLTF_MAGIC)
+        {
+            uint32 version = ReadUInt32(source.data + 4);
+            uint64 length  = MMath::Min<uint64>(ReadUInt32(source.data + 8), source.size);
+            if (version != 2)
+            {
+                MLOGE("Unsupported GLB version %d : %s", version, filename.c_str());
+                return false;
+            }
+
+            jsonData = nullptr;
+            jsonSize = 0;
+            for (uint64 pos = 12; pos + 8 <= length;)
+            {
+                uint32 chunkLength = ReadUInt32(source.data + pos + 0);
+                uint32 chunkType   = ReadUInt32(source.data + pos + 4);
+                pos += 8;
+
+                if (pos + chunkLength > length)
+                {
+                    break;
+                }
+
+                if (chunkType == GLTF_CHUNK_JSON && jsonData == nullptr)
+                {
+                    jsonData = source.data + pos;
+                    jsonSize = chunkLength;
+                }
+                else if (chunkType == GLTF_CHUNK_BIN && context.binaryChunk.data == nullptr)
+                {
+                    context.binaryChunk.data = source.data + pos;
+                    context.binaryChunk.size = chunkLength;
+                }
+
+                pos += (chunkLength + 3) & ~3;
+            }
+
+            if (jsonData == nullptr)
+            {
+                MLOGE("GLB without JSON chunk : %s", filename.c_str());
+                return false;
+            }
+        }
+
+        try
+        {
+            context.document = json::parse(jsonData, jsonData + jsonSize);
+        }
+        catch (const std::exception& e)
+        {
+            MLOGE("Failed parse glTF %s : %s", filename.c_str(), e.what());
+            return false;
+        }
+
+        const json& document = context.document;
+
+        // 必须支持的扩展，不认识的交给assimp
+        const json& required = GetArray(document, "extensionsRequired");
+        for (int32 i = 0; i < required.size(); ++i)
+        {
+            std::string extension = required[i].is_string() ? required[i].get<std::string>() : std::string();
+            if (extension != "KHR_mesh_quantization" && extension != "EXT_meshopt_compression")
+            {
+                MLOGE("Unsupported glTF extension %s : %s", extension.c_str(), filename.c_str());
+                return false;
+            }
+        }
+
+        // 数据全部就绪之后才修改模型，之前的失败都可以回退到assimp
+        if (!LoadBuffers(context) || !LoadBufferViews(context) || !LoadAccessors(context))
+        {
+            MLOGE("Failed load glTF buffers : %s", filename.c_str());
+            return false;
+        }
+
+        // 节点名称唯一，骨骼以及动画都通过名称查找节点
+        const json& nodes = GetArray(document, "nodes");
+        context.nodeNames.resize(nodes.size());
+        context.nodeTRS.resize(nodes.size());
+        context.nodeVisited.resize(nodes.size(), 0);
+        for (int32 i = 0; i < nodes.size(); ++i)
+        {
+            std::string name = GetString(nodes[i], "name");
+            if (name.empty())
+            {
+                name = "node_" + std::to_string(i);
+            }
+            for (int32 j = 0; j < i; ++j)
+            {
+                if (context.nodeNames[j] == name)
+                {
+                    name += "_" + std::to_string(i);
+                    break;
+                }
+            }
+            context.nodeNames[i] = name;
+        }
+
+        LoadSkins(context);
+
+        // 场景的根节点，多个时挂在一个空的根节点下
+        std::vector<int32> roots;
+        const json& scenes = GetArray(document, "scenes");
+        int32 sceneIndex   = GetInt(document, "scene", 0);
+        if (sceneIndex >= 0 && sceneIndex < scenes.size())
+        {
+            const json& sceneNodes = GetArray(scenes[sceneIndex], "nodes");
+            for (int32 i = 0; i < sceneNodes.size(); ++i)
+            {
+                int32 index = sceneNodes[i].is_number() ? sceneNodes[i].get<int32>() : -1;
+                if (index >= 0 && index < nodes.size())
+                {
+                    roots.push_back(index);
+                }
+            }
+        }
+        else
+        {
+            // 没有场景时所有不是子节点的节点都是根节点
+            std::vector<uint8> isChild(nodes.size(), 0);
+            for (int32 i = 0; i < nodes.size(); ++i)
+            {
+                const json& children = GetArray(nodes[i], "children");
+                for (int32 j = 0; j < children.size(); ++j)
+                {
+                    int32 index = children[j].is_number() ? children[j].get<int32>() : -1;
+                    if (index >= 0 && index < nodes.size())
+                    {
+                        isChild[index] = 1;
+                    }
+                }
+            }
+            for (int32 i = 0; i < nodes.size(); ++i)
+            {
+                if (!isChild[i])
+                {
+                    roots.push_back(i);
+                }
+            }
+        }
+
+        if (roots.size() == 1)
+        {
+            context.nodeVisited[roots[0]] = 1;
+            model->rootNode = LoadNode(context, roots[0]);
+        }
+        else
+        {
+            model->rootNode = new DVKNode();
+            model->rootNode->name = "RootNode";
+            model->nodesMap.insert(std::make_pair(model->rootNode->name, model->rootNode));
+            model->linearNodes.push_back(model->rootNode);
+
+            for (int32 i = 0; i < roots.size(); ++i)
+            {
+                if (context.nodeVisited[roots[i]])
+                {
+                    continue;
+                }
+                context.nodeVisited[roots[i]] = 1;
+
+                DVKNode* childNode = LoadNode(context, roots[i]);
+                childNode->parent  = model->rootNode;
+                model->rootNode->children.push_back(childNode);
+            }
+        }
+
+        LoadMeshes(context);
+        LoadAnimations(context);
+
+        return true;
+    }
+
+    bool DVKGLTFLoader::LoadBuffers(Context& context)
+    {
+        const json& buffers = GetArray(context.document, "buffers");
+        context.buffers.resize(buffers.size());
+
+        for (int32 i = 0; i < buffers.size(); ++i)
+        {
+            const json& buffer = buffers[i];
+            GLTFBuffer& result = context.buffers[i];
+            uint64 byteLength  = (uint64)MMath::Max(GetInt(buffer, "byteLength", 0), 0);
+            std::string uri    = GetString(buffer, "uri");
+
+            if (uri.empty())
+            {
+                // GLB的第一个buffer没有uri，指向BIN chunk
+                if (i == 0 && context.binaryChunk.data)
+                {
+                    result = context.binaryChunk;
+                }
+                // EXT_meshopt_compression的fallback buffer可以没有数据，只有压缩的bufferView引用它
+                else if (!GetBool(GetObject(GetObject(buffer, "extensions"), "EXT_meshopt_compression"), "fallback", false))
+                {
+                    MLOGE("glTF buffer %d has no data.", i);
+                    return false;
+                }
+            }
+            else if (uri.compare(0, 5, "data:") == 0)
+            {
+                const size_t base64Idx = uri.find(";base64,");
+                context.storages.push_back(std::vector<uint8>());
+                if (std::string::npos == base64Idx || !DecodeBase64(uri, base64Idx + 8, context.storages.back()))
+                {
+                    MLOGE("Invalid glTF data uri in buffer %d.", i);
+                    return false;
+                }
+                result.data = context.storages.back().data();
+                result.size = context.storages.back().size();
+            }
+            else
+            {
+                MappedFile* mappedFile = new MappedFile();
+                context.mappedFiles.push_back(mappedFile);
+                if (!OpenFile(context.directory + DecodeUri(uri), *mappedFile, context.storages, result))
+                {
+                    MLOGE("Failed open glTF buffer %s", uri.c_str());
+                    return false;
+                }
+            }
+
+            if (result.data && result.size < byteLength)
+            {
+                MLOGE("glTF buffer %d is smaller than byteLength.", i);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool DVKGLTFLoader::LoadBufferViews(Context& context)
+    {
+        const json& views = GetArray(context.document, "bufferViews");
+        context.views.resize(views.size());
+
+        for (int32 i = 0; i < views.size(); ++i)
+        {
+            const json& view = views[i];
+            GLTFBufferView& result = context.views[i];
+            result.stride = (uint32)MMath::Max(GetInt(view, "byteStride", 0), 0);
+
+            const json* compression = FindMember(GetObject(view, "extensions"), "EXT_meshopt_compression");
+            if (compression && compression->is_object())
+            {
+                int32  bufferIndex = GetInt(*compression, "buffer", -1);
+                uint64 byteOffset  = (uint64)MMath::Max(GetInt(*compression, "byteOffset", 0), 0);
+                uint64 byteLength  = (uint64)MMath::Max(GetInt(*compression, "byteLength", 0), 0);
+                uint32 byteStride  = (uint32)MMath::Max(GetInt(*compression, "byteStride", 0), 0);
+                uint32 count       = (uint32)MMath::Max(GetInt(*compression, "count", 0), 0);
+                std::string mode   = GetString(*compression, "mode");
+                std::string filter = GetString(*compression, "filter");
+
+                if (bufferIndex < 0 || bufferIndex >= context.buffers.size() || context.buffers[bufferIndex].data == nullptr ||
+                    byteOffset + byteLength > context.buffers[bufferIndex].size || byteStride == 0)
+                {
+                    MLOGE("Invalid EXT_meshopt_compression in bufferView %d.", i);
+                    return false;
+                }
+
+                // 解压进storages，之后与普通的bufferView一样使用
+                const uint8* src = context.buffers[bufferIndex].data + byteOffset;
+                context.storages.push_back(std::vector<uint8>((size_t)count * byteStride));
+                std::vector<uint8>& decoded = context.storages.back();
+
+                int32 ret = -1;
+                if (mode == "ATTRIBUTES")
+                {
+                    ret = meshopt_decodeVertexBuffer(decoded.data(), count, byteStride, src, (size_t)byteLength);
+                    if (ret == 0 && filter == "OCTAHEDRAL")
+                    {
+                        meshopt_decodeFilterOct(decoded.data(), count, byteStride);
+                    }
+                    else if (ret == 0 && filter == "QUATERNION")
+                    {
+                        meshopt_decodeFilterQuat(decoded.data(), count, byteStride);
+                    }
+                    else if (ret == 0 && filter == "EXPONENTIAL")
+                    {
+                        meshopt_decodeFilterExp(decoded.data(), count, byteStride);
+                    }
+                }
+                else if (mode == "TRIANGLES")
+                {
+                    ret = meshopt_decodeIndexBuffer(decoded.data(), count, byteStride, src, (size_t)byteLength);
+                }
+                else if (mode == "INDICES")
+                {
+                    ret = meshopt_decodeIndexSequence(decoded.data(), count, byteStride, src, (size_t)byteLength);
+                }
+
+                if (ret != 0)
+                {
+                    MLOGE("Failed decode bufferView %d, mode %s.", i, mode.c_str());
+                    return false;
+                }
+
+                result.data = decoded.data();
+                result.size = decoded.size();
+                continue;
+            }
+
+            int32  bufferIndex = GetInt(view, "buffer", -1);
+            uint64 byteOffset  = (uint64)MMath::Max(GetInt(view, "byteOffset", 0), 0);
+            uint64 byteLength  = (uint64)MMath::Max(GetInt(view, "byteLength", 0), 0);
+            if (bufferIndex < 0 || bufferIndex >= context.buffers.size())
+            {
+                MLOGE("Invalid buffer in bufferView %d.", i);
+                return false;
+            }
+
+            // fallback buffer上的bufferView保持为空，被使用时在accessor中报错
+            const GLTFBuffer& buffer = context.buffers[bufferIndex];
+            if (buffer.data == nullptr)
+            {
+                continue;
+            }
+
+            if (byteOffset + byteLength > buffer.size)
+            {
+                MLOGE("bufferView %d out of range.", i);
+                return false;
+            }
+
+            result.data = buffer.data + byteOffset;
+            result.size = byteLength;
+        }
+
+        return true;
+    }
+
+    bool DVKGLTFLoader::LoadAccessors(Context& context)
+    {
+        const json& accessors = GetArray(context.document, "accessors");
+        context.accessors.resize(accessors.size());
+
+        for (int32 i = 0; i < accessors.size(); ++i)
+        {
+            const json& accessor = accessors[i];
+            GLTFAccessor& result = context.accessors[i];
+            result.view          = GetInt(accessor, "bufferView", -1);
+            result.offset        = (uint32)MMath::Max(GetInt(accessor, "byteOffset", 0), 0);
+            result.count         = (uint32)MMath::Max(GetInt(accessor, "count", 0), 0);
+            result.componentType = GetInt(accessor, "componentType", 0);
+            result.components    = TypeComponents(GetString(accessor, "type"));
+            result.normalized    = GetBool(accessor, "normalized", false);
+
+            uint32 elementSize = ComponentSize(result.componentType) * result.components;
+            if (elementSize == 0)
+            {
+                MLOGE("Invalid type of accessor %d.", i);
+                return false;
+            }
+
+            result.stride = elementSize;
+            if (result.view >= 0)
+            {
+                if (result.view >= context.views.size() || context.views[result.view].data == nullptr)
+                {
+                    MLOGE("Invalid bufferView of accessor %d.", i);
+                    return false;
+                }
+
+                const GLTFBufferView& view = context.views[result.view];
+                result.stride = view.stride != 0 ? view.stride : elementSize;
+                if (result.count > 0 && result.offset + (uint64)result.stride * (result.count - 1) + elementSize > view.size)
+                {
+                    MLOGE("Accessor %d out of range.", i);
+                    return false;
+                }
+                result.data = view.data + result.offset;
+            }
+
+            // sparse的数据合并之后放入storages
+            const json* sparse = FindMember(accessor, "sparse");
+            if (sparse == nullptr || !sparse->is_object())
+            {
+                continue;
+            }
+
+            const json& sparseIndices = GetObject(*sparse, "indices");
+            const json& sparseValues  = GetObject(*sparse, "values");
+            uint32 sparseCount        = (uint32)MMath::Max(GetInt(*sparse, "count", 0), 0);
+            int32  indexView          = GetInt(sparseIndices, "bufferView", -1);
+            int32  valueView          = GetInt(sparseValues, "bufferView", -1);
+
+            GLTFAccessor indexAccessor;
+            indexAccessor.componentType = GetInt(sparseIndices, "componentType", 0);
+            indexAccessor.offset        = (uint32)MMath::Max(GetInt(sparseIndices, "byteOffset", 0), 0);
+            indexAccessor.stride        = ComponentSize(indexAccessor.componentType);
+            indexAccessor.count         = sparseCount;
+            uint32 valueOffset          = (uint32)MMath::Max(GetInt(sparseValues, "byteOffset", 0), 0);
+
+            if (indexView < 0 || indexView >= context.views.size() || context.views[indexView].data == nullptr ||
+                valueView < 0 || valueView >= context.views.size() || context.views[valueView].data == nullptr ||
+                indexAccessor.stride == 0 ||
+                indexAccessor.offset + (uint64)indexAccessor.stride * sparseCount > context.views[indexView].size ||
+                valueOffset + (uint64)elementSize * sparseCount > context.views[valueView].size)
+            {
+                MLOGE("Invalid sparse of accessor %d.", i);
+                return false;
+            }
+            indexAccessor.data = context.views[indexView].data + indexAccessor.offset;
+
+            std::vector<GLTFAccessor> indexAccessors(1, indexAccessor);
+            std::vector<uint32> indices;
+            if (!ReadIndices(indexAccessors, 0, indices))
+            {
+                MLOGE("Invalid sparse indices of accessor %d.", i);
+                return false;
+            }
+
+            context.storages.push_back(std::vector<uint8>((size_t)result.count * elementSize, 0));
+            std::vector<uint8>& merged = context.storages.back();
+            if (result.data)
+            {
+                for (uint32 j = 0; j < result.count; ++j)
+                {
+                    memcpy(merged.data() + j * elementSize, result.data + j * result.stride, elementSize);
+                }
+            }
+
+            const uint8* values = context.views[valueView].data + valueOffset;
+            for (uint32 j = 0; j < sparseCount; ++j)
+            {
+                if (indices[j] < result.count)
+                {
+                    memcpy(merged.data() + indices[j] * elementSize, values + j * elementSize, elementSize);
+                }
+            }
+
+            result.data   = merged.data();
+            result.stride = elementSize;
+        }
+
+        return true;
+    }
+
+    void DVKGLTFLoader::LoadSkins(Context& context)
+    {
+        DVKModel* model   = context.model;
+        const json& skins = GetArray(context.document, "skins");
+        context.skinBones.resize(skins.size());
+
+        for (int32 i = 0; i < skins.size(); ++i)
+        {
+            const json& joints = GetArray(skins[i], "joints");
+
+            std::vector<float> inverseBindMatrices;
+            ReadAccessor(context.accessors, GetInt(skins[i], "inverseBindMatrices", -1), 16, inverseBindMatrices);
+
+            std::vector<int32>& skinBones = context.skinBones[i];
+            for (int32 j = 0; j < joints.size(); ++j)
+            {
+                int32 nodeIndex = joints[j].is_number() ? joints[j].get<int32>() : -1;
+                if (nodeIndex < 0 || nodeIndex >= context.nodeNames.size())
+                {
+                    MLOGE("Invalid joint in skin %d, skin ignored.", i);
+                    skinBones.clear();
+                    break;
+                }
+
+                // 多个skin共用的骨骼只保留第一个inverseBindMatrix，与assimp路径相同
+                const std::string& name = context.nodeNames[nodeIndex];
+                auto it = model->bonesMap.find(name);
+                if (it != model->bonesMap.end())
+                {
+                    skinBones.push_back(it->second->index);
+                    continue;
+                }
+
+                DVKBone* bone = new DVKBone();
+                bone->index   = (int32)model->bones.size();
+                bone->parent  = -1;
+                bone->name    = name;
+                // glTF列主序的矩阵正好是行向量约定下的行主序
+                if ((j + 1) * 16 <= inverseBindMatrices.size())
+                {
+                    memcpy(bone->inverseBindPose.m, inverseBindMatrices.data() + j * 16, 16 * sizeof(float));
+                }
+                model->bones.push_back(bone);
+                model->bonesMap.insert(std::make_pair(name, bone));
+                skinBones.push_back(bone->index);
+            }
+        }
+    }
+
+    DVKNode* DVKGLTFLoader::LoadNode(Context& context, int32 index)
+    {
+        DVKModel* model  = context.model;
+        const json& node = GetArray(context.document, "nodes")[index];
+
+        DVKNode* vkNode = new DVKNode();
+        vkNode->name    = context.nodeNames[index];
+
+        // local matrix，matrix与TRS二选一
+        float values[16];
+        if (GetFloats(node, "matrix", values, 16))
+        {
+            memcpy(vkNode->localMatrix.m, values, sizeof(values));
+        }
+        else
+        {
+            GLTFNodeTRS& trs = context.nodeTRS[index];
+            if (GetFloats(node, "translation", values, 3))
+            {
+                trs.translation = Vector3(values[0], values[1], values[2]);
+            }
+            if (GetFloats(node, "rotation", values, 4))
+            {
+                trs.rotation = Quat(values[0], values[1], values[2], values[3]);
+            }
+            if (GetFloats(node, "scale", values, 3))
+            {
+                trs.scale = Vector3(values[0], values[1], values[2]);
+            }
+
+            vkNode->localMatrix.SetIdentity();
+            vkNode->localMatrix.AppendScale(trs.scale);
+            vkNode->localMatrix.Append(trs.rotation.ToMatrix());
+            vkNode->localMatrix.AppendTranslation(trs.translation);
+        }
+
+        // mesh，先占位，数据在LoadMeshes中转换，只保留三角形并且有POSITION的Primitive
+        const json& meshes = GetArray(context.document, "meshes");
+        int32 meshIndex    = GetInt(node, "mesh", -1);
+        if (meshIndex >= 0 && meshIndex < meshes.size())
+        {
+            int32 skinIndex = GetInt(node, "skin", -1);
+            if (skinIndex >= context.skinBones.size())
+            {
+                skinIndex = -1;
+            }
+
+            const json& primitives = GetArray(meshes[meshIndex], "primitives");
+            for (int32 i = 0; i < primitives.size(); ++i)
+            {
+                int32 mode     = GetInt(primitives[i], "mode", GLTF_MODE_TRIANGLES);
+                int32 position = GetInt(GetObject(primitives[i], "attributes"), "POSITION", -1);
+                if (mode < GLTF_MODE_TRIANGLES || mode > GLTF_MODE_TRIANGLE_FAN || position < 0 || position >= context.accessors.size())
+                {
+                    continue;
+                }
+
+                DVKMesh* vkMesh  = new DVKMesh();
+                vkMesh->linkNode = vkNode;
+                vkNode->meshes.push_back(vkMesh);
+                model->meshes.push_back(vkMesh);
+
+                GLTFPendingPrimitive pending;
+                pending.mesh           = vkMesh;
+                pending.meshIndex      = meshIndex;
+                pending.primitiveIndex = i;
+                pending.skin           = skinIndex;
+                context.pendings.push_back(pending);
+            }
+        }
+
+        // nodes map
+        model->nodesMap.insert(std::make_pair(vkNode->name, vkNode));
+        model->linearNodes.push_back(vkNode);
+
+        // bones parent
+        int32 boneParentIndex = -1;
+        {
+            auto it = model->bonesMap.find(vkNode->name);
+            if (it != model->bonesMap.end())
+            {
+                boneParentIndex = it->second->index;
+            }
+        }
+
+        // children node，忽略重复引用以及环
+        const json& children = GetArray(node, "children");
+        for (int32 i = 0; i < children.size(); ++i)
+        {
+            int32 childIndex = children[i].is_number() ? children[i].get<int32>() : -1;
+            if (childIndex < 0 || childIndex >= context.nodeNames.size() || context.nodeVisited[childIndex])
+            {
+                continue;
+            }
+            context.nodeVisited[childIndex] = 1;
+
+            DVKNode* childNode = LoadNode(context, childIndex);
+            childNode->parent  = vkNode;
+            vkNode->children.push_back(childNode);
+
+            // bones relationship
+            {
+                auto it = model->bonesMap.find(childNode->name);
+                if (it != model->bonesMap.end())
+                {
+                    it->second->parent = boneParentIndex;
+                }
+            }
+        }
+
+        return vkNode;
+    }
+
+    void DVKGLTFLoader::LoadMeshes(Context& context)
+    {
+        DVKModel* model = context.model;
+        int32 count     = (int32)context.pendings.size();
+
+        // 随机的默认颜色按顺序生成，与assimp路径一致
+        std::vector<Vector3> defaultColors(count);
+        for (int32 i = 0; i < count; ++i)
+        {
+            Vector3 defaultColor(
+                MMath::RandRange(0.0f, 1.0f),
+                MMath::RandRange(0.0f, 1.0f),
+                MMath::RandRange(0.0f, 1.0f)
+            );
+            defaultColors[i] = defaultColor;
+        }
+
+        bool optimize = (model->importFlags & (MIF_OptimizeMesh | MIF_GenerateLods | MIF_BuildMeshlets)) != 0;
+        std::vector<DVKMeshOptimizeStats> stats(optimize ? count : 0);
+
+        // 每个线程从计数器领取下一个Primitive，只读访问buffer
+        std::atomic<int32> nextMesh(0);
+        auto worker = [&]() -> void
+        {
+            for (int32 i = nextMesh++; i < count; i = nextMesh++)
+            {
+                LoadPrimitive(context, i, defaultColors[i]);
+
+                if (optimize)
+                {
+                    model->OptimizeMesh(context.pendings[i].mesh, stats[i]);
+                }
+            }
+        };
+
+        int32 numThreads = MMath::Min<int32>((int32)std::thread::hardware_concurrency(), count);
+        std::vector<std::thread> threads;
+        for (int32 i = 1; i < numThreads; ++i)
+        {
+            threads.push_back(std::thread(worker));
+        }
+
+        worker();
+
+        for (int32 i = 0; i < threads.size(); ++i)
+        {
+            threads[i].join();
+        }
+
+        for (int32 i = 0; i < stats.size(); ++i)
+        {
+            model->optimizeStats.Add(stats[i]);
+        }
+    }
+
+    // attributes对应的glTF属性及其格式，整个布局都与某个bufferView的交错数据一致时才能整块拷贝
+    struct GLTFAttributeFormat
+    {
+        const char*     semantic;
+        int32           componentType;
+        int32           components;
+        bool            normalized;
+    };
+
+    static bool GetAttributeFormat(VertexAttribute attribute, GLTFAttributeFormat& outFormat)
+    {
+        static const struct
+        {
+            VertexAttribute     attribute;
+            GLTFAttributeFormat format;
+        } formats[] = {
+            { VertexAttribute::VA_Position,        { "POSITION",   GLTF_FLOAT,          3, false } },
+            { VertexAttribute::VA_UV0,             { "TEXCOORD_0", GLTF_FLOAT,          2, false } },
+            { VertexAttribute::VA_UV1,             { "TEXCOORD_1", GLTF_FLOAT,          2, false } },
+            { VertexAttribute::VA_Normal,          { "NORMAL",     GLTF_FLOAT,          3, false } },
+            { VertexAttribute::VA_Tangent,         { "TANGENT",    GLTF_FLOAT,          4, false } },
+            { VertexAttribute::VA_Color,           { "COLOR_0",    GLTF_FLOAT,          3, false } },
+            { VertexAttribute::VA_SkinWeight,      { "WEIGHTS_0",  GLTF_FLOAT,          4, false } },
+            { VertexAttribute::VA_TangentSN16,     { "TANGENT",    GLTF_SHORT,          4, true  } },
+            { VertexAttribute::VA_ColorUN8,        { "COLOR_0",    GLTF_UNSIGNED_BYTE,  4, true  } },
+            { VertexAttribute::VA_SkinIndexU8,     { "JOINTS_0",   GLTF_UNSIGNED_BYTE,  4, false } },
+            { VertexAttribute::VA_SkinWeightUN8,   { "WEIGHTS_0",  GLTF_UNSIGNED_BYTE,  4, true  } },
+            { VertexAttribute::VA_SkinWeightUN16,  { "WEIGHTS_0",  GLTF_UNSIGNED_SHORT, 4, true  } },
+        };
+
+        for (int32 i = 0; i < sizeof(formats) / sizeof(formats[0]); ++i)
+        {
+            if (formats[i].attribute == attribute)
+            {
+                outFormat = formats[i].format;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    static bool IsSkinAttribute(VertexAttribute attribute)
+    {
+        return attribute == VertexAttribute::VA_SkinWeight || attribute == VertexAttribute::VA_SkinIndexU8 || attribute == VertexAttribute::VA_SkinWeightUN8 || attribute == VertexAttribute::VA_SkinWeightUN16;
+    }
+
+    // 找到与attributes完全一致的交错顶点，返回第一个顶点的位置
+    static const uint8* FindMatchedVertices(const std::vector<GLTFAccessor>& accessors, const json& gltfAttributes, const std::vector<VertexAttribute>& attributes, bool isSkin, uint32 vertexCount)
+    {
+        const uint8* base = nullptr;
+        int32 view        = -1;
+        uint32 offset     = 0;
+        uint32 stride     = 0;
+
+        for (int32 i = 0; i < attributes.size(); ++i)
+        {
+            stride += VertexAttributeToSize(attributes[i]);
+        }
+
+        for (int32 i = 0; i < attributes.size(); ++i)
+        {
+            GLTFAttributeFormat format;
+            if (!GetAttributeFormat(attributes[i], format) || (IsSkinAttribute(attributes[i]) && !isSkin))
+            {
+                return nullptr;
+            }
+
+            int32 index = GetInt(gltfAttributes, format.semantic, -1);
+            if (index < 0 || index >= accessors.size())
+            {
+                return nullptr;
+            }
+
+            const GLTFAccessor& accessor = accessors[index];
+            if (accessor.data == nullptr || accessor.count != vertexCount || accessor.stride != stride ||
+                accessor.componentType != format.componentType || accessor.components != format.components || accessor.normalized != format.normalized)
+            {
+                return nullptr;
+            }
+
+            // 所有属性在同一个bufferView中，相对偏移与attributes的排布一致
+            if (i == 0)
+            {
+                view = accessor.view;
+                base = accessor.data;
+            }
+            else if (accessor.view != view || accessor.data != base + offset)
+            {
+                return nullptr;
+            }
+
+            offset += VertexAttributeToSize(attributes[i]);
+        }
+
+        return base;
+    }
+
+    // 顶点属性的元素数量必须与POSITION一致，不一致时忽略该属性，避免越界读取
+    static int32 GetVertexAccessor(const std::vector<GLTFAccessor>& accessors, const json& gltfAttributes, const char* semantic, uint32 vertexCount)
+    {
+        int32 index = GetInt(gltfAttributes, semantic, -1);
+        if (index < 0 || index >= accessors.size())
+        {
+            return -1;
+        }
+
+        if (accessors[index].count != vertexCount)
+        {
+            MLOGE("Ignore glTF attribute %s : count %d, POSITION count %d", semantic, accessors[index].count, vertexCount);
+            return -1;
+        }
+
+        return index;
+    }
+
+    static bool NeedsTangents(const std::vector<VertexAttribute>& attributes)
+    {
+        for (int32 i = 0; i < attributes.size(); ++i)
+        {
+            if (attributes[i] == VertexAttribute::VA_Tangent || attributes[i] == VertexAttribute::VA_TangentSN16)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 按索引计算面积加权的平滑法线，与assimp的GenSmoothNormals相同
+    static void GenerateNormals(aiVector3D* outNormals, const aiVector3D* positions, uint32 vertexCount, const std::vector<uint32>& indices)
+    {
+        for (uint32 i = 0; i < vertexCount; ++i)
+        {
+            outNormals[i] = aiVector3D(0.0f, 0.0f, 0.0f);
+        }
+
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            const aiVector3D& p0 = positions[indices[i + 0]];
+            const aiVector3D& p1 = positions[indices[i + 1]];
+            const aiVector3D& p2 = positions[indices[i + 2]];
+            aiVector3D normal = (p1 - p0) ^ (p2 - p0);
+            outNormals[indices[i + 0]] += normal;
+            outNormals[indices[i + 1]] += normal;
+            outNormals[indices[i + 2]] += normal;
+        }
+
+        for (uint32 i = 0; i < vertexCount; ++i)
+        {
+            outNormals[i].NormalizeSafe();
+        }
+    }
+
+    // 没有TANGENT时按MikkTSpace的方式生成：逐三角形由UV求切线与副切线，按顶点处的夹角加权累加，
+    // 再对法线正交化，副切线只用于确定方向。UV退化的顶点取任意一个与法线垂直的方向
+    static void GenerateTangents(aiVector3D* outTangents, aiVector3D* outBitangents, const aiVector3D* positions, const aiVector3D* normals, const aiVector3D* uvs, uint32 vertexCount, const std::vector<uint32>& indices)
+    {
+        std::vector<aiVector3D> bitangents(vertexCount, aiVector3D(0.0f, 0.0f, 0.0f));
+        for (uint32 i = 0; i < vertexCount; ++i)
+        {
+            outTangents[i] = aiVector3D(0.0f, 0.0f, 0.0f);
+        }
+
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            for (int32 corner = 0; corner < 3; ++corner)
+            {
+                uint32 i0 = indices[i + corner];
+                uint32 i1 = indices[i + (corner + 1) % 3];
+                uint32 i2 = indices[i + (corner + 2) % 3];
+
+                aiVector3D e1 = positions[i1] - positions[i0];
+                aiVector3D e2 = positions[i2] - positions[i0];
+                float du1 = uvs[i1].x - uvs[i0].x;
+                float dv1 = uvs[i1].y - uvs[i0].y;
+                float du2 = uvs[i2].x - uvs[i0].x;
+                float dv2 = uvs[i2].y - uvs[i0].y;
+
+                float det = du1 * dv2 - du2 * dv1;
+                float len = e1.Length() * e2.Length();
+                if (MMath::Abs(det) < 1e-12f || len < 1e-12f)
+                {
+                    continue;
+                }
+
+                float angle = MMath::Acos((e1 * e2) / len);
+                float scale = (det > 0.0f ? 1.0f : -1.0f) * angle;
+                aiVector3D tangent   = e1 * dv2 - e2 * dv1;
+                aiVector3D bitangent = e2 * du1 - e1 * du2;
+                tangent.NormalizeSafe();
+                bitangent.NormalizeSafe();
+                outTangents[i0] += tangent * scale;
+                bitangents[i0]  += bitangent * scale;
+            }
+        }
+
+        for (uint32 i = 0; i < vertexCount; ++i)
+        {
+            const aiVector3D& normal = normals[i];
+            aiVector3D tangent = outTangents[i] - normal * (normal * outTangents[i]);
+            if (tangent.SquareLength() < 1e-12f)
+            {
+                tangent = MMath::Abs(normal.x) < 0.9f ? aiVector3D(1.0f, 0.0f, 0.0f) : aiVector3D(0.0f, 1.0f, 0.0f);
+                tangent = tangent - normal * (normal * tangent);
+            }
+            tangent.Normalize();
+
+            // 与glTF的TANGENT.w相同，副切线 = N×T * w
+            float sign = ((normal ^ tangent) * bitangents[i]) < 0.0f ? -1.0f : 1.0f;
+            outTangents[i]   = tangent;
+            outBitangents[i] = (normal ^ tangent) * sign;
+        }
+    }
+
+    static std::string GetTexturePath(const json& document, const json& textureInfo)
+    {
+        const json& textures = GetArray(document, "textures");
+        const json& images   = GetArray(document, "images");
+
+        int32 textureIndex = GetInt(textureInfo, "index", -1);
+        if (textureIndex < 0 || textureIndex >= textures.size())
+        {
+            return std::string();
+        }
+
+        int32 imageIndex = GetInt(textures[textureIndex], "source", -1);
+        if (imageIndex < 0 || imageIndex >= images.size())
+        {
+            return std::string();
+        }
+
+        // 内嵌的图片没有uri，使用名称
+        std::string path = GetString(images[imageIndex], "uri");
+        if (path.empty() || path.compare(0, 5, "data:") == 0)
+        {
+            path = GetString(images[imageIndex], "name");
+        }
+
+        path = DecodeUri(path);
+        SimplifyTexturePath(path);
+        return path;
+    }
+
+    void DVKGLTFLoader::LoadPrimitive(Context& context, int32 pendingIndex, const Vector3& defaultColor)
+    {
+        DVKModel* model = context.model;
+        const GLTFPendingPrimitive& pending = context.pendings[pendingIndex];
+        DVKMesh* mesh = pending.mesh;
+
+        const json& document       = context.document;
+        const json& gltfPrimitive  = GetArray(GetArray(document, "meshes")[pending.meshIndex], "primitives")[pending.primitiveIndex];
+        const json& gltfAttributes = GetObject(gltfPrimitive, "attributes");
+
+        // load material
+        const json& materials = GetArray(document, "materials");
+        int32 materialIndex   = GetInt(gltfPrimitive, "material", -1);
+        if (materialIndex >= 0 && materialIndex < materials.size())
+        {
+            const json& material   = materials[materialIndex];
+            mesh->material.diffuse   = GetTexturePath(document, GetObject(GetObject(material, "pbrMetallicRoughness"), "baseColorTexture"));
+            mesh->material.normalmap = GetTexturePath(document, GetObject(material, "normalTexture"));
+        }
+
+        const GLTFAccessor& positionAccessor = context.accessors[GetInt(gltfAttributes, "POSITION", -1)];
+        uint32 vertexCount = positionAccessor.count;
+
+        // load indices，strip以及fan转换为三角形列表，越界的三角形丢弃
+        std::vector<uint32> source;
+        if (!ReadIndices(context.accessors, GetInt(gltfPrimitive, "indices", -1), source))
+        {
+            source.resize(vertexCount);
+            for (uint32 i = 0; i < vertexCount; ++i)
+            {
+                source[i] = i;
+            }
+        }
+
+        int32 mode = GetInt(gltfPrimitive, "mode", GLTF_MODE_TRIANGLES);
+        std::vector<uint32> indices;
+        indices.reserve(mode == GLTF_MODE_TRIANGLES ? source.size() : source.size() * 3);
+        for (size_t i = 0; i + 2 < source.size(); i += (mode == GLTF_MODE_TRIANGLES ? 3 : 1))
+        {
+            uint32 triangle[3] = { source[i + 0], source[i + 1], source[i + 2] };
+            if (mode == GLTF_MODE_TRIANGLE_STRIP && (i & 1))
+            {
+                std::swap(triangle[0], triangle[1]);
+            }
+            else if (mode == GLTF_MODE_TRIANGLE_FAN)
+            {
+                triangle[0] = source[0];
+                triangle[1] = source[i + 1];
+                triangle[2] = source[i + 2];
+            }
+
+            if (triangle[0] < vertexCount && triangle[1] < vertexCount && triangle[2] < vertexCount)
+            {
+                indices.push_back(triangle[0]);
+                indices.push_back(triangle[1]);
+                indices.push_back(triangle[2]);
+            }
+        }
+
+        // load skin，JOINTS_0是skin中joints的索引，正好对应mesh->bones
+        std::vector<DVKVertexSkin> skinInfos;
+        int32 joints  = GetVertexAccessor(context.accessors, gltfAttributes, "JOINTS_0", vertexCount);
+        int32 weights = GetVertexAccessor(context.accessors, gltfAttributes, "WEIGHTS_0", vertexCount);
+        if (model->loadSkin && pending.skin >= 0 && context.skinBones[pending.skin].size() > 0 && joints >= 0 && weights >= 0)
+        {
+            std::vector<float> jointValues;
+            std::vector<float> weightValues;
+            ReadAccessor(context.accessors, joints, 4, jointValues);
+            ReadAccessor(context.accessors, weights, 4, weightValues);
+
+            mesh->bones  = context.skinBones[pending.skin];
+            mesh->isSkin = true;
+
+            skinInfos.resize(vertexCount);
+            for (uint32 i = 0; i < vertexCount; ++i)
+            {
+                DVKVertexSkin& info = skinInfos[i];
+                for (int32 j = 0; j < 4; ++j)
+                {
+                    int32 joint  = (int32)jointValues[i * 4 + j];
+                    float weight = weightValues[i * 4 + j];
+                    if (weight > 0.0f && joint < mesh->bones.size())
+                    {
+                        info.indices[info.used] = joint;
+                        info.weights[info.used] = weight;
+                        info.used += 1;
+                    }
+                }
+            }
+        }
+
+        // load vertex data
+        std::vector<float> vertices;
+        Vector3 mmin( MAX_FLT,  MAX_FLT,  MAX_FLT);
+        Vector3 mmax(-MAX_FLT, -MAX_FLT, -MAX_FLT);
+
+        const uint8* matched = FindMatchedVertices(context.accessors, gltfAttributes, model->attributes, mesh->isSkin, vertexCount);
+        if (matched)
+        {
+            // 布局一致，一次memcpy拷贝进Primitive，包围盒从Position计算
+            uint32 stride = (uint32)positionAccessor.stride;
+            vertices.resize(vertexCount * stride / sizeof(float));
+            memcpy(vertices.data(), matched, vertices.size() * sizeof(float));
+
+            int32 positionOffset = 0;
+            for (int32 i = 0; i < model->attributes.size() && model->attributes[i] != VertexAttribute::VA_Position; ++i)
+            {
+                positionOffset += VertexAttributeToSize(model->attributes[i]) / sizeof(float);
+            }
+
+            if (positionOffset < stride / sizeof(float))
+            {
+                for (uint32 i = 0; i < vertexCount; ++i)
+                {
+                    const float* position = vertices.data() + i * stride / sizeof(float) + positionOffset;
+                    mmin = Vector3::Min(mmin, Vector3(position[0], position[1], position[2]));
+                    mmax = Vector3::Max(mmax, Vector3(position[0], position[1], position[2]));
+                }
+            }
+        }
+        else
+        {
+            // 读取为float之后填入aiMesh，与assimp路径共用顶点转换
+            aiMesh aimesh;
+            aimesh.mNumVertices = vertexCount;
+
+            std::vector<float> values;
+            ReadAccessor(context.accessors, GetInt(gltfAttributes, "POSITION", -1), 3, values);
+            aimesh.mVertices = new aiVector3D[vertexCount];
+            memcpy(aimesh.mVertices, values.data(), vertexCount * sizeof(aiVector3D));
+
+            aimesh.mNormals = new aiVector3D[vertexCount];
+            if (ReadAccessor(context.accessors, GetVertexAccessor(context.accessors, gltfAttributes, "NORMAL", vertexCount), 3, values))
+            {
+                memcpy(aimesh.mNormals, values.data(), vertexCount * sizeof(aiVector3D));
+            }
+            else
+            {
+                GenerateNormals(aimesh.mNormals, aimesh.mVertices, vertexCount, indices);
+            }
+
+            const char* texcoords[] = { "TEXCOORD_0", "TEXCOORD_1" };
+            for (int32 channel = 0; channel < 2; ++channel)
+            {
+                if (ReadAccessor(context.accessors, GetVertexAccessor(context.accessors, gltfAttributes, texcoords[channel], vertexCount), 2, values))
+                {
+                    aimesh.mTextureCoords[channel]   = new aiVector3D[vertexCount];
+                    aimesh.mNumUVComponents[channel] = 2;
+                    for (uint32 i = 0; i < vertexCount; ++i)
+                    {
+                        aimesh.mTextureCoords[channel][i] = aiVector3D(values[i * 2 + 0], values[i * 2 + 1], 0.0f);
+                    }
+                }
+            }
+
+            // w为副切线方向，通过副切线传给顶点转换
+            if (ReadAccessor(context.accessors, GetVertexAccessor(context.accessors, gltfAttributes, "TANGENT", vertexCount), 4, values))
+            {
+                aimesh.mTangents   = new aiVector3D[vertexCount];
+                aimesh.mBitangents = new aiVector3D[vertexCount];
+                for (uint32 i = 0; i < vertexCount; ++i)
+                {
+                    aimesh.mTangents[i]   = aiVector3D(values[i * 4 + 0], values[i * 4 + 1], values[i * 4 + 2]);
+                    aimesh.mBitangents[i] = (aimesh.mNormals[i] ^ aimesh.mTangents[i]) * (values[i * 4 + 3] < 0.0f ? -1.0f : 1.0f);
+                }
+            }
+            else if (NeedsTangents(model->attributes) && aimesh.mTextureCoords[0])
+            {
+                // 与assimp的aiProcess_CalcTangentSpace一致，没有UV时不生成
+                aimesh.mTangents   = new aiVector3D[vertexCount];
+                aimesh.mBitangents = new aiVector3D[vertexCount];
+                GenerateTangents(aimesh.mTangents, aimesh.mBitangents, aimesh.mVertices, aimesh.mNormals, aimesh.mTextureCoords[0], vertexCount, indices);
+            }
+
+            int32 colors = GetVertexAccessor(context.accessors, gltfAttributes, "COLOR_0", vertexCount);
+            if (colors >= 0)
+            {
+                // VEC3的颜色alpha为1
+                int32 components = context.accessors[colors].components;
+                ReadAccessor(context.accessors, colors, 4, values);
+                aimesh.mColors[0] = new aiColor4D[vertexCount];
+                for (uint32 i = 0; i < vertexCount; ++i)
+                {
+                    aimesh.mColors[0][i] = aiColor4D(values[i * 4 + 0], values[i * 4 + 1], values[i * 4 + 2], components == 4 ? values[i * 4 + 3] : 1.0f);
+                }
+            }
+
+            model->LoadVertexDatas(skinInfos, vertices, mmax, mmin, defaultColor, mesh, &aimesh, nullptr);
+        }
+
+        // load primitives
+        DVKPrimitive* primitive = new DVKPrimitive();
+        primitive->vertices.swap(vertices);
+        primitive->indices.swap(indices);
+        primitive->vertexCount = (int32)vertexCount;
+        primitive->triangleNum = (int32)primitive->indices.size() / 3;
+        primitive->indexType   = DVKIndexBuffer::GetIndexType(primitive->vertexCount);
+        mesh->primitives.push_back(primitive);
+
+        mesh->vertexCount   += primitive->vertexCount;
+        mesh->triangleCount += primitive->triangleNum;
+
+        mesh->bounding.min = mmin;
+        mesh->bounding.max = mmax;
+        mesh->bounding.UpdateCorners();
+    }
+
+    void DVKGLTFLoader::LoadAnimations(Context& context)
+    {
+        DVKModel* model = context.model;
+        const json& animations = GetArray(context.document, "animations");
+
+        for (int32 i = 0; i < animations.size(); ++i)
+        {
+            const json& samplers = GetArray(animations[i], "samplers");
+            const json& channels = GetArray(animations[i], "channels");
+
+            DVKAnimation animation;
+            animation.name = GetString(animations[i], "name");
+
+            // 动画通道对应的节点，之后补齐缺少的通道
+            std::vector<int32> animatedNodes;
+
+            for (int32 j = 0; j < channels.size(); ++j)
+            {
+                const json& target = GetObject(channels[j], "target");
+                int32 nodeIndex    = GetInt(target, "node", -1);
+                int32 samplerIndex = GetInt(channels[j], "sampler", -1);
+                std::string path   = GetString(target, "path");
+
+                // morph target的weights不支持
+                if (nodeIndex < 0 || nodeIndex >= context.nodeNames.size() || !context.nodeVisited[nodeIndex] || samplerIndex < 0 || samplerIndex >= samplers.size() ||
+                    (path != "translation" && path != "rotation" && path != "scale"))
+                {
+                    continue;
+                }
+
+                const json& sampler = samplers[samplerIndex];
+                std::string interpolation = GetString(sampler, "interpolation");
+
+                std::vector<float> keys;
+                std::vector<float> values;
+                int32 components = path == "rotation" ? 4 : 3;
+                if (!ReadAccessor(context.accessors, GetInt(sampler, "input", -1), 1, keys) ||
+                    !ReadAccessor(context.accessors, GetInt(sampler, "output", -1), components, values))
+                {
+                    continue;
+                }
+
+                // CUBICSPLINE每个关键帧依次是入切线、值、出切线，只取值。STEP也按线性插值处理。
+                int32 valueStride = interpolation == "CUBICSPLINE" ? 3 : 1;
+                int32 valueOffset = interpolation == "CUBICSPLINE" ? 1 : 0;
+                if (keys.size() * valueStride * components > values.size())
+                {
+                    continue;
+                }
+
+                const std::string& nodeName = context.nodeNames[nodeIndex];
+                if (animation.clips.find(nodeName) == animation.clips.end())
+                {
+                    DVKAnimationClip clip;
+                    clip.nodeName = nodeName;
+                    clip.duration = 0.0f;
+                    animation.clips.insert(std::make_pair(nodeName, clip));
+                    animatedNodes.push_back(nodeIndex);
+                }
+
+                DVKAnimationClip& animClip = animation.clips[nodeName];
+                for (int32 k = 0; k < keys.size(); ++k)
+                {
+                    const float* value = values.data() + (k * valueStride + valueOffset) * components;
+                    if (path == "translation")
+                    {
+                        animClip.positions.keys.push_back(keys[k]);
+                        animClip.positions.values.push_back(Vector3(value[0], value[1], value[2]));
+                    }
+                    else if (path == "scale")
+                    {
+                        animClip.scales.keys.push_back(keys[k]);
+                        animClip.scales.values.push_back(Vector3(value[0], value[1], value[2]));
+                    }
+                    else
+                    {
+                        Quat rotation(value[0], value[1], value[2], value[3]);
+                        rotation.Normalize();
+                        animClip.rotations.keys.push_back(keys[k]);
+                        animClip.rotations.values.push_back(rotation);
+                    }
+                    animClip.duration = MMath::Max(keys[k], animClip.duration);
+                }
+
+                animation.duration = MMath::Max(animClip.duration, animation.duration);
+            }
+
+            if (animation.clips.size() == 0)
+            {
+                continue;
+            }
+
+            // glTF中没有动画的通道保持节点的初始值，DVKModel缺少通道时使用的是单位值
+            for (int32 j = 0; j < animatedNodes.size(); ++j)
+            {
+                const GLTFNodeTRS& trs = context.nodeTRS[animatedNodes[j]];
+                DVKAnimationClip& animClip = animation.clips[context.nodeNames[animatedNodes[j]]];
+                if (animClip.positions.keys.size() == 0)
+                {
+                    animClip.positions.keys.push_back(0.0f);
+                    animClip.positions.values.push_back(trs.translation);
+                }
+                if (animClip.scales.keys.size() == 0)
+                {
+                    animClip.scales.keys.push_back(0.0f);
+                    animClip.scales.values.push_back(trs.scale);
+                }
+                if (animClip.rotations.keys.size() == 0)
+                {
+                    animClip.rotations.keys.push_back(0.0f);
+                    animClip.rotations.values.push_back(trs.rotation);
+                }
+            }
+
+            model->animations.push_back(animation);
+        }
+    }
+
+}
@@ -0,0 +1,52 @@
+﻿#pragma once
+
+#include "Engine.h"
+
+#include "Common/Common.h"
+#include "Math/Vector3.h"
+
+#include <string>
+
+namespace vk_demo
+{
+    class DVKModel;
+    struct DVKNode;
+
+    // 直接解析glTF 2.0(.gltf/.glb)，不经过assimp。
+    // GLB以及外部.bin通过内存映射读取，布局与attributes一致的交错顶点整块拷贝进Primitive，不逐个属性转换。
+    // 顶点数据仍然保留在Primitive中(优化、LOD、蒙皮等需要)，之后与assimp路径一样经过Staging上传，并不是零拷贝。
+    // 支持KHR_mesh_quantization的整数属性以及EXT_meshopt_compression压缩的bufferView。
+    // 节点、材质贴图、蒙皮以及动画与assimp导入的结果保持一致，之后的优化、LOD、Meshlet按importFlags处理。
+    class DVKGLTFLoader
+    {
+    private:
+        struct Context;
+
+    public:
+
+        static bool IsGLTFFile(const std::string& filename);
+
+        // model必须是空模型，只设置了device、attributes、importFlags以及cmdBuffer。
+        // 解析、依赖的扩展或者buffer读取失败时返回false并保持模型为空，由调用者交给assimp处理。
+        static bool Load(DVKModel* model, const std::string& filename);
+
+    private:
+
+        static bool LoadBuffers(Context& context);
+
+        static bool LoadBufferViews(Context& context);
+
+        static bool LoadAccessors(Context& context);
+
+        static void LoadSkins(Context& context);
+
+        static DVKNode* LoadNode(Context& context, int32 index);
+
+        static void LoadMeshes(Context& context);
+
+        static void LoadPrimitive(Context& context, int32 pending, const Vector3& defaultColor);
+
+        static void LoadAnimations(Context& context);
+    };
+
+}
@@ -4,36 +4,58 @@
 
 namespace vk_demo
 {
-    DVKIndexBuffer* DVKIndexBuffer::Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, std::vector<uint32> indices)
+    DVKIndexBuffer* DVKIndexBuffer::Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, const std::vector<uint32>& indices)
     {
-        VkDevice device = vulkanDevice->GetInstanceHandle();
+        return Create(vulkanDevice, cmdBuffer, indices.data(), (int32)indices.size(), VK_INDEX_TYPE_UINT32);
+    }
 
-        DVKIndexBuffer* indexBuffer = new DVKIndexBuffer();
-        indexBuffer->device     = device;
-        indexBuffer->indexCount = (int32)indices.size();
-        indexBuffer->indexType  = VK_INDEX_TYPE_UINT32;
+    DVKIndexBuffer* DVKIndexBuffer::Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, const std::vector<uint32>& indices, VkIndexType indexType)
+    {
+        if (indexType == VK_INDEX_TYPE_UINT32)
+        {
+            return Create(vulkanDevice, cmdBuffer, indices);
+        }
+
+        std::vector<uint16> packed(indices.size());
+        PackIndices(packed.data(), indices.data(), (int32)indices.size(), indexType);
+        return Create(vulkanDevice, cmdBuffer, packed);
+    }
+
+    void DVKIndexBuffer::PackIndices(void* dst, const uint32* indices, int32 indexCount, VkIndexType indexType)
+    {
+        if (indexType == VK_INDEX_TYPE_UINT32)
+        {
+            memcpy(dst, indices, indexCount * sizeof(uint32));
+            return;
+        }
+
+        uint16* dst16 = (uint16*)dst;
+        for (int32 i = 0; i < indexCount; ++i)
+        {
+            dst16[i] = (uint16)indices[i];
+        }
+    }
+
+    DVKIndexBuffer* DVKIndexBuffer::Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, const std::vector<uint16>& indices)
+    {
+        return Create(vulkanDevice, cmdBuffer, indices.data(), (int32)indices.size(), VK_INDEX_TYPE_UINT16);
+    }
+
+    DVKIndexBuffer* DVKIndexBuffer::Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, const void* data, int32 indexCount, VkIndexType indexType)
+    {
+        VkDeviceSize dataSize = indexCount * GetIndexSize(indexType);
 
         vk_demo::DVKBuffer* indexStaging = vk_demo::DVKBuffer::CreateBuffer(
             vulkanDevice,
             VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            indices.size() * sizeof(uint32),
-            indices.data()
-        );
-
-        indexBuffer->dvkBuffer = vk_demo::DVKBuffer::CreateBuffer(
-            vulkanDevice,
-            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            indices.size() * sizeof(uint32)
+            dataSize,
+            (void*)data
         );
 
         cmdBuffer->Begin();
 
-        VkBufferCopy copyRegion = {};
-        copyRegion.size = indices.size() * sizeof(uint32);
-
-        vkCmdCopyBuffer(cmdBuffer->cmdBuffer, indexStaging->buffer, indexBuffer->dvkBuffer->buffer, 1, &copyRegion);
+        DVKIndexBuffer* indexBuffer = Create(vulkanDevice, cmdBuffer, indexStaging, 0, indexCount, indexType);
 
         cmdBuffer->End();
         cmdBuffer->Submit();
@@ -43,41 +65,29 @@ namespace vk_demo
         return indexBuffer;
     }
 
-    DVKIndexBuffer* DVKIndexBuffer::Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, std::vector<uint16> indices)
+    DVKIndexBuffer* DVKIndexBuffer::Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, DVKBuffer* staging, VkDeviceSize stagingOffset, int32 indexCount, VkIndexType indexType)
     {
         VkDevice device = vulkanDevice->GetInstanceHandle();
 
         DVKIndexBuffer* indexBuffer = new DVKIndexBuffer();
         indexBuffer->device     = device;
-        indexBuffer->indexCount = (int32)indices.size();
-        indexBuffer->indexType  = VK_INDEX_TYPE_UINT16;
+        indexBuffer->indexCount = indexCount;
+        indexBuffer->indexType  = indexType;
 
-        vk_demo::DVKBuffer* indexStaging = vk_demo::DVKBuffer::CreateBuffer(
-            vulkanDevice,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            indices.size() * sizeof(uint16),
-            indices.data()
-        );
+        VkDeviceSize dataSize = indexCount * GetIndexSize(indexType);
 
         indexBuffer->dvkBuffer = vk_demo::DVKBuffer::CreateBuffer(
             vulkanDevice,
             VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            indices.size() * sizeof(uint16)
+            dataSize
         );
 
-        cmdBuffer->Begin();
-
         VkBufferCopy copyRegion = {};
-        copyRegion.size = indices.size() * sizeof(uint16);
-
-        vkCmdCopyBuffer(cmdBuffer->cmdBuffer, indexStaging->buffer, indexBuffer->dvkBuffer->buffer, 1, &copyRegion);
+        copyRegion.srcOffset = stagingOffset;
+        copyRegion.size      = dataSize;
 
-        cmdBuffer->End();
-        cmdBuffer->Submit();
-
-        delete indexStaging;
+        vkCmdCopyBuffer(cmdBuffer->cmdBuffer, staging->buffer, indexBuffer->dvkBuffer->buffer, 1, &copyRegion);
 
         return indexBuffer;
     }
@@ -40,9 +40,31 @@ namespace vk_demo
             vkCmdBindIndexBuffer(cmdBuffer, dvkBuffer->buffer, 0, indexType);
         }
 
-        static DVKIndexBuffer* Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, std::vector<uint16> indices);
+        static DVKIndexBuffer* Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, const std::vector<uint16>& indices);
 
-        static DVKIndexBuffer* Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, std::vector<uint32> indices);
+        static DVKIndexBuffer* Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, const std::vector<uint32>& indices);
+
+        // 32位索引按indexType打包之后上传
+        static DVKIndexBuffer* Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, const std::vector<uint32>& indices, VkIndexType indexType);
+
+        // 数据直接拷贝进Staging，例如来自映射好的缓存文件
+        static DVKIndexBuffer* Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, const void* data, int32 indexCount, VkIndexType indexType);
+
+        // 只录制从staging拷贝的命令，调用者负责Begin/End/Submit以及释放staging，用于批量上传
+        static DVKIndexBuffer* Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, DVKBuffer* staging, VkDeviceSize stagingOffset, int32 indexCount, VkIndexType indexType);
+
+        static void PackIndices(void* dst, const uint32* indices, int32 indexCount, VkIndexType indexType);
+
+        // 顶点数不超过65535时使用UINT16，0xFFFF保留给primitive restart
+        static FORCE_INLINE VkIndexType GetIndexType(int32 vertexCount)
+        {
+            return vertexCount <= 65535 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+        }
+
+        static FORCE_INLINE uint32 GetIndexSize(VkIndexType indexType)
+        {
+            return indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16) : sizeof(uint32);
+        }
 
     public:
         VkDevice        device = VK_NULL_HANDLE;
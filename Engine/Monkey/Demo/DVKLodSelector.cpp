@@ -0,0 +1,99 @@
+﻿#include "DVKLodSelector.h"
+#include "DVKCamera.h"
+#include "DVKModel.h"
+
+namespace vk_demo
+{
+
+    float DVKLodSelector::ComputeScreenSize(DVKCamera& camera, const Vector3& center, float radius)
+    {
+        // 透视投影m[1][1]为1/tan(fovy/2)，正交投影为2/(top-bottom)
+        const Matrix4x4& projection = camera.GetProjection();
+        float scale = projection.m[1][1];
+
+        if (projection.m[2][3] == 0.0f)
+        {
+            return radius * scale;
+        }
+
+        // 使用到球心的距离而不是深度，相机旋转时LOD保持不变
+        float distance = (center - camera.GetTransform().GetOrigin()).Size();
+        if (distance <= radius)
+        {
+            return MAX_FLT;
+        }
+
+        return radius * scale / distance;
+    }
+
+    int32 DVKLodSelector::SelectLod(const DVKMesh* mesh, float screenSize, float radius) const
+    {
+        int32 lodCount = mesh->GetLodCount();
+        if (lodCount <= 1 || radius <= 0.0f)
+        {
+            return 0;
+        }
+
+        // 像素误差 = 物体空间误差 / 半径 * 投影半径(像素)
+        float pixelsPerUnit = screenSize * screenHeight * 0.5f / radius;
+
+        int32 current = MMath::Clamp(mesh->lodIndex, 0, lodCount - 1);
+        int32 target  = 0;
+        float relaxed = pixelError * (1.0f - hysteresis);
+
+        for (int32 i = 1; i < lodCount; ++i)
+        {
+            // 同一级各Primitive取最大的误差
+            float error = 0.0f;
+            for (int32 j = 0; j < mesh->primitives.size(); ++j)
+            {
+                const DVKPrimitive* primitive = mesh->primitives[j];
+                if (primitive->lods.size() > 0)
+                {
+                    error = MMath::Max(error, primitive->lods[MMath::Min<int32>(i, (int32)primitive->lods.size() - 1)].error);
+                }
+            }
+
+            float pixels = error * pixelsPerUnit;
+            if (pixels > pixelError)
+            {
+                break;
+            }
+
+            // 比当前更粗的级别需要满足更严格的阈值
+            if (i <= current || pixels <= relaxed)
+            {
+                target = i;
+            }
+        }
+
+        return target;
+    }
+
+    int32 DVKLodSelector::Update(DVKModel* model, DVKCamera& camera, const Matrix4x4& world)
+    {
+        int32 triangleCount = 0;
+
+        model->UpdateTransforms();
+
+        for (int32 i = 0; i < model->meshes.size(); ++i)
+        {
+            DVKMesh* mesh = model->meshes[i];
+
+            Matrix4x4 matrix = model->GetGlobalMatrix(mesh->linkNode);
+            matrix.Append(world);
+
+            Vector3 center = (mesh->bounding.min + mesh->bounding.max) * 0.5f;
+            float radius   = (mesh->bounding.max - mesh->bounding.min).Size() * 0.5f * matrix.GetMaximumAxisScale();
+            Vector3 worldCenter = matrix.TransformPosition(center);
+
+            float screenSize = ComputeScreenSize(camera, worldCenter, radius);
+            mesh->SetLod(SelectLod(mesh, screenSize, radius));
+
+            triangleCount += mesh->GetLodTriangleCount();
+        }
+
+        return triangleCount;
+    }
+
+}
@@ -0,0 +1,43 @@
+﻿#pragma once
+
+#include "Engine.h"
+
+#include "Common/Common.h"
+#include "Math/Math.h"
+#include "Math/Vector3.h"
+#include "Math/Matrix4x4.h"
+
+namespace vk_demo
+{
+    class DVKCamera;
+    class DVKModel;
+    struct DVKMesh;
+
+    // 按屏幕覆盖选择LOD：包围球投影到屏幕上的大小乘以LOD的相对误差得到像素误差，
+    // 选择像素误差不超过pixelError的最粗一级。变粗时需要低于pixelError * (1 - hysteresis)，避免在阈值附近来回切换。
+    class DVKLodSelector
+    {
+    public:
+
+        DVKLodSelector()
+        {
+
+        }
+
+        // 包围球投影之后的半径，相对于半个屏幕的高度，相机位于球内时返回MAX_FLT
+        static float ComputeScreenSize(DVKCamera& camera, const Vector3& center, float radius);
+
+        // 根据mesh当前的lodIndex选择新的级别，不修改mesh
+        int32 SelectLod(const DVKMesh* mesh, float screenSize, float radius) const;
+
+        // 更新模型所有Mesh的LOD，返回选择之后的三角形数量
+        int32 Update(DVKModel* model, DVKCamera& camera, const Matrix4x4& world = Matrix4x4::Identity);
+
+    public:
+
+        float   screenHeight = 1080.0f;
+        float   pixelError = 1.0f;
+        float   hysteresis = 0.25f;
+    };
+
+}
@@ -0,0 +1,615 @@
+﻿#include "DVKMeshCache.h"
+#include "DVKModel.h"
+#include "FileManager.h"
+
+#include "Common/Log.h"
+#include "Utils/Crc.h"
+
+#include <cstring>
+#include <unordered_map>
+
+#define MESH_CACHE_MAGIC    0x4D4B5644
+#define MESH_CACHE_VERSION  5
+#define MESH_CACHE_ALIGN    16
+
+namespace vk_demo
+{
+    struct MeshCacheHeader
+    {
+        uint32  magic;
+        uint32  version;
+        uint32  sourceHash;
+        uint32  sourceSize;
+        uint32  layoutHash;
+        uint32  nodeCount;
+        uint32  meshCount;
+        uint32  boneCount;
+        uint32  animCount;
+        uint32  reserved;
+        // 顶点/索引数据段，相对文件头的偏移，按MESH_CACHE_ALIGN对齐
+        uint64  blobOffset;
+        uint64  blobSize;
+    };
+
+    struct MeshCachePrimitive
+    {
+        int32   vertexCount;
+        int32   triangleNum;
+        uint32  indexCount;
+        uint32  indexSize;
+        uint64  vertexOffset;
+        uint64  vertexBytes;
+        uint64  indexOffset;
+    };
+
+    struct MeshCacheWriter
+    {
+        std::vector<uint8> data;
+
+        template <class T>
+        void Write(const T& value)
+        {
+            WriteBytes(&value, sizeof(T));
+        }
+
+        void WriteBytes(const void* bytes, uint64 size)
+        {
+            const uint8* ptr = (const uint8*)bytes;
+            data.insert(data.end(), ptr, ptr + size);
+        }
+
+        void WriteString(const std::string& str)
+        {
+            Write((uint32)str.size());
+            WriteBytes(str.data(), str.size());
+        }
+
+        template <class T>
+        void WriteArray(const std::vector<T>& values)
+        {
+            Write((uint32)values.size());
+            if (values.size() > 0)
+            {
+                WriteBytes(values.data(), values.size() * sizeof(T));
+            }
+        }
+
+        void Align(uint64 alignment)
+        {
+            uint64 size = (data.size() + alignment - 1) / alignment * alignment;
+            data.resize(size, 0);
+        }
+    };
+
+    // 所有读取都做越界检查，缓存文件损坏时返回失败
+    struct MeshCacheReader
+    {
+        const uint8*    data = nullptr;
+        uint64          size = 0;
+        uint64          pos = 0;
+        bool            failed = false;
+
+        template <class T>
+        void Read(T& value)
+        {
+            ReadBytes(&value, sizeof(T));
+        }
+
+        void ReadBytes(void* bytes, uint64 count)
+        {
+            if (failed || pos + count > size)
+            {
+                failed = true;
+                return;
+            }
+            memcpy(bytes, data + pos, count);
+            pos += count;
+        }
+
+        void ReadString(std::string& str)
+        {
+            uint32 count = 0;
+            Read(count);
+            if (failed || pos + count > size)
+            {
+                failed = true;
+                return;
+            }
+            str.assign((const char*)(data + pos), count);
+            pos += count;
+        }
+
+        template <class T>
+        void ReadArray(std::vector<T>& values)
+        {
+            uint32 count = 0;
+            Read(count);
+            if (failed || pos + (uint64)count * sizeof(T) > size)
+            {
+                failed = true;
+                return;
+            }
+            values.resize(count);
+            if (count > 0)
+            {
+                memcpy(values.data(), data + pos, count * sizeof(T));
+            }
+            pos += count * sizeof(T);
+        }
+    };
+
+    template <class ValueType>
+    static void WriteChannel(MeshCacheWriter& writer, const DVKAnimChannel<ValueType>& channel)
+    {
+        writer.WriteArray(channel.keys);
+        writer.WriteArray(channel.values);
+    }
+
+    template <class ValueType>
+    static void ReadChannel(MeshCacheReader& reader, DVKAnimChannel<ValueType>& channel)
+    {
+        reader.ReadArray(channel.keys);
+        reader.ReadArray(channel.values);
+        if (channel.keys.size() != channel.values.size())
+        {
+            reader.failed = true;
+        }
+    }
+
+    static void ResetModel(DVKModel* model)
+    {
+        // 失败时节点与Mesh尚未建立关联，逐个释放即可
+        for (int32 i = 0; i < model->linearNodes.size(); ++i)
+        {
+            delete model->linearNodes[i];
+        }
+        for (int32 i = 0; i < model->meshes.size(); ++i)
+        {
+            delete model->meshes[i];
+        }
+        for (int32 i = 0; i < model->bones.size(); ++i)
+        {
+            delete model->bones[i];
+        }
+
+        model->rootNode = nullptr;
+        model->linearNodes.clear();
+        model->meshes.clear();
+        model->nodesMap.clear();
+        model->bones.clear();
+        model->bonesMap.clear();
+        model->animations.clear();
+    }
+
+    std::string DVKMeshCache::GetCachePath(const std::string& filename, const std::vector<VertexAttribute>& attributes, uint32 importFlags)
+    {
+        // 不同的attributes布局以及导入选项使用不同的缓存文件，互不覆盖
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), ".%08x.mcache", ComputeLayoutHash(attributes, importFlags));
+        return filename + suffix;
+    }
+
+    uint32 DVKMeshCache::ComputeLayoutHash(const std::vector<VertexAttribute>& attributes, uint32 importFlags)
+    {
+        uint32 hash = Crc::MemCrc32(attributes.data(), (int32)(attributes.size() * sizeof(VertexAttribute)));
+        // MIF_MergeBuffers只影响上传方式，MIF_CompressAnimation在读取缓存之后处理，共用一份缓存
+        uint32 contentFlags = importFlags & ~(MIF_MergeBuffers | MIF_CompressAnimation);
+        hash = Crc::MemCrc32(&contentFlags, sizeof(uint32), hash);
+        uint32 version = MESH_CACHE_VERSION;
+        return Crc::MemCrc32(&version, sizeof(uint32), hash);
+    }
+
+    bool DVKMeshCache::Save(const std::string& cachePath, DVKModel* model, uint32 sourceHash, uint32 sourceSize)
+    {
+        if (model->rootNode == nullptr)
+        {
+            return false;
+        }
+
+        std::unordered_map<DVKNode*, int32> nodeIndices;
+        for (int32 i = 0; i < model->linearNodes.size(); ++i)
+        {
+            nodeIndices.insert(std::make_pair(model->linearNodes[i], i));
+        }
+
+        std::unordered_map<DVKMesh*, int32> meshIndices;
+        for (int32 i = 0; i < model->meshes.size(); ++i)
+        {
+            meshIndices.insert(std::make_pair(model->meshes[i], i));
+        }
+
+        MeshCacheHeader header;
+        memset(&header, 0, sizeof(MeshCacheHeader));
+        header.magic      = MESH_CACHE_MAGIC;
+        header.version    = MESH_CACHE_VERSION;
+        header.sourceHash = sourceHash;
+        header.sourceSize = sourceSize;
+        header.layoutHash = ComputeLayoutHash(model->attributes, model->importFlags);
+        header.nodeCount  = (uint32)model->linearNodes.size();
+        header.meshCount  = (uint32)model->meshes.size();
+        header.boneCount  = (uint32)model->bones.size();
+        header.animCount  = (uint32)model->animations.size();
+
+        MeshCacheWriter writer;
+        writer.Write(header);
+
+        // nodes，linearNodes为先序遍历，父节点总在子节点之前
+        for (int32 i = 0; i < model->linearNodes.size(); ++i)
+        {
+            DVKNode* node = model->linearNodes[i];
+            writer.WriteString(node->name);
+            writer.Write(node->parent ? nodeIndices[node->parent] : -1);
+            writer.Write(node->localMatrix);
+            writer.Write((uint32)node->meshes.size());
+            for (int32 j = 0; j < node->meshes.size(); ++j)
+            {
+                writer.Write(meshIndices[node->meshes[j]]);
+            }
+        }
+
+        // meshes，顶点/索引数据的偏移在数据段写完之后回填
+        std::vector<uint64> primitiveOffsets;
+        for (int32 i = 0; i < model->meshes.size(); ++i)
+        {
+            DVKMesh* mesh = model->meshes[i];
+            writer.WriteString(mesh->material.diffuse);
+            writer.WriteString(mesh->material.normalmap);
+            writer.WriteString(mesh->material.specular);
+            writer.WriteArray(mesh->bones);
+            writer.Write((uint8)(mesh->isSkin ? 1 : 0));
+            writer.Write(mesh->bounding.min);
+            writer.Write(mesh->bounding.max);
+            writer.Write((uint32)mesh->primitives.size());
+            for (int32 j = 0; j < mesh->primitives.size(); ++j)
+            {
+                primitiveOffsets.push_back(writer.data.size());
+                writer.Write(MeshCachePrimitive());
+                writer.WriteArray(mesh->primitives[j]->lods);
+                writer.WriteArray(mesh->primitives[j]->meshlets);
+            }
+        }
+
+        // bones
+        for (int32 i = 0; i < model->bones.size(); ++i)
+        {
+            DVKBone* bone = model->bones[i];
+            writer.WriteString(bone->name);
+            writer.Write(bone->index);
+            writer.Write(bone->parent);
+            writer.Write(bone->inverseBindPose);
+        }
+
+        // animations
+        for (int32 i = 0; i < model->animations.size(); ++i)
+        {
+            DVKAnimation& animation = model->animations[i];
+            writer.WriteString(animation.name);
+            writer.Write(animation.duration);
+            writer.Write(animation.speed);
+            writer.Write((uint32)animation.clips.size());
+            for (auto it = animation.clips.begin(); it != animation.clips.end(); ++it)
+            {
+                DVKAnimationClip& clip = it->second;
+                writer.WriteString(clip.nodeName);
+                writer.Write(clip.duration);
+                WriteChannel(writer, clip.positions);
+                WriteChannel(writer, clip.scales);
+                WriteChannel(writer, clip.rotations);
+            }
+        }
+
+        // blobs，每段都按MESH_CACHE_ALIGN对齐，映射之后可以直接作为上传源
+        writer.Align(MESH_CACHE_ALIGN);
+        uint64 blobOffset = writer.data.size();
+
+        int32 primitiveIndex = 0;
+        for (int32 i = 0; i < model->meshes.size(); ++i)
+        {
+            DVKMesh* mesh = model->meshes[i];
+            for (int32 j = 0; j < mesh->primitives.size(); ++j)
+            {
+                DVKPrimitive* primitive = mesh->primitives[j];
+
+                MeshCachePrimitive info;
+                info.vertexCount = primitive->vertexCount;
+                info.triangleNum = primitive->triangleNum;
+                info.indexCount  = (uint32)primitive->indices.size();
+                info.indexSize   = DVKIndexBuffer::GetIndexSize(primitive->indexType);
+
+                info.vertexOffset = writer.data.size() - blobOffset;
+                info.vertexBytes  = primitive->vertices.size() * sizeof(float);
+                writer.WriteBytes(primitive->vertices.data(), info.vertexBytes);
+                writer.Align(MESH_CACHE_ALIGN);
+
+                // 索引按GPU上的格式保存
+                info.indexOffset = writer.data.size() - blobOffset;
+                writer.data.resize(writer.data.size() + info.indexCount * info.indexSize);
+                DVKIndexBuffer::PackIndices(writer.data.data() + blobOffset + info.indexOffset, primitive->indices.data(), info.indexCount, primitive->indexType);
+                writer.Align(MESH_CACHE_ALIGN);
+
+                memcpy(writer.data.data() + primitiveOffsets[primitiveIndex], &info, sizeof(MeshCachePrimitive));
+                primitiveIndex += 1;
+            }
+        }
+
+        header.blobOffset = blobOffset;
+        header.blobSize   = writer.data.size() - blobOffset;
+        memcpy(writer.data.data(), &header, sizeof(MeshCacheHeader));
+
+        if (!FileManager::WriteFile(cachePath, writer.data.data(), (uint32)writer.data.size()))
+        {
+            return false;
+        }
+
+        MLOG("Mesh cache saved :%s", cachePath.c_str());
+        return true;
+    }
+
+    bool DVKMeshCache::Load(const std::string& cachePath, DVKModel* model, uint32 sourceHash, uint32 sourceSize)
+    {
+        MappedFile file;
+        if (!file.Open(cachePath) || file.GetSize() < sizeof(MeshCacheHeader))
+        {
+            return false;
+        }
+
+        MeshCacheHeader header;
+        memcpy(&header, file.GetData(), sizeof(MeshCacheHeader));
+
+        if (header.magic != MESH_CACHE_MAGIC ||
+            header.version != MESH_CACHE_VERSION ||
+            header.sourceHash != sourceHash ||
+            header.sourceSize != sourceSize ||
+            header.layoutHash != ComputeLayoutHash(model->attributes, model->importFlags) ||
+            header.blobOffset + header.blobSize != file.GetSize())
+        {
+            MLOG("Mesh cache outdated :%s", cachePath.c_str());
+            return false;
+        }
+
+        const uint8* blobs = file.GetData() + header.blobOffset;
+
+        MeshCacheReader reader;
+        reader.data = file.GetData();
+        reader.size = header.blobOffset;
+        reader.pos  = sizeof(MeshCacheHeader);
+
+        // nodes，先不建立父子及Mesh关系，全部读取成功之后再关联
+        std::vector<int32> nodeParents(header.nodeCount, -1);
+        std::vector<std::vector<int32>> nodeMeshes(header.nodeCount);
+        for (uint32 i = 0; i < header.nodeCount && !reader.failed; ++i)
+        {
+            DVKNode* node = new DVKNode();
+            model->linearNodes.push_back(node);
+
+            reader.ReadString(node->name);
+            reader.Read(nodeParents[i]);
+            reader.Read(node->localMatrix);
+
+            uint32 meshCount = 0;
+            reader.Read(meshCount);
+            for (uint32 j = 0; j < meshCount && !reader.failed; ++j)
+            {
+                int32 meshIndex = -1;
+                reader.Read(meshIndex);
+                nodeMeshes[i].push_back(meshIndex);
+            }
+        }
+
+        // meshes
+        std::vector<MeshCachePrimitive> primitiveInfos;
+        for (uint32 i = 0; i < header.meshCount && !reader.failed; ++i)
+        {
+            DVKMesh* mesh = new DVKMesh();
+            model->meshes.push_back(mesh);
+
+            uint8 isSkin = 0;
+            reader.ReadString(mesh->material.diffuse);
+            reader.ReadString(mesh->material.normalmap);
+            reader.ReadString(mesh->material.specular);
+            reader.ReadArray(mesh->bones);
+            reader.Read(isSkin);
+            reader.Read(mesh->bounding.min);
+            reader.Read(mesh->bounding.max);
+            mesh->isSkin = isSkin != 0;
+            mesh->bounding.UpdateCorners();
+
+            uint32 primitiveCount = 0;
+            reader.Read(primitiveCount);
+            for (uint32 j = 0; j < primitiveCount && !reader.failed; ++j)
+            {
+                MeshCachePrimitive info;
+                reader.Read(info);
+
+                if (info.vertexOffset + info.vertexBytes > header.blobSize ||
+                    info.indexOffset + (uint64)info.indexCount * info.indexSize > header.blobSize ||
+                    (info.indexSize != sizeof(uint16) && info.indexSize != sizeof(uint32)))
+                {
+                    reader.failed = true;
+                    break;
+                }
+
+                DVKPrimitive* primitive = new DVKPrimitive();
+                primitive->vertexCount  = info.vertexCount;
+                primitive->triangleNum  = info.triangleNum;
+                mesh->primitives.push_back(primitive);
+
+                reader.ReadArray(primitive->lods);
+                for (int32 k = 0; k < primitive->lods.size(); ++k)
+                {
+                    const DVKLodLevel& lod = primitive->lods[k];
+                    if ((uint64)lod.indexStart + lod.indexCount > info.indexCount)
+                    {
+                        reader.failed = true;
+                    }
+                }
+
+                reader.ReadArray(primitive->meshlets);
+                for (int32 k = 0; k < primitive->meshlets.size(); ++k)
+                {
+                    const DVKMeshlet& meshlet = primitive->meshlets[k];
+                    if ((uint64)meshlet.indexStart + meshlet.indexCount > info.indexCount)
+                    {
+                        reader.failed = true;
+                    }
+                }
+                primitiveInfos.push_back(info);
+
+                mesh->vertexCount   += info.vertexCount;
+                mesh->triangleCount += info.triangleNum;
+            }
+        }
+
+        // bones
+        for (uint32 i = 0; i < header.boneCount && !reader.failed; ++i)
+        {
+            DVKBone* bone = new DVKBone();
+            model->bones.push_back(bone);
+
+            reader.ReadString(bone->name);
+            reader.Read(bone->index);
+            reader.Read(bone->parent);
+            reader.Read(bone->inverseBindPose);
+        }
+
+        // animations
+        model->animations.resize(reader.failed ? 0 : header.animCount);
+        for (uint32 i = 0; i < model->animations.size() && !reader.failed; ++i)
+        {
+            DVKAnimation& animation = model->animations[i];
+            reader.ReadString(animation.name);
+            reader.Read(animation.duration);
+            reader.Read(animation.speed);
+
+            uint32 clipCount = 0;
+            reader.Read(clipCount);
+            for (uint32 j = 0; j < clipCount && !reader.failed; ++j)
+            {
+                DVKAnimationClip clip;
+                reader.ReadString(clip.nodeName);
+                reader.Read(clip.duration);
+                ReadChannel(reader, clip.positions);
+                ReadChannel(reader, clip.scales);
+                ReadChannel(reader, clip.rotations);
+                animation.clips.insert(std::make_pair(clip.nodeName, clip));
+            }
+        }
+
+        // 校验索引范围
+        for (uint32 i = 0; i < header.nodeCount && !reader.failed; ++i)
+        {
+            if (nodeParents[i] >= (int32)i || (i == 0) != (nodeParents[i] < 0))
+            {
+                reader.failed = true;
+            }
+            for (int32 j = 0; j < nodeMeshes[i].size(); ++j)
+            {
+                if (nodeMeshes[i][j] < 0 || nodeMeshes[i][j] >= (int32)header.meshCount)
+                {
+                    reader.failed = true;
+                }
+            }
+        }
+
+        if (reader.failed || header.nodeCount == 0)
+        {
+            MLOGE("Mesh cache corrupted :%s", cachePath.c_str());
+            ResetModel(model);
+            return false;
+        }
+
+        // 建立节点层级以及Mesh关联
+        for (uint32 i = 0; i < header.nodeCount; ++i)
+        {
+            DVKNode* node = model->linearNodes[i];
+            if (nodeParents[i] >= 0)
+            {
+                node->parent = model->linearNodes[nodeParents[i]];
+                node->parent->children.push_back(node);
+            }
+            for (int32 j = 0; j < nodeMeshes[i].size(); ++j)
+            {
+                DVKMesh* mesh = model->meshes[nodeMeshes[i][j]];
+                mesh->linkNode = node;
+                node->meshes.push_back(mesh);
+            }
+            model->nodesMap.insert(std::make_pair(node->name, node));
+        }
+        model->rootNode = model->linearNodes[0];
+
+        for (int32 i = 0; i < model->bones.size(); ++i)
+        {
+            model->bonesMap.insert(std::make_pair(model->bones[i]->name, model->bones[i]));
+        }
+
+        // 顶点/索引数据从映射内存直接拷贝，不做任何解析
+        DVKBuffer* staging = nullptr;
+        bool merged = (model->importFlags & MIF_MergeBuffers) != 0;
+        if (model->cmdBuffer && header.blobSize > 0 && !merged)
+        {
+            // 整个数据段一次拷贝进Staging，各Primitive按偏移拷贝到自己的Buffer
+            staging = DVKBuffer::CreateBuffer(
+                model->device,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                header.blobSize,
+                (void*)blobs
+            );
+            model->cmdBuffer->Begin();
+        }
+
+        int32 primitiveIndex = 0;
+        for (int32 i = 0; i < model->meshes.size(); ++i)
+        {
+            DVKMesh* mesh = model->meshes[i];
+            for (int32 j = 0; j < mesh->primitives.size(); ++j)
+            {
+                DVKPrimitive* primitive = mesh->primitives[j];
+                const MeshCachePrimitive& info = primitiveInfos[primitiveIndex++];
+
+                const float* vertexData = (const float*)(blobs + info.vertexOffset);
+                const uint8* indexData  = blobs + info.indexOffset;
+                VkIndexType  indexType  = info.indexSize == sizeof(uint16) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+
+                primitive->vertices.assign(vertexData, vertexData + info.vertexBytes / sizeof(float));
+                primitive->indexType = indexType;
+                if (indexType == VK_INDEX_TYPE_UINT16)
+                {
+                    primitive->indices.assign((const uint16*)indexData, (const uint16*)indexData + info.indexCount);
+                }
+                else
+                {
+                    primitive->indices.assign((const uint32*)indexData, (const uint32*)indexData + info.indexCount);
+                }
+
+                if (staging)
+                {
+                    if (info.vertexBytes > 0)
+                    {
+                        primitive->vertexBuffer = DVKVertexBuffer::Create(model->device, model->cmdBuffer, staging, info.vertexOffset, info.vertexBytes, model->attributes);
+                    }
+                    if (info.indexCount > 0)
+                    {
+                        primitive->indexBuffer = DVKIndexBuffer::Create(model->device, model->cmdBuffer, staging, info.indexOffset, info.indexCount, indexType);
+                    }
+                }
+            }
+        }
+
+        if (staging)
+        {
+            model->cmdBuffer->End();
+            model->cmdBuffer->Submit();
+            delete staging;
+        }
+
+        // 共用Buffer需要重新拼接，按解析出的数据上传
+        if (model->cmdBuffer && merged)
+        {
+            model->UploadPrimitives();
+        }
+
+        return true;
+    }
+
+}
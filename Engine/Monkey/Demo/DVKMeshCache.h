@@ -0,0 +1,33 @@
+﻿#pragma once
+
+#include "Engine.h"
+
+#include "Common/Common.h"
+#include "Vulkan/VulkanCommon.h"
+
+#include <string>
+#include <vector>
+
+namespace vk_demo
+{
+    class DVKModel;
+
+    // 模型的二进制缓存：节点层级、Mesh、骨骼、动画以及按attributes排布好的顶点/索引数据。
+    // 首次导入之后写入，之后通过内存映射读取，顶点/索引数据直接拷贝进Staging。
+    // 源文件的CRC、大小、attributes布局或者导入选项不一致时缓存失效。
+    class DVKMeshCache
+    {
+    public:
+
+        static std::string GetCachePath(const std::string& filename, const std::vector<VertexAttribute>& attributes, uint32 importFlags);
+
+        static uint32 ComputeLayoutHash(const std::vector<VertexAttribute>& attributes, uint32 importFlags);
+
+        // model必须是刚导入的完整模型
+        static bool Save(const std::string& cachePath, DVKModel* model, uint32 sourceHash, uint32 sourceSize);
+
+        // model必须是空模型，只设置了device、attributes以及cmdBuffer，失败时保持为空
+        static bool Load(const std::string& cachePath, DVKModel* model, uint32 sourceHash, uint32 sourceSize);
+    };
+
+}
@@ -0,0 +1,226 @@
+﻿#include "DVKMeshOptimizer.h"
+#include "DVKModel.h"
+
+#include "meshoptimizer.h"
+
+#include <cstring>
+
+// 模拟的Post-Transform Cache大小
+#define MESH_OPTIMIZE_CACHE_SIZE            16
+// Overdraw优化允许ACMR变差的比例
+#define MESH_OPTIMIZE_OVERDRAW_THRESHOLD    1.05f
+// meshoptimizer支持的最大顶点字节数
+#define MESH_OPTIMIZE_MAX_VERTEX_SIZE       256
+// 每一级LOD至多保留上一级的索引比例，减面不明显时跳过该级
+#define MESH_LOD_MAX_RATIO                  0.75f
+// 三角形少于该数量时不再继续简化
+#define MESH_LOD_MIN_TRIANGLES              32
+// 每个Meshlet的顶点与三角形上限，不能超过meshopt_Meshlet的静态大小
+#define MESH_MESHLET_MAX_VERTICES           64
+#define MESH_MESHLET_MAX_TRIANGLES          124
+
+namespace vk_demo
+{
+    // 相对网格包围盒最大边长的误差阶梯
+    static const float MeshLodErrors[] = { 0.0025f, 0.005f, 0.01f, 0.02f, 0.04f, 0.08f, 0.16f };
+
+    uint32 DVKMeshOptimizer::AnalyzeVertexCache(const std::vector<uint32>& indices, int32 vertexCount)
+    {
+        meshopt_VertexCacheStatistics statistics = meshopt_analyzeVertexCache(indices.data(), indices.size(), vertexCount, MESH_OPTIMIZE_CACHE_SIZE, 0, 0);
+        return statistics.vertices_transformed;
+    }
+
+    void DVKMeshOptimizer::ExtractPositions(const std::vector<float>& vertices, int32 vertexCount, int32 vertexStride, const DVKVertexPosition& position, std::vector<float>& outPositions)
+    {
+        outPositions.resize(vertexCount * 3);
+
+        const float* src = vertices.data() + position.offset;
+        float* dst = outPositions.data();
+        for (int32 i = 0; i < vertexCount; ++i)
+        {
+            if (position.quantized)
+            {
+                uint16 packed[3];
+                memcpy(packed, src, sizeof(packed));
+                dst[0] = position.min.x + packed[0] * position.scale.x;
+                dst[1] = position.min.y + packed[1] * position.scale.y;
+                dst[2] = position.min.z + packed[2] * position.scale.z;
+            }
+            else
+            {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+            }
+            src += vertexStride;
+            dst += 3;
+        }
+    }
+
+    void DVKMeshOptimizer::Optimize(DVKPrimitive* primitive, int32 vertexStride, const DVKVertexPosition& position, DVKMeshOptimizeStats& stats)
+    {
+        std::vector<uint32>& indices = primitive->indices;
+        size_t vertexSize  = vertexStride * sizeof(float);
+        size_t vertexCount = primitive->vertexCount;
+
+        if (indices.size() == 0 || vertexCount == 0 || vertexSize == 0 || vertexSize > MESH_OPTIMIZE_MAX_VERTEX_SIZE)
+        {
+            return;
+        }
+
+        stats.triangleNum       += (uint32)(indices.size() / 3);
+        stats.vertexCountBefore += (uint32)vertexCount;
+        stats.transformedBefore += AnalyzeVertexCache(indices, (int32)vertexCount);
+
+        // 二进制完全相同的顶点合并，未被引用的顶点被丢弃
+        std::vector<uint32> remap(vertexCount);
+        size_t uniqueCount = meshopt_generateVertexRemap(remap.data(), indices.data(), indices.size(), primitive->vertices.data(), vertexCount, vertexSize);
+        meshopt_remapIndexBuffer(indices.data(), indices.data(), indices.size(), remap.data());
+
+        std::vector<float> vertices(uniqueCount * vertexStride);
+        meshopt_remapVertexBuffer(vertices.data(), primitive->vertices.data(), vertexCount, vertexSize, remap.data());
+
+        // 先按VertexCache排序，再在阈值内按Overdraw调整三角形簇的顺序
+        meshopt_optimizeVertexCache(indices.data(), indices.data(), indices.size(), uniqueCount);
+        if (position.IsValid())
+        {
+            std::vector<float> positions;
+            ExtractPositions(vertices, (int32)uniqueCount, vertexStride, position, positions);
+            meshopt_optimizeOverdraw(indices.data(), indices.data(), indices.size(), positions.data(), uniqueCount, sizeof(float) * 3, MESH_OPTIMIZE_OVERDRAW_THRESHOLD);
+        }
+
+        // 顶点按首次被引用的顺序重排
+        size_t fetchCount = meshopt_optimizeVertexFetch(vertices.data(), indices.data(), indices.size(), vertices.data(), uniqueCount, vertexSize);
+        vertices.resize(fetchCount * vertexStride);
+
+        primitive->vertices.swap(vertices);
+        primitive->vertexCount = (int32)fetchCount;
+        primitive->indexType   = DVKIndexBuffer::GetIndexType(primitive->vertexCount);
+
+        stats.vertexCountAfter += (uint32)fetchCount;
+        stats.transformedAfter += AnalyzeVertexCache(indices, primitive->vertexCount);
+    }
+
+    void DVKMeshOptimizer::BuildMeshlets(DVKPrimitive* primitive, int32 vertexStride, const DVKVertexPosition& position)
+    {
+        std::vector<uint32>& indices = primitive->indices;
+        size_t vertexCount = primitive->vertexCount;
+        size_t baseCount   = primitive->lods.size() > 0 ? primitive->lods[0].indexCount : indices.size();
+
+        primitive->meshlets.clear();
+
+        if (baseCount == 0 || vertexCount == 0 || !position.IsValid())
+        {
+            return;
+        }
+
+        std::vector<float> positions;
+        ExtractPositions(primitive->vertices, (int32)vertexCount, vertexStride, position, positions);
+
+        std::vector<meshopt_Meshlet> meshlets(meshopt_buildMeshletsBound(baseCount, MESH_MESHLET_MAX_VERTICES, MESH_MESHLET_MAX_TRIANGLES));
+        meshlets.resize(meshopt_buildMeshlets(meshlets.data(), indices.data(), baseCount, vertexCount, MESH_MESHLET_MAX_VERTICES, MESH_MESHLET_MAX_TRIANGLES));
+
+        // Meshlet内的局部索引展开为全局索引，依次写回LOD0的范围
+        uint32 indexStart = 0;
+        primitive->meshlets.resize(meshlets.size());
+        for (size_t i = 0; i < meshlets.size(); ++i)
+        {
+            const meshopt_Meshlet& meshlet = meshlets[i];
+            for (uint32 j = 0; j < meshlet.triangle_count; ++j)
+            {
+                indices[indexStart + j * 3 + 0] = meshlet.vertices[meshlet.indices[j][0]];
+                indices[indexStart + j * 3 + 1] = meshlet.vertices[meshlet.indices[j][1]];
+                indices[indexStart + j * 3 + 2] = meshlet.vertices[meshlet.indices[j][2]];
+            }
+
+            meshopt_Bounds bounds = meshopt_computeMeshletBounds(&meshlet, positions.data(), vertexCount, sizeof(float) * 3);
+
+            DVKMeshlet& dst = primitive->meshlets[i];
+            dst.center.Set(bounds.center[0], bounds.center[1], bounds.center[2]);
+            dst.radius = bounds.radius;
+            dst.coneApex.Set(bounds.cone_apex[0], bounds.cone_apex[1], bounds.cone_apex[2]);
+            dst.coneAxis.Set(bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2]);
+            dst.coneCutoff = bounds.cone_cutoff;
+            dst.indexStart = indexStart;
+            dst.indexCount = meshlet.triangle_count * 3;
+
+            indexStart += dst.indexCount;
+        }
+    }
+
+    void DVKMeshOptimizer::GenerateLods(DVKPrimitive* primitive, int32 vertexStride, const DVKVertexPosition& position)
+    {
+        std::vector<uint32>& indices = primitive->indices;
+        size_t vertexSize  = vertexStride * sizeof(float);
+        size_t vertexCount = primitive->vertexCount;
+        size_t baseCount   = indices.size();
+
+        primitive->lods.clear();
+        primitive->lodIndex = 0;
+
+        if (baseCount == 0 || vertexCount == 0 || !position.IsValid() || vertexSize > MESH_OPTIMIZE_MAX_VERTEX_SIZE)
+        {
+            return;
+        }
+
+        // meshopt_simplify的误差相对于包围盒最大边长
+        std::vector<float> positions;
+        ExtractPositions(primitive->vertices, (int32)vertexCount, vertexStride, position, positions);
+
+        Vector3 mmin( MAX_FLT,  MAX_FLT,  MAX_FLT);
+        Vector3 mmax(-MAX_FLT, -MAX_FLT, -MAX_FLT);
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            const float* p = positions.data() + i * 3;
+            mmin.Set(MMath::Min(mmin.x, p[0]), MMath::Min(mmin.y, p[1]), MMath::Min(mmin.z, p[2]));
+            mmax.Set(MMath::Max(mmax.x, p[0]), MMath::Max(mmax.y, p[1]), MMath::Max(mmax.z, p[2]));
+        }
+        float extent = (mmax - mmin).GetMax();
+
+        DVKLodLevel baseLevel;
+        baseLevel.indexStart = 0;
+        baseLevel.indexCount = (uint32)baseCount;
+        baseLevel.error      = 0.0f;
+        primitive->lods.push_back(baseLevel);
+
+        // 每一级都从原始网格简化，误差不会逐级累积
+        std::vector<uint32> lodIndices(baseCount);
+        size_t lastCount = baseCount;
+        for (int32 i = 0; i < sizeof(MeshLodErrors) / sizeof(MeshLodErrors[0]); ++i)
+        {
+            if (lastCount / 3 <= MESH_LOD_MIN_TRIANGLES)
+            {
+                break;
+            }
+
+            size_t count = meshopt_simplify(lodIndices.data(), indices.data(), baseCount, positions.data(), vertexCount, sizeof(float) * 3, 0, MeshLodErrors[i]);
+            if (count == 0)
+            {
+                break;
+            }
+
+            if (count > lastCount * MESH_LOD_MAX_RATIO)
+            {
+                continue;
+            }
+
+            meshopt_optimizeVertexCache(lodIndices.data(), lodIndices.data(), count, vertexCount);
+
+            DVKLodLevel level;
+            level.indexStart = (uint32)indices.size();
+            level.indexCount = (uint32)count;
+            level.error      = MeshLodErrors[i] * extent;
+            primitive->lods.push_back(level);
+
+            indices.insert(indices.end(), lodIndices.begin(), lodIndices.begin() + count);
+            lastCount = count;
+        }
+
+        // 无法简化时不保留LOD
+        if (primitive->lods.size() == 1)
+        {
+            primitive->lods.clear();
+        }
+    }
+
+}
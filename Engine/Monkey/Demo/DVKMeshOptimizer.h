@@ -0,0 +1,91 @@
+﻿#pragma once
+
+#include "Engine.h"
+
+#include "Common/Common.h"
+#include "Math/Math.h"
+#include "Math/Vector3.h"
+
+#include <vector>
+
+namespace vk_demo
+{
+    struct DVKPrimitive;
+
+    // 优化前后的顶点缓存统计，基于meshoptimizer的FIFO模型
+    struct DVKMeshOptimizeStats
+    {
+        uint32  triangleNum = 0;
+        uint32  vertexCountBefore = 0;
+        uint32  vertexCountAfter = 0;
+        uint32  transformedBefore = 0;
+        uint32  transformedAfter = 0;
+
+        void Add(const DVKMeshOptimizeStats& other)
+        {
+            triangleNum       += other.triangleNum;
+            vertexCountBefore += other.vertexCountBefore;
+            vertexCountAfter  += other.vertexCountAfter;
+            transformedBefore += other.transformedBefore;
+            transformedAfter  += other.transformedAfter;
+        }
+
+        // Average Cache Miss Ratio：每个三角形需要变换的顶点数，0.5~3.0
+        FORCE_INLINE float GetACMRBefore() const
+        {
+            return triangleNum > 0 ? (float)transformedBefore / triangleNum : 0.0f;
+        }
+
+        FORCE_INLINE float GetACMRAfter() const
+        {
+            return triangleNum > 0 ? (float)transformedAfter / triangleNum : 0.0f;
+        }
+
+        // Average Transformed Vertex Ratio：每个顶点被变换的次数，最优为1.0
+        FORCE_INLINE float GetATVRBefore() const
+        {
+            return vertexCountBefore > 0 ? (float)transformedBefore / vertexCountBefore : 0.0f;
+        }
+
+        FORCE_INLINE float GetATVRAfter() const
+        {
+            return vertexCountAfter > 0 ? (float)transformedAfter / vertexCountAfter : 0.0f;
+        }
+    };
+
+    // 顶点中Position的位置，offset以float为单位，小于0表示没有Position。
+    // 量化的Position(VA_PositionQ)按 min + q * scale 还原。
+    struct DVKVertexPosition
+    {
+        int32   offset = -1;
+        bool    quantized = false;
+        Vector3 min = Vector3(0.0f, 0.0f, 0.0f);
+        Vector3 scale = Vector3(1.0f, 1.0f, 1.0f);
+
+        FORCE_INLINE bool IsValid() const
+        {
+            return offset >= 0;
+        }
+    };
+
+    // 导入时的Mesh优化：顶点去重、VertexCache、Overdraw以及VertexFetch顺序优化，以及LOD生成。
+    class DVKMeshOptimizer
+    {
+    public:
+
+        // vertexStride以float为单位，没有Position时跳过Overdraw优化
+        static void Optimize(DVKPrimitive* primitive, int32 vertexStride, const DVKVertexPosition& position, DVKMeshOptimizeStats& stats);
+
+        // 按误差阶梯从原始网格简化出LOD链，追加在indices之后，lods[0]为原始网格。需要先经过Optimize去重。
+        static void GenerateLods(DVKPrimitive* primitive, int32 vertexStride, const DVKVertexPosition& position);
+
+        // 将LOD0的三角形按Meshlet重新排列并计算包围球与法线锥，三角形集合不变。需要先经过Optimize。
+        static void BuildMeshlets(DVKPrimitive* primitive, int32 vertexStride, const DVKVertexPosition& position);
+
+        // 取出(量化时还原)紧密排列的xyz
+        static void ExtractPositions(const std::vector<float>& vertices, int32 vertexCount, int32 vertexStride, const DVKVertexPosition& position, std::vector<float>& outPositions);
+
+        static uint32 AnalyzeVertexCache(const std::vector<uint32>& indices, int32 vertexCount);
+    };
+
+}
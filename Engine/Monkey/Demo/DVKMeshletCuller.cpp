@@ -0,0 +1,248 @@
+﻿#include "DVKMeshletCuller.h"
+#include "DVKModel.h"
+#include "DVKCamera.h"
+
+#include "Vulkan/VulkanDevice.h"
+
+// 与MeshletCull.comp的local_size_x一致
+#define MESHLET_CULL_GROUP_SIZE     64
+// vkCmdUpdateBuffer单次最多写入的字节数
+#define MESHLET_UPDATE_MAX_SIZE     65536
+
+namespace vk_demo
+{
+
+    DVKMeshletCuller::~DVKMeshletCuller()
+    {
+        delete compute;
+        delete meshletBuffer;
+        delete transformBuffer;
+        delete countBuffer;
+        delete indirectBuffer;
+
+        compute         = nullptr;
+        meshletBuffer   = nullptr;
+        transformBuffer = nullptr;
+        countBuffer     = nullptr;
+        indirectBuffer  = nullptr;
+
+        ranges.clear();
+        transforms.clear();
+
+        model        = nullptr;
+        vulkanDevice = nullptr;
+    }
+
+    DVKMeshletCuller* DVKMeshletCuller::Create(std::shared_ptr<VulkanDevice> vulkanDevice, VkPipelineCache pipelineCache, DVKShader* shader, DVKModel* model, DVKCommandBuffer* cmdBuffer)
+    {
+        DVKMeshletCuller* culler = new DVKMeshletCuller();
+        culler->vulkanDevice = vulkanDevice;
+        culler->model        = model;
+
+        culler->PrepareBuffers(cmdBuffer);
+        if (culler->meshletCount == 0)
+        {
+            MLOGE("Model has no meshlets, import it with MIF_BuildMeshlets.");
+            return culler;
+        }
+
+        culler->compute = DVKCompute::Create(vulkanDevice, pipelineCache, shader);
+        culler->compute->SetStorageBuffer("inMeshlets", culler->meshletBuffer);
+        culler->compute->SetStorageBuffer("inTransforms", culler->transformBuffer);
+        culler->compute->SetStorageBuffer("outCounts", culler->countBuffer);
+        culler->compute->SetStorageBuffer("outCommands", culler->indirectBuffer);
+
+        return culler;
+    }
+
+    void DVKMeshletCuller::PrepareBuffers(DVKCommandBuffer* cmdBuffer)
+    {
+        std::vector<GPUMeshlet> meshlets;
+        uint32 primitiveCount = 0;
+
+        for (int32 i = 0; i < model->meshes.size(); ++i)
+        {
+            DVKMesh* mesh = model->meshes[i];
+            for (int32 j = 0; j < mesh->primitives.size(); ++j)
+            {
+                DVKPrimitive* primitive = mesh->primitives[j];
+                if (primitive->meshlets.size() == 0 || primitive->indexBuffer == nullptr)
+                {
+                    continue;
+                }
+
+                DrawRange range;
+                range.primitive  = primitive;
+                range.drawOffset = (uint32)meshlets.size();
+                range.drawCount  = (uint32)primitive->meshlets.size();
+                ranges.push_back(range);
+
+                for (int32 k = 0; k < primitive->meshlets.size(); ++k)
+                {
+                    const DVKMeshlet& src = primitive->meshlets[k];
+
+                    GPUMeshlet dst;
+                    memset(&dst, 0, sizeof(GPUMeshlet));
+                    dst.sphere          = Vector4(src.center, src.radius);
+                    dst.coneApex        = Vector4(src.coneApex, 1.0f);
+                    dst.coneAxis        = Vector4(src.coneAxis, src.coneCutoff);
+                    dst.indexStart      = src.indexStart + primitive->firstIndex;
+                    dst.indexCount      = src.indexCount;
+                    dst.meshIndex       = i;
+                    dst.primitiveIndex  = primitiveCount;
+                    dst.drawOffset      = range.drawOffset;
+                    dst.vertexOffset    = primitive->vertexOffset;
+                    meshlets.push_back(dst);
+                }
+
+                primitiveCount += 1;
+            }
+        }
+
+        meshletCount = (uint32)meshlets.size();
+        if (meshletCount == 0)
+        {
+            return;
+        }
+
+        transforms.resize(model->meshes.size());
+
+        VkDeviceSize dataSize = meshlets.size() * sizeof(GPUMeshlet);
+        DVKBuffer* stagingBuffer = DVKBuffer::CreateBuffer(
+            vulkanDevice,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            dataSize,
+            meshlets.data()
+        );
+
+        meshletBuffer = DVKBuffer::CreateBuffer(
+            vulkanDevice,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            dataSize
+        );
+
+        transformBuffer = DVKBuffer::CreateBuffer(
+            vulkanDevice,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            transforms.size() * sizeof(Matrix4x4)
+        );
+
+        // 可见数量可以回读到CPU用于统计
+        countBuffer = DVKBuffer::CreateBuffer(
+            vulkanDevice,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            primitiveCount * sizeof(uint32)
+        );
+
+        // 每个Meshlet预留一个间接命令，可见的Meshlet紧凑地排在各自区间的前面
+        indirectBuffer = DVKBuffer::CreateBuffer(
+            vulkanDevice,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            meshletCount * sizeof(VkDrawIndexedIndirectCommand)
+        );
+
+        cmdBuffer->Begin();
+
+        VkBufferCopy copyRegion = {};
+        copyRegion.size = dataSize;
+        vkCmdCopyBuffer(cmdBuffer->cmdBuffer, stagingBuffer->buffer, meshletBuffer->buffer, 1, &copyRegion);
+
+        cmdBuffer->End();
+        cmdBuffer->Submit();
+
+        delete stagingBuffer;
+    }
+
+    void DVKMeshletCuller::Cull(VkCommandBuffer commandBuffer, DVKCamera& camera, const Matrix4x4& world)
+    {
+        if (meshletCount == 0)
+        {
+            return;
+        }
+
+        model->UpdateTransforms();
+
+        for (int32 i = 0; i < model->meshes.size(); ++i)
+        {
+            DVKMesh* mesh = model->meshes[i];
+            transforms[i] = mesh->linkNode ? model->GetGlobalMatrix(mesh->linkNode) : Matrix4x4::Identity;
+            transforms[i].Append(world);
+        }
+
+        CullParam param;
+        camera.GetFrustum().GetPlanes(param.planes);
+        param.cameraPos = Vector4(camera.GetTransform().GetOrigin(), 1.0f);
+        param.meshletCount[0] = meshletCount;
+        param.meshletCount[1] = 0;
+        param.meshletCount[2] = 0;
+        param.meshletCount[3] = 0;
+        compute->SetUniform("param", &param, sizeof(CullParam));
+
+        // 上一帧的间接绘制、剔除以及计数回读完成之后才能清空
+        VkMemoryBarrier memoryBarrier;
+        ZeroVulkanStruct(memoryBarrier, VK_STRUCTURE_TYPE_MEMORY_BARRIER);
+        memoryBarrier.srcAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+        // 变换随命令缓冲一起提交，不需要区分飞行中的帧
+        const uint8* transformData = (const uint8*)transforms.data();
+        VkDeviceSize transformSize = transforms.size() * sizeof(Matrix4x4);
+        for (VkDeviceSize offset = 0; offset < transformSize; offset += MESHLET_UPDATE_MAX_SIZE)
+        {
+            VkDeviceSize size = MMath::Min<VkDeviceSize>(transformSize - offset, MESHLET_UPDATE_MAX_SIZE);
+            vkCmdUpdateBuffer(commandBuffer, transformBuffer->buffer, offset, size, transformData + offset);
+        }
+
+        vkCmdFillBuffer(commandBuffer, countBuffer->buffer, 0, VK_WHOLE_SIZE, 0);
+        vkCmdFillBuffer(commandBuffer, indirectBuffer->buffer, 0, VK_WHOLE_SIZE, 0);
+
+        memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+        compute->BindDispatch(commandBuffer, (meshletCount + MESHLET_CULL_GROUP_SIZE - 1) / MESHLET_CULL_GROUP_SIZE, 1, 1);
+
+        memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+    }
+
+    void DVKMeshletCuller::Draw(VkCommandBuffer commandBuffer)
+    {
+        uint32 stride = sizeof(VkDrawIndexedIndirectCommand);
+        bool multiDraw = vulkanDevice->GetPhysicalFeatures().multiDrawIndirect;
+
+        // 各Primitive的区间首尾相连，共用Buffer时可以一次绘制
+        if (model->IsMerged() && multiDraw)
+        {
+            model->BindBuffers(commandBuffer);
+            vkCmdDrawIndexedIndirect(commandBuffer, indirectBuffer->buffer, 0, meshletCount, stride);
+            return;
+        }
+
+        for (int32 i = 0; i < ranges.size(); ++i)
+        {
+            const DrawRange& range = ranges[i];
+            range.primitive->BindOnly(commandBuffer);
+
+            if (multiDraw)
+            {
+                vkCmdDrawIndexedIndirect(commandBuffer, indirectBuffer->buffer, range.drawOffset * stride, range.drawCount, stride);
+            }
+            else
+            {
+                for (uint32 j = 0; j < range.drawCount; ++j)
+                {
+                    vkCmdDrawIndexedIndirect(commandBuffer, indirectBuffer->buffer, (range.drawOffset + j) * stride, 1, stride);
+                }
+            }
+        }
+    }
+
+}
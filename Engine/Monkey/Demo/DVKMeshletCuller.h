@@ -0,0 +1,108 @@
+﻿#pragma once
+
+#include "Engine.h"
+#include "DVKBuffer.h"
+#include "DVKShader.h"
+#include "DVKCompute.h"
+#include "DVKCommand.h"
+
+#include "Common/Common.h"
+#include "Math/Math.h"
+#include "Math/Vector3.h"
+#include "Math/Vector4.h"
+#include "Math/Matrix4x4.h"
+#include "Vulkan/VulkanCommon.h"
+
+#include <vector>
+#include <memory>
+
+namespace vk_demo
+{
+    class DVKCamera;
+    class DVKModel;
+    struct DVKPrimitive;
+
+    // GPU上逐Meshlet剔除：计算着色器用视锥与法线锥测试每个Meshlet，
+    // 可见的Meshlet紧凑地写入各Primitive的VkDrawIndexedIndirectCommand区间。
+    // 模型需要以MIF_BuildMeshlets导入。Cull需要在RenderPass之外录制，Draw在RenderPass之内录制。
+    class DVKMeshletCuller
+    {
+    private:
+
+        // 与MeshletCull.comp中的Meshlet一致，std430
+        struct GPUMeshlet
+        {
+            Vector4 sphere;
+            Vector4 coneApex;
+            // w为coneCutoff
+            Vector4 coneAxis;
+            uint32  indexStart;
+            uint32  indexCount;
+            uint32  meshIndex;
+            uint32  primitiveIndex;
+            // 所属Primitive在间接命令中的起始位置
+            uint32  drawOffset;
+            int32   vertexOffset;
+            uint32  padding[2];
+        };
+
+        struct CullParam
+        {
+            Vector4 planes[6];
+            Vector4 cameraPos;
+            uint32  meshletCount[4];
+        };
+
+        struct DrawRange
+        {
+            DVKPrimitive*   primitive = nullptr;
+            uint32          drawOffset = 0;
+            uint32          drawCount = 0;
+        };
+
+        DVKMeshletCuller()
+        {
+
+        }
+
+    public:
+
+        ~DVKMeshletCuller();
+
+        static DVKMeshletCuller* Create(std::shared_ptr<VulkanDevice> vulkanDevice, VkPipelineCache pipelineCache, DVKShader* shader, DVKModel* model, DVKCommandBuffer* cmdBuffer);
+
+        // 清空上一帧的间接命令，上传变换并剔除
+        void Cull(VkCommandBuffer commandBuffer, DVKCamera& camera, const Matrix4x4& world = Matrix4x4::Identity);
+
+        // 外部绑定Pipeline与DescriptorSet之后调用，未被写入的间接命令instanceCount为0。
+        // 模型共用Buffer(MIF_MergeBuffers)时所有Primitive合并为一次间接绘制
+        void Draw(VkCommandBuffer commandBuffer);
+
+        FORCE_INLINE uint32 GetMeshletCount() const
+        {
+            return meshletCount;
+        }
+
+    private:
+
+        void PrepareBuffers(DVKCommandBuffer* cmdBuffer);
+
+    public:
+
+        std::shared_ptr<VulkanDevice>   vulkanDevice = nullptr;
+        DVKModel*                       model = nullptr;
+        DVKCompute*                     compute = nullptr;
+
+        DVKBuffer*                      meshletBuffer = nullptr;
+        DVKBuffer*                      transformBuffer = nullptr;
+        DVKBuffer*                      countBuffer = nullptr;
+        DVKBuffer*                      indirectBuffer = nullptr;
+
+    private:
+
+        std::vector<DrawRange>          ranges;
+        std::vector<Matrix4x4>          transforms;
+        uint32                          meshletCount = 0;
+    };
+
+}
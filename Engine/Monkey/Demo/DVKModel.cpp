@@ -1,13 +1,22 @@
 ﻿#include "DVKModel.h"
+#include "DVKMeshCache.h"
+#include "DVKGLTFLoader.h"
 
 #include "FileManager.h"
 #include "Math/Matrix4x4.h"
+#include "Math/VectorRegister.h"
+#include "Utils/Crc.h"
+
+#include "meshoptimizer.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <assimp/cimport.h>
 
+#include <thread>
+#include <atomic>
+
 namespace vk_demo
 {
     void SimplifyTexturePath(std::string& path)
@@ -88,8 +97,9 @@ namespace vk_demo
 
         DVKPrimitive* primitive = new DVKPrimitive();
         primitive->vertices     = vertices;
-        primitive->indices      = indices;
+        primitive->indices.assign(indices.begin(), indices.end());
         primitive->vertexCount  = (int32)vertices.size() / stride * 4;
+        primitive->indexType    = VK_INDEX_TYPE_UINT16;
 
         if (cmdBuffer)
         {
@@ -99,7 +109,7 @@ namespace vk_demo
             }
             if (indices.size() > 0)
             {
-                primitive->indexBuffer = DVKIndexBuffer::Create(vulkanDevice, cmdBuffer, primitive->indices);
+                primitive->indexBuffer = DVKIndexBuffer::Create(vulkanDevice, cmdBuffer, indices);
             }
         }
 
@@ -116,30 +126,32 @@ namespace vk_demo
 
         model->rootNode = rootNode;
         model->meshes.push_back(mesh);
+        model->LinkTransforms();
 
         return model;
     }
 
-    DVKModel* DVKModel::LoadFromFile(const std::string& filename, std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, const std::vector<VertexAttribute>& attributes)
+    DVKModel* DVKModel::LoadFromFile(const std::string& filename, std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, const std::vector<VertexAttribute>& attributes, uint32 importFlags)
     {
-        DVKModel* model   = new DVKModel();
-        model->device     = vulkanDevice;
-        model->attributes = attributes;
-        model->cmdBuffer  = cmdBuffer;
+        DVKModel* model    = new DVKModel();
+        model->device      = vulkanDevice;
+        model->attributes  = attributes;
+        model->cmdBuffer   = cmdBuffer;
+        model->importFlags = importFlags;
 
         int assimpFlags = aiProcess_Triangulate | aiProcess_FlipUVs;
 
         for (int32 i = 0; i < attributes.size(); ++i)
         {
-            if (attributes[i] == VertexAttribute::VA_Tangent)
+            if (attributes[i] == VertexAttribute::VA_Tangent || attributes[i] == VertexAttribute::VA_TangentSN16)
             {
                 assimpFlags = assimpFlags | aiProcess_CalcTangentSpace;
             }
-            else if (attributes[i] == VertexAttribute::VA_UV0)
+            else if (attributes[i] == VertexAttribute::VA_UV0 || attributes[i] == VertexAttribute::VA_UV0Half)
             {
                 assimpFlags = assimpFlags | aiProcess_GenUVCoords;
             }
-            else if (attributes[i] == VertexAttribute::VA_Normal)
+            else if (attributes[i] == VertexAttribute::VA_Normal || attributes[i] == VertexAttribute::VA_NormalOct)
             {
                 assimpFlags = assimpFlags | aiProcess_GenSmoothNormals;
             }
@@ -155,6 +167,30 @@ namespace vk_demo
             {
                 model->loadSkin = true;
             }
+            else if (attributes[i] == VertexAttribute::VA_SkinIndexU8 || attributes[i] == VertexAttribute::VA_SkinWeightUN8 || attributes[i] == VertexAttribute::VA_SkinWeightUN16)
+            {
+                model->loadSkin = true;
+            }
+        }
+
+        // glTF直接解析，buffer已经是内存映射，不再使用缓存
+        if (DVKGLTFLoader::IsGLTFFile(filename) && DVKGLTFLoader::Load(model, filename))
+        {
+            model->LinkTransforms();
+            model->CompressAnimations(filename);
+
+            if (importFlags & (MIF_OptimizeMesh | MIF_GenerateLods | MIF_BuildMeshlets))
+            {
+                const DVKMeshOptimizeStats& stats = model->optimizeStats;
+                MLOG("Optimize %s : ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, vertices %d -> %d", filename.c_str(), stats.GetACMRBefore(), stats.GetACMRAfter(), stats.GetATVRBefore(), stats.GetATVRAfter(), stats.vertexCountBefore, stats.vertexCountAfter);
+            }
+
+            if (cmdBuffer)
+            {
+                model->UploadPrimitives();
+            }
+
+            return model;
         }
 
         uint32 dataSize = 0;
@@ -164,12 +200,50 @@ namespace vk_demo
             return model;
         }
 
+        // 源文件、attributes以及importFlags都没有变化时直接使用缓存
+        uint32 sourceHash = Crc::MemCrc32(dataPtr, dataSize);
+        std::string cachePath = DVKMeshCache::GetCachePath(filename, attributes, importFlags);
+        if (DVKMeshCache::Load(cachePath, model, sourceHash, dataSize))
+        {
+            model->LinkTransforms();
+            model->CompressAnimations(filename);
+            delete[] dataPtr;
+            return model;
+        }
+
+        // 扩展名作为格式提示，glTF依赖的扩展不支持时也能由assimp读取
+        const size_t periodIdx = filename.rfind('.');
+        std::string  extension = std::string::npos != periodIdx ? filename.substr(periodIdx + 1) : std::string();
+
         Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFileFromMemory(dataPtr, dataSize, assimpFlags);
+        const aiScene* scene = importer.ReadFileFromMemory(dataPtr, dataSize, assimpFlags, extension.c_str());
+        if (scene == nullptr)
+        {
+            MLOGE("Failed import %s : %s", filename.c_str(), importer.GetErrorString());
+            delete[] dataPtr;
+            return model;
+        }
 
+        std::vector<const aiMesh*> aiMeshes;
         model->LoadBones(scene);
-        model->LoadNode(scene->mRootNode, scene);
+        model->LoadNode(scene->mRootNode, scene, aiMeshes);
+        model->LoadMeshes(aiMeshes, scene);
         model->LoadAnim(scene);
+        model->LinkTransforms();
+
+        if (importFlags & (MIF_OptimizeMesh | MIF_GenerateLods | MIF_BuildMeshlets))
+        {
+            const DVKMeshOptimizeStats& stats = model->optimizeStats;
+            MLOG("Optimize %s : ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, vertices %d -> %d", filename.c_str(), stats.GetACMRBefore(), stats.GetACMRAfter(), stats.GetATVRBefore(), stats.GetATVRAfter(), stats.vertexCountBefore, stats.vertexCountAfter);
+        }
+
+        if (cmdBuffer)
+        {
+            model->UploadPrimitives();
+        }
+
+        DVKMeshCache::Save(cachePath, model, sourceHash, dataSize);
+        model->CompressAnimations(filename);
 
         delete[] dataPtr;
 
@@ -207,15 +281,18 @@ namespace vk_demo
         }
     }
 
-    void DVKModel::LoadSkin(std::unordered_map<uint32, DVKVertexSkin>& skinInfoMap, DVKMesh* mesh, const aiMesh* aiMesh, const aiScene* aiScene)
+    void DVKModel::LoadSkin(std::vector<DVKVertexSkin>& skinInfos, DVKMesh* mesh, const aiMesh* aiMesh, const aiScene* aiScene)
     {
         std::unordered_map<int32, int32> boneIndexMap;
 
+        // 每个顶点一项，未被Bone影响的顶点保持为0
+        skinInfos.resize(aiMesh->mNumVertices);
+
         for (int32 i = 0; i < (int32)aiMesh->mNumBones; ++i)
         {
             aiBone* boneInfo = aiMesh->mBones[i];
             std::string boneName(boneInfo->mName.C_Str());
-            int32 boneIndex = bonesMap[boneName]->index;
+            int32 boneIndex = bonesMap.find(boneName)->second->index;
 
             // bone在mesh中的索引
             int32 meshBoneIndex = 0;
@@ -236,12 +313,12 @@ namespace vk_demo
             {
                 uint32 vertexID = boneInfo->mWeights[j].mVertexId;
                 float  weight   = boneInfo->mWeights[j].mWeight;
-                // 顶点->Bone
-                if (skinInfoMap.find(vertexID) == skinInfoMap.end())
+                if (vertexID >= skinInfos.size())
                 {
-                    skinInfoMap.insert(std::make_pair(vertexID, DVKVertexSkin()));
+                    continue;
                 }
-                DVKVertexSkin* info = &(skinInfoMap[vertexID]);
+                // 顶点->Bone
+                DVKVertexSkin* info = &(skinInfos[vertexID]);
                 info->indices[info->used] = meshBoneIndex;
                 info->weights[info->used] = weight;
                 info->used += 1;
@@ -253,186 +330,686 @@ namespace vk_demo
             }
         }
 
-        // 再次处理一遍skinInfoMap，把未使用的补齐
-        for (auto it = skinInfoMap.begin(); it != skinInfoMap.end(); ++it)
+        mesh->isSkin = true;
+    }
+
+    // 顶点转换的上下文，所有属性共用
+    struct VertexConvertContext
+    {
+        const aiMesh*                       source;
+        const DVKMesh*                      mesh;
+        const std::vector<DVKVertexSkin>*   skinInfos;
+        Vector3                             defaultColor;
+        Vector3                             mmin;
+        Vector3                             mmax;
+    };
+
+    // 交错顶点数据中某一个属性的写入位置，stride以float为单位
+    struct VertexStream
+    {
+        float*  data;
+        int32   stride;
+        int32   count;
+    };
+
+    // 每个属性一个特化版本，按属性逐个写入，内层循环没有分支。
+    // 未特化的属性(Custom、Instance)保持为0，数据在分配时已经清零。
+    template <VertexAttribute Attribute>
+    struct VertexConverter
+    {
+        static void Convert(const VertexStream& stream, VertexConvertContext& context)
         {
-            DVKVertexSkin& info = it->second;
-            for (int32 i = info.used; i < 4; ++i)
+
+        }
+    };
+
+    template <>
+    struct VertexConverter<VertexAttribute::VA_Position>
+    {
+        static void Convert(const VertexStream& stream, VertexConvertContext& context)
+        {
+            const aiVector3D* src = context.source->mVertices;
+            float* dst = stream.data;
+            int32  i   = 0;
+
+#if MONKEY_MATH_SSE
+            __m128 vmin = _mm_setr_ps(context.mmin.x, context.mmin.y, context.mmin.z, 0.0f);
+            __m128 vmax = _mm_setr_ps(context.mmax.x, context.mmax.y, context.mmax.z, 0.0f);
+            // 一次读取4个float，最后一个顶点单独处理避免越界
+            for (; i < stream.count - 1; ++i)
             {
-                info.indices[i] = 0;
-                info.weights[i] = 0.0f;
+                __m128 p = _mm_loadu_ps(&(src[i].x));
+                vmin = _mm_min_ps(p, vmin);
+                vmax = _mm_max_ps(p, vmax);
+                _mm_storel_pi((__m64*)dst, p);
+                _mm_store_ss(dst + 2, _mm_movehl_ps(p, p));
+                dst += stream.stride;
+            }
+            float minValues[4];
+            float maxValues[4];
+            _mm_storeu_ps(minValues, vmin);
+            _mm_storeu_ps(maxValues, vmax);
+            context.mmin.Set(minValues[0], minValues[1], minValues[2]);
+            context.mmax.Set(maxValues[0], maxValues[1], maxValues[2]);
+#endif
+
+            for (; i < stream.count; ++i)
+            {
+                dst[0] = src[i].x;
+                dst[1] = src[i].y;
+                dst[2] = src[i].z;
+
+                context.mmin.x = MMath::Min(dst[0], context.mmin.x);
+                context.mmin.y = MMath::Min(dst[1], context.mmin.y);
+                context.mmin.z = MMath::Min(dst[2], context.mmin.z);
+                context.mmax.x = MMath::Max(dst[0], context.mmax.x);
+                context.mmax.y = MMath::Max(dst[1], context.mmax.y);
+                context.mmax.z = MMath::Max(dst[2], context.mmax.z);
+
+                dst += stream.stride;
             }
         }
+    };
 
-        mesh->isSkin = true;
-    }
+    template <int32 Channel>
+    struct UVConverter
+    {
+        static void Convert(const VertexStream& stream, VertexConvertContext& context)
+        {
+            if (!context.source->HasTextureCoords(Channel))
+            {
+                return;
+            }
+
+            const aiVector3D* src = context.source->mTextureCoords[Channel];
+            float* dst = stream.data;
+            for (int32 i = 0; i < stream.count; ++i)
+            {
+                dst[0] = src[i].x;
+                dst[1] = src[i].y;
+                dst += stream.stride;
+            }
+        }
+    };
 
-    void DVKModel::LoadVertexDatas(std::unordered_map<uint32, DVKVertexSkin>& skinInfoMap, std::vector<float>& vertices, Vector3& mmax, Vector3& mmin, DVKMesh* mesh, const aiMesh* aiMesh, const aiScene* aiScene)
+    template <>
+    struct VertexConverter<VertexAttribute::VA_UV0> : public UVConverter<0>
     {
-        Vector3 defaultColor(
-            MMath::RandRange(0.0f, 1.0f),
-            MMath::RandRange(0.0f, 1.0f),
-            MMath::RandRange(0.0f, 1.0f)
-        );
 
-        for (int32 i = 0; i < (int32)aiMesh->mNumVertices; ++i)
+    };
+
+    template <>
+    struct VertexConverter<VertexAttribute::VA_UV1> : public UVConverter<1>
+    {
+
+    };
+
+    template <>
+    struct VertexConverter<VertexAttribute::VA_Normal>
+    {
+        static void Convert(const VertexStream& stream, VertexConvertContext& context)
         {
-            for (int32 j = 0; j < attributes.size(); ++j)
+            const aiVector3D* src = context.source->mNormals;
+            float* dst = stream.data;
+            int32  i   = 0;
+
+            if (src == nullptr)
             {
-                if (attributes[j] == VertexAttribute::VA_Position)
-                {
-                    float v0 = aiMesh->mVertices[i].x;
-                    float v1 = aiMesh->mVertices[i].y;
-                    float v2 = aiMesh->mVertices[i].z;
-
-                    vertices.push_back(v0);
-                    vertices.push_back(v1);
-                    vertices.push_back(v2);
-
-                    mmin.x = MMath::Min(v0, mmin.x);
-                    mmin.y = MMath::Min(v1, mmin.y);
-                    mmin.z = MMath::Min(v2, mmin.z);
-                    mmax.x = MMath::Max(v0, mmax.x);
-                    mmax.y = MMath::Max(v1, mmax.y);
-                    mmax.z = MMath::Max(v2, mmax.z);
-                }
-                else if (attributes[j] == VertexAttribute::VA_UV0)
-                {
-                    if (aiMesh->HasTextureCoords(0))
-                    {
-                        vertices.push_back(aiMesh->mTextureCoords[0][i].x);
-                        vertices.push_back(aiMesh->mTextureCoords[0][i].y);
-                    }
-                    else
-                    {
-                        vertices.push_back(0);
-                        vertices.push_back(0);
-                    }
-                }
-                else if (attributes[j] == VertexAttribute::VA_UV1)
+                return;
+            }
+
+#if MONKEY_MATH_SSE
+            for (; i < stream.count - 1; ++i)
+            {
+                __m128 n = _mm_loadu_ps(&(src[i].x));
+                _mm_storel_pi((__m64*)dst, n);
+                _mm_store_ss(dst + 2, _mm_movehl_ps(n, n));
+                dst += stream.stride;
+            }
+#endif
+
+            for (; i < stream.count; ++i)
+            {
+                dst[0] = src[i].x;
+                dst[1] = src[i].y;
+                dst[2] = src[i].z;
+                dst += stream.stride;
+            }
+        }
+    };
+
+    template <>
+    struct VertexConverter<VertexAttribute::VA_Tangent>
+    {
+        static void Convert(const VertexStream& stream, VertexConvertContext& context)
+        {
+            const aiVector3D* src = context.source->mTangents;
+            float* dst = stream.data;
+            int32  i   = 0;
+
+            // 没有UV时无法计算切线
+            if (src == nullptr)
+            {
+                for (; i < stream.count; ++i)
                 {
-                    if (aiMesh->HasTextureCoords(1))
-                    {
-                        vertices.push_back(aiMesh->mTextureCoords[1][i].x);
-                        vertices.push_back(aiMesh->mTextureCoords[1][i].y);
-                    }
-                    else
-                    {
-                        vertices.push_back(0);
-                        vertices.push_back(0);
-                    }
+                    dst[3] = 1.0f;
+                    dst += stream.stride;
                 }
-                else if (attributes[j] == VertexAttribute::VA_Normal)
+                return;
+            }
+
+#if MONKEY_MATH_SSE
+            __m128 one = _mm_set1_ps(1.0f);
+            for (; i < stream.count - 1; ++i)
+            {
+                __m128 t = _mm_loadu_ps(&(src[i].x));
+                // (x, y, z, 1)
+                t = _mm_movelh_ps(t, _mm_unpackhi_ps(t, one));
+                _mm_storeu_ps(dst, t);
+                dst += stream.stride;
+            }
+#endif
+
+            for (; i < stream.count; ++i)
+            {
+                dst[0] = src[i].x;
+                dst[1] = src[i].y;
+                dst[2] = src[i].z;
+                dst[3] = 1.0f;
+                dst += stream.stride;
+            }
+
+            // 有副切线时w为副切线相对N×T的方向，镜像UV时为-1
+            const aiVector3D* normals    = context.source->mNormals;
+            const aiVector3D* bitangents = context.source->mBitangents;
+            if (normals == nullptr || bitangents == nullptr)
+            {
+                return;
+            }
+
+            dst = stream.data;
+            for (i = 0; i < stream.count; ++i)
+            {
+                dst[3] = ((normals[i] ^ src[i]) * bitangents[i]) < 0.0f ? -1.0f : 1.0f;
+                dst += stream.stride;
+            }
+        }
+    };
+
+    template <>
+    struct VertexConverter<VertexAttribute::VA_Color>
+    {
+        static void Convert(const VertexStream& stream, VertexConvertContext& context)
+        {
+            float* dst = stream.data;
+
+            if (context.source->HasVertexColors(0))
+            {
+                const aiColor4D* src = context.source->mColors[0];
+                for (int32 i = 0; i < stream.count; ++i)
                 {
-                    vertices.push_back(aiMesh->mNormals[i].x);
-                    vertices.push_back(aiMesh->mNormals[i].y);
-                    vertices.push_back(aiMesh->mNormals[i].z);
+                    dst[0] = src[i].r;
+                    dst[1] = src[i].g;
+                    dst[2] = src[i].b;
+                    dst += stream.stride;
                 }
-                else if (attributes[j] == VertexAttribute::VA_Tangent)
+            }
+            else
+            {
+                for (int32 i = 0; i < stream.count; ++i)
                 {
-                    vertices.push_back(aiMesh->mTangents[i].x);
-                    vertices.push_back(aiMesh->mTangents[i].y);
-                    vertices.push_back(aiMesh->mTangents[i].z);
-                    vertices.push_back(1);
+                    dst[0] = context.defaultColor.x;
+                    dst[1] = context.defaultColor.y;
+                    dst[2] = context.defaultColor.z;
+                    dst += stream.stride;
                 }
-                else if (attributes[j] == VertexAttribute::VA_Color)
+            }
+        }
+    };
+
+    template <>
+    struct VertexConverter<VertexAttribute::VA_SkinPack>
+    {
+        static void Convert(const VertexStream& stream, VertexConvertContext& context)
+        {
+            float* dst = stream.data;
+
+            if (!context.mesh->isSkin)
+            {
+                for (int32 i = 0; i < stream.count; ++i)
                 {
-                    if (aiMesh->HasVertexColors(i))
-                    {
-                        vertices.push_back(aiMesh->mColors[0][i].r);
-                        vertices.push_back(aiMesh->mColors[0][i].g);
-                        vertices.push_back(aiMesh->mColors[0][i].b);
-                    }
-                    else
-                    {
-                        vertices.push_back(defaultColor.x);
-                        vertices.push_back(defaultColor.y);
-                        vertices.push_back(defaultColor.z);
-                    }
+                    dst[1] = 65535;
+                    dst += stream.stride;
                 }
-                else if (attributes[j] == VertexAttribute::VA_SkinPack)
+                return;
+            }
+
+            const DVKVertexSkin* skins = context.skinInfos->data();
+            for (int32 i = 0; i < stream.count; ++i)
+            {
+                const DVKVertexSkin& skin = skins[i];
+
+                int32 idx0 = skin.indices[0];
+                int32 idx1 = skin.indices[1];
+                int32 idx2 = skin.indices[2];
+                int32 idx3 = skin.indices[3];
+                uint32 packIndex = (idx0 << 24) + (idx1 << 16) + (idx2 << 8) + idx3;
+
+                uint16 weight0 = uint16(skin.weights[0] * 65535);
+                uint16 weight1 = uint16(skin.weights[1] * 65535);
+                uint16 weight2 = uint16(skin.weights[2] * 65535);
+                uint16 weight3 = uint16(skin.weights[3] * 65535);
+                uint32 packWeight0 = (weight0 << 16) + weight1;
+                uint32 packWeight1 = (weight2 << 16) + weight3;
+
+                dst[0] = (float)packIndex;
+                dst[1] = (float)packWeight0;
+                dst[2] = (float)packWeight1;
+                dst += stream.stride;
+            }
+        }
+    };
+
+    template <>
+    struct VertexConverter<VertexAttribute::VA_SkinIndex>
+    {
+        static void Convert(const VertexStream& stream, VertexConvertContext& context)
+        {
+            if (!context.mesh->isSkin)
+            {
+                return;
+            }
+
+            const DVKVertexSkin* skins = context.skinInfos->data();
+            float* dst = stream.data;
+            for (int32 i = 0; i < stream.count; ++i)
+            {
+                dst[0] = (float)skins[i].indices[0];
+                dst[1] = (float)skins[i].indices[1];
+                dst[2] = (float)skins[i].indices[2];
+                dst[3] = (float)skins[i].indices[3];
+                dst += stream.stride;
+            }
+        }
+    };
+
+    template <>
+    struct VertexConverter<VertexAttribute::VA_SkinWeight>
+    {
+        static void Convert(const VertexStream& stream, VertexConvertContext& context)
+        {
+            float* dst = stream.data;
+
+            if (!context.mesh->isSkin)
+            {
+                for (int32 i = 0; i < stream.count; ++i)
                 {
-                    if (mesh->isSkin)
-                    {
-                        DVKVertexSkin& skin = skinInfoMap[i];
-
-                        int32 idx0 = skin.indices[0];
-                        int32 idx1 = skin.indices[1];
-                        int32 idx2 = skin.indices[2];
-                        int32 idx3 = skin.indices[3];
-                        uint32 packIndex = (idx0 << 24) + (idx1 << 16) + (idx2 << 8) + idx3;
-
-                        uint16 weight0 = uint16(skin.weights[0] * 65535);
-                        uint16 weight1 = uint16(skin.weights[1] * 65535);
-                        uint16 weight2 = uint16(skin.weights[2] * 65535);
-                        uint16 weight3 = uint16(skin.weights[3] * 65535);
-                        uint32 packWeight0 = (weight0 << 16) + weight1;
-                        uint32 packWeight1 = (weight2 << 16) + weight3;
-
-                        vertices.push_back((float)packIndex);
-                        vertices.push_back((float)packWeight0);
-                        vertices.push_back((float)packWeight1);
-                    }
-                    else
-                    {
-                        vertices.push_back(0);
-                        vertices.push_back(65535);
-                        vertices.push_back(0);
-                    }
+                    dst[0] = 1.0f;
+                    dst += stream.stride;
                 }
-                else if (attributes[j] == VertexAttribute::VA_SkinIndex)
+                return;
+            }
+
+            const DVKVertexSkin* skins = context.skinInfos->data();
+            for (int32 i = 0; i < stream.count; ++i)
+            {
+                memcpy(dst, skins[i].weights, sizeof(float) * 4);
+                dst += stream.stride;
+            }
+        }
+    };
+
+    // 八面体编码：单位向量投影到八面体再展开到[-1, 1]的正方形
+    static FORCE_INLINE void EncodeOctahedron(float x, float y, float z, int16* dst)
+    {
+        float len = MMath::Abs(x) + MMath::Abs(y) + MMath::Abs(z);
+        if (len <= 0.0f)
+        {
+            dst[0] = 0;
+            dst[1] = 0;
+            return;
+        }
+
+        float u = x / len;
+        float v = y / len;
+        if (z < 0.0f)
+        {
+            float fu = (1.0f - MMath::Abs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+            float fv = (1.0f - MMath::Abs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+            u = fu;
+            v = fv;
+        }
+
+        dst[0] = (int16)meshopt_quantizeSnorm(u, 16);
+        dst[1] = (int16)meshopt_quantizeSnorm(v, 16);
+    }
+
+    // 先归一化(最多保留4个骨骼时权重之和可能不为1)，量化之后的权重之和严格等于最大值，误差补到最大的权重上
+    template <int32 Bits, class T>
+    static FORCE_INLINE void QuantizeWeights(const float* weights, T* dst)
+    {
+        float total = weights[0] + weights[1] + weights[2] + weights[3];
+        float scale = total > 0.0f ? 1.0f / total : 0.0f;
+
+        int32 sum     = 0;
+        int32 largest = 0;
+        for (int32 i = 0; i < 4; ++i)
+        {
+            int32 value = meshopt_quantizeUnorm(weights[i] * scale, Bits);
+            dst[i] = (T)value;
+            sum   += value;
+            largest = weights[i] > weights[largest] ? i : largest;
+        }
+
+        if (sum > 0)
+        {
+            dst[largest] = (T)(dst[largest] + ((1 << Bits) - 1) - sum);
+        }
+    }
+
+    template <>
+    struct VertexConverter<VertexAttribute::VA_PositionQ>
+    {
+        static void Convert(const VertexStream& stream, VertexConvertContext& context)
+        {
+            const aiVector3D* src = context.source->mVertices;
+
+            // 先求出包围盒，量化范围与Mesh的bounding一致
+            for (int32 i = 0; i < stream.count; ++i)
+            {
+                context.mmin.x = MMath::Min(src[i].x, context.mmin.x);
+                context.mmin.y = MMath::Min(src[i].y, context.mmin.y);
+                context.mmin.z = MMath::Min(src[i].z, context.mmin.z);
+                context.mmax.x = MMath::Max(src[i].x, context.mmax.x);
+                context.mmax.y = MMath::Max(src[i].y, context.mmax.y);
+                context.mmax.z = MMath::Max(src[i].z, context.mmax.z);
+            }
+
+            Vector3 extent = context.mmax - context.mmin;
+            Vector3 scale(
+                extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+                extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+                extent.z > 0.0f ? 1.0f / extent.z : 0.0f
+            );
+
+            float* dst = stream.data;
+            for (int32 i = 0; i < stream.count; ++i)
+            {
+                uint16 packed[4];
+                packed[0] = (uint16)meshopt_quantizeUnorm((src[i].x - context.mmin.x) * scale.x, 16);
+                packed[1] = (uint16)meshopt_quantizeUnorm((src[i].y - context.mmin.y) * scale.y, 16);
+                packed[2] = (uint16)meshopt_quantizeUnorm((src[i].z - context.mmin.z) * scale.z, 16);
+                packed[3] = 0;
+                memcpy(dst, packed, sizeof(packed));
+                dst += stream.stride;
+            }
+        }
+    };
+
+    template <int32 Channel>
+    struct UVHalfConverter
+    {
+        static void Convert(const VertexStream& stream, VertexConvertContext& context)
+        {
+            if (!context.source->HasTextureCoords(Channel))
+            {
+                return;
+            }
+
+            const aiVector3D* src = context.source->mTextureCoords[Channel];
+            float* dst = stream.data;
+            for (int32 i = 0; i < stream.count; ++i)
+            {
+                uint16 packed[2];
+                packed[0] = meshopt_quantizeHalf(src[i].x);
+                packed[1] = meshopt_quantizeHalf(src[i].y);
+                memcpy(dst, packed, sizeof(packed));
+                dst += stream.stride;
+            }
+        }
+    };
+
+    template <>
+    struct VertexConverter<VertexAttribute::VA_UV0Half> : public UVHalfConverter<0>
+    {
+
+    };
+
+    template <>
+    struct VertexConverter<VertexAttribute::VA_UV1Half> : public UVHalfConverter<1>
+    {
+
+    };
+
+    template <>
+    struct VertexConverter<VertexAttribute::VA_NormalOct>
+    {
+        static void Convert(const VertexStream& stream, VertexConvertContext& context)
+        {
+            const aiVector3D* src = context.source->mNormals;
+            if (src == nullptr)
+            {
+                return;
+            }
+
+            float* dst = stream.data;
+            for (int32 i = 0; i < stream.count; ++i)
+            {
+                int16 packed[2];
+                EncodeOctahedron(src[i].x, src[i].y, src[i].z, packed);
+                memcpy(dst, packed, sizeof(packed));
+                dst += stream.stride;
+            }
+        }
+    };
+
+    template <>
+    struct VertexConverter<VertexAttribute::VA_TangentSN16>
+    {
+        static void Convert(const VertexStream& stream, VertexConvertContext& context)
+        {
+            const aiVector3D* src        = context.source->mTangents;
+            const aiVector3D* normals    = context.source->mNormals;
+            const aiVector3D* bitangents = context.source->mBitangents;
+            float* dst = stream.data;
+
+            for (int32 i = 0; i < stream.count; ++i)
+            {
+                int16 packed[4] = { 0, 0, 0, 32767 };
+                if (src)
                 {
-                    if (mesh->isSkin)
-                    {
-                        DVKVertexSkin& skin = skinInfoMap[i];
-                        vertices.push_back((float)skin.indices[0]);
-                        vertices.push_back((float)skin.indices[1]);
-                        vertices.push_back((float)skin.indices[2]);
-                        vertices.push_back((float)skin.indices[3]);
-                    }
-                    else
-                    {
-                        vertices.push_back(0);
-                        vertices.push_back(0);
-                        vertices.push_back(0);
-                        vertices.push_back(0);
-                    }
+                    packed[0] = (int16)meshopt_quantizeSnorm(src[i].x, 16);
+                    packed[1] = (int16)meshopt_quantizeSnorm(src[i].y, 16);
+                    packed[2] = (int16)meshopt_quantizeSnorm(src[i].z, 16);
                 }
-                else if (attributes[j] == VertexAttribute::VA_SkinWeight)
+                // 与VA_Tangent相同，w为副切线相对N×T的方向
+                if (src && normals && bitangents && ((normals[i] ^ src[i]) * bitangents[i]) < 0.0f)
                 {
-                    if (mesh->isSkin)
-                    {
-                        DVKVertexSkin& skin = skinInfoMap[i];
-                        vertices.push_back(skin.weights[0]);
-                        vertices.push_back(skin.weights[1]);
-                        vertices.push_back(skin.weights[2]);
-                        vertices.push_back(skin.weights[3]);
-                    }
-                    else
-                    {
-                        vertices.push_back(1.0f);
-                        vertices.push_back(0.0f);
-                        vertices.push_back(0.0f);
-                        vertices.push_back(0.0f);
-                    }
+                    packed[3] = -32767;
                 }
-                else if (attributes[j] == VertexAttribute::VA_Custom0 ||
-                         attributes[j] == VertexAttribute::VA_Custom1 ||
-                         attributes[j] == VertexAttribute::VA_Custom2 ||
-                         attributes[j] == VertexAttribute::VA_Custom3
-                )
+                memcpy(dst, packed, sizeof(packed));
+                dst += stream.stride;
+            }
+        }
+    };
+
+    template <>
+    struct VertexConverter<VertexAttribute::VA_ColorUN8>
+    {
+        static void Convert(const VertexStream& stream, VertexConvertContext& context)
+        {
+            const aiColor4D* src = context.source->HasVertexColors(0) ? context.source->mColors[0] : nullptr;
+            float* dst = stream.data;
+
+            for (int32 i = 0; i < stream.count; ++i)
+            {
+                uint8 packed[4];
+                packed[0] = (uint8)meshopt_quantizeUnorm(src ? src[i].r : context.defaultColor.x, 8);
+                packed[1] = (uint8)meshopt_quantizeUnorm(src ? src[i].g : context.defaultColor.y, 8);
+                packed[2] = (uint8)meshopt_quantizeUnorm(src ? src[i].b : context.defaultColor.z, 8);
+                packed[3] = (uint8)meshopt_quantizeUnorm(src ? src[i].a : 1.0f, 8);
+                memcpy(dst, packed, sizeof(packed));
+                dst += stream.stride;
+            }
+        }
+    };
+
+    template <>
+    struct VertexConverter<VertexAttribute::VA_SkinIndexU8>
+    {
+        static void Convert(const VertexStream& stream, VertexConvertContext& context)
+        {
+            if (!context.mesh->isSkin)
+            {
+                return;
+            }
+
+            const DVKVertexSkin* skins = context.skinInfos->data();
+            float* dst = stream.data;
+            for (int32 i = 0; i < stream.count; ++i)
+            {
+                uint8 packed[4];
+                for (int32 j = 0; j < 4; ++j)
                 {
-                    vertices.push_back(0.0f);
-                    vertices.push_back(0.0f);
-                    vertices.push_back(0.0f);
-                    vertices.push_back(0.0f);
+                    packed[j] = (uint8)MMath::Min(skins[i].indices[j], 255);
                 }
+                memcpy(dst, packed, sizeof(packed));
+                dst += stream.stride;
+            }
+        }
+    };
+
+    template <int32 Bits, class T>
+    struct SkinWeightConverter
+    {
+        static void Convert(const VertexStream& stream, VertexConvertContext& context)
+        {
+            static const float defaultWeights[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+
+            const DVKVertexSkin* skins = context.mesh->isSkin ? context.skinInfos->data() : nullptr;
+            float* dst = stream.data;
+            for (int32 i = 0; i < stream.count; ++i)
+            {
+                T packed[4];
+                QuantizeWeights<Bits>(skins ? skins[i].weights : defaultWeights, packed);
+                memcpy(dst, packed, sizeof(packed));
+                dst += stream.stride;
+            }
+        }
+    };
+
+    template <>
+    struct VertexConverter<VertexAttribute::VA_SkinWeightUN8> : public SkinWeightConverter<8, uint8>
+    {
+
+    };
+
+    template <>
+    struct VertexConverter<VertexAttribute::VA_SkinWeightUN16> : public SkinWeightConverter<16, uint16>
+    {
+
+    };
+
+    void DVKModel::LoadVertexDatas(std::vector<DVKVertexSkin>& skinInfos, std::vector<float>& vertices, Vector3& mmax, Vector3& mmin, const Vector3& defaultColor, DVKMesh* mesh, const aiMesh* aiMesh, const aiScene* aiScene)
+    {
+        int32 stride = 0;
+        for (int32 i = 0; i < attributes.size(); ++i)
+        {
+            stride += VertexAttributeToSize(attributes[i]) / sizeof(float);
+        }
+
+        int32 count = (int32)aiMesh->mNumVertices;
+
+        // 一次分配并清零，各个属性的默认值大多为0
+        vertices.resize(count * stride, 0.0f);
+
+        VertexConvertContext context;
+        context.source       = aiMesh;
+        context.mesh         = mesh;
+        context.skinInfos    = &skinInfos;
+        context.defaultColor = defaultColor;
+        context.mmin         = mmin;
+        context.mmax         = mmax;
+
+        int32 offset = 0;
+        for (int32 i = 0; i < attributes.size(); ++i)
+        {
+            VertexStream stream;
+            stream.data   = vertices.data() + offset;
+            stream.stride = stride;
+            stream.count  = count;
+
+            switch (attributes[i])
+            {
+                case VertexAttribute::VA_Position:
+                    VertexConverter<VertexAttribute::VA_Position>::Convert(stream, context);
+                    break;
+                case VertexAttribute::VA_UV0:
+                    VertexConverter<VertexAttribute::VA_UV0>::Convert(stream, context);
+                    break;
+                case VertexAttribute::VA_UV1:
+                    VertexConverter<VertexAttribute::VA_UV1>::Convert(stream, context);
+                    break;
+                case VertexAttribute::VA_Normal:
+                    VertexConverter<VertexAttribute::VA_Normal>::Convert(stream, context);
+                    break;
+                case VertexAttribute::VA_Tangent:
+                    VertexConverter<VertexAttribute::VA_Tangent>::Convert(stream, context);
+                    break;
+                case VertexAttribute::VA_Color:
+                    VertexConverter<VertexAttribute::VA_Color>::Convert(stream, context);
+                    break;
+                case VertexAttribute::VA_SkinPack:
+                    VertexConverter<VertexAttribute::VA_SkinPack>::Convert(stream, context);
+                    break;
+                case VertexAttribute::VA_SkinIndex:
+                    VertexConverter<VertexAttribute::VA_SkinIndex>::Convert(stream, context);
+                    break;
+                case VertexAttribute::VA_SkinWeight:
+                    VertexConverter<VertexAttribute::VA_SkinWeight>::Convert(stream, context);
+                    break;
+                case VertexAttribute::VA_PositionQ:
+                    VertexConverter<VertexAttribute::VA_PositionQ>::Convert(stream, context);
+                    break;
+                case VertexAttribute::VA_UV0Half:
+                    VertexConverter<VertexAttribute::VA_UV0Half>::Convert(stream, context);
+                    break;
+                case VertexAttribute::VA_UV1Half:
+                    VertexConverter<VertexAttribute::VA_UV1Half>::Convert(stream, context);
+                    break;
+                case VertexAttribute::VA_NormalOct:
+                    VertexConverter<VertexAttribute::VA_NormalOct>::Convert(stream, context);
+                    break;
+                case VertexAttribute::VA_TangentSN16:
+                    VertexConverter<VertexAttribute::VA_TangentSN16>::Convert(stream, context);
+                    break;
+                case VertexAttribute::VA_ColorUN8:
+                    VertexConverter<VertexAttribute::VA_ColorUN8>::Convert(stream, context);
+                    break;
+                case VertexAttribute::VA_SkinIndexU8:
+                    VertexConverter<VertexAttribute::VA_SkinIndexU8>::Convert(stream, context);
+                    break;
+                case VertexAttribute::VA_SkinWeightUN8:
+                    VertexConverter<VertexAttribute::VA_SkinWeightUN8>::Convert(stream, context);
+                    break;
+                case VertexAttribute::VA_SkinWeightUN16:
+                    VertexConverter<VertexAttribute::VA_SkinWeightUN16>::Convert(stream, context);
+                    break;
+                default:
+                    break;
             }
+
+            offset += VertexAttributeToSize(attributes[i]) / sizeof(float);
         }
+
+        mmin = context.mmin;
+        mmax = context.mmax;
     }
 
     void DVKModel::LoadIndices(std::vector<uint32>& indices, const aiMesh* aiMesh, const aiScene* aiScene)
     {
+        indices.reserve(aiMesh->mNumFaces * 3);
+
         for (int32 i = 0; i < (int32)aiMesh->mNumFaces; ++i)
         {
             indices.push_back(aiMesh->mFaces[i].mIndices[0]);
@@ -443,87 +1020,370 @@ namespace vk_demo
 
     void DVKModel::LoadPrimitives(std::vector<float>& vertices, std::vector<uint32>& indices, DVKMesh* mesh, const aiMesh* aiMesh, const aiScene* aiScene)
     {
-        int32 stride = (int32)vertices.size() / aiMesh->mNumVertices;
+        // 每个Mesh一个Primitive，索引格式按顶点数选择，不再拆分以及复制顶点
+        DVKPrimitive* primitive = new DVKPrimitive();
+        primitive->vertices.swap(vertices);
+        primitive->indices.swap(indices);
+        primitive->vertexCount = (int32)aiMesh->mNumVertices;
+        primitive->triangleNum = (int32)primitive->indices.size() / 3;
+        primitive->indexType   = DVKIndexBuffer::GetIndexType(primitive->vertexCount);
+        mesh->primitives.push_back(primitive);
+
+        mesh->vertexCount   += primitive->vertexCount;
+        mesh->triangleCount += primitive->triangleNum;
+    }
 
-        if (indices.size() > 65535)
+    void DVKModel::UploadPrimitives()
+    {
+        if (importFlags & MIF_MergeBuffers)
         {
-            std::unordered_map<uint32, uint32> indicesMap;
-            DVKPrimitive* primitive = nullptr;
+            UploadMergedPrimitives();
+            return;
+        }
 
-            for (int32 i = 0; i < indices.size(); ++i)
+        VkDeviceSize stagingSize = 0;
+        for (int32 i = 0; i < meshes.size(); ++i)
+        {
+            for (int32 j = 0; j < meshes[i]->primitives.size(); ++j)
             {
-                uint32 idx = indices[i];
-                if (primitive == nullptr)
-                {
-                    primitive = new DVKPrimitive();
-                    indicesMap.clear();
-                    mesh->primitives.push_back(primitive);
-                }
+                DVKPrimitive* primitive = meshes[i]->primitives[j];
+                stagingSize += primitive->vertices.size() * sizeof(float);
+                stagingSize += primitive->indices.size() * DVKIndexBuffer::GetIndexSize(primitive->indexType);
+            }
+        }
 
-                uint32 newIdx = 0;
-                auto it = indicesMap.find(idx);
-                if (it == indicesMap.end())
+        if (stagingSize == 0)
+        {
+            return;
+        }
+
+        DVKBuffer* staging = DVKBuffer::CreateBuffer(
+            device,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            stagingSize
+        );
+        staging->Map();
+
+        cmdBuffer->Begin();
+
+        VkDeviceSize offset = 0;
+        for (int32 i = 0; i < meshes.size(); ++i)
+        {
+            for (int32 j = 0; j < meshes[i]->primitives.size(); ++j)
+            {
+                DVKPrimitive* primitive = meshes[i]->primitives[j];
+
+                VkDeviceSize vertexSize = primitive->vertices.size() * sizeof(float);
+                if (vertexSize > 0)
                 {
-                    uint32 start = idx * stride;
-                    newIdx = (uint32)primitive->vertices.size() / stride;
-                    primitive->vertices.insert(primitive->vertices.end(), vertices.begin() + start, vertices.begin() + start + stride);
-                    indicesMap.insert(std::make_pair(idx, newIdx));
+                    memcpy((uint8*)staging->mapped + offset, primitive->vertices.data(), vertexSize);
+                    primitive->vertexBuffer = DVKVertexBuffer::Create(device, cmdBuffer, staging, offset, vertexSize, attributes);
+                    offset += vertexSize;
                 }
-                else
+
+                VkDeviceSize indexSize = primitive->indices.size() * DVKIndexBuffer::GetIndexSize(primitive->indexType);
+                if (indexSize > 0)
                 {
-                    newIdx = it->second;
+                    DVKIndexBuffer::PackIndices((uint8*)staging->mapped + offset, primitive->indices.data(), (int32)primitive->indices.size(), primitive->indexType);
+                    primitive->indexBuffer = DVKIndexBuffer::Create(device, cmdBuffer, staging, offset, (int32)primitive->indices.size(), primitive->indexType);
+                    offset += indexSize;
                 }
+            }
+        }
+
+        staging->UnMap();
 
-                primitive->indices.push_back(newIdx);
+        cmdBuffer->End();
+        cmdBuffer->Submit();
+
+        delete staging;
+    }
 
-                if (primitive->indices.size() == 65535)
+    void DVKModel::UploadMergedPrimitives()
+    {
+        // 索引是Primitive内的局部值，只要每个Primitive都能用16位表示就可以共用16位的Index Buffer
+        VkIndexType  indexType   = VK_INDEX_TYPE_UINT16;
+        VkDeviceSize vertexSize  = 0;
+        uint32       vertexCount = 0;
+        uint32       indexCount  = 0;
+        for (int32 i = 0; i < meshes.size(); ++i)
+        {
+            for (int32 j = 0; j < meshes[i]->primitives.size(); ++j)
+            {
+                DVKPrimitive* primitive = meshes[i]->primitives[j];
+                primitive->firstIndex    = indexCount;
+                primitive->vertexOffset  = vertexCount;
+                primitive->sharedBuffers = true;
+
+                vertexSize  += primitive->vertices.size() * sizeof(float);
+                vertexCount += primitive->vertexCount;
+                indexCount  += (uint32)primitive->indices.size();
+
+                if (primitive->indexType == VK_INDEX_TYPE_UINT32)
                 {
-                    primitive = nullptr;
+                    indexType = VK_INDEX_TYPE_UINT32;
                 }
             }
+        }
 
-            if (cmdBuffer)
+        VkDeviceSize indexSize = indexCount * DVKIndexBuffer::GetIndexSize(indexType);
+        if (vertexSize == 0)
+        {
+            return;
+        }
+
+        GenerateIndirectCommands(nullptr);
+        VkDeviceSize indirectSize = indirectCommands.size() * sizeof(VkDrawIndexedIndirectCommand);
+
+        DVKBuffer* staging = DVKBuffer::CreateBuffer(
+            device,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            vertexSize + indexSize + indirectSize
+        );
+        staging->Map();
+
+        uint8* vertexData = (uint8*)staging->mapped;
+        uint8* indexData  = vertexData + vertexSize;
+        for (int32 i = 0; i < meshes.size(); ++i)
+        {
+            for (int32 j = 0; j < meshes[i]->primitives.size(); ++j)
             {
-                for (int32 i = 0; i < mesh->primitives.size(); ++i)
+                DVKPrimitive* primitive = meshes[i]->primitives[j];
+                memcpy(vertexData, primitive->vertices.data(), primitive->vertices.size() * sizeof(float));
+                DVKIndexBuffer::PackIndices(indexData, primitive->indices.data(), (int32)primitive->indices.size(), indexType);
+                vertexData += primitive->vertices.size() * sizeof(float);
+                indexData  += primitive->indices.size() * DVKIndexBuffer::GetIndexSize(indexType);
+            }
+        }
+        memcpy(indexData, indirectCommands.data(), indirectSize);
+
+        staging->UnMap();
+
+        cmdBuffer->Begin();
+
+        vertexBuffer = DVKVertexBuffer::Create(device, cmdBuffer, staging, 0, vertexSize, attributes);
+        if (indexCount > 0)
+        {
+            indexBuffer = DVKIndexBuffer::Create(device, cmdBuffer, staging, vertexSize, indexCount, indexType);
+
+            indirectBuffer = DVKBuffer::CreateBuffer(
+                device,
+                VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                indirectSize
+            );
+
+            VkBufferCopy copyRegion = {};
+            copyRegion.srcOffset = vertexSize + indexSize;
+            copyRegion.size      = indirectSize;
+            vkCmdCopyBuffer(cmdBuffer->cmdBuffer, staging->buffer, indirectBuffer->buffer, 1, &copyRegion);
+        }
+
+        cmdBuffer->End();
+        cmdBuffer->Submit();
+
+        delete staging;
+
+        for (int32 i = 0; i < meshes.size(); ++i)
+        {
+            for (int32 j = 0; j < meshes[i]->primitives.size(); ++j)
+            {
+                meshes[i]->primitives[j]->vertexBuffer = vertexBuffer;
+                meshes[i]->primitives[j]->indexBuffer  = indexBuffer;
+            }
+        }
+    }
+
+    void DVKModel::GenerateIndirectCommands(const uint8* visibility)
+    {
+        bool firstInstance = device->GetPhysicalFeatures().drawIndirectFirstInstance;
+
+        indirectCommands.clear();
+        for (int32 i = 0; i < meshes.size(); ++i)
+        {
+            for (int32 j = 0; j < meshes[i]->primitives.size(); ++j)
+            {
+                DVKPrimitive* primitive = meshes[i]->primitives[j];
+                if (primitive->indices.size() == 0)
                 {
-                    primitive = mesh->primitives[i];
-                    primitive->vertexBuffer = DVKVertexBuffer::Create(device, cmdBuffer, primitive->vertices, attributes);
-                    primitive->indexBuffer  = DVKIndexBuffer::Create(device, cmdBuffer, primitive->indices);
+                    continue;
                 }
+
+                VkDrawIndexedIndirectCommand command;
+                primitive->GetDrawCommand(command);
+                command.instanceCount = (visibility == nullptr || visibility[i]) ? command.instanceCount : 0;
+                command.firstInstance = firstInstance ? i : 0;
+                indirectCommands.push_back(command);
             }
         }
+    }
+
+    void DVKModel::BindBuffers(VkCommandBuffer cmdBuffer)
+    {
+        if (vertexBuffer)
+        {
+            vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &(vertexBuffer->dvkBuffer->buffer), &(vertexBuffer->offset));
+        }
+
+        if (indexBuffer)
+        {
+            vkCmdBindIndexBuffer(cmdBuffer, indexBuffer->dvkBuffer->buffer, 0, indexBuffer->indexType);
+        }
+    }
+
+    void DVKModel::UpdateIndirectCommands(VkCommandBuffer cmdBuffer, const uint8* visibility)
+    {
+        if (indirectBuffer == nullptr)
+        {
+            return;
+        }
+
+        GenerateIndirectCommands(visibility);
+
+        // 上一帧的间接绘制读取完成之后才能覆盖
+        VkMemoryBarrier memoryBarrier;
+        ZeroVulkanStruct(memoryBarrier, VK_STRUCTURE_TYPE_MEMORY_BARRIER);
+        memoryBarrier.srcAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+        // vkCmdUpdateBuffer单次最多65536字节，数据随命令缓冲提交
+        const uint8* data = (const uint8*)indirectCommands.data();
+        VkDeviceSize dataSize = indirectCommands.size() * sizeof(VkDrawIndexedIndirectCommand);
+        for (VkDeviceSize offset = 0; offset < dataSize; offset += 65536)
+        {
+            VkDeviceSize size = MMath::Min<VkDeviceSize>(dataSize - offset, 65536);
+            vkCmdUpdateBuffer(cmdBuffer, indirectBuffer->buffer, offset, size, data + offset);
+        }
+
+        memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+    }
+
+    void DVKModel::DrawIndirect(VkCommandBuffer cmdBuffer)
+    {
+        if (indirectBuffer == nullptr)
+        {
+            return;
+        }
+
+        BindBuffers(cmdBuffer);
+
+        uint32 stride = sizeof(VkDrawIndexedIndirectCommand);
+        if (device->GetPhysicalFeatures().multiDrawIndirect)
+        {
+            vkCmdDrawIndexedIndirect(cmdBuffer, indirectBuffer->buffer, 0, (uint32)indirectCommands.size(), stride);
+        }
         else
         {
-            DVKPrimitive* primitive = new DVKPrimitive();
-            primitive->vertices = vertices;
-            for (uint16 i = 0; i < indices.size(); ++i)
+            for (uint32 i = 0; i < indirectCommands.size(); ++i)
             {
-                primitive->indices.push_back(indices[i]);
+                vkCmdDrawIndexedIndirect(cmdBuffer, indirectBuffer->buffer, i * stride, 1, stride);
             }
-            mesh->primitives.push_back(primitive);
+        }
+    }
 
-            if (cmdBuffer)
+    void DVKModel::LoadMeshes(const std::vector<const aiMesh*>& aiMeshes, const aiScene* aiScene)
+    {
+        // 随机的默认颜色按原先的顺序生成，保证结果与单线程一致
+        std::vector<Vector3> defaultColors(aiMeshes.size());
+        for (int32 i = 0; i < aiMeshes.size(); ++i)
+        {
+            Vector3 defaultColor(
+                MMath::RandRange(0.0f, 1.0f),
+                MMath::RandRange(0.0f, 1.0f),
+                MMath::RandRange(0.0f, 1.0f)
+            );
+            defaultColors[i] = defaultColor;
+        }
+
+        bool optimize = (importFlags & (MIF_OptimizeMesh | MIF_GenerateLods | MIF_BuildMeshlets)) != 0;
+        std::vector<DVKMeshOptimizeStats> stats(optimize ? aiMeshes.size() : 0);
+
+        // 每个线程从计数器领取下一个Mesh，Mesh之间互不依赖
+        std::atomic<int32> nextMesh(0);
+        auto worker = [&]() -> void
+        {
+            for (int32 i = nextMesh++; i < (int32)aiMeshes.size(); i = nextMesh++)
             {
-                primitive->vertexBuffer = DVKVertexBuffer::Create(device, cmdBuffer, primitive->vertices, attributes);
-                primitive->indexBuffer  = DVKIndexBuffer::Create(device, cmdBuffer, primitive->indices);
+                LoadMesh(meshes[i], aiMeshes[i], aiScene, defaultColors[i]);
+
+                if (optimize)
+                {
+                    OptimizeMesh(meshes[i], stats[i]);
+                }
             }
+        };
+
+        int32 numThreads = MMath::Min<int32>((int32)std::thread::hardware_concurrency(), (int32)aiMeshes.size());
+        std::vector<std::thread> threads;
+        for (int32 i = 1; i < numThreads; ++i)
+        {
+            threads.push_back(std::thread(worker));
         }
 
-        for (int32 i = 0; i < mesh->primitives.size(); ++i)
+        worker();
+
+        for (int32 i = 0; i < threads.size(); ++i)
         {
-            DVKPrimitive* primitive = mesh->primitives[i];
-            primitive->vertexCount  = (int32)primitive->vertices.size() / stride;
-            primitive->triangleNum  = (int32)primitive->indices.size() / 3;
+            threads[i].join();
+        }
 
-            mesh->vertexCount   += primitive->vertexCount;
-            mesh->triangleCount += primitive->triangleNum;
+        for (int32 i = 0; i < stats.size(); ++i)
+        {
+            optimizeStats.Add(stats[i]);
         }
     }
 
-    DVKMesh* DVKModel::LoadMesh(const aiMesh* aiMesh, const aiScene* aiScene)
+    void DVKModel::OptimizeMesh(DVKMesh* mesh, DVKMeshOptimizeStats& stats)
     {
-        DVKMesh* mesh = new DVKMesh();
+        // 优化需要顶点的跨度以及Position的偏移，以float为单位，优先使用未量化的Position
+        int32 vertexStride = 0;
+        DVKVertexPosition position;
+        for (int32 i = 0; i < attributes.size(); ++i)
+        {
+            if (attributes[i] == VertexAttribute::VA_Position || (attributes[i] == VertexAttribute::VA_PositionQ && !position.IsValid()))
+            {
+                position.offset    = vertexStride;
+                position.quantized = attributes[i] == VertexAttribute::VA_PositionQ;
+            }
+            vertexStride += VertexAttributeToSize(attributes[i]) / sizeof(float);
+        }
+
+        // 量化范围即Mesh的包围盒
+        if (position.quantized)
+        {
+            position.min   = mesh->bounding.min;
+            position.scale = (mesh->bounding.max - mesh->bounding.min) / 65535.0f;
+        }
+
+        bool generateLods  = (importFlags & MIF_GenerateLods) != 0;
+        bool buildMeshlets = (importFlags & MIF_BuildMeshlets) != 0;
 
+        // 去重之后顶点数量会减少
+        mesh->vertexCount = 0;
+        for (int32 j = 0; j < mesh->primitives.size(); ++j)
+        {
+            DVKMeshOptimizer::Optimize(mesh->primitives[j], vertexStride, position, stats);
+            mesh->vertexCount += mesh->primitives[j]->vertexCount;
+
+            if (generateLods)
+            {
+                DVKMeshOptimizer::GenerateLods(mesh->primitives[j], vertexStride, position);
+            }
+
+            if (buildMeshlets)
+            {
+                DVKMeshOptimizer::BuildMeshlets(mesh->primitives[j], vertexStride, position);
+            }
+        }
+    }
+
+    void DVKModel::LoadMesh(DVKMesh* mesh, const aiMesh* aiMesh, const aiScene* aiScene, const Vector3& defaultColor)
+    {
         // load material
         aiMaterial* material = aiScene->mMaterials[aiMesh->mMaterialIndex];
         if (material)
@@ -532,17 +1392,17 @@ namespace vk_demo
         }
 
         // load bones
-        std::unordered_map<uint32, DVKVertexSkin> skinInfoMap;
+        std::vector<DVKVertexSkin> skinInfos;
         if (aiMesh->mNumBones > 0 && loadSkin)
         {
-            LoadSkin(skinInfoMap, mesh, aiMesh, aiScene);
+            LoadSkin(skinInfos, mesh, aiMesh, aiScene);
         }
 
         // load vertex data
         std::vector<float> vertices;
         Vector3 mmin( MAX_FLT,  MAX_FLT,  MAX_FLT);
         Vector3 mmax(-MAX_FLT, -MAX_FLT, -MAX_FLT);
-        LoadVertexDatas(skinInfoMap, vertices, mmax, mmin, mesh, aiMesh, aiScene);
+        LoadVertexDatas(skinInfos, vertices, mmax, mmin, defaultColor, mesh, aiMesh, aiScene);
 
         // load indices
         std::vector<uint32> indices;
@@ -554,11 +1414,9 @@ namespace vk_demo
         mesh->bounding.min = mmin;
         mesh->bounding.max = mmax;
         mesh->bounding.UpdateCorners();
-
-        return mesh;
     }
 
-    DVKNode* DVKModel::LoadNode(const aiNode* aiNode, const aiScene* aiScene)
+    DVKNode* DVKModel::LoadNode(const aiNode* aiNode, const aiScene* aiScene, std::vector<const aiMesh*>& outAiMeshes)
     {
         DVKNode* vkNode = new DVKNode();
         vkNode->name = aiNode->mName.C_Str();
@@ -571,15 +1429,16 @@ namespace vk_demo
         // local matrix
         FillMatrixWithAiMatrix(vkNode->localMatrix, aiNode->mTransformation);
 
-        // mesh
+        // mesh，先占位，数据在LoadMeshes中转换
         if (aiNode->mNumMeshes > 0)
         {
             for (uint32 i = 0; i < aiNode->mNumMeshes; ++i)
             {
-                DVKMesh* vkMesh  = LoadMesh(aiScene->mMeshes[aiNode->mMeshes[i]], aiScene);
+                DVKMesh* vkMesh  = new DVKMesh();
                 vkMesh->linkNode = vkNode;
                 vkNode->meshes.push_back(vkMesh);
                 meshes.push_back(vkMesh);
+                outAiMeshes.push_back(aiScene->mMeshes[aiNode->mMeshes[i]]);
             }
         }
 
@@ -600,7 +1459,7 @@ namespace vk_demo
         // children node
         for (int32 i = 0; i < (int32)aiNode->mNumChildren; ++i)
         {
-            DVKNode* childNode = LoadNode(aiNode->mChildren[i], aiScene);
+            DVKNode* childNode = LoadNode(aiNode->mChildren[i], aiScene, outAiMeshes);
             childNode->parent  = vkNode;
             vkNode->children.push_back(childNode);
 
@@ -670,57 +1529,206 @@ namespace vk_demo
         }
     }
 
-    void DVKModel::GotoAnimation(float time)
+    void DVKAnimation::SampleClip(const DVKAnimationClip& clip, float time, int32* cursors, Matrix4x4& outMatrix) const
     {
-        if (animIndex == -1)
+        Quat    retRot(0, 0, 0, 1);
+        Vector3 retPos(0, 0, 0);
+        Vector3 retScale(1, 1, 1);
+
+        if (compressed)
         {
-            return;
+            float frame = time * frameRate;
+            clip.compressedPositions.Sample(frame, cursors[0], retPos);
+            clip.compressedRotations.Sample(frame, cursors[1], retRot);
+            clip.compressedScales.Sample(frame, cursors[2], retScale);
         }
-
-        DVKAnimation& animation = animations[animIndex];
-        animation.time = MMath::Clamp(time, 0.0f, animation.duration);
-
-        // update nodes animation
-        for (auto it = animation.clips.begin(); it != animation.clips.end(); ++it)
+        else
         {
-            vk_demo::DVKAnimationClip& clip = it->second;
-            vk_demo::DVKNode* node = nodesMap[clip.nodeName];
-
             float alpha = 0.0f;
 
-            // rotation
-            Quat prevRot(0, 0, 0, 1);
-            Quat nextRot(0, 0, 0, 1);
-            clip.rotations.GetValue(animation.time, prevRot, nextRot, alpha);
-            Quat retRot = MMath::Lerp(prevRot, nextRot, alpha);
-
             // position
             Vector3 prevPos(0, 0, 0);
             Vector3 nextPos(0, 0, 0);
-            clip.positions.GetValue(animation.time, prevPos, nextPos, alpha);
-            Vector3 retPos = MMath::Lerp(prevPos, nextPos, alpha);
+            clip.positions.GetValue(time, cursors[0], prevPos, nextPos, alpha);
+            retPos = MMath::Lerp(prevPos, nextPos, alpha);
+
+            // rotation
+            Quat prevRot(0, 0, 0, 1);
+            Quat nextRot(0, 0, 0, 1);
+            clip.rotations.GetValue(time, cursors[1], prevRot, nextRot, alpha);
+            retRot = MMath::Lerp(prevRot, nextRot, alpha);
 
             // scale
             Vector3 prevScale(1, 1, 1);
             Vector3 nextScale(1, 1, 1);
-            clip.scales.GetValue(animation.time, prevScale, nextScale, alpha);
-            Vector3 retScale = MMath::Lerp(prevScale, nextScale, alpha);
+            clip.scales.GetValue(time, cursors[2], prevScale, nextScale, alpha);
+            retScale = MMath::Lerp(prevScale, nextScale, alpha);
+        }
+
+        // 等价于SetIdentity、AppendScale、Append(rotation)、AppendTranslation，直接写入各行
+        Matrix4x4 rotation = retRot.ToMatrix();
+        for (int32 i = 0; i < 3; ++i)
+        {
+            outMatrix.m[0][i] = rotation.m[0][i] * retScale.x;
+            outMatrix.m[1][i] = rotation.m[1][i] * retScale.y;
+            outMatrix.m[2][i] = rotation.m[2][i] * retScale.z;
+            outMatrix.m[3][i] = retPos[i];
+        }
+        outMatrix.m[0][3] = 0.0f;
+        outMatrix.m[1][3] = 0.0f;
+        outMatrix.m[2][3] = 0.0f;
+        outMatrix.m[3][3] = 1.0f;
+    }
+
+    void DVKModel::GotoAnimation(float time)
+    {
+        if (animIndex == -1)
+        {
+            return;
+        }
+
+        DVKAnimation& animation = animations[animIndex];
+        animation.time = MMath::Clamp(time, 0.0f, animation.duration);
 
-            node->localMatrix.SetIdentity();
-            node->localMatrix.AppendScale(retScale);
-            node->localMatrix.Append(retRot.ToMatrix());
-            node->localMatrix.AppendTranslation(retPos);
+        // update nodes animation
+        for (int32 i = 0; i < animation.linearClips.size(); ++i)
+        {
+            vk_demo::DVKAnimationClip& clip = *animation.linearClips[i];
+            animation.SampleClip(clip, animation.time, clip.cursors, linearNodes[clip.nodeIndex]->localMatrix);
         }
 
+        UpdateTransforms();
+
         // update bones
         for (int32 i = 0; i < bones.size(); ++i)
         {
             DVKBone* bone = bones[i];
-            DVKNode* node = nodesMap[bone->name];
             // 注意行列矩阵的区别
             bone->finalTransform = bone->inverseBindPose;
-            bone->finalTransform.Append(node->GetGlobalMatrix());
+            if (boneNodes[i] >= 0)
+            {
+                bone->finalTransform.Append(globalMatrices[boneNodes[i]]);
+            }
+        }
+    }
+
+    void DVKModel::CompressAnimations(const std::string& filename)
+    {
+        if ((importFlags & MIF_CompressAnimation) == 0 || animations.size() == 0)
+        {
+            return;
+        }
+
+        DVKAnimationCompressSettings settings;
+        for (int32 i = 0; i < animations.size(); ++i)
+        {
+            DVKAnimationCompressStats stats;
+            DVKAnimationCompressor::Compress(animations[i], settings, stats);
+            animCompressStats.Add(stats);
+        }
+
+        const DVKAnimationCompressStats& stats = animCompressStats;
+        MLOG("Compress animation %s : keys %d -> %d, %.1fKB -> %.1fKB, max error position %f rotation %f scale %f", filename.c_str(), stats.keyCountBefore, stats.keyCountAfter, stats.sizeBefore / 1024.0f, stats.sizeAfter / 1024.0f, stats.maxPositionError, stats.maxRotationError, stats.maxScaleError);
+    }
+
+    void DVKModel::LinkTransforms()
+    {
+        linearNodes.clear();
+
+        // 先序遍历，子节点逆序入栈保持原来的顺序
+        std::vector<DVKNode*> stack;
+        if (rootNode)
+        {
+            stack.push_back(rootNode);
+        }
+
+        while (stack.size() > 0)
+        {
+            DVKNode* node = stack.back();
+            stack.pop_back();
+
+            node->index = (int32)linearNodes.size();
+            linearNodes.push_back(node);
+
+            for (int32 i = (int32)node->children.size() - 1; i >= 0; --i)
+            {
+                stack.push_back(node->children[i]);
+            }
+        }
+
+        nodeParents.resize(linearNodes.size());
+        for (int32 i = 0; i < linearNodes.size(); ++i)
+        {
+            nodeParents[i] = linearNodes[i]->parent ? linearNodes[i]->parent->index : -1;
         }
+
+        globalMatrices.resize(linearNodes.size());
+        cachedLocals.resize(linearNodes.size());
+        nodeDirty.resize(linearNodes.size());
+        transformsValid = false;
+
+        boneNodes.resize(bones.size());
+        for (int32 i = 0; i < bones.size(); ++i)
+        {
+            auto it = nodesMap.find(bones[i]->name);
+            boneNodes[i] = it != nodesMap.end() ? it->second->index : -1;
+        }
+
+        // clip的节点解析为索引，找不到节点的clip不参与采样
+        for (int32 i = 0; i < animations.size(); ++i)
+        {
+            DVKAnimation& animation = animations[i];
+            animation.linearClips.clear();
+
+            for (auto it = animation.clips.begin(); it != animation.clips.end(); ++it)
+            {
+                DVKAnimationClip& clip = it->second;
+                auto node = nodesMap.find(clip.nodeName);
+                clip.nodeIndex = node != nodesMap.end() ? node->second->index : -1;
+                if (clip.nodeIndex >= 0)
+                {
+                    animation.linearClips.push_back(&clip);
+                }
+            }
+
+            std::sort(animation.linearClips.begin(), animation.linearClips.end(), [](const DVKAnimationClip* a, const DVKAnimationClip* b) {
+                return a->nodeIndex < b->nodeIndex;
+            });
+        }
+
+        UpdateTransforms();
+    }
+
+    int32 DVKModel::UpdateTransforms()
+    {
+        int32 count = 0;
+
+        for (int32 i = 0; i < linearNodes.size(); ++i)
+        {
+            const DVKNode* node = linearNodes[i];
+            int32 parent = nodeParents[i];
+
+            bool dirty = !transformsValid || (parent >= 0 && nodeDirty[parent]) || memcmp(&cachedLocals[i], &node->localMatrix, sizeof(Matrix4x4)) != 0;
+            nodeDirty[i] = dirty;
+
+            if (!dirty)
+            {
+                continue;
+            }
+
+            cachedLocals[i]   = node->localMatrix;
+            globalMatrices[i] = node->localMatrix;
+            if (parent >= 0)
+            {
+                globalMatrices[i].Append(globalMatrices[parent]);
+            }
+
+            count += 1;
+        }
+
+        transformsValid = true;
+
+        return count;
     }
 
     void DVKModel::Update(float time, float delta)
@@ -6,18 +6,23 @@
 #include "DVKBuffer.h"
 #include "DVKIndexBuffer.h"
 #include "DVKVertexBuffer.h"
+#include "DVKMeshOptimizer.h"
+#include "DVKAnimationCompressor.h"
 
 #include "Common/Common.h"
 #include "Math/Math.h"
 #include "Math/Vector3.h"
+#include "Math/Vector4.h"
 #include "Math/Matrix4x4.h"
 #include "Math/Quat.h"
+#include "Math/VectorBatch.h"
 
 #include "Vulkan/VulkanCommon.h"
 
 #include <string>
 #include <cstring>
 #include <vector>
+#include <algorithm>
 #include <memory>
 #include <unordered_map>
 
@@ -29,6 +34,17 @@ namespace vk_demo
 {
     struct DVKNode;
 
+    // LoadFromFile的可选导入处理，结果会写入模型缓存
+    enum ModelImportFlags
+    {
+        MIF_None              = 0,
+        MIF_OptimizeMesh      = 1 << 0,   // 顶点去重以及VertexCache、Overdraw、VertexFetch优化
+        MIF_GenerateLods      = 1 << 1,   // 生成LOD链，包含MIF_OptimizeMesh
+        MIF_BuildMeshlets     = 1 << 2,   // 将LOD0按Meshlet重排并生成包围球与法线锥，包含MIF_OptimizeMesh
+        MIF_MergeBuffers      = 1 << 3,   // 所有Primitive共用一个Vertex Buffer与Index Buffer，不影响缓存内容
+        MIF_CompressAnimation = 1 << 4,   // 删除冗余关键帧并量化动画，缓存中保存的仍是原始动画
+    };
+
     struct DVKBoundingBox
     {
         Vector3 min;
@@ -63,6 +79,27 @@ namespace vk_demo
         }
     };
 
+    // LOD在共用Index Buffer中的索引范围，error为物体空间下的几何误差上限
+    struct DVKLodLevel
+    {
+        uint32  indexStart = 0;
+        uint32  indexCount = 0;
+        float   error = 0.0f;
+    };
+
+    // Meshlet在共用Index Buffer中的索引范围以及用于剔除的包围球与法线锥，物体空间
+    struct DVKMeshlet
+    {
+        Vector3 center;
+        float   radius = 0.0f;
+        Vector3 coneApex;
+        Vector3 coneAxis;
+        // cos(锥角/2)，大于等于1时不做背面剔除
+        float   coneCutoff = 1.0f;
+        uint32  indexStart = 0;
+        uint32  indexCount = 0;
+    };
+
     struct DVKPrimitive
     {
         DVKIndexBuffer*     indexBuffer = nullptr;
@@ -71,11 +108,26 @@ namespace vk_demo
 
         std::vector<float>  vertices;
         std::vector<float>  instanceDatas;
-        std::vector<uint16> indices;
+        std::vector<uint32> indices;
 
         int32               vertexCount = 0;
         int32               triangleNum = 0;
 
+        // GPU上索引的格式，按顶点数自动选择
+        VkIndexType         indexType = VK_INDEX_TYPE_UINT16;
+
+        // 为空时绘制整个Index Buffer，否则只绘制lodIndex对应的范围
+        std::vector<DVKLodLevel> lods;
+        int32               lodIndex = 0;
+
+        // 覆盖LOD0的全部三角形，由DVKMeshletCuller使用
+        std::vector<DVKMeshlet> meshlets;
+
+        // 共用Buffer时在其中的起始位置，Buffer归DVKModel所有
+        uint32              firstIndex = 0;
+        int32               vertexOffset = 0;
+        bool                sharedBuffers = false;
+
         DVKPrimitive()
         {
 
@@ -83,12 +135,12 @@ namespace vk_demo
 
         ~DVKPrimitive()
         {
-            if (indexBuffer)
+            if (indexBuffer && !sharedBuffers)
             {
                 delete indexBuffer;
             }
 
-            if (vertexBuffer)
+            if (vertexBuffer && !sharedBuffers)
             {
                 delete vertexBuffer;
             }
@@ -102,15 +154,33 @@ namespace vk_demo
             vertexBuffer = nullptr;
         }
 
+        // 共用Buffer时indexBuffer包含整个模型的索引
+        FORCE_INLINE uint32 GetIndexCount() const
+        {
+            return sharedBuffers ? (uint32)indices.size() : (uint32)indexBuffer->indexCount;
+        }
+
+        // 当前LOD的绘制参数，firstIndex与vertexOffset已经包含共用Buffer中的偏移
+        void GetDrawCommand(VkDrawIndexedIndirectCommand& outCommand) const
+        {
+            outCommand.indexCount    = lods.size() > 0 ? lods[lodIndex].indexCount : GetIndexCount();
+            outCommand.instanceCount = indexBuffer ? indexBuffer->instanceCount : 1;
+            outCommand.firstIndex    = firstIndex + (lods.size() > 0 ? lods[lodIndex].indexStart : 0);
+            outCommand.vertexOffset  = vertexOffset;
+            outCommand.firstInstance = 0;
+        }
+
         void DrawOnly(VkCommandBuffer cmdBuffer)
         {
             if (vertexBuffer && !indexBuffer)
             {
-                vkCmdDraw(cmdBuffer, vertexCount, 1, 0, 0);
+                vkCmdDraw(cmdBuffer, vertexCount, 1, vertexOffset, 0);
             }
             else
             {
-                vkCmdDrawIndexed(cmdBuffer, indexBuffer->indexCount, indexBuffer->instanceCount, 0, 0, 0);
+                VkDrawIndexedIndirectCommand command;
+                GetDrawCommand(command);
+                vkCmdDrawIndexed(cmdBuffer, command.indexCount, command.instanceCount, command.firstIndex, command.vertexOffset, command.firstInstance);
             }
         }
 
@@ -149,14 +219,7 @@ namespace vk_demo
                 vkCmdBindIndexBuffer(cmdBuffer, indexBuffer->dvkBuffer->buffer, 0, indexBuffer->indexType);
             }
 
-            if (vertexBuffer && !indexBuffer)
-            {
-                vkCmdDraw(cmdBuffer, vertexCount, 1, 0, 0);
-            }
-            else
-            {
-                vkCmdDrawIndexed(cmdBuffer, indexBuffer->indexCount, indexBuffer->instanceCount, 0, 0, 0);
-            }
+            DrawOnly(cmdBuffer);
         }
     };
 
@@ -189,7 +252,8 @@ namespace vk_demo
         std::vector<float>     keys;
         std::vector<ValueType> values;
 
-        void GetValue(float key, ValueType& outPrevValue, ValueType& outNextValue, float& outAlpha)
+        // cursor为上次采样所在的关键帧，顺序播放时不需要重新查找。不修改通道本身，多个线程可以同时采样
+        void GetValue(float key, int32& cursor, ValueType& outPrevValue, ValueType& outNextValue, float& outAlpha) const
         {
             outAlpha = 0.0f;
 
@@ -214,15 +278,20 @@ namespace vk_demo
                 return;
             }
 
-            int32 frameIndex = 0;
-            for (int32 i = 0; i < keys.size() - 1; ++i)
+            // 找到第一个满足key <= keys[i + 1]的i。顺序播放时停留在当前帧或者前进一帧，跳转以及循环时二分查找
+            int32 last       = (int32)keys.size() - 2;
+            int32 frameIndex = MMath::Min(cursor, last);
+            bool  before     = frameIndex > 0 && key <= keys[frameIndex];
+            bool  after      = key > keys[frameIndex + 1];
+            if (after && frameIndex < last && key <= keys[frameIndex + 2])
             {
-                if (key <= keys[i + 1])
-                {
-                    frameIndex = i;
-                    break;
-                }
+                frameIndex += 1;
             }
+            else if (before || after)
+            {
+                frameIndex = (int32)(std::lower_bound(keys.begin() + 1, keys.end(), key) - keys.begin()) - 1;
+            }
+            cursor = frameIndex;
 
             outPrevValue = values[frameIndex + 0];
             outNextValue = values[frameIndex + 1];
@@ -236,10 +305,18 @@ namespace vk_demo
     struct DVKAnimationClip
     {
         std::string                 nodeName;
+        // 在DVKModel::linearNodes中的索引，加载完成之后确定
+        int32                       nodeIndex = -1;
         float                       duration;
         DVKAnimChannel<Vector3>     positions;
         DVKAnimChannel<Vector3>     scales;
         DVKAnimChannel<Quat>        rotations;
+        // MIF_CompressAnimation时使用，上面的float通道被清空
+        DVKCompressedVectorTrack    compressedPositions;
+        DVKCompressedVectorTrack    compressedScales;
+        DVKCompressedQuatTrack      compressedRotations;
+        // GotoAnimation时position、rotation、scale三个通道的查找位置
+        int32                       cursors[3] = { 0, 0, 0 };
     };
 
     struct DVKAnimation
@@ -248,7 +325,22 @@ namespace vk_demo
         float       time = 0.0f;
         float       duration = 0.0f;
         float       speed = 1.0f;
+        // 压缩之后关键帧时间为帧序号，采样时乘以frameRate
+        bool        compressed = false;
+        float       frameRate = 30.0f;
         std::unordered_map<std::string, DVKAnimationClip> clips;
+        // 按nodeIndex排序的clips，每帧按顺序采样，不再查找名称
+        std::vector<DVKAnimationClip*> linearClips;
+
+        // 采样clip在time时刻的局部矩阵，cursors为三个通道的查找位置，可以在多个线程中同时调用
+        void SampleClip(const DVKAnimationClip& clip, float time, int32* cursors, Matrix4x4& outMatrix) const;
+    };
+
+    // VA_PositionQ的还原参数，与着色器中的uniform布局一致：position = min.xyz + inPositionQ.xyz * extent.xyz
+    struct DVKPositionDequant
+    {
+        Vector4 min;
+        Vector4 extent;
     };
 
     struct DVKMesh
@@ -267,14 +359,60 @@ namespace vk_demo
         int32               vertexCount;
         int32               triangleCount;
 
+        // 当前使用的LOD，由DVKLodSelector每帧更新
+        int32               lodIndex;
+
         DVKMesh()
             : linkNode(nullptr)
             , vertexCount(0)
             , triangleCount(0)
+            , lodIndex(0)
         {
 
         }
 
+        int32 GetLodCount() const
+        {
+            int32 count = 1;
+            for (int i = 0; i < primitives.size(); ++i)
+            {
+                count = MMath::Max<int32>(count, (int32)primitives[i]->lods.size());
+            }
+            return count;
+        }
+
+        // 各Primitive的级别数量可能不同，超出的使用自身最粗的一级
+        void SetLod(int32 index)
+        {
+            lodIndex = index;
+            for (int i = 0; i < primitives.size(); ++i)
+            {
+                DVKPrimitive* primitive = primitives[i];
+                primitive->lodIndex = MMath::Min<int32>(index, MMath::Max<int32>((int32)primitive->lods.size() - 1, 0));
+            }
+        }
+
+        // VA_PositionQ相对Mesh的包围盒量化，每个Mesh需要各自的还原参数
+        DVKPositionDequant GetPositionDequant() const
+        {
+            DVKPositionDequant dequant;
+            dequant.min    = Vector4(bounding.min, 1.0f);
+            dequant.extent = Vector4(bounding.max - bounding.min, 0.0f);
+            return dequant;
+        }
+
+        // 当前LOD下的三角形数量
+        int32 GetLodTriangleCount() const
+        {
+            int32 count = 0;
+            for (int i = 0; i < primitives.size(); ++i)
+            {
+                DVKPrimitive* primitive = primitives[i];
+                count += primitive->lods.size() > 0 ? primitive->lods[primitive->lodIndex].indexCount / 3 : primitive->triangleNum;
+            }
+            return count;
+        }
+
         void BindOnly(VkCommandBuffer cmdBuffer)
         {
             for (int i = 0; i < primitives.size(); ++i)
@@ -322,9 +460,13 @@ namespace vk_demo
         Matrix4x4                   localMatrix;
         Matrix4x4                   globalMatrix;
 
+        // 在DVKModel::linearNodes中的索引
+        int32                       index;
+
         DVKNode()
             : name("None")
             , parent(nullptr)
+            , index(-1)
         {
 
         }
@@ -334,6 +476,7 @@ namespace vk_demo
             return localMatrix;
         }
 
+        // 不经过缓存逐级计算，每帧需要大量节点时使用DVKModel::UpdateTransforms
         Matrix4x4& GetGlobalMatrix()
         {
             globalMatrix = localMatrix;
@@ -346,25 +489,29 @@ namespace vk_demo
             return globalMatrix;
         }
 
-        void CalcBounds(DVKBoundingBox& outBounds)
+        // 父节点的矩阵向下传递，每个节点只计算一次
+        void CalcBounds(DVKBoundingBox& outBounds, const Matrix4x4& parentMatrix)
         {
+            Matrix4x4 matrix = localMatrix;
+            matrix.Append(parentMatrix);
+
+            // 变换全部8个角点，旋转之后只变换min、max会得到错误的包围盒
             if (meshes.size() > 0)
             {
-                const Matrix4x4& matrix = GetGlobalMatrix();
+                BoundsArray bounds;
+                bounds.Resize((int32)meshes.size());
                 for (int32 i = 0; i < meshes.size(); ++i)
                 {
-                    Vector3 mmin = matrix.TransformPosition(meshes[i]->bounding.min);
-                    Vector3 mmax = matrix.TransformPosition(meshes[i]->bounding.max);
-                    outBounds.min = Vector3::Min(outBounds.min, mmin);
-                    outBounds.min = Vector3::Min(outBounds.min, mmax);
-                    outBounds.max = Vector3::Max(outBounds.max, mmin);
-                    outBounds.max = Vector3::Max(outBounds.max, mmax);
+                    bounds.Set(i, meshes[i]->bounding.min, meshes[i]->bounding.max);
                 }
+
+                VectorBatch::TransformBounds(matrix, bounds, bounds);
+                VectorBatch::MergeBounds(bounds, outBounds.min, outBounds.max);
             }
 
             for (int32 i = 0; i < children.size(); ++i)
             {
-                children[i]->CalcBounds(outBounds);
+                children[i]->CalcBounds(outBounds, matrix);
             }
         }
 
@@ -373,7 +520,7 @@ namespace vk_demo
             DVKBoundingBox bounds;
             bounds.min.Set( MAX_FLT,  MAX_FLT,  MAX_FLT);
             bounds.max.Set(-MAX_FLT, -MAX_FLT, -MAX_FLT);
-            CalcBounds(bounds);
+            CalcBounds(bounds, parent ? parent->GetGlobalMatrix() : Matrix4x4::Identity);
             bounds.UpdateCorners();
             return bounds;
         }
@@ -396,6 +543,9 @@ namespace vk_demo
 
     class DVKModel
     {
+        friend class DVKMeshCache;
+        friend class DVKGLTFLoader;
+
     private:
         DVKModel()
             : device(nullptr)
@@ -409,6 +559,15 @@ namespace vk_demo
         {
             delete rootNode;
             rootNode = nullptr;
+
+            // Primitive不拥有共用的Buffer
+            delete vertexBuffer;
+            delete indexBuffer;
+            delete indirectBuffer;
+            vertexBuffer   = nullptr;
+            indexBuffer    = nullptr;
+            indirectBuffer = nullptr;
+
             device = nullptr;
 
             meshes.clear();
@@ -429,25 +588,63 @@ namespace vk_demo
 
         void GotoAnimation(float time);
 
+        // 按linearNodes的顺序一次前向遍历更新globalMatrices，只计算localMatrix变化的节点及其子节点，返回更新的节点数量
+        int32 UpdateTransforms();
+
+        // 需要先调用UpdateTransforms
+        FORCE_INLINE const Matrix4x4& GetGlobalMatrix(const DVKNode* node) const
+        {
+            return globalMatrices[node->index];
+        }
+
+        // MIF_MergeBuffers时一次绑定共用的Buffer，之后各Mesh只需要DrawOnly
+        void BindBuffers(VkCommandBuffer cmdBuffer);
+
+        // LOD或者可见性变化之后重新生成间接绘制命令，需要在RenderPass之外录制。
+        // visibility按meshes的顺序，为0的Mesh的instanceCount为0，nullptr时全部可见
+        void UpdateIndirectCommands(VkCommandBuffer cmdBuffer, const uint8* visibility = nullptr);
+
+        // 所有Primitive合并为一次vkCmdDrawIndexedIndirect，支持drawIndirectFirstInstance时firstInstance为Mesh的索引
+        void DrawIndirect(VkCommandBuffer cmdBuffer);
+
+        FORCE_INLINE bool IsMerged() const
+        {
+            return vertexBuffer != nullptr;
+        }
+
         VkVertexInputBindingDescription GetInputBinding();
 
         std::vector<VkVertexInputAttributeDescription> GetInputAttributes();
 
-        static DVKModel* LoadFromFile(const std::string& filename, std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, const std::vector<VertexAttribute>& attributes);
+        static DVKModel* LoadFromFile(const std::string& filename, std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, const std::vector<VertexAttribute>& attributes, uint32 importFlags = MIF_None);
 
         static DVKModel* Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, const std::vector<float>& vertices, const std::vector<uint16>& indices, const std::vector<VertexAttribute>& attributes);
 
     protected:
 
-        DVKNode* LoadNode(const aiNode* node, const aiScene* scene);
+        DVKNode* LoadNode(const aiNode* node, const aiScene* scene, std::vector<const aiMesh*>& outAiMeshes);
 
-        DVKMesh* LoadMesh(const aiMesh* mesh, const aiScene* scene);
+        // 多线程转换所有Mesh，aiMeshes与meshes一一对应
+        void LoadMeshes(const std::vector<const aiMesh*>& aiMeshes, const aiScene* scene);
+
+        void LoadMesh(DVKMesh* mesh, const aiMesh* aiMesh, const aiScene* scene, const Vector3& defaultColor);
+
+        // 按importFlags优化Mesh的所有Primitive，不同的Mesh可以在多个线程中同时处理
+        void OptimizeMesh(DVKMesh* mesh, DVKMeshOptimizeStats& stats);
+
+        // 所有Primitive共用一个Staging，一次提交
+        void UploadPrimitives();
+
+        // 顶点与索引分别拼接进一个Buffer，索引保持Primitive内的局部值，由vertexOffset偏移
+        void UploadMergedPrimitives();
+
+        void GenerateIndirectCommands(const uint8* visibility);
 
         void LoadBones(const aiScene* aiScene);
 
-        void LoadSkin(std::unordered_map<uint32, DVKVertexSkin>& skinInfoMap, DVKMesh* mesh, const aiMesh* aiMesh, const aiScene* aiScene);
+        void LoadSkin(std::vector<DVKVertexSkin>& skinInfos, DVKMesh* mesh, const aiMesh* aiMesh, const aiScene* aiScene);
 
-        void LoadVertexDatas(std::unordered_map<uint32, DVKVertexSkin>& skinInfoMap, std::vector<float>& vertices, Vector3& mmax, Vector3& mmin, DVKMesh* mesh, const aiMesh* aiMesh, const aiScene* aiScene);
+        void LoadVertexDatas(std::vector<DVKVertexSkin>& skinInfos, std::vector<float>& vertices, Vector3& mmax, Vector3& mmin, const Vector3& defaultColor, DVKMesh* mesh, const aiMesh* aiMesh, const aiScene* aiScene);
 
         void LoadIndices(std::vector<uint32>& indices, const aiMesh* aiMesh, const aiScene* aiScene);
 
@@ -455,6 +652,12 @@ namespace vk_demo
 
         void LoadAnim(const aiScene* aiScene);
 
+        // 按先序重建linearNodes并分配变换所需的数组，节点层级确定之后调用
+        void LinkTransforms();
+
+        // MIF_CompressAnimation时压缩所有动画，需要在写入缓存之后调用
+        void CompressAnimations(const std::string& filename);
+
     public:
         typedef std::unordered_map<std::string, DVKNode*> NodesMap;
         typedef std::unordered_map<std::string, DVKBone*> BonesMap;
@@ -462,7 +665,11 @@ namespace vk_demo
         std::shared_ptr<VulkanDevice>   device;
 
         DVKNode*                        rootNode;
+        // 先序排列，父节点总在子节点之前
         std::vector<DVKNode*>           linearNodes;
+        // 与linearNodes一一对应，根节点的父节点为-1
+        std::vector<int32>              nodeParents;
+        std::vector<Matrix4x4>          globalMatrices;
         std::vector<DVKMesh*>           meshes;
 
         NodesMap                        nodesMap;
@@ -474,10 +681,30 @@ namespace vk_demo
         std::vector<DVKAnimation>       animations;
         int32                           animIndex = -1;
 
+        uint32                          importFlags = MIF_None;
+        // MIF_OptimizeMesh导入时的统计，从缓存读取时为空
+        DVKMeshOptimizeStats            optimizeStats;
+        // MIF_CompressAnimation压缩所有动画的统计
+        DVKAnimationCompressStats       animCompressStats;
+
+        // MIF_MergeBuffers时所有Primitive共用
+        DVKVertexBuffer*                vertexBuffer = nullptr;
+        DVKIndexBuffer*                 indexBuffer = nullptr;
+        DVKBuffer*                      indirectBuffer = nullptr;
+        std::vector<VkDrawIndexedIndirectCommand> indirectCommands;
+
     private:
 
         DVKCommandBuffer*               cmdBuffer = nullptr;
         bool                            loadSkin = false;
+
+        // 上次计算时的localMatrix，直接修改localMatrix的代码不需要设置标记
+        std::vector<Matrix4x4>          cachedLocals;
+        // 本次遍历中更新过的节点，子节点据此更新
+        std::vector<uint8>              nodeDirty;
+        bool                            transformsValid = false;
+        // 每个Bone对应节点在linearNodes中的索引
+        std::vector<int32>              boneNodes;
     };
 
 }
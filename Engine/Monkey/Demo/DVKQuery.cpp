@@ -0,0 +1,171 @@
+﻿#include "DVKQuery.h"
+
+#include "Common/Log.h"
+#include "Math/Math.h"
+
+#include <cstring>
+
+namespace vk_demo
+{
+
+    DVKQueryPool::~DVKQueryPool()
+    {
+        if (queryPool != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(vulkanDevice->GetInstanceHandle(), queryPool, VULKAN_CPU_ALLOCATOR);
+            queryPool = VK_NULL_HANDLE;
+        }
+
+        slices.clear();
+        results.clear();
+        resultFrames.clear();
+        readback.clear();
+
+        vulkanDevice = nullptr;
+    }
+
+    DVKQueryPool* DVKQueryPool::Create(std::shared_ptr<VulkanDevice> vulkanDevice, VkQueryType queryType, uint32 queryCount, uint32 frameCount, VkQueryPipelineStatisticFlags statistics, uint64 defaultValue)
+    {
+        DVKQueryPool* pool = new DVKQueryPool();
+        pool->vulkanDevice   = vulkanDevice;
+        pool->queryType      = queryType;
+        pool->queryCount     = queryCount;
+        pool->frameCount     = MMath::Max<uint32>(frameCount, 1);
+        pool->valuesPerQuery = queryType == VK_QUERY_TYPE_PIPELINE_STATISTICS ? MMath::CountBits(statistics) : 1;
+        pool->timestampPeriod = vulkanDevice->GetLimits().timestampPeriod;
+
+        if (vulkanDevice->IsHostQueryResetSupported())
+        {
+            pool->vkResetQueryPoolFunc = (PFN_vkResetQueryPoolEXT)vkGetDeviceProcAddr(vulkanDevice->GetInstanceHandle(), "vkResetQueryPoolEXT");
+        }
+
+        // 每帧一段，总数量为queryCount * frameCount
+        VkQueryPoolCreateInfo queryPoolCreateInfo;
+        ZeroVulkanStruct(queryPoolCreateInfo, VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO);
+        queryPoolCreateInfo.queryType  = queryType;
+        queryPoolCreateInfo.queryCount = queryCount * pool->frameCount;
+        queryPoolCreateInfo.pipelineStatistics = statistics;
+        VERIFYVULKANRESULT(vkCreateQueryPool(vulkanDevice->GetInstanceHandle(), &queryPoolCreateInfo, VULKAN_CPU_ALLOCATOR, &(pool->queryPool)));
+
+        pool->slices.resize(pool->frameCount);
+        pool->results.resize(queryCount * pool->valuesPerQuery, defaultValue);
+        pool->resultFrames.resize(queryCount, 0);
+        // 每个Query的结果后面跟一个Availability
+        pool->readback.resize(queryCount * (pool->valuesPerQuery + 1));
+
+        return pool;
+    }
+
+    void DVKQueryPool::BeginFrame(VkCommandBuffer commandBuffer, int32 frameIndex)
+    {
+        frameCounter += 1;
+        currentSlice  = frameIndex % frameCount;
+
+        // 该slice即将被重置，调用者已经等待过该帧的Fence，最后回收一次结果
+        QuerySlice& slice = slices[currentSlice];
+        if (slice.pending)
+        {
+            Harvest(currentSlice);
+        }
+
+        // CPU端重置立即生效，Poll不会把上一次的结果当成这一帧的结果
+        if (vkResetQueryPoolFunc)
+        {
+            vkResetQueryPoolFunc(vulkanDevice->GetInstanceHandle(), queryPool, currentSlice * queryCount, queryCount);
+        }
+        else
+        {
+            vkCmdResetQueryPool(commandBuffer, queryPool, currentSlice * queryCount, queryCount);
+        }
+
+        slice.frame   = frameCounter;
+        slice.pending = true;
+    }
+
+    void DVKQueryPool::BeginQuery(VkCommandBuffer commandBuffer, uint32 index, VkQueryControlFlags flags)
+    {
+        vkCmdBeginQuery(commandBuffer, queryPool, currentSlice * queryCount + index, flags);
+    }
+
+    void DVKQueryPool::EndQuery(VkCommandBuffer commandBuffer, uint32 index)
+    {
+        vkCmdEndQuery(commandBuffer, queryPool, currentSlice * queryCount + index);
+    }
+
+    void DVKQueryPool::WriteTimestamp(VkCommandBuffer commandBuffer, uint32 index, VkPipelineStageFlagBits stage)
+    {
+        vkCmdWriteTimestamp(commandBuffer, stage, queryPool, currentSlice * queryCount + index);
+    }
+
+    bool DVKQueryPool::Poll()
+    {
+        // 在CommandBuffer中重置的slice，GPU执行到重置之前读到的是上一次的结果
+        if (vkResetQueryPoolFunc == nullptr)
+        {
+            return false;
+        }
+
+        bool updated = false;
+
+        // 按帧号从旧到新回收，新结果覆盖旧结果
+        for (uint64 frame = frameCounter >= frameCount ? frameCounter - frameCount + 1 : 1; frame <= frameCounter; ++frame)
+        {
+            for (int32 i = 0; i < slices.size(); ++i)
+            {
+                if (slices[i].pending && slices[i].frame == frame)
+                {
+                    updated = Harvest(i) || updated;
+                }
+            }
+        }
+
+        return updated;
+    }
+
+    bool DVKQueryPool::Harvest(int32 sliceIndex)
+    {
+        QuerySlice& slice = slices[sliceIndex];
+
+        // 不等待，只读取Availability已经置位的Query
+        uint32 stride = sizeof(uint64) * (valuesPerQuery + 1);
+        VkResult result = vkGetQueryPoolResults(
+            vulkanDevice->GetInstanceHandle(),
+            queryPool,
+            sliceIndex * queryCount,
+            queryCount,
+            stride * queryCount,
+            readback.data(),
+            stride,
+            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
+        );
+
+        if (result != VK_SUCCESS && result != VK_NOT_READY)
+        {
+            MLOGE("Failed get query pool results : %d", (int32)result);
+            return false;
+        }
+
+        bool updated = false;
+        for (uint32 i = 0; i < queryCount; ++i)
+        {
+            const uint64* data = readback.data() + i * (valuesPerQuery + 1);
+            if (data[valuesPerQuery] == 0 || resultFrames[i] > slice.frame)
+            {
+                continue;
+            }
+
+            memcpy(results.data() + i * valuesPerQuery, data, sizeof(uint64) * valuesPerQuery);
+            resultFrames[i] = slice.frame;
+            updated = true;
+        }
+
+        // 所有Query都已经返回，该slice无需再轮询
+        if (result == VK_SUCCESS)
+        {
+            slice.pending = false;
+        }
+
+        return updated;
+    }
+
+}
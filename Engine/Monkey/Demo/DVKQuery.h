@@ -0,0 +1,121 @@
+﻿#pragma once
+
+#include <vector>
+#include <memory>
+
+#include "Common/Common.h"
+#include "Vulkan/VulkanCommon.h"
+#include "Vulkan/VulkanDevice.h"
+#include "Math/Math.h"
+
+namespace vk_demo
+{
+    // 异步Query管理器：每帧独占QueryPool的一段(slice)，通过Availability位轮询结果，
+    // 结果通常延迟1~2帧返回，未返回的Query保留上一次的结果。
+    // 支持VK_EXT_host_query_reset时在CPU端重置slice，否则重置要等到GPU执行，
+    // 之前的Availability仍然有效，此时只在BeginFrame中(Fence已经等待)回收结果。
+    class DVKQueryPool
+    {
+    private:
+
+        struct QuerySlice
+        {
+            uint64  frame   = 0;
+            bool    pending = false;
+        };
+
+        DVKQueryPool()
+        {
+
+        }
+
+    public:
+
+        ~DVKQueryPool();
+
+        static DVKQueryPool* Create(std::shared_ptr<VulkanDevice> vulkanDevice, VkQueryType queryType, uint32 queryCount, uint32 frameCount, VkQueryPipelineStatisticFlags statistics = 0, uint64 defaultValue = 0);
+
+        // 开始新的一帧：先回收该slice上一次的结果，再重置该slice。
+        void BeginFrame(VkCommandBuffer commandBuffer, int32 frameIndex);
+
+        void BeginQuery(VkCommandBuffer commandBuffer, uint32 index, VkQueryControlFlags flags = 0);
+
+        void EndQuery(VkCommandBuffer commandBuffer, uint32 index);
+
+        // 时间戳Query，在stage执行完毕时写入GPU时钟
+        void WriteTimestamp(VkCommandBuffer commandBuffer, uint32 index, VkPipelineStageFlagBits stage);
+
+        // 非阻塞轮询所有已提交的slice，返回是否有新结果。不支持CPU端重置时不做任何事情
+        bool Poll();
+
+        FORCE_INLINE uint64 GetResult(uint32 index, uint32 valueIndex = 0) const
+        {
+            return results[index * valuesPerQuery + valueIndex];
+        }
+
+        FORCE_INLINE const uint64* GetResults(uint32 index) const
+        {
+            return results.data() + index * valuesPerQuery;
+        }
+
+        // 结果对应的帧号，0表示尚未获得任何结果
+        FORCE_INLINE uint64 GetResultFrame(uint32 index) const
+        {
+            return resultFrames[index];
+        }
+
+        // 结果落后当前帧的帧数
+        FORCE_INLINE uint64 GetResultLatency(uint32 index) const
+        {
+            return resultFrames[index] == 0 ? frameCounter : frameCounter - resultFrames[index];
+        }
+
+        // 时间戳转换为毫秒，需要与其它时间戳相减得到耗时
+        FORCE_INLINE double GetTimestampMS(uint32 index) const
+        {
+            return (double)(results[index] & timestampMask) * timestampPeriod / 1000000.0;
+        }
+
+        FORCE_INLINE uint32 GetValuesPerQuery() const
+        {
+            return valuesPerQuery;
+        }
+
+        FORCE_INLINE VkQueryPool GetHandle() const
+        {
+            return queryPool;
+        }
+
+    private:
+
+        bool Harvest(int32 sliceIndex);
+
+    public:
+
+        std::shared_ptr<VulkanDevice>   vulkanDevice;
+
+        VkQueryPool                     queryPool = VK_NULL_HANDLE;
+        VkQueryType                     queryType = VK_QUERY_TYPE_OCCLUSION;
+        uint32                          queryCount = 0;
+        uint32                          frameCount = 0;
+        uint32                          valuesPerQuery = 1;
+
+        // 时间戳的有效位数取决于提交的队列族
+        uint64                          timestampMask = MAX_uint64;
+        float                           timestampPeriod = 1.0f;
+
+        uint64                          frameCounter = 0;
+        int32                           currentSlice = -1;
+
+        std::vector<QuerySlice>         slices;
+        std::vector<uint64>             results;
+        std::vector<uint64>             resultFrames;
+
+    private:
+
+        std::vector<uint64>             readback;
+
+        PFN_vkResetQueryPoolEXT         vkResetQueryPoolFunc = nullptr;
+    };
+
+}
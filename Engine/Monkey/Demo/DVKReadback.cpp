@@ -0,0 +1,333 @@
+﻿#include "DVKReadback.h"
+
+#include "Vulkan/VulkanDevice.h"
+#include "Vulkan/VulkanQueue.h"
+
+#include "Math/Math.h"
+
+namespace vk_demo
+{
+
+    DVKReadback::~DVKReadback()
+    {
+        VkDevice device = vulkanDevice->GetInstanceHandle();
+
+        Flush();
+
+        for (int32 i = 0; i < slots.size(); ++i)
+        {
+            ReadbackSlot& slot = slots[i];
+            if (slot.buffer)
+            {
+                slot.buffer->UnMap();
+                delete slot.buffer;
+                slot.buffer = nullptr;
+            }
+            if (slot.fence != VK_NULL_HANDLE)
+            {
+                vkDestroyFence(device, slot.fence, VULKAN_CPU_ALLOCATOR);
+            }
+        }
+        slots.clear();
+
+        // 销毁CommandPool时会释放所有的CommandBuffer
+        vkDestroyCommandPool(device, commandPool, VULKAN_CPU_ALLOCATOR);
+        commandPool = VK_NULL_HANDLE;
+
+        queue = nullptr;
+        scheduler = nullptr;
+        vulkanDevice = nullptr;
+    }
+
+    bool DVKReadback::IsHostCachedSupported(std::shared_ptr<VulkanDevice> vulkanDevice)
+    {
+        const VkPhysicalDeviceMemoryProperties& memoryProperties = vulkanDevice->GetMemoryManager().GetMemoryProperties();
+        VkMemoryPropertyFlags flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+
+        for (uint32 i = 0; i < memoryProperties.memoryTypeCount; ++i)
+        {
+            if ((memoryProperties.memoryTypes[i].propertyFlags & flags) == flags)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    DVKReadback* DVKReadback::Create(std::shared_ptr<VulkanDevice> vulkanDevice, std::shared_ptr<VulkanQueue> queue)
+    {
+        DVKReadback* readback = new DVKReadback();
+        readback->vulkanDevice = vulkanDevice;
+        readback->queue        = queue ? queue : vulkanDevice->GetGraphicsQueue();
+
+        // CPU读取使用Cached内存速度更快，不支持时退回Coherent
+        if (IsHostCachedSupported(vulkanDevice))
+        {
+            readback->memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+        }
+        else
+        {
+            readback->memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        }
+
+        VkCommandPoolCreateInfo poolCreateInfo;
+        ZeroVulkanStruct(poolCreateInfo, VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO);
+        poolCreateInfo.queueFamilyIndex = readback->queue->GetFamilyIndex();
+        poolCreateInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        VERIFYVULKANRESULT(vkCreateCommandPool(vulkanDevice->GetInstanceHandle(), &poolCreateInfo, VULKAN_CPU_ALLOCATOR, &(readback->commandPool)));
+
+        return readback;
+    }
+
+    DVKReadback* DVKReadback::Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKFrameScheduler* scheduler, DVKFrameScheduler::QueueType queueType)
+    {
+        DVKReadback* readback = Create(vulkanDevice, scheduler->GetQueue(queueType));
+        readback->scheduler = scheduler;
+        readback->queueType = queueType;
+        return readback;
+    }
+
+    int32 DVKReadback::AcquireSlot(VkDeviceSize size)
+    {
+        VkDevice device = vulkanDevice->GetInstanceHandle();
+
+        // 优先复用容量足够的空闲slot
+        int32 index = -1;
+        for (int32 i = 0; i < slots.size(); ++i)
+        {
+            if (slots[i].busy)
+            {
+                continue;
+            }
+            if (index == -1 || (slots[i].buffer && slots[i].buffer->size >= size))
+            {
+                index = i;
+            }
+            if (slots[i].buffer && slots[i].buffer->size >= size)
+            {
+                break;
+            }
+        }
+
+        if (index == -1)
+        {
+            ReadbackSlot newSlot;
+
+            VkCommandBufferAllocateInfo cmdBufferAllocateInfo;
+            ZeroVulkanStruct(cmdBufferAllocateInfo, VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO);
+            cmdBufferAllocateInfo.commandPool        = commandPool;
+            cmdBufferAllocateInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            cmdBufferAllocateInfo.commandBufferCount = 1;
+            VERIFYVULKANRESULT(vkAllocateCommandBuffers(device, &cmdBufferAllocateInfo, &(newSlot.cmdBuffer)));
+
+            if (scheduler == nullptr)
+            {
+                VkFenceCreateInfo fenceCreateInfo;
+                ZeroVulkanStruct(fenceCreateInfo, VK_STRUCTURE_TYPE_FENCE_CREATE_INFO);
+                VERIFYVULKANRESULT(vkCreateFence(device, &fenceCreateInfo, VULKAN_CPU_ALLOCATOR, &(newSlot.fence)));
+            }
+
+            slots.push_back(newSlot);
+            index = slots.size() - 1;
+        }
+
+        ReadbackSlot& slot = slots[index];
+        if (slot.buffer == nullptr || slot.buffer->size < size)
+        {
+            if (slot.buffer)
+            {
+                slot.buffer->UnMap();
+                delete slot.buffer;
+            }
+            slot.buffer = DVKBuffer::CreateBuffer(vulkanDevice, VK_BUFFER_USAGE_TRANSFER_DST_BIT, memoryFlags, size);
+            slot.buffer->Map();
+        }
+
+        slot.size = size;
+        slot.busy = true;
+
+        VkCommandBufferBeginInfo cmdBeginInfo;
+        ZeroVulkanStruct(cmdBeginInfo, VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO);
+        cmdBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        VERIFYVULKANRESULT(vkBeginCommandBuffer(slot.cmdBuffer, &cmdBeginInfo));
+
+        return index;
+    }
+
+    void DVKReadback::Submit(int32 index)
+    {
+        ReadbackSlot& slot = slots[index];
+
+        // 拷贝结果对Host可见
+        VkMemoryBarrier memoryBarrier;
+        ZeroVulkanStruct(memoryBarrier, VK_STRUCTURE_TYPE_MEMORY_BARRIER);
+        memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(slot.cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+        VERIFYVULKANRESULT(vkEndCommandBuffer(slot.cmdBuffer));
+
+        VkSubmitInfo submitInfo;
+        ZeroVulkanStruct(submitInfo, VK_STRUCTURE_TYPE_SUBMIT_INFO);
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers    = &slot.cmdBuffer;
+
+        if (scheduler)
+        {
+            slot.value = scheduler->Submit(queueType, &slot.cmdBuffer, 1);
+            return;
+        }
+
+        VERIFYVULKANRESULT(vkResetFences(vulkanDevice->GetInstanceHandle(), 1, &slot.fence));
+        VERIFYVULKANRESULT(vkQueueSubmit(queue->GetHandle(), 1, &submitInfo, slot.fence));
+    }
+
+    void DVKReadback::ReadBuffer(VkBuffer srcBuffer, VkDeviceSize offset, VkDeviceSize size, ReadbackCallback callback, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess)
+    {
+        int32 index = AcquireSlot(size);
+        ReadbackSlot& slot = slots[index];
+        slot.callback = callback;
+
+        // 等待之前提交的写入完成
+        VkMemoryBarrier memoryBarrier;
+        ZeroVulkanStruct(memoryBarrier, VK_STRUCTURE_TYPE_MEMORY_BARRIER);
+        memoryBarrier.srcAccessMask = srcAccess;
+        memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(slot.cmdBuffer, srcStage, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+        VkBufferCopy copyRegion = {};
+        copyRegion.srcOffset = offset;
+        copyRegion.dstOffset = 0;
+        copyRegion.size      = size;
+        vkCmdCopyBuffer(slot.cmdBuffer, srcBuffer, slot.buffer->buffer, 1, &copyRegion);
+
+        Submit(index);
+    }
+
+    void DVKReadback::ReadImage(VkImage srcImage, VkImageLayout layout, VkImageAspectFlags aspect, int32 width, int32 height, uint32 bytesPerPixel, ReadbackCallback callback, int32 mipLevel, int32 arrayLayer)
+    {
+        int32 index = AcquireSlot((VkDeviceSize)width * height * bytesPerPixel);
+        ReadbackSlot& slot = slots[index];
+        slot.callback = callback;
+
+        VkImageSubresourceRange subresourceRange = {};
+        subresourceRange.aspectMask     = aspect;
+        subresourceRange.baseMipLevel   = mipLevel;
+        subresourceRange.levelCount     = 1;
+        subresourceRange.baseArrayLayer = arrayLayer;
+        subresourceRange.layerCount     = 1;
+
+        VkImageMemoryBarrier imageBarrier;
+        ZeroVulkanStruct(imageBarrier, VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER);
+        imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.image               = srcImage;
+        imageBarrier.subresourceRange    = subresourceRange;
+
+        // 转换到TransferSrc
+        if (layout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+        {
+            imageBarrier.oldLayout     = layout;
+            imageBarrier.newLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            imageBarrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+            imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            vkCmdPipelineBarrier(slot.cmdBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+        }
+
+        VkBufferImageCopy copyRegion = {};
+        copyRegion.bufferOffset      = 0;
+        copyRegion.bufferRowLength   = 0;
+        copyRegion.bufferImageHeight = 0;
+        copyRegion.imageSubresource.aspectMask     = aspect;
+        copyRegion.imageSubresource.mipLevel       = mipLevel;
+        copyRegion.imageSubresource.baseArrayLayer = arrayLayer;
+        copyRegion.imageSubresource.layerCount     = 1;
+        copyRegion.imageExtent.width  = width;
+        copyRegion.imageExtent.height = height;
+        copyRegion.imageExtent.depth  = 1;
+        vkCmdCopyImageToBuffer(slot.cmdBuffer, srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer->buffer, 1, &copyRegion);
+
+        // 恢复原有layout
+        if (layout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL && layout != VK_IMAGE_LAYOUT_UNDEFINED)
+        {
+            imageBarrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            imageBarrier.newLayout     = layout;
+            imageBarrier.srcAccessMask = 0;
+            imageBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+            vkCmdPipelineBarrier(slot.cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+        }
+
+        Submit(index);
+    }
+
+    void DVKReadback::Complete(int32 index)
+    {
+        ReadbackSlot& slot = slots[index];
+
+        // 非Coherent内存需要Invalidate之后才能读取到GPU写入的数据
+        if ((memoryFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0)
+        {
+            slot.buffer->Invalidate();
+        }
+
+        ReadbackCallback callback = slot.callback;
+        const void* data = slot.buffer->mapped;
+        VkDeviceSize size = slot.size;
+        slot.callback = nullptr;
+
+        // 回调中可能发起新的回读，回调结束之前slot保持占用
+        if (callback)
+        {
+            callback(data, size);
+        }
+
+        slots[index].busy = false;
+    }
+
+    bool DVKReadback::IsSlotCompleted(int32 index)
+    {
+        if (scheduler)
+        {
+            return scheduler->IsCompleted(queueType, slots[index].value);
+        }
+        return vkGetFenceStatus(vulkanDevice->GetInstanceHandle(), slots[index].fence) == VK_SUCCESS;
+    }
+
+    int32 DVKReadback::Update()
+    {
+        int32 count = 0;
+        for (int32 i = 0; i < slots.size(); ++i)
+        {
+            if (slots[i].busy && IsSlotCompleted(i))
+            {
+                Complete(i);
+                count += 1;
+            }
+        }
+
+        return count;
+    }
+
+    void DVKReadback::Flush()
+    {
+        VkDevice device = vulkanDevice->GetInstanceHandle();
+
+        for (int32 i = 0; i < slots.size(); ++i)
+        {
+            if (slots[i].busy)
+            {
+                if (scheduler)
+                {
+                    scheduler->Wait(queueType, slots[i].value);
+                }
+                else
+                {
+                    vkWaitForFences(device, 1, &slots[i].fence, VK_TRUE, MAX_uint64);
+                }
+                Complete(i);
+            }
+        }
+    }
+
+}
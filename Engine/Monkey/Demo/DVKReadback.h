@@ -0,0 +1,105 @@
+﻿#pragma once
+
+#include "Engine.h"
+
+#include "Common/Common.h"
+#include "Vulkan/VulkanCommon.h"
+
+#include "DVKBuffer.h"
+#include "DVKFrameScheduler.h"
+
+#include <vector>
+#include <memory>
+#include <functional>
+
+class VulkanDevice;
+class VulkanQueue;
+
+namespace vk_demo
+{
+    // 异步回读：将GPU Buffer或Image拷贝到HOST_CACHED的Staging内存，
+    // Fence完成之后在Update中以映射好的内存回调给调用者，不阻塞当前帧。
+    class DVKReadback
+    {
+    public:
+
+        typedef std::function<void(const void* data, VkDeviceSize size)> ReadbackCallback;
+
+    private:
+
+        struct ReadbackSlot
+        {
+            DVKBuffer*          buffer = nullptr;
+            VkCommandBuffer     cmdBuffer = VK_NULL_HANDLE;
+            VkFence             fence = VK_NULL_HANDLE;
+            uint64              value = 0;
+            VkDeviceSize        size = 0;
+            ReadbackCallback    callback;
+            bool                busy = false;
+        };
+
+        DVKReadback()
+        {
+
+        }
+
+    public:
+
+        ~DVKReadback();
+
+        static DVKReadback* Create(std::shared_ptr<VulkanDevice> vulkanDevice, std::shared_ptr<VulkanQueue> queue = nullptr);
+
+        // 通过调度器提交，使用timeline值代替Fence
+        static DVKReadback* Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKFrameScheduler* scheduler, DVKFrameScheduler::QueueType queueType = DVKFrameScheduler::QueueType::Graphics);
+
+        static bool IsHostCachedSupported(std::shared_ptr<VulkanDevice> vulkanDevice);
+
+        // srcStage/srcAccess描述数据最后一次被写入的位置
+        void ReadBuffer(VkBuffer srcBuffer, VkDeviceSize offset, VkDeviceSize size, ReadbackCallback callback, VkPipelineStageFlags srcStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VkAccessFlags srcAccess = VK_ACCESS_MEMORY_WRITE_BIT);
+
+        // Image在回读前后都保持layout不变
+        void ReadImage(VkImage srcImage, VkImageLayout layout, VkImageAspectFlags aspect, int32 width, int32 height, uint32 bytesPerPixel, ReadbackCallback callback, int32 mipLevel = 0, int32 arrayLayer = 0);
+
+        // 非阻塞检查完成的回读并触发回调，返回完成的数量
+        int32 Update();
+
+        // 阻塞等待所有回读完成
+        void Flush();
+
+        FORCE_INLINE int32 GetInFlightCount() const
+        {
+            int32 count = 0;
+            for (int32 i = 0; i < slots.size(); ++i)
+            {
+                count += slots[i].busy ? 1 : 0;
+            }
+            return count;
+        }
+
+    private:
+
+        int32 AcquireSlot(VkDeviceSize size);
+
+        void Submit(int32 index);
+
+        void Complete(int32 index);
+
+        bool IsSlotCompleted(int32 index);
+
+    public:
+
+        std::shared_ptr<VulkanDevice>   vulkanDevice = nullptr;
+        std::shared_ptr<VulkanQueue>    queue = nullptr;
+
+        VkCommandPool                   commandPool = VK_NULL_HANDLE;
+        VkMemoryPropertyFlags           memoryFlags = 0;
+
+        DVKFrameScheduler*              scheduler = nullptr;
+        DVKFrameScheduler::QueueType    queueType = DVKFrameScheduler::QueueType::Graphics;
+
+    private:
+
+        std::vector<ReadbackSlot>       slots;
+    };
+
+}
@@ -0,0 +1,629 @@
+﻿#include "DVKSceneBVH.h"
+#include "DVKCamera.h"
+
+#include <algorithm>
+
+// 重建时沿最长轴划分的桶数量
+#define BVH_SAH_BINS        16
+// 遍历栈的初始容量
+#define BVH_STACK_SIZE      64
+
+namespace vk_demo
+{
+    static FORCE_INLINE float SurfaceArea(const Vector3& min, const Vector3& max)
+    {
+        Vector3 d = max - min;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    static FORCE_INLINE float UnionArea(const Vector3& minA, const Vector3& maxA, const Vector3& minB, const Vector3& maxB)
+    {
+        return SurfaceArea(Vector3::Min(minA, minB), Vector3::Max(maxA, maxB));
+    }
+
+    // 射线与AABB的进入距离，不相交或者进入距离超过maxDist时返回false
+    static FORCE_INLINE bool IntersectRayBox(const Vector3& origin, const Vector3& invDir, const Vector3& min, const Vector3& max, float maxDist, float& outEnter)
+    {
+        float t1 = (min.x - origin.x) * invDir.x;
+        float t2 = (max.x - origin.x) * invDir.x;
+        float tmin = MMath::Min(t1, t2);
+        float tmax = MMath::Max(t1, t2);
+
+        t1 = (min.y - origin.y) * invDir.y;
+        t2 = (max.y - origin.y) * invDir.y;
+        tmin = MMath::Max(tmin, MMath::Min(t1, t2));
+        tmax = MMath::Min(tmax, MMath::Max(t1, t2));
+
+        t1 = (min.z - origin.z) * invDir.z;
+        t2 = (max.z - origin.z) * invDir.z;
+        tmin = MMath::Max(tmin, MMath::Min(t1, t2));
+        tmax = MMath::Min(tmax, MMath::Max(t1, t2));
+
+        outEnter = MMath::Max(tmin, 0.0f);
+        return outEnter <= MMath::Min(tmax, maxDist);
+    }
+
+    int32 DVKSceneBVH::AllocateNode()
+    {
+        int32 node = freeNode;
+        if (node >= 0)
+        {
+            freeNode = nodes[node].left;
+            nodes[node] = Node();
+        }
+        else
+        {
+            node = (int32)nodes.size();
+            nodes.push_back(Node());
+        }
+        return node;
+    }
+
+    void DVKSceneBVH::FreeNode(int32 node)
+    {
+        nodes[node].left  = freeNode;
+        nodes[node].proxy = -1;
+        freeNode = node;
+    }
+
+    int32 DVKSceneBVH::AddProxy(const Vector3& min, const Vector3& max, void* userData)
+    {
+        int32 proxy = freeProxy;
+        if (proxy >= 0)
+        {
+            freeProxy = proxies[proxy].nextFree;
+        }
+        else
+        {
+            proxy = (int32)proxies.size();
+            proxies.push_back(Proxy());
+        }
+
+        int32 leaf = AllocateNode();
+        nodes[leaf].min   = min;
+        nodes[leaf].max   = max;
+        nodes[leaf].proxy = proxy;
+
+        proxies[proxy].userData = userData;
+        proxies[proxy].leaf     = leaf;
+        proxies[proxy].nextFree = -1;
+        proxies[proxy].moved    = false;
+        proxyCount += 1;
+
+        InsertLeaf(leaf);
+
+        return proxy;
+    }
+
+    void DVKSceneBVH::RemoveProxy(int32 proxy)
+    {
+        int32 leaf = proxies[proxy].leaf;
+        RemoveLeaf(leaf);
+        FreeNode(leaf);
+
+        // movedProxies中的记录在Update时跳过
+        proxies[proxy].userData = nullptr;
+        proxies[proxy].leaf     = -1;
+        proxies[proxy].nextFree = freeProxy;
+        freeProxy   = proxy;
+        proxyCount -= 1;
+    }
+
+    void DVKSceneBVH::MoveProxy(int32 proxy, const Vector3& min, const Vector3& max)
+    {
+        Node& leaf = nodes[proxies[proxy].leaf];
+        leaf.min = min;
+        leaf.max = max;
+
+        if (!proxies[proxy].moved)
+        {
+            proxies[proxy].moved = true;
+            movedProxies.push_back(proxy);
+        }
+    }
+
+    void DVKSceneBVH::InsertLeaf(int32 leaf)
+    {
+        if (root < 0)
+        {
+            root = leaf;
+            nodes[leaf].parent = -1;
+            return;
+        }
+
+        const Vector3 leafMin = nodes[leaf].min;
+        const Vector3 leafMax = nodes[leaf].max;
+
+        // 向下寻找插入之后代价增加最少的兄弟节点
+        int32 index = root;
+        while (nodes[index].proxy < 0)
+        {
+            const Node& node = nodes[index];
+            float area         = SurfaceArea(node.min, node.max);
+            float combinedArea = UnionArea(node.min, node.max, leafMin, leafMax);
+
+            // 在这里创建新的父节点的代价，以及继续向下时祖先增加的代价
+            float costHere    = 2.0f * combinedArea;
+            float inheritance = 2.0f * (combinedArea - area);
+
+            float childCost[2];
+            int32 children[2] = { node.left, node.right };
+            for (int32 i = 0; i < 2; ++i)
+            {
+                const Node& child = nodes[children[i]];
+                float childArea = UnionArea(child.min, child.max, leafMin, leafMax);
+                if (child.proxy < 0)
+                {
+                    childArea -= SurfaceArea(child.min, child.max);
+                }
+                childCost[i] = childArea + inheritance;
+            }
+
+            if (costHere < childCost[0] && costHere < childCost[1])
+            {
+                break;
+            }
+
+            index = childCost[0] < childCost[1] ? children[0] : children[1];
+        }
+
+        int32 sibling   = index;
+        int32 oldParent = nodes[sibling].parent;
+        int32 newParent = AllocateNode();
+
+        nodes[newParent].parent = oldParent;
+        nodes[newParent].min    = Vector3::Min(nodes[sibling].min, leafMin);
+        nodes[newParent].max    = Vector3::Max(nodes[sibling].max, leafMax);
+        nodes[newParent].left   = sibling;
+        nodes[newParent].right  = leaf;
+        nodes[sibling].parent   = newParent;
+        nodes[leaf].parent      = newParent;
+        cost += SurfaceArea(nodes[newParent].min, nodes[newParent].max);
+
+        if (oldParent < 0)
+        {
+            root = newParent;
+        }
+        else
+        {
+            if (nodes[oldParent].left == sibling)
+            {
+                nodes[oldParent].left = newParent;
+            }
+            else
+            {
+                nodes[oldParent].right = newParent;
+            }
+            RefitAncestors(oldParent);
+        }
+    }
+
+    void DVKSceneBVH::RemoveLeaf(int32 leaf)
+    {
+        if (leaf == root)
+        {
+            root = -1;
+            return;
+        }
+
+        int32 parent      = nodes[leaf].parent;
+        int32 grandParent = nodes[parent].parent;
+        int32 sibling     = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+        cost -= SurfaceArea(nodes[parent].min, nodes[parent].max);
+
+        if (grandParent < 0)
+        {
+            root = sibling;
+            nodes[sibling].parent = -1;
+            FreeNode(parent);
+            return;
+        }
+
+        if (nodes[grandParent].left == parent)
+        {
+            nodes[grandParent].left = sibling;
+        }
+        else
+        {
+            nodes[grandParent].right = sibling;
+        }
+        nodes[sibling].parent = grandParent;
+        FreeNode(parent);
+
+        RefitAncestors(grandParent);
+    }
+
+    void DVKSceneBVH::RefitAncestors(int32 index)
+    {
+        while (index >= 0)
+        {
+            Node& node = nodes[index];
+            const Node& left  = nodes[node.left];
+            const Node& right = nodes[node.right];
+
+            Vector3 newMin = Vector3::Min(left.min, right.min);
+            Vector3 newMax = Vector3::Max(left.max, right.max);
+            if (newMin == node.min && newMax == node.max)
+            {
+                return;
+            }
+
+            cost += SurfaceArea(newMin, newMax) - SurfaceArea(node.min, node.max);
+            node.min = newMin;
+            node.max = newMax;
+
+            index = node.parent;
+        }
+    }
+
+    void DVKSceneBVH::Update()
+    {
+        for (int32 i = 0; i < movedProxies.size(); ++i)
+        {
+            Proxy& proxy = proxies[movedProxies[i]];
+            if (!proxy.moved || proxy.leaf < 0)
+            {
+                continue;
+            }
+            proxy.moved = false;
+            RefitAncestors(nodes[proxy.leaf].parent);
+        }
+        movedProxies.clear();
+
+        // 首次批量添加之后，或者移动使得包围盒大量重叠之后重建
+        if (proxyCount > 2 && (builtCost < 0.0f || cost > builtCost * rebuildRatio))
+        {
+            Rebuild();
+        }
+    }
+
+    void DVKSceneBVH::Rebuild()
+    {
+        std::vector<int32> leaves;
+        leaves.reserve(proxyCount);
+
+        std::vector<Node> oldNodes;
+        oldNodes.swap(nodes);
+        nodes.reserve(proxyCount * 2);
+        freeNode = -1;
+        cost     = 0.0f;
+
+        for (int32 i = 0; i < proxies.size(); ++i)
+        {
+            Proxy& proxy = proxies[i];
+            if (proxy.leaf < 0)
+            {
+                continue;
+            }
+
+            int32 leaf = AllocateNode();
+            nodes[leaf].min   = oldNodes[proxy.leaf].min;
+            nodes[leaf].max   = oldNodes[proxy.leaf].max;
+            nodes[leaf].proxy = i;
+            proxy.leaf  = leaf;
+            proxy.moved = false;
+            leaves.push_back(leaf);
+        }
+        movedProxies.clear();
+
+        root = leaves.size() > 0 ? BuildRange(leaves.data(), (int32)leaves.size(), -1) : -1;
+
+        builtCost     = cost;
+        rebuildCount += 1;
+    }
+
+    int32 DVKSceneBVH::BuildRange(int32* leaves, int32 count, int32 parent)
+    {
+        if (count == 1)
+        {
+            nodes[leaves[0]].parent = parent;
+            return leaves[0];
+        }
+
+        // 按包围盒中心沿最长轴划分
+        Vector3 centerMin( MAX_FLT,  MAX_FLT,  MAX_FLT);
+        Vector3 centerMax(-MAX_FLT, -MAX_FLT, -MAX_FLT);
+        for (int32 i = 0; i < count; ++i)
+        {
+            const Node& leaf = nodes[leaves[i]];
+            Vector3 center = (leaf.min + leaf.max) * 0.5f;
+            centerMin = Vector3::Min(centerMin, center);
+            centerMax = Vector3::Max(centerMax, center);
+        }
+
+        Vector3 extent = centerMax - centerMin;
+        int32 axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+        float axisMin    = centerMin[axis];
+        float axisExtent = extent[axis];
+
+        int32 mid = count / 2;
+
+        if (axisExtent > 0.0f)
+        {
+            int32   binCount[BVH_SAH_BINS] = { 0 };
+            Vector3 binMin[BVH_SAH_BINS];
+            Vector3 binMax[BVH_SAH_BINS];
+            for (int32 i = 0; i < BVH_SAH_BINS; ++i)
+            {
+                binMin[i].Set( MAX_FLT,  MAX_FLT,  MAX_FLT);
+                binMax[i].Set(-MAX_FLT, -MAX_FLT, -MAX_FLT);
+            }
+
+            const float binScale = BVH_SAH_BINS / axisExtent;
+            auto GetBin = [&](int32 leafIndex) -> int32 {
+                const Node& leaf = nodes[leafIndex];
+                float center = (leaf.min[axis] + leaf.max[axis]) * 0.5f;
+                return MMath::Min<int32>((int32)((center - axisMin) * binScale), BVH_SAH_BINS - 1);
+            };
+
+            for (int32 i = 0; i < count; ++i)
+            {
+                int32 bin = GetBin(leaves[i]);
+                binCount[bin] += 1;
+                binMin[bin] = Vector3::Min(binMin[bin], nodes[leaves[i]].min);
+                binMax[bin] = Vector3::Max(binMax[bin], nodes[leaves[i]].max);
+            }
+
+            // 从右向左累计右侧的代价，再从左向右寻找最小的划分
+            float   rightCost[BVH_SAH_BINS];
+            Vector3 accMin( MAX_FLT,  MAX_FLT,  MAX_FLT);
+            Vector3 accMax(-MAX_FLT, -MAX_FLT, -MAX_FLT);
+            int32   accCount = 0;
+            for (int32 i = BVH_SAH_BINS - 1; i > 0; --i)
+            {
+                accMin    = Vector3::Min(accMin, binMin[i]);
+                accMax    = Vector3::Max(accMax, binMax[i]);
+                accCount += binCount[i];
+                rightCost[i] = accCount > 0 ? SurfaceArea(accMin, accMax) * accCount : 0.0f;
+            }
+
+            int32 bestSplit = -1;
+            float bestCost  = MAX_FLT;
+            accMin.Set( MAX_FLT,  MAX_FLT,  MAX_FLT);
+            accMax.Set(-MAX_FLT, -MAX_FLT, -MAX_FLT);
+            accCount = 0;
+            for (int32 i = 1; i < BVH_SAH_BINS; ++i)
+            {
+                accMin    = Vector3::Min(accMin, binMin[i - 1]);
+                accMax    = Vector3::Max(accMax, binMax[i - 1]);
+                accCount += binCount[i - 1];
+                if (accCount == 0 || accCount == count)
+                {
+                    continue;
+                }
+
+                float splitCost = SurfaceArea(accMin, accMax) * accCount + rightCost[i];
+                if (splitCost < bestCost)
+                {
+                    bestCost  = splitCost;
+                    bestSplit = i;
+                }
+            }
+
+            if (bestSplit > 0)
+            {
+                int32* split = std::partition(leaves, leaves + count, [&](int32 leafIndex) { return GetBin(leafIndex) < bestSplit; });
+                mid = (int32)(split - leaves);
+            }
+        }
+
+        // 中心重合时按数量平分
+        if (mid <= 0 || mid >= count)
+        {
+            mid = count / 2;
+        }
+
+        int32 node  = AllocateNode();
+        int32 left  = BuildRange(leaves, mid, node);
+        int32 right = BuildRange(leaves + mid, count - mid, node);
+
+        nodes[node].parent = parent;
+        nodes[node].left   = left;
+        nodes[node].right  = right;
+        nodes[node].min    = Vector3::Min(nodes[left].min, nodes[right].min);
+        nodes[node].max    = Vector3::Max(nodes[left].max, nodes[right].max);
+        cost += SurfaceArea(nodes[node].min, nodes[node].max);
+
+        return node;
+    }
+
+    void DVKSceneBVH::Clear()
+    {
+        nodes.clear();
+        proxies.clear();
+        movedProxies.clear();
+
+        root       = -1;
+        freeNode   = -1;
+        freeProxy  = -1;
+        proxyCount = 0;
+        cost       = 0.0f;
+        builtCost  = -1.0f;
+    }
+
+    void DVKSceneBVH::QueryFrustum(const DVKFrustum& frustum, std::vector<int32>& outProxies) const
+    {
+        outProxies.clear();
+        if (root < 0)
+        {
+            return;
+        }
+
+        // 每个节点记录仍需测试的平面
+        std::vector<int32> stack;
+        stack.reserve(BVH_STACK_SIZE * 2);
+        stack.push_back(root);
+        stack.push_back((1 << DVKFrustum::FP_Count) - 1);
+
+        while (stack.size() > 0)
+        {
+            int32 mask  = stack.back(); stack.pop_back();
+            int32 index = stack.back(); stack.pop_back();
+            const Node& node = nodes[index];
+
+            bool outside = false;
+            for (int32 i = 0; i < DVKFrustum::FP_Count && mask != 0; ++i)
+            {
+                if ((mask & (1 << i)) == 0)
+                {
+                    continue;
+                }
+
+                // 沿法线最远以及最近的角点
+                const Plane& plane = frustum.planes[i];
+                Vector3 farthest(plane.x >= 0.0f ? node.max.x : node.min.x, plane.y >= 0.0f ? node.max.y : node.min.y, plane.z >= 0.0f ? node.max.z : node.min.z);
+                if (plane.PlaneDot(farthest) < 0.0f)
+                {
+                    outside = true;
+                    break;
+                }
+
+                Vector3 nearest(plane.x >= 0.0f ? node.min.x : node.max.x, plane.y >= 0.0f ? node.min.y : node.max.y, plane.z >= 0.0f ? node.min.z : node.max.z);
+                if (plane.PlaneDot(nearest) >= 0.0f)
+                {
+                    mask &= ~(1 << i);
+                }
+            }
+
+            if (outside)
+            {
+                continue;
+            }
+
+            if (node.proxy >= 0)
+            {
+                outProxies.push_back(node.proxy);
+            }
+            else
+            {
+                stack.push_back(node.left);
+                stack.push_back(mask);
+                stack.push_back(node.right);
+                stack.push_back(mask);
+            }
+        }
+    }
+
+    void DVKSceneBVH::QuerySphere(const Vector3& center, float radius, std::vector<int32>& outProxies) const
+    {
+        outProxies.clear();
+        if (root < 0)
+        {
+            return;
+        }
+
+        const float radiusSquared = radius * radius;
+
+        std::vector<int32> stack;
+        stack.reserve(BVH_STACK_SIZE);
+        stack.push_back(root);
+
+        while (stack.size() > 0)
+        {
+            const Node& node = nodes[stack.back()];
+            stack.pop_back();
+
+            // 球心到AABB的最近距离
+            Vector3 closest = Vector3::Max(node.min, Vector3::Min(center, node.max));
+            if ((closest - center).SizeSquared() > radiusSquared)
+            {
+                continue;
+            }
+
+            if (node.proxy >= 0)
+            {
+                outProxies.push_back(node.proxy);
+            }
+            else
+            {
+                stack.push_back(node.left);
+                stack.push_back(node.right);
+            }
+        }
+    }
+
+    int32 DVKSceneBVH::RayCast(const Vector3& origin, const Vector3& direction, float maxDist, const RayCallback& callback, float* outDist) const
+    {
+        if (root < 0)
+        {
+            return -1;
+        }
+
+        // 分量为0时得到无穷大，slab测试仍然成立
+        const Vector3 invDir(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+        struct StackEntry
+        {
+            int32   node;
+            float   enter;
+        };
+
+        float bestDist  = maxDist;
+        int32 bestProxy = -1;
+
+        std::vector<StackEntry> stack;
+        stack.reserve(BVH_STACK_SIZE);
+
+        float enter = 0.0f;
+        if (IntersectRayBox(origin, invDir, nodes[root].min, nodes[root].max, bestDist, enter))
+        {
+            StackEntry entry = { root, enter };
+            stack.push_back(entry);
+        }
+
+        while (stack.size() > 0)
+        {
+            StackEntry entry = stack.back();
+            stack.pop_back();
+
+            // 入栈之后找到了更近的交点
+            if (entry.enter > bestDist)
+            {
+                continue;
+            }
+
+            const Node& node = nodes[entry.node];
+            if (node.proxy >= 0)
+            {
+                float t = callback(node.proxy, proxies[node.proxy].userData, origin, direction, bestDist);
+                if (t >= 0.0f && t < bestDist)
+                {
+                    bestDist  = t;
+                    bestProxy = node.proxy;
+                }
+                continue;
+            }
+
+            // 较远的子节点先入栈，较近的先访问
+            float enterLeft  = 0.0f;
+            float enterRight = 0.0f;
+            bool hitLeft  = IntersectRayBox(origin, invDir, nodes[node.left].min,  nodes[node.left].max,  bestDist, enterLeft);
+            bool hitRight = IntersectRayBox(origin, invDir, nodes[node.right].min, nodes[node.right].max, bestDist, enterRight);
+
+            StackEntry left  = { node.left,  enterLeft  };
+            StackEntry right = { node.right, enterRight };
+            if (hitLeft && hitRight)
+            {
+                stack.push_back(enterLeft < enterRight ? right : left);
+                stack.push_back(enterLeft < enterRight ? left : right);
+            }
+            else if (hitLeft)
+            {
+                stack.push_back(left);
+            }
+            else if (hitRight)
+            {
+                stack.push_back(right);
+            }
+        }
+
+        if (outDist && bestProxy >= 0)
+        {
+            *outDist = bestDist;
+        }
+
+        return bestProxy;
+    }
+
+}
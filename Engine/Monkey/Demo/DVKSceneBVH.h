@@ -0,0 +1,124 @@
+﻿#pragma once
+
+#include "Engine.h"
+
+#include "Common/Common.h"
+#include "Math/Math.h"
+#include "Math/Vector3.h"
+
+#include <vector>
+#include <functional>
+
+namespace vk_demo
+{
+    struct DVKFrustum;
+
+    // 场景级的动态包围盒树，每个叶子是一个代理(世界空间的AABB以及用户数据，例如DVKMesh*)。
+    // 代理移动之后只重新拟合它的祖先节点；内部节点的表面积之和(SAH代价)超过上次重建时的rebuildRatio倍之后按SAH重建。
+    class DVKSceneBVH
+    {
+    public:
+
+        // 射线与代理求交，返回交点的t(origin + direction * t)，未相交时返回负数。maxDist为当前最近的交点
+        typedef std::function<float(int32 proxy, void* userData, const Vector3& origin, const Vector3& direction, float maxDist)> RayCallback;
+
+        DVKSceneBVH()
+        {
+
+        }
+
+        int32 AddProxy(const Vector3& min, const Vector3& max, void* userData);
+
+        void RemoveProxy(int32 proxy);
+
+        // 只更新叶子，祖先在Update中统一重新拟合
+        void MoveProxy(int32 proxy, const Vector3& min, const Vector3& max);
+
+        // 重新拟合移动过的代理，树的质量退化时重建，查询之前调用
+        void Update();
+
+        void Rebuild();
+
+        void Clear();
+
+        // 与视锥体相交或者在内侧的代理，完全在平面内侧的子树不再测试该平面
+        void QueryFrustum(const DVKFrustum& frustum, std::vector<int32>& outProxies) const;
+
+        // AABB与球相交的代理
+        void QuerySphere(const Vector3& center, float radius, std::vector<int32>& outProxies) const;
+
+        // 按距离由近到远访问射线穿过的代理，返回最近的交点所属的代理，没有相交时返回-1
+        int32 RayCast(const Vector3& origin, const Vector3& direction, float maxDist, const RayCallback& callback, float* outDist = nullptr) const;
+
+        FORCE_INLINE void* GetUserData(int32 proxy) const
+        {
+            return proxies[proxy].userData;
+        }
+
+        FORCE_INLINE int32 GetProxyCount() const
+        {
+            return proxyCount;
+        }
+
+        FORCE_INLINE float GetCost() const
+        {
+            return cost;
+        }
+
+    public:
+
+        float   rebuildRatio = 1.5f;
+        int32   rebuildCount = 0;
+
+    private:
+
+        struct Node
+        {
+            Vector3     min;
+            Vector3     max;
+            int32       parent = -1;
+            int32       left = -1;
+            int32       right = -1;
+            // 叶子节点对应的代理，内部节点为-1
+            int32       proxy = -1;
+        };
+
+        struct Proxy
+        {
+            void*       userData = nullptr;
+            // 叶子节点，空闲时为-1
+            int32       leaf = -1;
+            int32       nextFree = -1;
+            bool        moved = false;
+        };
+
+        int32 AllocateNode();
+
+        void FreeNode(int32 node);
+
+        void InsertLeaf(int32 leaf);
+
+        void RemoveLeaf(int32 leaf);
+
+        // 由node开始向上重新计算包围盒，包围盒不再变化时停止
+        void RefitAncestors(int32 node);
+
+        int32 BuildRange(int32* leaves, int32 count, int32 parent);
+
+    private:
+
+        std::vector<Node>   nodes;
+        std::vector<Proxy>  proxies;
+        std::vector<int32>  movedProxies;
+
+        int32               root = -1;
+        int32               freeNode = -1;
+        int32               freeProxy = -1;
+        int32               proxyCount = 0;
+
+        float               cost = 0.0f;
+        // 上次重建时的代价，小于0表示尚未重建
+        float               builtCost = -1.0f;
+    };
+
+}
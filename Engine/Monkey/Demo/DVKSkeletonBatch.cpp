@@ -0,0 +1,291 @@
+﻿#include "DVKSkeletonBatch.h"
+#include "DVKModel.h"
+
+#include "Common/Log.h"
+
+#include <cstring>
+
+// 每个工作线程一次领取的实例数量
+#define SKELETON_BATCH_CHUNK    8
+
+namespace vk_demo
+{
+    DVKSkeletonBatch::~DVKSkeletonBatch()
+    {
+        {
+            std::lock_guard<std::mutex> lockGuard(mutex);
+            running = false;
+        }
+        startCV.notify_all();
+
+        for (int32 i = 0; i < workers.size(); ++i)
+        {
+            workers[i].join();
+        }
+        workers.clear();
+    }
+
+    DVKSkeletonBatch* DVKSkeletonBatch::Create(DVKModel* model, const std::vector<int32>& bones, BonePaletteFormat format, const Matrix4x4& postMatrix, int32 numThreads)
+    {
+        DVKSkeletonBatch* batch = new DVKSkeletonBatch();
+        batch->model         = model;
+        batch->format        = format;
+        batch->postMatrix    = postMatrix;
+        batch->hasPostMatrix = memcmp(&postMatrix, &Matrix4x4::Identity, sizeof(Matrix4x4)) != 0;
+
+        model->UpdateTransforms();
+
+        // 标记骨骼以及它们的祖先，其余节点不影响Palette
+        int32 nodeCount = (int32)model->linearNodes.size();
+        std::vector<int32> boneNodeIndices(bones.size(), -1);
+        std::vector<bool>  needed(nodeCount, false);
+        for (int32 i = 0; i < bones.size(); ++i)
+        {
+            DVKBone* bone = model->bones[bones[i]];
+            auto it = model->nodesMap.find(bone->name);
+            if (it == model->nodesMap.end())
+            {
+                continue;
+            }
+            boneNodeIndices[i] = it->second->index;
+            for (int32 node = it->second->index; node >= 0 && !needed[node]; node = model->nodeParents[node])
+            {
+                needed[node] = true;
+            }
+        }
+
+        // linearNodes为先序，紧凑之后父节点仍然在子节点之前
+        std::vector<int32> compactIndex(nodeCount, -1);
+        for (int32 i = 0; i < nodeCount; ++i)
+        {
+            if (!needed[i])
+            {
+                continue;
+            }
+            int32 parent = model->nodeParents[i];
+            compactIndex[i] = (int32)batch->nodes.size();
+            batch->nodes.push_back(i);
+            batch->parents.push_back(parent >= 0 ? compactIndex[parent] : -1);
+        }
+
+        for (int32 i = 0; i < bones.size(); ++i)
+        {
+            batch->boneNodes.push_back(boneNodeIndices[i] >= 0 ? compactIndex[boneNodeIndices[i]] : -1);
+            batch->inverseBindPoses.push_back(model->bones[bones[i]]->inverseBindPose);
+        }
+
+        batch->nodeClips.resize(model->animations.size());
+        for (int32 i = 0; i < model->animations.size(); ++i)
+        {
+            const DVKAnimation& animation = model->animations[i];
+            std::vector<int32>& clips = batch->nodeClips[i];
+            clips.resize(batch->nodes.size(), -1);
+            for (int32 j = 0; j < animation.linearClips.size(); ++j)
+            {
+                int32 node = compactIndex[animation.linearClips[j]->nodeIndex];
+                if (node >= 0)
+                {
+                    clips[node] = j;
+                }
+            }
+            batch->maxClipCount = MMath::Max(batch->maxClipCount, (int32)animation.linearClips.size());
+        }
+
+        if (numThreads <= 0)
+        {
+            numThreads = MMath::Max<int32>((int32)std::thread::hardware_concurrency(), 1);
+        }
+
+        batch->contexts.resize(numThreads);
+        for (int32 i = 0; i < numThreads; ++i)
+        {
+            batch->contexts[i].globals.resize(batch->nodes.size());
+            batch->contexts[i].cursors.resize(batch->maxClipCount * 3, 0);
+        }
+
+        // 调用Evaluate的线程作为0号线程
+        batch->jobNext = 0;
+        for (int32 i = 1; i < numThreads; ++i)
+        {
+            batch->workers.push_back(std::thread(&DVKSkeletonBatch::WorkerLoop, batch, i));
+        }
+
+        return batch;
+    }
+
+    void DVKSkeletonBatch::WorkerLoop(int32 threadIndex)
+    {
+        uint32 lastGeneration = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lockGuard(mutex);
+                while (running && generation == lastGeneration)
+                {
+                    startCV.wait(lockGuard);
+                }
+                if (!running)
+                {
+                    return;
+                }
+                lastGeneration = generation;
+            }
+
+            RunJobs(contexts[threadIndex]);
+
+            {
+                std::lock_guard<std::mutex> lockGuard(mutex);
+                doneCount += 1;
+            }
+            doneCV.notify_one();
+        }
+    }
+
+    void DVKSkeletonBatch::RunJobs(ThreadContext& context)
+    {
+        while (true)
+        {
+            int32 begin = jobNext.fetch_add(SKELETON_BATCH_CHUNK);
+            if (begin >= jobCount)
+            {
+                return;
+            }
+
+            int32 end = MMath::Min(begin + SKELETON_BATCH_CHUNK, jobCount);
+            for (int32 i = begin; i < end; ++i)
+            {
+                EvaluateInstance(jobInstances[i], context, (float*)(jobOutput + (size_t)i * jobStride));
+            }
+        }
+    }
+
+    void DVKSkeletonBatch::Evaluate(const DVKSkeletonInstance* instances, int32 count, void* output, uint32 stride)
+    {
+        if (count <= 0)
+        {
+            return;
+        }
+
+        // 工作线程中不做检查，越界的animIndex在这里报告，计算时使用节点当前的localMatrix
+        int32 animCount = (int32)nodeClips.size();
+        for (int32 i = 0; i < count; ++i)
+        {
+            if (instances[i].animIndex < 0 || instances[i].animIndex >= animCount)
+            {
+                MLOGE("Skeleton instance %d has invalid animIndex %d, animation count %d.", i, instances[i].animIndex, animCount);
+                break;
+            }
+        }
+
+        jobInstances = instances;
+        jobCount     = count;
+        jobOutput    = (uint8*)output;
+        jobStride    = stride;
+        jobNext      = 0;
+
+        // 实例较少时不唤醒工作线程
+        if (workers.size() == 0 || count <= SKELETON_BATCH_CHUNK)
+        {
+            RunJobs(contexts[0]);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lockGuard(mutex);
+            doneCount   = 0;
+            generation += 1;
+        }
+        startCV.notify_all();
+
+        RunJobs(contexts[0]);
+
+        std::unique_lock<std::mutex> lockGuard(mutex);
+        while (doneCount != workers.size())
+        {
+            doneCV.wait(lockGuard);
+        }
+    }
+
+    void DVKSkeletonBatch::EvaluateInstance(const DVKSkeletonInstance& instance, ThreadContext& context, float* output)
+    {
+        bool animated = instance.animIndex >= 0 && instance.animIndex < nodeClips.size();
+        const DVKAnimation* animation = animated ? &(model->animations[instance.animIndex]) : nullptr;
+        const int32* clips = animated ? nodeClips[instance.animIndex].data() : nullptr;
+        float time = animated ? MMath::Clamp(instance.time, 0.0f, animation->duration) : 0.0f;
+
+        // local to model
+        Matrix4x4 local;
+        Matrix4x4* globals = context.globals.data();
+        for (int32 i = 0; i < nodes.size(); ++i)
+        {
+            const Matrix4x4* localMatrix = &(model->linearNodes[nodes[i]]->localMatrix);
+            if (animated && clips[i] >= 0)
+            {
+                animation->SampleClip(*animation->linearClips[clips[i]], time, &(context.cursors[clips[i] * 3]), local);
+                localMatrix = &local;
+            }
+
+            if (parents[i] >= 0)
+            {
+                MMath::VectorMatrixMultiply(&globals[i], localMatrix, &globals[parents[i]]);
+            }
+            else
+            {
+                globals[i] = *localMatrix;
+            }
+        }
+
+        // inverse bind pose
+        Matrix4x4 finalTransform;
+        for (int32 i = 0; i < boneNodes.size(); ++i)
+        {
+            if (boneNodes[i] >= 0)
+            {
+                MMath::VectorMatrixMultiply(&finalTransform, &inverseBindPoses[i], &globals[boneNodes[i]]);
+            }
+            else
+            {
+                finalTransform = inverseBindPoses[i];
+            }
+
+            if (hasPostMatrix)
+            {
+                MMath::VectorMatrixMultiply(&finalTransform, &finalTransform, &postMatrix);
+            }
+
+            if (format == BPF_Matrix4x4)
+            {
+                memcpy(output, finalTransform.m, sizeof(float) * 16);
+                output += 16;
+                continue;
+            }
+
+            if (format == BPF_Matrix3x4)
+            {
+                for (int32 col = 0; col < 3; ++col)
+                {
+                    output[0] = finalTransform.m[0][col];
+                    output[1] = finalTransform.m[1][col];
+                    output[2] = finalTransform.m[2][col];
+                    output[3] = finalTransform.m[3][col];
+                    output += 4;
+                }
+                continue;
+            }
+
+            // 转为对偶四元数
+            Quat    quat = finalTransform.ToQuat();
+            Vector3 pos  = finalTransform.GetOrigin();
+            output[0] = quat.x;
+            output[1] = quat.y;
+            output[2] = quat.z;
+            output[3] = quat.w;
+            output[4] = (+0.5f) * ( pos.x * quat.w + pos.y * quat.z - pos.z * quat.y);
+            output[5] = (+0.5f) * (-pos.x * quat.z + pos.y * quat.w + pos.z * quat.x);
+            output[6] = (+0.5f) * ( pos.x * quat.y - pos.y * quat.x + pos.z * quat.w);
+            output[7] = (-0.5f) * ( pos.x * quat.x + pos.y * quat.y + pos.z * quat.z);
+            output += 8;
+        }
+    }
+
+}
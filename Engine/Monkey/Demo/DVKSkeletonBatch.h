@@ -0,0 +1,117 @@
+﻿#pragma once
+
+#include "Engine.h"
+
+#include "Common/Common.h"
+#include "Math/Math.h"
+#include "Math/Matrix4x4.h"
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+namespace vk_demo
+{
+    class DVKModel;
+
+    // 每个骨骼输出的数据格式
+    enum BonePaletteFormat
+    {
+        BPF_Matrix4x4 = 0,  // 16个float，与DVKBone::finalTransform一致
+        BPF_DualQuat,       // 8个float，旋转四元数以及对偶部分
+        BPF_Matrix3x4,      // 12个float，finalTransform的前三列，着色器中dot(column, vec4(p, 1))
+    };
+
+    // 一个动画实例，共享同一个模型的骨架
+    struct DVKSkeletonInstance
+    {
+        // 超出模型动画数量时Evaluate报错，输出节点当前localMatrix的姿势
+        int32   animIndex = 0;
+        float   time = 0.0f;
+    };
+
+    // 批量计算多个实例的骨骼Palette。实例在工作线程之间分块，每个实例只读模型数据，结果直接写入output(可以是映射的Buffer或者Texture数据)
+    class DVKSkeletonBatch
+    {
+    public:
+
+        ~DVKSkeletonBatch();
+
+        // bones为需要输出的骨骼，通常为DVKMesh::bones；postMatrix追加在finalTransform之后，例如linkNode的逆矩阵。numThreads为0时使用所有核心
+        static DVKSkeletonBatch* Create(DVKModel* model, const std::vector<int32>& bones, BonePaletteFormat format, const Matrix4x4& postMatrix = Matrix4x4::Identity, int32 numThreads = 0);
+
+        // 第i个实例的Palette写入output + i * stride，stride为字节数，不能小于GetPaletteSize()
+        void Evaluate(const DVKSkeletonInstance* instances, int32 count, void* output, uint32 stride);
+
+        FORCE_INLINE uint32 GetPaletteSize() const
+        {
+            return (uint32)(boneNodes.size() * GetBoneFloats(format) * sizeof(float));
+        }
+
+        static FORCE_INLINE uint32 GetBoneFloats(BonePaletteFormat format)
+        {
+            return format == BPF_Matrix4x4 ? 16 : (format == BPF_Matrix3x4 ? 12 : 8);
+        }
+
+        FORCE_INLINE int32 GetNumThreads() const
+        {
+            return (int32)workers.size() + 1;
+        }
+
+    private:
+
+        DVKSkeletonBatch()
+        {
+
+        }
+
+        struct ThreadContext
+        {
+            std::vector<Matrix4x4>  globals;
+            std::vector<int32>      cursors;
+        };
+
+        void WorkerLoop(int32 threadIndex);
+
+        void RunJobs(ThreadContext& context);
+
+        void EvaluateInstance(const DVKSkeletonInstance& instance, ThreadContext& context, float* output);
+
+    private:
+
+        DVKModel*                           model = nullptr;
+        BonePaletteFormat                   format = BPF_Matrix4x4;
+        Matrix4x4                           postMatrix;
+        bool                                hasPostMatrix = false;
+
+        // 只保留骨骼以及它们的祖先节点，按先序排列，parents为紧凑之后的索引
+        std::vector<int32>                  nodes;
+        std::vector<int32>                  parents;
+        // 每个动画中各节点对应的clip，没有动画的节点使用模型当前的localMatrix
+        std::vector<std::vector<int32>>     nodeClips;
+        int32                               maxClipCount = 0;
+
+        // 输出的骨骼在nodes中的索引以及inverseBindPose
+        std::vector<int32>                  boneNodes;
+        std::vector<Matrix4x4>              inverseBindPoses;
+
+        std::vector<std::thread>            workers;
+        std::vector<ThreadContext>          contexts;
+        std::mutex                          mutex;
+        std::condition_variable             startCV;
+        std::condition_variable             doneCV;
+        uint32                              generation = 0;
+        int32                               doneCount = 0;
+        bool                                running = true;
+
+        // 当前一次Evaluate的参数
+        const DVKSkeletonInstance*          jobInstances = nullptr;
+        int32                               jobCount = 0;
+        uint8*                              jobOutput = nullptr;
+        uint32                              jobStride = 0;
+        std::atomic<int32>                  jobNext;
+    };
+
+}
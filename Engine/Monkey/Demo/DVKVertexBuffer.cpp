@@ -3,34 +3,24 @@
 namespace vk_demo
 {
 
-    DVKVertexBuffer* DVKVertexBuffer::Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, std::vector<float> vertices, const std::vector<VertexAttribute>& attributes)
+    DVKVertexBuffer* DVKVertexBuffer::Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, const std::vector<float>& vertices, const std::vector<VertexAttribute>& attributes)
     {
-        VkDevice device = vulkanDevice->GetInstanceHandle();
-
-        DVKVertexBuffer* vertexBuffer = new DVKVertexBuffer();
-        vertexBuffer->device     = device;
-        vertexBuffer->attributes = attributes;
+        return Create(vulkanDevice, cmdBuffer, vertices.data(), vertices.size() * sizeof(float), attributes);
+    }
 
+    DVKVertexBuffer* DVKVertexBuffer::Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, const void* data, VkDeviceSize dataSize, const std::vector<VertexAttribute>& attributes)
+    {
         vk_demo::DVKBuffer* vertexStaging = vk_demo::DVKBuffer::CreateBuffer(
             vulkanDevice,
             VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            vertices.size() * sizeof(float),
-            vertices.data()
-        );
-
-        vertexBuffer->dvkBuffer = vk_demo::DVKBuffer::CreateBuffer(
-            vulkanDevice,
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            vertices.size() * sizeof(float)
+            dataSize,
+            (void*)data
         );
 
         cmdBuffer->Begin();
 
-        VkBufferCopy copyRegion = {};
-        copyRegion.size = vertices.size() * sizeof(float);
-        vkCmdCopyBuffer(cmdBuffer->cmdBuffer, vertexStaging->buffer, vertexBuffer->dvkBuffer->buffer, 1, &copyRegion);
+        DVKVertexBuffer* vertexBuffer = Create(vulkanDevice, cmdBuffer, vertexStaging, 0, dataSize, attributes);
 
         cmdBuffer->End();
         cmdBuffer->Submit();
@@ -40,6 +30,29 @@ namespace vk_demo
         return vertexBuffer;
     }
 
+    DVKVertexBuffer* DVKVertexBuffer::Create(std::shared_ptr<VulkanDevice> vulkanDevice, DVKCommandBuffer* cmdBuffer, DVKBuffer* staging, VkDeviceSize stagingOffset, VkDeviceSize dataSize, const std::vector<VertexAttribute>& attributes)
+    {
+        VkDevice device = vulkanDevice->GetInstanceHandle();
+
+        DVKVertexBuffer* vertexBuffer = new DVKVertexBuffer();
+        vertexBuffer->device     = device;
+        vertexBuffer->attributes = attributes;
+
+        vertexBuffer->dvkBuffer = vk_demo::DVKBuffer::CreateBuffer(
+            vulkanDevice,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            dataSize
+        );
+
+        VkBufferCopy copyRegion = {};
+        copyRegion.srcOffset = stagingOffset;
+        copyRegion.size      = dataSize;
+        vkCmdCopyBuffer(cmdBuffer->cmdBuffer, staging->buffer, vertexBuffer->dvkBuffer->buffer, 1, &copyRegion);
+
+        return vertexBuffer;
+    }
+
     std::vector<VkVertexInputAttributeDescription> DVKVertexBuffer::GetInputAttributes(const std::vector<VertexAttribute>& shaderInputs)
     {
         std::vector<VkVertexInputAttributeDescription> vertexInputAttributs;
@@ -80,6 +80,40 @@ namespace vk_demo
         {
             return 4 * sizeof(float);
         }
+        else if (attribute == VertexAttribute::VA_PositionQ)
+        {
+            return 4 * sizeof(uint16);
+        }
+        else if (attribute == VertexAttribute::VA_UV0Half ||
+                 attribute == VertexAttribute::VA_UV1Half
+        )
+        {
+            return 2 * sizeof(uint16);
+        }
+        else if (attribute == VertexAttribute::VA_NormalOct)
+        {
+            return 2 * sizeof(int16);
+        }
+        else if (attribute == VertexAttribute::VA_TangentSN16)
+        {
+            return 4 * sizeof(int16);
+        }
+        else if (attribute == VertexAttribute::VA_ColorUN8)
+        {
+            return 4 * sizeof(uint8);
+        }
+        else if (attribute == VertexAttribute::VA_SkinIndexU8)
+        {
+            return 4 * sizeof(uint8);
+        }
+        else if (attribute == VertexAttribute::VA_SkinWeightUN8)
+        {
+            return 4 * sizeof(uint8);
+        }
+        else if (attribute == VertexAttribute::VA_SkinWeightUN16)
+        {
+            return 4 * sizeof(uint16);
+        }
 
         return 0;
     }
@@ -147,6 +181,40 @@ namespace vk_demo
         {
             format = VK_FORMAT_R32G32B32A32_SFLOAT;
         }
+        else if (attribute == VertexAttribute::VA_PositionQ)
+        {
+            format = VK_FORMAT_R16G16B16A16_UNORM;
+        }
+        else if (attribute == VertexAttribute::VA_UV0Half ||
+                 attribute == VertexAttribute::VA_UV1Half
+        )
+        {
+            format = VK_FORMAT_R16G16_SFLOAT;
+        }
+        else if (attribute == VertexAttribute::VA_NormalOct)
+        {
+            format = VK_FORMAT_R16G16_SNORM;
+        }
+        else if (attribute == VertexAttribute::VA_TangentSN16)
+        {
+            format = VK_FORMAT_R16G16B16A16_SNORM;
+        }
+        else if (attribute == VertexAttribute::VA_ColorUN8)
+        {
+            format = VK_FORMAT_R8G8B8A8_UNORM;
+        }
+        else if (attribute == VertexAttribute::VA_SkinIndexU8)
+        {
+            format = VK_FORMAT_R8G8B8A8_UINT;
+        }
+        else if (attribute == VertexAttribute::VA_SkinWeightUN8)
+        {
+            format = VK_FORMAT_R8G8B8A8_UNORM;
+        }
+        else if (attribute == VertexAttribute::VA_SkinWeightUN16)
+        {
+            format = VK_FORMAT_R16G16B16A16_UNORM;
+        }
 
         return format;
     }
@@ -178,7 +246,13 @@ namespace vk_demo
 
         std::vector<VkVertexInputAttributeDescription> GetInputAttributes(const std::vector<VertexAttribute>& shaderInputs);
 
-        static DVKVertexBuffer* Create(std::shared_ptr<VulkanDevice> device, DVKCommandBuffer* cmdBuffer, std::vector<float> vertices, const std::vector<VertexAttribute>& attributes);
+        static DVKVertexBuffer* Create(std::shared_ptr<VulkanDevice> device, DVKCommandBuffer* cmdBuffer, const std::vector<float>& vertices, const std::vector<VertexAttribute>& attributes);
+
+        // 数据直接拷贝进Staging，例如来自映射好的缓存文件
+        static DVKVertexBuffer* Create(std::shared_ptr<VulkanDevice> device, DVKCommandBuffer* cmdBuffer, const void* data, VkDeviceSize dataSize, const std::vector<VertexAttribute>& attributes);
+
+        // 只录制从staging拷贝的命令，调用者负责Begin/End/Submit以及释放staging，用于批量上传
+        static DVKVertexBuffer* Create(std::shared_ptr<VulkanDevice> device, DVKCommandBuffer* cmdBuffer, DVKBuffer* staging, VkDeviceSize stagingOffset, VkDeviceSize dataSize, const std::vector<VertexAttribute>& attributes);
 
     public:
         VkDevice                        device = VK_NULL_HANDLE;
@@ -1,6 +1,7 @@
 ﻿#include "DemoBase.h"
 #include "DVKDefaultRes.h"
 #include "DVKCommand.h"
+#include "DVKFrameScheduler.h"
 
 void DemoBase::Setup()
 {
@@ -20,29 +21,166 @@ void DemoBase::Setup()
 
 int32 DemoBase::AcquireBackbufferIndex()
 {
+    // 尺寸变化只做了标记，在这里统一重建一次
+    if (m_AutoResize && GetVulkanRHI()->IsSwapChainDirty())
+    {
+        RecreateSwapChain();
+    }
+
     int32 backBufferIndex = m_SwapChain->AcquireImageIndex(&m_PresentComplete);
+    if (m_AutoResize && backBufferIndex == (int32)VulkanSwapChain::SwapStatus::OutOfDate && RecreateSwapChain())
+    {
+        backBufferIndex = m_SwapChain->AcquireImageIndex(&m_PresentComplete);
+    }
+
+    if (backBufferIndex < 0)
+    {
+        return backBufferIndex;
+    }
+
+    // 只在需要时等待：该backbuffer的CommandBuffer，以及超出m_MaxFramesInFlight的帧
+    typedef vk_demo::DVKFrameScheduler::QueueType QueueType;
+    uint64 submitted = m_Scheduler->GetSubmittedValue(QueueType::Graphics);
+    uint64 waitValue = m_FrameValues[backBufferIndex];
+    if (submitted + 1 > m_MaxFramesInFlight)
+    {
+        waitValue = MMath::Max<uint64>(waitValue, submitted + 1 - m_MaxFramesInFlight);
+    }
+    m_Scheduler->Wait(QueueType::Graphics, waitValue);
+    m_Scheduler->Update();
+
     return backBufferIndex;
 }
 
 void DemoBase::Present(int backBufferIndex)
 {
-    VkSubmitInfo submitInfo = {};
-    submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.pWaitDstStageMask    = &m_WaitStageMask;
-    submitInfo.pWaitSemaphores      = &m_PresentComplete;
-    submitInfo.waitSemaphoreCount   = 1;
-    submitInfo.pSignalSemaphores    = &m_RenderComplete;
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pCommandBuffers      = &(m_CommandBuffers[backBufferIndex]);
-    submitInfo.commandBufferCount   = 1;
+    typedef vk_demo::DVKFrameScheduler::QueueType QueueType;
 
-    vkResetFences(m_Device, 1, &(m_Fences[backBufferIndex]));
-
-    VERIFYVULKANRESULT(vkQueueSubmit(m_GfxQueue, 1, &submitInfo, m_Fences[backBufferIndex]));
-    vkWaitForFences(m_Device, 1, &(m_Fences[backBufferIndex]), true, MAX_uint64);
+    m_Scheduler->AddWaitSemaphore(QueueType::Graphics, m_PresentComplete, m_WaitStageMask);
+    m_FrameValues[backBufferIndex] = m_Scheduler->Submit(QueueType::Graphics, &(m_CommandBuffers[backBufferIndex]), 1, m_RenderComplete[backBufferIndex]);
 
     // present
-    m_SwapChain->Present(m_VulkanDevice->GetGraphicsQueue(), m_VulkanDevice->GetPresentQueue(), &m_RenderComplete);
+    VulkanSwapChain::SwapStatus status = m_SwapChain->Present(m_VulkanDevice->GetGraphicsQueue(), m_VulkanDevice->GetPresentQueue(), &(m_RenderComplete[backBufferIndex]));
+    if (status == VulkanSwapChain::SwapStatus::OutOfDate)
+    {
+        GetVulkanRHI()->SetSwapChainDirty(true);
+    }
+}
+
+bool DemoBase::RecreateSwapChain()
+{
+    auto vulkanRHI = GetVulkanRHI();
+
+    // 窗口最小化时保持标记，等待恢复之后再重建
+    int32 width  = Engine::Get()->GetPlatformWindow()->GetWidth();
+    int32 height = Engine::Get()->GetPlatformWindow()->GetHeight();
+    if (width <= 0 || height <= 0)
+    {
+        return false;
+    }
+
+    // 以旧的swapchain作为oldSwapchain重建，不需要等待设备空闲
+    VulkanRHI::ReleaseFunc releaseSwapChain = vulkanRHI->RecreateSwapChain();
+    m_SwapChain = vulkanRHI->GetSwapChain();
+    SetSize(width, height);
+
+    std::vector<VkFramebuffer> oldFrameBuffers = m_FrameBuffers;
+    m_FrameBuffers.clear();
+
+    // 深度只在尺寸真正变化时重新分配
+    VkImage        oldDepthImage  = VK_NULL_HANDLE;
+    VkImageView    oldDepthView   = VK_NULL_HANDLE;
+    VkDeviceMemory oldDepthMemory = VK_NULL_HANDLE;
+    if (m_SwapChain->GetWidth() != m_FrameWidth || m_SwapChain->GetHeight() != m_FrameHeight)
+    {
+        oldDepthImage  = m_DepthStencilImage;
+        oldDepthView   = m_DepthStencilView;
+        oldDepthMemory = m_DepthStencilMemory;
+        m_DepthStencilImage  = VK_NULL_HANDLE;
+        m_DepthStencilView   = VK_NULL_HANDLE;
+        m_DepthStencilMemory = VK_NULL_HANDLE;
+        CreateDepthStencil();
+    }
+
+    m_FrameWidth  = m_SwapChain->GetWidth();
+    m_FrameHeight = m_SwapChain->GetHeight();
+
+    CreateFrameBuffers();
+
+    if (m_SwapChain->GetBackBufferCount() != m_CommandBuffers.size())
+    {
+        ResizeFrameResources(m_SwapChain->GetBackBufferCount());
+    }
+
+    // 旧的FrameBuffer、深度以及swapchain在当前提交的帧全部执行完毕后释放
+    VkDevice device = m_Device;
+    m_Scheduler->DeferRelease([=]() {
+        for (int32 i = 0; i < oldFrameBuffers.size(); ++i)
+        {
+            vkDestroyFramebuffer(device, oldFrameBuffers[i], VULKAN_CPU_ALLOCATOR);
+        }
+
+        if (oldDepthView != VK_NULL_HANDLE)
+        {
+            vkDestroyImageView(device, oldDepthView, VULKAN_CPU_ALLOCATOR);
+            vkDestroyImage(device, oldDepthImage, VULKAN_CPU_ALLOCATOR);
+            vkFreeMemory(device, oldDepthMemory, VULKAN_CPU_ALLOCATOR);
+        }
+
+        if (releaseSwapChain)
+        {
+            releaseSwapChain();
+        }
+    });
+
+    MLOG("Recreate swapchain %dx%d", m_FrameWidth, m_FrameHeight);
+
+    OnResize(m_FrameWidth, m_FrameHeight);
+
+    return true;
+}
+
+void DemoBase::ResizeFrameResources(int32 frameCount)
+{
+    // backbuffer数量变化很少见，直接等待空闲后调整
+    WaitIdle();
+
+    VkDevice device = m_Device;
+    int32 oldCount  = m_CommandBuffers.size();
+
+    for (int32 i = frameCount; i < oldCount; ++i)
+    {
+        vkFreeCommandBuffers(device, m_CommandPool, 1, &(m_CommandBuffers[i]));
+        vkDestroySemaphore(device, m_RenderComplete[i], VULKAN_CPU_ALLOCATOR);
+    }
+
+    m_CommandBuffers.resize(frameCount);
+    m_RenderComplete.resize(frameCount);
+    m_FrameValues.resize(frameCount, 0);
+
+    VkCommandBufferAllocateInfo cmdBufferInfo;
+    ZeroVulkanStruct(cmdBufferInfo, VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO);
+    cmdBufferInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdBufferInfo.commandBufferCount = 1;
+    cmdBufferInfo.commandPool        = m_CommandPool;
+
+    VkSemaphoreCreateInfo createInfo;
+    ZeroVulkanStruct(createInfo, VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO);
+
+    for (int32 i = oldCount; i < frameCount; ++i)
+    {
+        VERIFYVULKANRESULT(vkAllocateCommandBuffers(device, &cmdBufferInfo, &(m_CommandBuffers[i])));
+        VERIFYVULKANRESULT(vkCreateSemaphore(device, &createInfo, VULKAN_CPU_ALLOCATOR, &m_RenderComplete[i]));
+    }
+}
+
+void DemoBase::WaitIdle()
+{
+    if (m_Scheduler)
+    {
+        m_Scheduler->WaitIdle();
+        m_Scheduler->Update();
+    }
 }
 
 uint32 DemoBase::GetMemoryTypeFromProperties(uint32 typeBits, VkMemoryPropertyFlags properties)
@@ -73,31 +211,32 @@ void DemoBase::CreateFences()
     VkDevice device  = GetVulkanRHI()->GetDevice()->GetInstanceHandle();
     int32 frameCount = GetVulkanRHI()->GetSwapChain()->GetBackBufferCount();
 
-    VkFenceCreateInfo fenceCreateInfo;
-    ZeroVulkanStruct(fenceCreateInfo, VK_STRUCTURE_TYPE_FENCE_CREATE_INFO);
-    fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-    m_Fences.resize(frameCount);
-    for (int32 i = 0; i < m_Fences.size(); ++i)
-    {
-        VERIFYVULKANRESULT(vkCreateFence(device, &fenceCreateInfo, VULKAN_CPU_ALLOCATOR, &m_Fences[i]));
-    }
+    m_Scheduler = vk_demo::DVKFrameScheduler::Create(GetVulkanRHI()->GetDevice());
+    m_FrameValues.resize(frameCount, 0);
 
     VkSemaphoreCreateInfo createInfo;
     ZeroVulkanStruct(createInfo, VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO);
-    vkCreateSemaphore(device, &createInfo, VULKAN_CPU_ALLOCATOR, &m_RenderComplete);
+
+    m_RenderComplete.resize(frameCount);
+    for (int32 i = 0; i < m_RenderComplete.size(); ++i)
+    {
+        VERIFYVULKANRESULT(vkCreateSemaphore(device, &createInfo, VULKAN_CPU_ALLOCATOR, &m_RenderComplete[i]));
+    }
 }
 
 void DemoBase::DestroyFences()
 {
     VkDevice device = GetVulkanRHI()->GetDevice()->GetInstanceHandle();
 
-    for (int32 i = 0; i < m_Fences.size(); ++i)
+    delete m_Scheduler;
+    m_Scheduler = nullptr;
+    m_FrameValues.clear();
+
+    for (int32 i = 0; i < m_RenderComplete.size(); ++i)
     {
-        vkDestroyFence(device, m_Fences[i], VULKAN_CPU_ALLOCATOR);
+        vkDestroySemaphore(device, m_RenderComplete[i], VULKAN_CPU_ALLOCATOR);
     }
-
-    vkDestroySemaphore(device, m_RenderComplete, VULKAN_CPU_ALLOCATOR);
+    m_RenderComplete.clear();
 }
 
 void DemoBase::CreateDefaultRes()
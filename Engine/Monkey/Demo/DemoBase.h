@@ -13,6 +13,11 @@
 
 #include <string>
 
+namespace vk_demo
+{
+    class DVKFrameScheduler;
+}
+
 class DemoBase : public AppModuleBase
 {
 public:
@@ -26,7 +31,9 @@ public:
         , m_FrameHeight(0)
         , m_PipelineCache(VK_NULL_HANDLE)
         , m_PresentComplete(VK_NULL_HANDLE)
-        , m_RenderComplete(VK_NULL_HANDLE)
+        , m_Scheduler(nullptr)
+        , m_MaxFramesInFlight(1)
+        , m_AutoResize(true)
         , m_CommandPool(VK_NULL_HANDLE)
         , m_WaitStageMask(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT)
         , m_SwapChain(VK_NULL_HANDLE)
@@ -91,6 +98,7 @@ public:
 
     void Release() override
     {
+        WaitIdle();
         AppModuleBase::Release();
         DestroyDefaultRes();
         DestroyFences();
@@ -102,10 +110,25 @@ public:
 
     int32 AcquireBackbufferIndex();
 
+    void WaitIdle();
+
     uint32 GetMemoryTypeFromProperties(uint32 typeBits, VkMemoryPropertyFlags properties);
 
+protected:
+
+    // swapchain重建之后调用，Demo在这里重建与尺寸相关的资源。旧的资源应通过m_Scheduler->DeferRelease释放；
+    // DescriptorSet与已录制的CommandBuffer不能在使用中更新，需要改写它们时先WaitIdle
+    virtual void OnResize(int32 width, int32 height)
+    {
+
+    }
+
+    bool RecreateSwapChain();
+
 private:
 
+    void ResizeFrameResources(int32 frameCount);
+
     void CreateDefaultRes();
 
     void DestroyDefaultRes();
@@ -136,9 +159,16 @@ protected:
 
     VkPipelineCache                 m_PipelineCache;
 
-    std::vector<VkFence>            m_Fences;
     VkSemaphore                     m_PresentComplete;
-    VkSemaphore                     m_RenderComplete;
+    std::vector<VkSemaphore>        m_RenderComplete;
+
+    // 每个backbuffer最后一次提交的timeline值
+    vk_demo::DVKFrameScheduler*     m_Scheduler;
+    std::vector<uint64>             m_FrameValues;
+    int32                           m_MaxFramesInFlight;
+
+    // 窗口尺寸变化时自动重建swapchain，默认开启。与窗口等大的资源在OnResize中重建，只录制一次的CommandBuffer也在OnResize中重新录制
+    bool                            m_AutoResize;
 
     VkCommandPool                   m_CommandPool;
     VkCommandPool                   m_ComputeCommandPool;
@@ -4,13 +4,25 @@
 #include "FileManager.h"
 
 #if PLATFORM_WINDOWS
-
+    #include <Windows.h>
 #elif PLATFORM_MAC
-
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <dirent.h>
 #elif PLATFORM_IOS
-
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <dirent.h>
 #elif PLATFORM_LINUX
-
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <dirent.h>
 #elif PLATFORM_ANDROID
     #include "Application/Android/AndroidWindow.h"
 #endif
@@ -64,3 +76,222 @@ bool FileManager::ReadFile(const std::string& filepath, uint8*& dataPtr, uint32&
 
     return true;
 }
+
+bool FileManager::WriteFile(const std::string& filepath, const uint8* dataPtr, uint32 dataSize)
+{
+#if PLATFORM_ANDROID
+
+    return false;
+
+#else
+
+    std::string finalPath = FileManager::GetFilePath(filepath);
+
+    FILE* file = fopen(finalPath.c_str(), "wb");
+    if (!file)
+    {
+        MLOGE("Failed open file for write :%s", filepath.c_str());
+        return false;
+    }
+
+    size_t written = fwrite(dataPtr, 1, dataSize, file);
+    fclose(file);
+
+    if (written != dataSize)
+    {
+        MLOGE("Failed write file :%s", filepath.c_str());
+        remove(finalPath.c_str());
+        return false;
+    }
+
+    return true;
+
+#endif
+}
+
+bool FileManager::ListFiles(const std::string& directory, std::vector<std::string>& outFiles)
+{
+    outFiles.clear();
+
+#if PLATFORM_ANDROID
+
+    return false;
+
+#elif PLATFORM_WINDOWS
+
+    std::string finalPath = FileManager::GetFilePath(directory.size() > 0 ? directory + "/*" : "*");
+
+    WIN32_FIND_DATAA findData;
+    HANDLE handle = FindFirstFileA(finalPath.c_str(), &findData);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    do
+    {
+        if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+        {
+            outFiles.push_back(findData.cFileName);
+        }
+    } while (FindNextFileA(handle, &findData));
+
+    FindClose(handle);
+    return true;
+
+#else
+
+    std::string finalPath = FileManager::GetFilePath(directory.size() > 0 ? directory : ".");
+
+    DIR* dir = opendir(finalPath.c_str());
+    if (!dir)
+    {
+        return false;
+    }
+
+    struct dirent* entry = nullptr;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        std::string name = entry->d_name;
+        struct stat fileStat;
+        if (stat((finalPath + "/" + name).c_str(), &fileStat) == 0 && S_ISREG(fileStat.st_mode))
+        {
+            outFiles.push_back(name);
+        }
+    }
+
+    closedir(dir);
+    return true;
+
+#endif
+}
+
+bool FileManager::RemoveFile(const std::string& filepath)
+{
+#if PLATFORM_ANDROID
+
+    return false;
+
+#else
+
+    std::string finalPath = FileManager::GetFilePath(filepath);
+    return remove(finalPath.c_str()) == 0;
+
+#endif
+}
+
+MappedFile::MappedFile()
+    : m_Data(nullptr)
+    , m_Size(0)
+#if PLATFORM_WINDOWS
+    , m_File(nullptr)
+    , m_Mapping(nullptr)
+#endif
+{
+
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::string& filepath)
+{
+    Close();
+
+    std::string finalPath = FileManager::GetFilePath(filepath);
+
+#if PLATFORM_WINDOWS
+
+    HANDLE file = CreateFileA(finalPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_File    = file;
+    m_Mapping = mapping;
+    m_Data    = (uint8*)data;
+    m_Size    = (uint64)fileSize.QuadPart;
+
+    return true;
+
+#elif PLATFORM_ANDROID
+
+    return false;
+
+#else
+
+    int fd = open(finalPath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // 映射建立之后文件描述符就可以关闭了
+    close(fd);
+
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_Data = (uint8*)data;
+    m_Size = (uint64)st.st_size;
+
+    return true;
+
+#endif
+}
+
+void MappedFile::Close()
+{
+    if (m_Data == nullptr)
+    {
+        return;
+    }
+
+#if PLATFORM_WINDOWS
+    UnmapViewOfFile(m_Data);
+    CloseHandle((HANDLE)m_Mapping);
+    CloseHandle((HANDLE)m_File);
+    m_File    = nullptr;
+    m_Mapping = nullptr;
+#elif !PLATFORM_ANDROID
+    munmap(m_Data, (size_t)m_Size);
+#endif
+
+    m_Data = nullptr;
+    m_Size = 0;
+}
@@ -3,12 +3,52 @@
 #include "Common/Common.h"
 
 #include <string>
+#include <vector>
 
 class FileManager
 {
 public:
     static bool ReadFile(const std::string& filepath, uint8*& dataPtr, uint32& dataSize);
 
+    static bool WriteFile(const std::string& filepath, const uint8* dataPtr, uint32 dataSize);
+
     static std::string GetFilePath(const std::string& filepath);
 
+    // 列出目录中的文件名(不含目录)，Android的Asset不支持
+    static bool ListFiles(const std::string& directory, std::vector<std::string>& outFiles);
+
+    static bool RemoveFile(const std::string& filepath);
+
+};
+
+// 只读的内存映射文件，Android的Asset不支持映射
+class MappedFile
+{
+public:
+    MappedFile();
+
+    ~MappedFile();
+
+    bool Open(const std::string& filepath);
+
+    void Close();
+
+    FORCE_INLINE const uint8* GetData() const
+    {
+        return m_Data;
+    }
+
+    FORCE_INLINE uint64 GetSize() const
+    {
+        return m_Size;
+    }
+
+private:
+    uint8*  m_Data;
+    uint64  m_Size;
+
+#if PLATFORM_WINDOWS
+    void*   m_File;
+    void*   m_Mapping;
+#endif
 };
\ No newline at end of file
@@ -619,6 +619,8 @@ void ImageGUIContext::StartFrame()
 {
     const Vector2& mousePos = InputManager::GetMousePosition();
     ImGuiIO& io = ImGui::GetIO();
+    // 跟随窗口尺寸，swapchain重建之后不需要Demo手动Resize
+    io.DisplaySize  = ImVec2((float)Engine::Get()->GetPlatformWindow()->GetWidth(), (float)Engine::Get()->GetPlatformWindow()->GetHeight());
     io.MouseWheel  += InputManager::GetMouseDelta();
     io.MousePos     = ImVec2(mousePos.x * io.DisplayFramebufferScale.x, mousePos.y * io.DisplayFramebufferScale.y);
     io.MouseDown[0] = InputManager::IsMouseDown(MouseType::MOUSE_BUTTON_LEFT);
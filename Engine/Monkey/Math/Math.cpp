@@ -563,10 +563,15 @@ Quat Quat::SlerpNotNormalized(const Quat& quat1, const Quat& quat2, float slerp)
 	scale1 = MMath::FloatSelect(RawCosom, scale1, -scale1);
 
 	Quat result;
+#if MONKEY_MATH_SIMD
+	const VectorRegister blend = VectorMultiplyAdd(VectorSetFloat1(scale0), VectorLoad(&quat1.x), VectorMultiply(VectorSetFloat1(scale1), VectorLoad(&quat2.x)));
+	VectorStore(blend, &result.x);
+#else
 	result.x = scale0 * quat1.x + scale1 * quat2.x;
 	result.y = scale0 * quat1.y + scale1 * quat2.y;
 	result.z = scale0 * quat1.z + scale1 * quat2.z;
 	result.w = scale0 * quat1.w + scale1 * quat2.w;
+#endif
 
 	return result;
 }
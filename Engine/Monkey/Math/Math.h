@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "Math/PlatformMath.h"
+#include "Math/VectorRegister.h"
 #include "Common/Common.h"
 
 #include <string>
@@ -325,8 +326,50 @@ public:
 		return degVal * (PI / 180.f);
 	}
     
+#if MONKEY_MATH_SIMD
+    // 2x2矩阵(行优先存放在一个寄存器中)相乘 a * b
+    static FORCE_INLINE VectorRegister Matrix2x2Multiply(const VectorRegister& a, const VectorRegister& b)
+    {
+        return VectorAdd(VectorMultiply(a, VectorSwizzle(b, 0, 3, 0, 3)), VectorMultiply(VectorSwizzle(a, 1, 0, 3, 2), VectorSwizzle(b, 2, 1, 2, 1)));
+    }
+
+    // 伴随矩阵相乘 adj(a) * b
+    static FORCE_INLINE VectorRegister Matrix2x2AdjMultiply(const VectorRegister& a, const VectorRegister& b)
+    {
+        return VectorSubtract(VectorMultiply(VectorSwizzle(a, 3, 3, 0, 0), b), VectorMultiply(VectorSwizzle(a, 1, 1, 2, 2), VectorSwizzle(b, 2, 3, 0, 1)));
+    }
+
+    // a * adj(b)
+    static FORCE_INLINE VectorRegister Matrix2x2MultiplyAdj(const VectorRegister& a, const VectorRegister& b)
+    {
+        return VectorSubtract(VectorMultiply(a, VectorSwizzle(b, 3, 0, 3, 0)), VectorMultiply(VectorSwizzle(a, 1, 0, 3, 2), VectorSwizzle(b, 2, 1, 2, 1)));
+    }
+#endif
+
+    // result = matrix1 * matrix2，SIMD实现与标量实现的累加顺序一致，结果完全相同
     static FORCE_INLINE void VectorMatrixMultiply(void* result, const void* matrix1, const void* matrix2)
     {
+#if MONKEY_MATH_SIMD
+        const float* a = (const float*)matrix1;
+        const float* b = (const float*)matrix2;
+        float* r = (float*)result;
+
+        // 先读取matrix2，result与matrix1或者matrix2相同时也是安全的
+        const VectorRegister b0 = VectorLoad(b + 0);
+        const VectorRegister b1 = VectorLoad(b + 4);
+        const VectorRegister b2 = VectorLoad(b + 8);
+        const VectorRegister b3 = VectorLoad(b + 12);
+
+        for (int32 i = 0; i < 4; ++i)
+        {
+            const VectorRegister row = VectorLoad(a + i * 4);
+            VectorRegister temp = VectorMultiply(VectorReplicate(row, 0), b0);
+            temp = VectorMultiplyAdd(VectorReplicate(row, 1), b1, temp);
+            temp = VectorMultiplyAdd(VectorReplicate(row, 2), b2, temp);
+            temp = VectorMultiplyAdd(VectorReplicate(row, 3), b3, temp);
+            VectorStore(temp, r + i * 4);
+        }
+#else
         typedef float Float4x4[4][4];
         const Float4x4& a = *((const Float4x4*) matrix1);
         const Float4x4& b = *((const Float4x4*) matrix2);
@@ -353,10 +396,66 @@ public:
         temp[3][3] = a[3][0] * b[0][3] + a[3][1] * b[1][3] + a[3][2] * b[2][3] + a[3][3] * b[3][3];
         
         memcpy(result, &temp, 16 * sizeof(float));
+#endif
     }
     
+    // SIMD实现使用2x2分块求逆，与标量的余子式展开相差若干ulp
     static FORCE_INLINE void VectorMatrixInverse(void* dstMatrix, const void* srcMatrix)
     {
+#if MONKEY_MATH_SIMD
+        const float* src = (const float*)srcMatrix;
+        float* dst = (float*)dstMatrix;
+
+        const VectorRegister row0 = VectorLoad(src + 0);
+        const VectorRegister row1 = VectorLoad(src + 4);
+        const VectorRegister row2 = VectorLoad(src + 8);
+        const VectorRegister row3 = VectorLoad(src + 12);
+
+        // | A B |
+        // | C D |
+        const VectorRegister A = VectorShuffle(row0, row1, 0, 1, 0, 1);
+        const VectorRegister B = VectorShuffle(row0, row1, 2, 3, 2, 3);
+        const VectorRegister C = VectorShuffle(row2, row3, 0, 1, 0, 1);
+        const VectorRegister D = VectorShuffle(row2, row3, 2, 3, 2, 3);
+
+        // (|A|, |B|, |C|, |D|)
+        const VectorRegister detSub = VectorSubtract(
+            VectorMultiply(VectorShuffle(row0, row2, 0, 2, 0, 2), VectorShuffle(row1, row3, 1, 3, 1, 3)),
+            VectorMultiply(VectorShuffle(row0, row2, 1, 3, 1, 3), VectorShuffle(row1, row3, 0, 2, 0, 2))
+        );
+        const VectorRegister detA = VectorReplicate(detSub, 0);
+        const VectorRegister detB = VectorReplicate(detSub, 1);
+        const VectorRegister detC = VectorReplicate(detSub, 2);
+        const VectorRegister detD = VectorReplicate(detSub, 3);
+
+        const VectorRegister DC = Matrix2x2AdjMultiply(D, C);
+        const VectorRegister AB = Matrix2x2AdjMultiply(A, B);
+
+        // 逆矩阵分块的伴随矩阵
+        VectorRegister X = VectorSubtract(VectorMultiply(detD, A), Matrix2x2Multiply(B, DC));
+        VectorRegister W = VectorSubtract(VectorMultiply(detA, D), Matrix2x2Multiply(C, AB));
+        VectorRegister Y = VectorSubtract(VectorMultiply(detB, C), Matrix2x2MultiplyAdj(D, AB));
+        VectorRegister Z = VectorSubtract(VectorMultiply(detC, B), Matrix2x2MultiplyAdj(A, DC));
+
+        // |M| = |A||D| + |B||C| - tr(adj(A)B * adj(D)C)
+        VectorRegister trace = VectorMultiply(AB, VectorSwizzle(DC, 0, 2, 1, 3));
+        trace = VectorAdd(trace, VectorSwizzle(trace, 1, 0, 3, 2));
+        trace = VectorAdd(trace, VectorSwizzle(trace, 2, 3, 0, 1));
+        VectorRegister determinant = VectorAdd(VectorMultiply(detA, detD), VectorMultiply(detB, detC));
+        determinant = VectorSubtract(determinant, trace);
+
+        const VectorRegister rDet = VectorDivide(VectorSet(1.0f, -1.0f, -1.0f, 1.0f), determinant);
+        X = VectorMultiply(X, rDet);
+        Y = VectorMultiply(Y, rDet);
+        Z = VectorMultiply(Z, rDet);
+        W = VectorMultiply(W, rDet);
+
+        // 伴随矩阵的转置与分块的重新排列合并在一次Shuffle中
+        VectorStore(VectorShuffle(X, Y, 3, 1, 3, 1), dst + 0);
+        VectorStore(VectorShuffle(X, Y, 2, 0, 2, 0), dst + 4);
+        VectorStore(VectorShuffle(Z, W, 3, 1, 3, 1), dst + 8);
+        VectorStore(VectorShuffle(Z, W, 2, 0, 2, 0), dst + 12);
+#else
         typedef float Float4x4[4][4];
         const Float4x4& m = *((const Float4x4*)srcMatrix);
         Float4x4 result;
@@ -437,10 +536,21 @@ public:
                                 );
         
         memcpy(dstMatrix, &result, 16 * sizeof(float));
+#endif
     }
     
     static FORCE_INLINE void VectorTransformVector(void* result, const void* vec,  const void* matrix)
     {
+#if MONKEY_MATH_SIMD
+        const float* m = (const float*)matrix;
+        const VectorRegister v = VectorLoad((const float*)vec);
+
+        VectorRegister temp = VectorMultiply(VectorReplicate(v, 0), VectorLoad(m + 0));
+        temp = VectorMultiplyAdd(VectorReplicate(v, 1), VectorLoad(m + 4), temp);
+        temp = VectorMultiplyAdd(VectorReplicate(v, 2), VectorLoad(m + 8), temp);
+        temp = VectorMultiplyAdd(VectorReplicate(v, 3), VectorLoad(m + 12), temp);
+        VectorStore(temp, (float*)result);
+#else
         typedef float Float4[4];
         typedef float Float4x4[4][4];
         
@@ -452,10 +562,22 @@ public:
         rVec4[1] = vec4[0] * m44[0][1] + vec4[1] * m44[1][1] + vec4[2] * m44[2][1] + vec4[3] * m44[3][1];
         rVec4[2] = vec4[0] * m44[0][2] + vec4[1] * m44[1][2] + vec4[2] * m44[2][2] + vec4[3] * m44[3][2];
         rVec4[3] = vec4[0] * m44[0][3] + vec4[1] * m44[1][3] + vec4[2] * m44[2][3] + vec4[3] * m44[3][3];
+#endif
     }
     
+	// SIMD实现直接展开Hamilton乘积，与标量实现相差若干ulp
 	static FORCE_INLINE void VectorQuaternionMultiply(void* result, const void* quat1, const void* quat2)
 	{
+#if MONKEY_MATH_SIMD
+		const VectorRegister a = VectorLoad((const float*)quat1);
+		const VectorRegister b = VectorLoad((const float*)quat2);
+
+		VectorRegister temp = VectorMultiply(VectorReplicate(a, 3), b);
+		temp = VectorMultiplyAdd(VectorReplicate(a, 0), VectorMultiply(VectorSwizzle(b, 3, 2, 1, 0), VectorSet( 1.0f, -1.0f,  1.0f, -1.0f)), temp);
+		temp = VectorMultiplyAdd(VectorReplicate(a, 1), VectorMultiply(VectorSwizzle(b, 2, 3, 0, 1), VectorSet( 1.0f,  1.0f, -1.0f, -1.0f)), temp);
+		temp = VectorMultiplyAdd(VectorReplicate(a, 2), VectorMultiply(VectorSwizzle(b, 1, 0, 3, 2), VectorSet(-1.0f,  1.0f,  1.0f, -1.0f)), temp);
+		VectorStore(temp, (float*)result);
+#else
 		typedef float Float4[4];
 		const Float4& a = *((const Float4*)quat1);
 		const Float4& b = *((const Float4*)quat2);
@@ -476,6 +598,7 @@ public:
 		r[1] = t2 + t9 - t7;
 		r[2] = t3 + t9 - t6;
 		r[3] = t0 + t9 - t5;
+#endif
 	}
 
 	static FORCE_INLINE float FindDeltaAngleDegrees(float a1, float a2)
@@ -611,6 +611,15 @@ FORCE_INLINE void Matrix4x4::CopyRawDataTo(float* rawData) const
 
 FORCE_INLINE Vector4 Matrix4x4::DeltaTransformVector(const Vector4& v) const
 {
+#if MONKEY_MATH_SIMD
+	VectorRegister temp = VectorMultiply(VectorSetFloat1(v.x), VectorLoad(m[0]));
+	temp = VectorMultiplyAdd(VectorSetFloat1(v.y), VectorLoad(m[1]), temp);
+	temp = VectorMultiplyAdd(VectorSetFloat1(v.z), VectorLoad(m[2]), temp);
+
+	Vector4 result;
+	VectorStore(temp, &result.x);
+	return result;
+#else
 	float x = v.x;
 	float y = v.y;
 	float z = v.z;
@@ -620,6 +629,7 @@ FORCE_INLINE Vector4 Matrix4x4::DeltaTransformVector(const Vector4& v) const
 		(x * m[0][2] + y * m[1][2] + z * m[2][2]),
 		(x * m[0][3] + y * m[1][3] + z * m[2][3])
 	);
+#endif
 }
 
 FORCE_INLINE void Matrix4x4::Recompose(const Vector4& pos, const Vector4& scale, const Vector4& rot)
@@ -923,6 +933,16 @@ FORCE_INLINE Vector3 Matrix4x4::InverseTransformPosition(const Vector3 &v) const
 
 FORCE_INLINE Vector4 Matrix4x4::TransformVector(const Vector3& v) const
 {
+#if MONKEY_MATH_SIMD
+	VectorRegister temp = VectorMultiplyAdd(VectorSetFloat1(v.x), VectorLoad(m[0]), VectorLoad(m[3]));
+	temp = VectorMultiplyAdd(VectorSetFloat1(v.y), VectorLoad(m[1]), temp);
+	temp = VectorMultiplyAdd(VectorSetFloat1(v.z), VectorLoad(m[2]), temp);
+
+	Vector4 temp4;
+	VectorStore(temp, &temp4.x);
+	temp4.w = 1.0f;
+	return temp4;
+#else
 	Vector4 col0;
 	Vector4 col1;
 	Vector4 col2;
@@ -939,6 +959,7 @@ FORCE_INLINE Vector4 Matrix4x4::TransformVector(const Vector3& v) const
 	temp.w = 1.0f;
 
 	return temp;
+#endif
 }
 
 FORCE_INLINE Vector3 Matrix4x4::InverseTransformVector(const Vector3 &v) const
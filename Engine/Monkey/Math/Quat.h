@@ -609,6 +609,31 @@ FORCE_INLINE float Quat::ErrorAutoNormalize(const Quat& a, const Quat& b)
 
 FORCE_INLINE void Quat::ToMatrix(Matrix4x4& outMatrix) const
 {
+#if MONKEY_MATH_SIMD
+	// 与标量实现的乘加顺序一致，每一行由两组乘积以及符号掩码组合而成
+	const VectorRegister q  = VectorLoad(&x);
+	const VectorRegister q2 = VectorAdd(q, q);
+
+	// (yy + zz, xy + wz, xz - wy)
+	VectorRegister a = VectorMultiply(VectorSwizzle(q, 1, 0, 0, 3), VectorSwizzle(q2, 1, 1, 2, 3));
+	VectorRegister b = VectorMultiply(VectorSwizzle(q, 2, 3, 3, 3), VectorSwizzle(q2, 2, 2, 1, 3));
+	VectorRegister t = VectorMultiplyAdd(VectorSet(1.0f, 1.0f, -1.0f, 0.0f), b, a);
+	VectorStore(VectorMultiplyAdd(VectorSet(-1.0f, 1.0f, 1.0f, 0.0f), t, VectorSet(1.0f, 0.0f, 0.0f, 0.0f)), outMatrix.m[0]);
+
+	// (xy - wz, xx + zz, yz + wx)
+	a = VectorMultiply(VectorSwizzle(q, 0, 0, 1, 3), VectorSwizzle(q2, 1, 0, 2, 3));
+	b = VectorMultiply(VectorSwizzle(q, 3, 2, 3, 3), VectorSwizzle(q2, 2, 2, 0, 3));
+	t = VectorMultiplyAdd(VectorSet(-1.0f, 1.0f, 1.0f, 0.0f), b, a);
+	VectorStore(VectorMultiplyAdd(VectorSet(1.0f, -1.0f, 1.0f, 0.0f), t, VectorSet(0.0f, 1.0f, 0.0f, 0.0f)), outMatrix.m[1]);
+
+	// (xz + wy, yz - wx, xx + yy)
+	a = VectorMultiply(VectorSwizzle(q, 0, 1, 0, 3), VectorSwizzle(q2, 2, 2, 0, 3));
+	b = VectorMultiply(VectorSwizzle(q, 3, 3, 1, 3), VectorSwizzle(q2, 1, 0, 1, 3));
+	t = VectorMultiplyAdd(VectorSet(1.0f, -1.0f, 1.0f, 0.0f), b, a);
+	VectorStore(VectorMultiplyAdd(VectorSet(1.0f, 1.0f, -1.0f, 0.0f), t, VectorSet(0.0f, 0.0f, 1.0f, 0.0f)), outMatrix.m[2]);
+
+	VectorStore(VectorSet(0.0f, 0.0f, 0.0f, 1.0f), outMatrix.m[3]);
+#else
 	const float x2 = x + x;  const float y2 = y + y;  const float z2 = z + z;
 	const float xx = x * x2; const float xy = x * y2; const float xz = x * z2;
 	const float yy = y * y2; const float yz = y * z2; const float zz = z * z2;
@@ -618,6 +643,7 @@ FORCE_INLINE void Quat::ToMatrix(Matrix4x4& outMatrix) const
 	outMatrix.m[0][1] = xy + wz;			outMatrix.m[1][1] = 1.0f - (xx + zz);		outMatrix.m[2][1] = yz - wx;			outMatrix.m[3][1] = 0;
 	outMatrix.m[0][2] = xz - wy;			outMatrix.m[1][2] = yz + wx;				outMatrix.m[2][2] = 1.0f - (xx + yy);	outMatrix.m[3][2] = 0;
 	outMatrix.m[0][3] = 0.0f;				outMatrix.m[1][3] = 0.0f;					outMatrix.m[2][3] = 0.0f;				outMatrix.m[3][3] = 1.0f;
+#endif
 }
 
 FORCE_INLINE Matrix4x4 Quat::ToMatrix() const
@@ -0,0 +1,247 @@
+﻿#include "VectorBatch.h"
+
+// 不足4个的尾部复制到临时数组中按完整的4个计算
+#define BATCH_WIDTH 4
+
+// 尾部不足的部分用fill填充
+static FORCE_INLINE VectorRegister LoadBatch(const float* src, int32 count, float fill)
+{
+	if (count >= BATCH_WIDTH)
+	{
+		return VectorLoad(src);
+	}
+
+	float temp[BATCH_WIDTH] = { fill, fill, fill, fill };
+	for (int32 i = 0; i < count; ++i)
+	{
+		temp[i] = src[i];
+	}
+	return VectorLoad(temp);
+}
+
+static FORCE_INLINE void StoreBatch(const VectorRegister& vec, float* dst, int32 count)
+{
+	if (count >= BATCH_WIDTH)
+	{
+		VectorStore(vec, dst);
+		return;
+	}
+
+	float temp[BATCH_WIDTH];
+	VectorStore(vec, temp);
+	for (int32 i = 0; i < count; ++i)
+	{
+		dst[i] = temp[i];
+	}
+}
+
+// ((x * m0 + y * m1) + z * m2) + m3，与MMath::VectorTransformVector(w = 1)的累加顺序一致
+static FORCE_INLINE VectorRegister TransformAxis(const VectorRegister& x, const VectorRegister& y, const VectorRegister& z, const Matrix4x4& matrix, int32 axis)
+{
+	VectorRegister result = VectorMultiply(x, VectorSetFloat1(matrix.m[0][axis]));
+	result = VectorMultiplyAdd(y, VectorSetFloat1(matrix.m[1][axis]), result);
+	result = VectorMultiplyAdd(z, VectorSetFloat1(matrix.m[2][axis]), result);
+	return VectorAdd(result, VectorSetFloat1(matrix.m[3][axis]));
+}
+
+// 加法对每个参数单调，逐项取min/max的和等于8个角点之和的min/max
+static FORCE_INLINE void TransformBoundsAxis(const VectorRegister* inMin, const VectorRegister* inMax, const Matrix4x4& matrix, int32 axis, VectorRegister& outMin, VectorRegister& outMax)
+{
+	VectorRegister a = VectorMultiply(inMin[0], VectorSetFloat1(matrix.m[0][axis]));
+	VectorRegister b = VectorMultiply(inMax[0], VectorSetFloat1(matrix.m[0][axis]));
+	outMin = VectorMin(a, b);
+	outMax = VectorMax(a, b);
+
+	for (int32 i = 1; i < 3; ++i)
+	{
+		a = VectorMultiply(inMin[i], VectorSetFloat1(matrix.m[i][axis]));
+		b = VectorMultiply(inMax[i], VectorSetFloat1(matrix.m[i][axis]));
+		outMin = VectorAdd(outMin, VectorMin(a, b));
+		outMax = VectorAdd(outMax, VectorMax(a, b));
+	}
+
+	outMin = VectorAdd(outMin, VectorSetFloat1(matrix.m[3][axis]));
+	outMax = VectorAdd(outMax, VectorSetFloat1(matrix.m[3][axis]));
+}
+
+// 到平面的有符号距离，与Plane::PlaneDot一致
+static FORCE_INLINE VectorRegister PlaneDistance(const Plane& plane, const VectorRegister& x, const VectorRegister& y, const VectorRegister& z)
+{
+	VectorRegister result = VectorMultiply(x, VectorSetFloat1(plane.x));
+	result = VectorMultiplyAdd(y, VectorSetFloat1(plane.y), result);
+	result = VectorMultiplyAdd(z, VectorSetFloat1(plane.z), result);
+	return VectorSubtract(result, VectorSetFloat1(plane.w));
+}
+
+static FORCE_INLINE int32 StoreVisible(const VectorRegister& minDistance, uint8* outVisible, int32 count)
+{
+	float distance[BATCH_WIDTH];
+	VectorStore(minDistance, distance);
+
+	int32 visible = 0;
+	for (int32 i = 0; i < count && i < BATCH_WIDTH; ++i)
+	{
+		outVisible[i] = distance[i] >= 0.0f ? 1 : 0;
+		visible += outVisible[i];
+	}
+	return visible;
+}
+
+void VectorBatch::TransformPositions(const Matrix4x4& matrix, const Vector3Array& inPositions, Vector3Array& outPositions)
+{
+	const int32 count = inPositions.Size();
+	outPositions.Resize(count);
+
+	for (int32 i = 0; i < count; i += BATCH_WIDTH)
+	{
+		const int32 num = count - i;
+		const VectorRegister x = LoadBatch(&inPositions.x[i], num, 0.0f);
+		const VectorRegister y = LoadBatch(&inPositions.y[i], num, 0.0f);
+		const VectorRegister z = LoadBatch(&inPositions.z[i], num, 0.0f);
+
+		StoreBatch(TransformAxis(x, y, z, matrix, 0), &outPositions.x[i], num);
+		StoreBatch(TransformAxis(x, y, z, matrix, 1), &outPositions.y[i], num);
+		StoreBatch(TransformAxis(x, y, z, matrix, 2), &outPositions.z[i], num);
+	}
+}
+
+void VectorBatch::TransformBounds(const Matrix4x4& matrix, const BoundsArray& inBounds, BoundsArray& outBounds)
+{
+	outBounds.Resize(inBounds.Size());
+	TransformBounds(matrix, inBounds, outBounds, 0, inBounds.Size());
+}
+
+void VectorBatch::TransformBounds(const Matrix4x4& matrix, const BoundsArray& inBounds, BoundsArray& outBounds, int32 first, int32 count)
+{
+	const int32 last = first + count;
+
+	for (int32 i = first; i < last; i += BATCH_WIDTH)
+	{
+		const int32 num = last - i;
+
+		VectorRegister inMin[3];
+		VectorRegister inMax[3];
+		inMin[0] = LoadBatch(&inBounds.min.x[i], num, 0.0f);
+		inMin[1] = LoadBatch(&inBounds.min.y[i], num, 0.0f);
+		inMin[2] = LoadBatch(&inBounds.min.z[i], num, 0.0f);
+		inMax[0] = LoadBatch(&inBounds.max.x[i], num, 0.0f);
+		inMax[1] = LoadBatch(&inBounds.max.y[i], num, 0.0f);
+		inMax[2] = LoadBatch(&inBounds.max.z[i], num, 0.0f);
+
+		VectorRegister outMin;
+		VectorRegister outMax;
+
+		TransformBoundsAxis(inMin, inMax, matrix, 0, outMin, outMax);
+		StoreBatch(outMin, &outBounds.min.x[i], num);
+		StoreBatch(outMax, &outBounds.max.x[i], num);
+
+		TransformBoundsAxis(inMin, inMax, matrix, 1, outMin, outMax);
+		StoreBatch(outMin, &outBounds.min.y[i], num);
+		StoreBatch(outMax, &outBounds.max.y[i], num);
+
+		TransformBoundsAxis(inMin, inMax, matrix, 2, outMin, outMax);
+		StoreBatch(outMin, &outBounds.min.z[i], num);
+		StoreBatch(outMax, &outBounds.max.z[i], num);
+	}
+}
+
+void VectorBatch::MergeBounds(const BoundsArray& bounds, Vector3& outMin, Vector3& outMax)
+{
+	const int32 count = bounds.Size();
+
+	VectorRegister minX = VectorSetFloat1(outMin.x);
+	VectorRegister minY = VectorSetFloat1(outMin.y);
+	VectorRegister minZ = VectorSetFloat1(outMin.z);
+	VectorRegister maxX = VectorSetFloat1(outMax.x);
+	VectorRegister maxY = VectorSetFloat1(outMax.y);
+	VectorRegister maxZ = VectorSetFloat1(outMax.z);
+
+	// 尾部填充当前的结果，不影响min/max
+	for (int32 i = 0; i < count; i += BATCH_WIDTH)
+	{
+		const int32 num = count - i;
+		minX = VectorMin(minX, LoadBatch(&bounds.min.x[i], num, outMin.x));
+		minY = VectorMin(minY, LoadBatch(&bounds.min.y[i], num, outMin.y));
+		minZ = VectorMin(minZ, LoadBatch(&bounds.min.z[i], num, outMin.z));
+		maxX = VectorMax(maxX, LoadBatch(&bounds.max.x[i], num, outMax.x));
+		maxY = VectorMax(maxY, LoadBatch(&bounds.max.y[i], num, outMax.y));
+		maxZ = VectorMax(maxZ, LoadBatch(&bounds.max.z[i], num, outMax.z));
+	}
+
+	float temp[6][BATCH_WIDTH];
+	VectorStore(minX, temp[0]);
+	VectorStore(minY, temp[1]);
+	VectorStore(minZ, temp[2]);
+	VectorStore(maxX, temp[3]);
+	VectorStore(maxY, temp[4]);
+	VectorStore(maxZ, temp[5]);
+
+	for (int32 i = 0; i < BATCH_WIDTH; ++i)
+	{
+		outMin = Vector3::Min(outMin, Vector3(temp[0][i], temp[1][i], temp[2][i]));
+		outMax = Vector3::Max(outMax, Vector3(temp[3][i], temp[4][i], temp[5][i]));
+	}
+}
+
+int32 VectorBatch::CullSpheres(const Plane* planes, int32 numPlanes, const SphereArray& spheres, uint8* outVisible)
+{
+	const int32 count = spheres.Size();
+	int32 visible = 0;
+
+	for (int32 i = 0; i < count; i += BATCH_WIDTH)
+	{
+		const int32 num = count - i;
+		const VectorRegister x = LoadBatch(&spheres.center.x[i], num, 0.0f);
+		const VectorRegister y = LoadBatch(&spheres.center.y[i], num, 0.0f);
+		const VectorRegister z = LoadBatch(&spheres.center.z[i], num, 0.0f);
+		const VectorRegister r = LoadBatch(&spheres.radius[i], num, 0.0f);
+
+		// 所有平面中最小的(距离 + 半径)
+		VectorRegister minDistance = VectorSetFloat1(MAX_FLT);
+		for (int32 p = 0; p < numPlanes; ++p)
+		{
+			minDistance = VectorMin(minDistance, VectorAdd(PlaneDistance(planes[p], x, y, z), r));
+		}
+
+		visible += StoreVisible(minDistance, &outVisible[i], num);
+	}
+
+	return visible;
+}
+
+int32 VectorBatch::CullBounds(const Plane* planes, int32 numPlanes, const BoundsArray& bounds, uint8* outVisible)
+{
+	return CullBounds(planes, numPlanes, bounds, 0, bounds.Size(), outVisible);
+}
+
+int32 VectorBatch::CullBounds(const Plane* planes, int32 numPlanes, const BoundsArray& bounds, int32 first, int32 count, uint8* outVisible)
+{
+	const int32 last = first + count;
+	int32 visible = 0;
+
+	for (int32 i = first; i < last; i += BATCH_WIDTH)
+	{
+		const int32 num = last - i;
+		const VectorRegister minX = LoadBatch(&bounds.min.x[i], num, 0.0f);
+		const VectorRegister minY = LoadBatch(&bounds.min.y[i], num, 0.0f);
+		const VectorRegister minZ = LoadBatch(&bounds.min.z[i], num, 0.0f);
+		const VectorRegister maxX = LoadBatch(&bounds.max.x[i], num, 0.0f);
+		const VectorRegister maxY = LoadBatch(&bounds.max.y[i], num, 0.0f);
+		const VectorRegister maxZ = LoadBatch(&bounds.max.z[i], num, 0.0f);
+
+		// 平面对所有元素相同，沿法线方向最远的角点只需要按法线的符号选择min或max
+		VectorRegister minDistance = VectorSetFloat1(MAX_FLT);
+		for (int32 p = 0; p < numPlanes; ++p)
+		{
+			const Plane& plane = planes[p];
+			const VectorRegister& x = plane.x >= 0.0f ? maxX : minX;
+			const VectorRegister& y = plane.y >= 0.0f ? maxY : minY;
+			const VectorRegister& z = plane.z >= 0.0f ? maxZ : minZ;
+			minDistance = VectorMin(minDistance, PlaneDistance(plane, x, y, z));
+		}
+
+		visible += StoreVisible(minDistance, &outVisible[i], num);
+	}
+
+	return visible;
+}
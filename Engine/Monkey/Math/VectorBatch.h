@@ -0,0 +1,122 @@
+﻿#pragma once
+
+#include "Common/Common.h"
+#include "Math/Math.h"
+#include "Math/Vector3.h"
+#include "Math/Vector4.h"
+#include "Math/Matrix4x4.h"
+#include "Math/Plane.h"
+#include "Math/VectorRegister.h"
+
+#include <vector>
+
+// SoA布局：x、y、z分别连续存放，一次处理4个元素
+struct Vector3Array
+{
+public:
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+
+public:
+
+	FORCE_INLINE int32 Size() const
+	{
+		return (int32)x.size();
+	}
+
+	FORCE_INLINE void Resize(int32 count)
+	{
+		x.resize(count);
+		y.resize(count);
+		z.resize(count);
+	}
+
+	FORCE_INLINE void Set(int32 index, const Vector3& v)
+	{
+		x[index] = v.x;
+		y[index] = v.y;
+		z[index] = v.z;
+	}
+
+	FORCE_INLINE Vector3 Get(int32 index) const
+	{
+		return Vector3(x[index], y[index], z[index]);
+	}
+};
+
+struct BoundsArray
+{
+public:
+	Vector3Array min;
+	Vector3Array max;
+
+public:
+
+	FORCE_INLINE int32 Size() const
+	{
+		return min.Size();
+	}
+
+	FORCE_INLINE void Resize(int32 count)
+	{
+		min.Resize(count);
+		max.Resize(count);
+	}
+
+	FORCE_INLINE void Set(int32 index, const Vector3& inMin, const Vector3& inMax)
+	{
+		min.Set(index, inMin);
+		max.Set(index, inMax);
+	}
+};
+
+struct SphereArray
+{
+public:
+	Vector3Array		center;
+	std::vector<float>	radius;
+
+public:
+
+	FORCE_INLINE int32 Size() const
+	{
+		return center.Size();
+	}
+
+	FORCE_INLINE void Resize(int32 count)
+	{
+		center.Resize(count);
+		radius.resize(count);
+	}
+
+	FORCE_INLINE void Set(int32 index, const Vector3& inCenter, float inRadius)
+	{
+		center.Set(index, inCenter);
+		radius[index] = inRadius;
+	}
+};
+
+// 批量的点、包围盒、包围球计算。矩阵为行向量约定的仿射矩阵，Plane::PlaneDot(p) >= 0为平面内侧。
+struct VectorBatch
+{
+	// 与Matrix4x4::TransformPosition结果完全相同，in与out可以是同一个数组
+	static void TransformPositions(const Matrix4x4& matrix, const Vector3Array& inPositions, Vector3Array& outPositions);
+
+	// 变换后的包围盒与变换8个角点再求min/max的结果完全相同
+	static void TransformBounds(const Matrix4x4& matrix, const BoundsArray& inBounds, BoundsArray& outBounds);
+
+	// 只处理[first, first + count)，outBounds需要预先分配
+	static void TransformBounds(const Matrix4x4& matrix, const BoundsArray& inBounds, BoundsArray& outBounds, int32 first, int32 count);
+
+	// 合并到outMin、outMax中，调用前需要初始化
+	static void MergeBounds(const BoundsArray& bounds, Vector3& outMin, Vector3& outMax);
+
+	// outVisible[i]为1表示与所有平面相交或者在内侧，返回可见的数量
+	static int32 CullSpheres(const Plane* planes, int32 numPlanes, const SphereArray& spheres, uint8* outVisible);
+
+	static int32 CullBounds(const Plane* planes, int32 numPlanes, const BoundsArray& bounds, uint8* outVisible);
+
+	// 只处理[first, first + count)，结果写入outVisible[first]开始的位置
+	static int32 CullBounds(const Plane* planes, int32 numPlanes, const BoundsArray& bounds, int32 first, int32 count, uint8* outVisible);
+};
@@ -0,0 +1,261 @@
+﻿#pragma once
+
+#include "Configuration/Platform.h"
+#include "Common/Common.h"
+
+// 编译期按平台选择SIMD实现，定义MONKEY_MATH_SCALAR=1可以强制使用标量实现(用于对比测试)。
+// 只使用乘法与加法，不使用FMA，保证与标量实现的运算顺序以及舍入一致。
+#ifndef MONKEY_MATH_SCALAR
+    #define MONKEY_MATH_SCALAR 0
+#endif
+
+#if !MONKEY_MATH_SCALAR && (defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+    #include <xmmintrin.h>
+    #define MONKEY_MATH_SSE     1
+    #define MONKEY_MATH_NEON    0
+#elif !MONKEY_MATH_SCALAR && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+    #include <arm_neon.h>
+    #define MONKEY_MATH_SSE     0
+    #define MONKEY_MATH_NEON    1
+#else
+    #define MONKEY_MATH_SSE     0
+    #define MONKEY_MATH_NEON    0
+#endif
+
+#define MONKEY_MATH_SIMD (MONKEY_MATH_SSE || MONKEY_MATH_NEON)
+
+#if MONKEY_MATH_SSE
+
+typedef __m128 VectorRegister;
+
+FORCE_INLINE VectorRegister VectorLoad(const float* ptr)
+{
+    return _mm_loadu_ps(ptr);
+}
+
+FORCE_INLINE void VectorStore(const VectorRegister& vec, float* ptr)
+{
+    _mm_storeu_ps(ptr, vec);
+}
+
+FORCE_INLINE VectorRegister VectorSetFloat1(float value)
+{
+    return _mm_set1_ps(value);
+}
+
+FORCE_INLINE VectorRegister VectorSet(float x, float y, float z, float w)
+{
+    return _mm_setr_ps(x, y, z, w);
+}
+
+FORCE_INLINE VectorRegister VectorAdd(const VectorRegister& a, const VectorRegister& b)
+{
+    return _mm_add_ps(a, b);
+}
+
+FORCE_INLINE VectorRegister VectorSubtract(const VectorRegister& a, const VectorRegister& b)
+{
+    return _mm_sub_ps(a, b);
+}
+
+FORCE_INLINE VectorRegister VectorMultiply(const VectorRegister& a, const VectorRegister& b)
+{
+    return _mm_mul_ps(a, b);
+}
+
+FORCE_INLINE VectorRegister VectorDivide(const VectorRegister& a, const VectorRegister& b)
+{
+    return _mm_div_ps(a, b);
+}
+
+FORCE_INLINE VectorRegister VectorMin(const VectorRegister& a, const VectorRegister& b)
+{
+    return _mm_min_ps(a, b);
+}
+
+FORCE_INLINE VectorRegister VectorMax(const VectorRegister& a, const VectorRegister& b)
+{
+    return _mm_max_ps(a, b);
+}
+
+// (a[x], a[y], b[z], b[w])
+#define VectorShuffle(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+
+#elif MONKEY_MATH_NEON
+
+typedef float32x4_t VectorRegister;
+
+FORCE_INLINE VectorRegister VectorLoad(const float* ptr)
+{
+    return vld1q_f32(ptr);
+}
+
+FORCE_INLINE void VectorStore(const VectorRegister& vec, float* ptr)
+{
+    vst1q_f32(ptr, vec);
+}
+
+FORCE_INLINE VectorRegister VectorSetFloat1(float value)
+{
+    return vdupq_n_f32(value);
+}
+
+FORCE_INLINE VectorRegister VectorSet(float x, float y, float z, float w)
+{
+    const float values[4] = { x, y, z, w };
+    return vld1q_f32(values);
+}
+
+FORCE_INLINE VectorRegister VectorAdd(const VectorRegister& a, const VectorRegister& b)
+{
+    return vaddq_f32(a, b);
+}
+
+FORCE_INLINE VectorRegister VectorSubtract(const VectorRegister& a, const VectorRegister& b)
+{
+    return vsubq_f32(a, b);
+}
+
+FORCE_INLINE VectorRegister VectorMultiply(const VectorRegister& a, const VectorRegister& b)
+{
+    return vmulq_f32(a, b);
+}
+
+// 与SSE的_mm_div_ps一致使用真正的除法，不使用倒数近似
+FORCE_INLINE VectorRegister VectorDivide(const VectorRegister& a, const VectorRegister& b)
+{
+#if defined(__aarch64__) || defined(_M_ARM64)
+    return vdivq_f32(a, b);
+#else
+    float va[4];
+    float vb[4];
+    vst1q_f32(va, a);
+    vst1q_f32(vb, b);
+    const float values[4] = { va[0] / vb[0], va[1] / vb[1], va[2] / vb[2], va[3] / vb[3] };
+    return vld1q_f32(values);
+#endif
+}
+
+FORCE_INLINE VectorRegister VectorMin(const VectorRegister& a, const VectorRegister& b)
+{
+    return vminq_f32(a, b);
+}
+
+FORCE_INLINE VectorRegister VectorMax(const VectorRegister& a, const VectorRegister& b)
+{
+    return vmaxq_f32(a, b);
+}
+
+// lane都是常量，编译器生成ins/dup指令
+template <int32 X, int32 Y, int32 Z, int32 W>
+FORCE_INLINE VectorRegister VectorShuffleImpl(const VectorRegister& a, const VectorRegister& b)
+{
+    VectorRegister result = vdupq_n_f32(vgetq_lane_f32(a, X));
+    result = vsetq_lane_f32(vgetq_lane_f32(a, Y), result, 1);
+    result = vsetq_lane_f32(vgetq_lane_f32(b, Z), result, 2);
+    result = vsetq_lane_f32(vgetq_lane_f32(b, W), result, 3);
+    return result;
+}
+
+// (a[x], a[y], b[z], b[w])
+#define VectorShuffle(a, b, x, y, z, w) VectorShuffleImpl<x, y, z, w>(a, b)
+
+#else
+
+// 没有SIMD时逐分量计算，批量计算的代码(VectorBatch)不需要再写一份标量版本
+struct VectorRegister
+{
+    float v[4];
+};
+
+FORCE_INLINE VectorRegister VectorLoad(const float* ptr)
+{
+    VectorRegister result = { { ptr[0], ptr[1], ptr[2], ptr[3] } };
+    return result;
+}
+
+FORCE_INLINE void VectorStore(const VectorRegister& vec, float* ptr)
+{
+    ptr[0] = vec.v[0];
+    ptr[1] = vec.v[1];
+    ptr[2] = vec.v[2];
+    ptr[3] = vec.v[3];
+}
+
+FORCE_INLINE VectorRegister VectorSetFloat1(float value)
+{
+    VectorRegister result = { { value, value, value, value } };
+    return result;
+}
+
+FORCE_INLINE VectorRegister VectorSet(float x, float y, float z, float w)
+{
+    VectorRegister result = { { x, y, z, w } };
+    return result;
+}
+
+FORCE_INLINE VectorRegister VectorAdd(const VectorRegister& a, const VectorRegister& b)
+{
+    VectorRegister result = { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } };
+    return result;
+}
+
+FORCE_INLINE VectorRegister VectorSubtract(const VectorRegister& a, const VectorRegister& b)
+{
+    VectorRegister result = { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } };
+    return result;
+}
+
+FORCE_INLINE VectorRegister VectorMultiply(const VectorRegister& a, const VectorRegister& b)
+{
+    VectorRegister result = { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } };
+    return result;
+}
+
+FORCE_INLINE VectorRegister VectorDivide(const VectorRegister& a, const VectorRegister& b)
+{
+    VectorRegister result = { { a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3] } };
+    return result;
+}
+
+// 与_mm_min_ps一致，比较不成立时返回b
+FORCE_INLINE VectorRegister VectorMin(const VectorRegister& a, const VectorRegister& b)
+{
+    VectorRegister result;
+    for (int32 i = 0; i < 4; ++i)
+    {
+        result.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+    }
+    return result;
+}
+
+FORCE_INLINE VectorRegister VectorMax(const VectorRegister& a, const VectorRegister& b)
+{
+    VectorRegister result;
+    for (int32 i = 0; i < 4; ++i)
+    {
+        result.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+    }
+    return result;
+}
+
+template <int32 X, int32 Y, int32 Z, int32 W>
+FORCE_INLINE VectorRegister VectorShuffleImpl(const VectorRegister& a, const VectorRegister& b)
+{
+    VectorRegister result = { { a.v[X], a.v[Y], b.v[Z], b.v[W] } };
+    return result;
+}
+
+// (a[x], a[y], b[z], b[w])
+#define VectorShuffle(a, b, x, y, z, w) VectorShuffleImpl<x, y, z, w>(a, b)
+
+#endif
+
+#define VectorSwizzle(vec, x, y, z, w)  VectorShuffle(vec, vec, x, y, z, w)
+#define VectorReplicate(vec, index)     VectorShuffle(vec, vec, index, index, index, index)
+
+// a * b + c，分开的乘法与加法
+FORCE_INLINE VectorRegister VectorMultiplyAdd(const VectorRegister& a, const VectorRegister& b, const VectorRegister& c)
+{
+    return VectorAdd(VectorMultiply(a, b), c);
+}
@@ -55,6 +55,16 @@ enum VertexAttribute
 	VA_Custom1,
 	VA_Custom2,
 	VA_Custom3,
+	// 压缩格式，每个属性都是4字节的整数倍
+	VA_PositionQ,		// unorm16x4，相对Mesh包围盒量化，w为0
+	VA_UV0Half,			// half2
+	VA_UV1Half,			// half2
+	VA_NormalOct,		// snorm16x2，八面体编码
+	VA_TangentSN16,		// snorm16x4，w为副切线方向
+	VA_ColorUN8,		// unorm8x4
+	VA_SkinIndexU8,		// uint8x4
+	VA_SkinWeightUN8,	// unorm8x4
+	VA_SkinWeightUN16,	// unorm16x4
 	VA_Count,
 };
 
@@ -139,6 +149,33 @@ FORCE_INLINE VertexAttribute StringToVertexAttribute(const char* name)
 	else if (strcmp(name, "inCustom3") == 0) {
 		return VertexAttribute::VA_Custom3;
 	}
+	else if (strcmp(name, "inPositionQ") == 0) {
+		return VertexAttribute::VA_PositionQ;
+	}
+	else if (strcmp(name, "inUV0Half") == 0) {
+		return VertexAttribute::VA_UV0Half;
+	}
+	else if (strcmp(name, "inUV1Half") == 0) {
+		return VertexAttribute::VA_UV1Half;
+	}
+	else if (strcmp(name, "inNormalOct") == 0) {
+		return VertexAttribute::VA_NormalOct;
+	}
+	else if (strcmp(name, "inTangentSN16") == 0) {
+		return VertexAttribute::VA_TangentSN16;
+	}
+	else if (strcmp(name, "inColorUN8") == 0) {
+		return VertexAttribute::VA_ColorUN8;
+	}
+	else if (strcmp(name, "inSkinIndexU8") == 0) {
+		return VertexAttribute::VA_SkinIndexU8;
+	}
+	else if (strcmp(name, "inSkinWeightUN8") == 0) {
+		return VertexAttribute::VA_SkinWeightUN8;
+	}
+	else if (strcmp(name, "inSkinWeightUN16") == 0) {
+		return VertexAttribute::VA_SkinWeightUN16;
+	}
 	
 	return VertexAttribute::VA_None;
 }
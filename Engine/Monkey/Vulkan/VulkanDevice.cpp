@@ -14,6 +14,8 @@ VulkanDevice::VulkanDevice(VkPhysicalDevice physicalDevice)
     , m_FenceManager(nullptr)
     , m_MemoryManager(nullptr)
 	, m_PhysicalDeviceFeatures2(nullptr)
+	, m_TimelineSemaphoreSupported(false)
+	, m_HostQueryResetSupported(false)
 {
     
 }
@@ -60,6 +62,56 @@ void VulkanDevice::CreateDevice()
 		deviceInfo.pEnabledFeatures = &m_PhysicalDeviceFeatures;
 	}
 
+	// 扩展可用并且支持该特性时开启timeline semaphore
+	VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures;
+	ZeroVulkanStruct(timelineFeatures, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR);
+	m_TimelineSemaphoreSupported = false;
+#if !PLATFORM_IOS && !PLATFORM_ANDROID
+	for (int32 i = 0; i < deviceExtensions.size(); ++i)
+	{
+		if (strcmp(deviceExtensions[i], VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) != 0) {
+			continue;
+		}
+
+		VkPhysicalDeviceFeatures2 features2;
+		ZeroVulkanStruct(features2, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2);
+		features2.pNext = &timelineFeatures;
+		vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &features2);
+
+		if (timelineFeatures.timelineSemaphore) {
+			timelineFeatures.pNext       = (void*)deviceInfo.pNext;
+			deviceInfo.pNext             = &timelineFeatures;
+			m_TimelineSemaphoreSupported = true;
+		}
+		break;
+	}
+#endif
+
+	// 支持时在CPU端重置Query，避免读到重置之前的结果
+	VkPhysicalDeviceHostQueryResetFeaturesEXT hostQueryResetFeatures;
+	ZeroVulkanStruct(hostQueryResetFeatures, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES_EXT);
+	m_HostQueryResetSupported = false;
+#if !PLATFORM_IOS && !PLATFORM_ANDROID
+	for (int32 i = 0; i < deviceExtensions.size(); ++i)
+	{
+		if (strcmp(deviceExtensions[i], VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME) != 0) {
+			continue;
+		}
+
+		VkPhysicalDeviceFeatures2 features2;
+		ZeroVulkanStruct(features2, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2);
+		features2.pNext = &hostQueryResetFeatures;
+		vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &features2);
+
+		if (hostQueryResetFeatures.hostQueryReset) {
+			hostQueryResetFeatures.pNext = (void*)deviceInfo.pNext;
+			deviceInfo.pNext             = &hostQueryResetFeatures;
+			m_HostQueryResetSupported    = true;
+		}
+		break;
+	}
+#endif
+
     MLOG("Found %d Queue Families", (int32)m_QueueFamilyProps.size());
     
 	std::vector<VkDeviceQueueCreateInfo> queueFamilyInfos;
@@ -75,10 +75,25 @@ public:
         return m_PhysicalDeviceFeatures;
     }
     
+    FORCE_INLINE const std::vector<VkQueueFamilyProperties>& GetQueueFamilyProperties() const
+    {
+        return m_QueueFamilyProps;
+    }
+    
     FORCE_INLINE VkDevice GetInstanceHandle() const
     {
         return m_Device;
     }
+
+    FORCE_INLINE bool IsTimelineSemaphoreSupported() const
+    {
+        return m_TimelineSemaphoreSupported;
+    }
+
+    FORCE_INLINE bool IsHostQueryResetSupported() const
+    {
+        return m_HostQueryResetSupported;
+    }
     
     FORCE_INLINE const VkFormatProperties* GetFormatProperties() const
     {
@@ -141,4 +156,6 @@ private:
 
 	std::vector<const char*>				m_AppDeviceExtensions;
 	VkPhysicalDeviceFeatures2*				m_PhysicalDeviceFeatures2;
+	bool									m_TimelineSemaphoreSupported;
+	bool									m_HostQueryResetSupported;
 };
@@ -69,14 +69,16 @@ void VulkanRHI::InitInstance()
     RecreateSwapChain();
 }
 
-void VulkanRHI::RecreateSwapChain()
+VulkanRHI::ReleaseFunc VulkanRHI::RecreateSwapChain()
 {
-	DestorySwapChain();
+	std::shared_ptr<VulkanSwapChain> oldSwapChain = m_SwapChain;
+	std::vector<VkImageView> oldViews = m_BackbufferViews;
 
     uint32 desiredNumBackBuffers = 3;
     int32 width  = Engine::Get()->GetPlatformWindow()->GetWidth();
     int32 height = Engine::Get()->GetPlatformWindow()->GetHeight();
-    m_SwapChain  = std::shared_ptr<VulkanSwapChain>(new VulkanSwapChain(m_Instance, m_Device, m_PixelFormat, width, height, &desiredNumBackBuffers, m_BackbufferImages, 1));
+    m_SwapChain  = std::shared_ptr<VulkanSwapChain>(new VulkanSwapChain(m_Instance, m_Device, m_PixelFormat, width, height, &desiredNumBackBuffers, m_BackbufferImages, 1, oldSwapChain.get()));
+	m_SwapChainDirty = false;
 	
 	m_BackbufferViews.resize(m_BackbufferImages.size());
 	for (int32 i = 0; i < m_BackbufferViews.size(); ++i)
@@ -95,6 +97,19 @@ void VulkanRHI::RecreateSwapChain()
         VERIFYVULKANRESULT(vkCreateImageView(m_Device->GetInstanceHandle(), &imageViewCreateInfo, VULKAN_CPU_ALLOCATOR, &(m_BackbufferViews[i])));
     }
 
+	if (!oldSwapChain) {
+		return nullptr;
+	}
+
+	// 旧的swapchain已经retired，只需等待引用它的帧结束后释放
+	VkDevice device = m_Device->GetInstanceHandle();
+	return [device, oldSwapChain, oldViews]() mutable {
+		for (int32 i = 0; i < oldViews.size(); ++i) {
+			vkDestroyImageView(device, oldViews[i], VULKAN_CPU_ALLOCATOR);
+		}
+		oldViews.clear();
+		oldSwapChain = nullptr;
+	};
 }
 
 void VulkanRHI::DestorySwapChain()
@@ -104,6 +119,7 @@ void VulkanRHI::DestorySwapChain()
 	for (int32 i = 0; i < m_BackbufferViews.size(); ++i) {
 		vkDestroyImageView(m_Device->GetInstanceHandle(), m_BackbufferViews[i], VULKAN_CPU_ALLOCATOR);
 	}
+	m_BackbufferViews.clear();
 }
 
 void VulkanRHI::CreateInstance()
@@ -7,6 +7,7 @@
 #include "RHIDefinitions.h"
 
 #include <string>
+#include <functional>
 
 class VulkanDevice;
 class VulkanQueue;
@@ -15,6 +16,8 @@ class VulkanSwapChain;
 class VulkanRHI
 {
 public:
+	typedef std::function<void()> ReleaseFunc;
+
 	VulkanRHI();
 
 	virtual ~VulkanRHI();
@@ -60,6 +63,21 @@ public:
 		return m_BackbufferViews;
 	}
 
+	FORCE_INLINE bool IsSwapChainDirty() const
+	{
+		return m_SwapChainDirty;
+	}
+
+	// 窗口尺寸变化时只做标记，由渲染循环在下一次Acquire之前重建
+	FORCE_INLINE void SetSwapChainDirty(bool dirty)
+	{
+		m_SwapChainDirty = dirty;
+	}
+
+	// 以当前swapchain作为oldSwapchain重建，不等待设备空闲。
+	// 旧的swapchain与ImageView由返回的函数释放，调用者需要在引用它们的帧执行完毕之后调用。
+	ReleaseFunc RecreateSwapChain();
+
 	FORCE_INLINE const PixelFormat& GetPixelFormat() const
 	{
 		return m_PixelFormat;
@@ -101,8 +119,6 @@ protected:
 
 	void InitInstance();
 
-	void RecreateSwapChain();
-
 	void DestorySwapChain();
 
 protected:
@@ -124,6 +140,7 @@ protected:
 	PixelFormat							m_PixelFormat;
 	std::vector<VkImage>				m_BackbufferImages;
 	std::vector<VkImageView>			m_BackbufferViews;
+	bool								m_SwapChainDirty = false;
 };
 
 
@@ -5,7 +5,7 @@
 #include "Math/Math.h"
 
 VulkanSwapChain::VulkanSwapChain(VkInstance instance, std::shared_ptr<VulkanDevice> device, PixelFormat& outPixelFormat, uint32 width, uint32 height,
-	uint32* outDesiredNumBackBuffers, std::vector<VkImage>& outImages, int8 lockToVsync)
+	uint32* outDesiredNumBackBuffers, std::vector<VkImage>& outImages, int8 lockToVsync, VulkanSwapChain* oldSwapChain)
 	: m_Instance(instance)
 	, m_SwapChain(VK_NULL_HANDLE)
     , m_Surface(VK_NULL_HANDLE)
@@ -20,8 +20,14 @@ VulkanSwapChain::VulkanSwapChain(VkInstance instance, std::shared_ptr<VulkanDevi
 	, m_PresentID(0)
 {
 
-	// 创建Surface
-	VulkanPlatform::CreateSurface(instance, &m_Surface);
+	// 创建Surface，重建时从旧的swapchain接管
+	if (oldSwapChain) {
+		m_Surface = oldSwapChain->m_Surface;
+		oldSwapChain->m_Surface = VK_NULL_HANDLE;
+	}
+	else {
+		VulkanPlatform::CreateSurface(instance, &m_Surface);
+	}
 
 	// 设置Present Queue
 	m_Device->SetupPresentQueue(m_Surface);
@@ -189,7 +195,7 @@ VulkanSwapChain::VulkanSwapChain(VkInstance instance, std::shared_ptr<VulkanDevi
 	m_SwapChainInfo.imageArrayLayers	= 1;
 	m_SwapChainInfo.imageSharingMode	= VK_SHARING_MODE_EXCLUSIVE;
 	m_SwapChainInfo.presentMode			= presentMode;
-	m_SwapChainInfo.oldSwapchain		= VK_NULL_HANDLE;
+	m_SwapChainInfo.oldSwapchain		= oldSwapChain ? oldSwapChain->m_SwapChain : VK_NULL_HANDLE;
 	m_SwapChainInfo.clipped				= VK_TRUE;
 	m_SwapChainInfo.compositeAlpha		= compositeAlpha;
 	
@@ -243,7 +249,10 @@ VulkanSwapChain::~VulkanSwapChain()
 	}
     
 	vkDestroySwapchainKHR(device, m_SwapChain, VULKAN_CPU_ALLOCATOR);
-    vkDestroySurfaceKHR(m_Instance, m_Surface, VULKAN_CPU_ALLOCATOR);
+
+	if (m_Surface != VK_NULL_HANDLE) {
+		vkDestroySurfaceKHR(m_Instance, m_Surface, VULKAN_CPU_ALLOCATOR);
+	}
 }
 
 int32 VulkanSwapChain::AcquireImageIndex(VkSemaphore* outSemaphore)
@@ -21,7 +21,8 @@ public:
 		SurfaceLost = -2,
 	};
 
-	VulkanSwapChain(VkInstance instance, std::shared_ptr<VulkanDevice> device, PixelFormat& outPixelFormat, uint32 width, uint32 height, uint32* outDesiredNumBackBuffers, std::vector<VkImage>& outImages, int8 lockToVsync);
+	// oldSwapChain不为空时复用它的Surface并作为oldSwapchain，旧的swapchain由调用者在其帧结束后释放
+	VulkanSwapChain(VkInstance instance, std::shared_ptr<VulkanDevice> device, PixelFormat& outPixelFormat, uint32 width, uint32 height, uint32* outDesiredNumBackBuffers, std::vector<VkImage>& outImages, int8 lockToVsync, VulkanSwapChain* oldSwapChain = nullptr);
 
 	virtual ~VulkanSwapChain();
 
@@ -66,6 +66,15 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width / 3.0f, height);
+
+        // CommandBuffer只录制一次，引用了旧的FrameBuffer。等待之前的提交执行完毕后重新录制
+        DemoBase::WaitIdle();
+        SetupCommandBuffers();
+    }
+
 private:
 
     struct MVPBlock
@@ -65,6 +65,15 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+
+        // CommandBuffer只录制一次，引用了旧的FrameBuffer。等待之前的提交执行完毕后重新录制
+        DemoBase::WaitIdle();
+        SetupCommandBuffers();
+    }
+
 private:
 
     struct ModelBlock
@@ -67,6 +67,14 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        // attachment已在CreateFrameBuffers中重建，DescriptorSet与CommandBuffer仍引用旧的attachment。等待之前的提交执行完毕后改写
+        DemoBase::WaitIdle();
+        UpdateAttachmentDescriptorSets();
+        SetupCommandBuffers();
+    }
+
 protected:
 
     void CreateFrameBuffers() override
@@ -90,6 +98,13 @@ protected:
 
         const std::vector<VkImageView>& backbufferViews = GetVulkanRHI()->GetBackbufferViews();
 
+        // swapchain重建之后attachment的尺寸与数量需要与backbuffer保持一致
+        if (m_AttachsColor.size() != backbufferViews.size() || m_AttachsColor[0]->width != fwidth || m_AttachsColor[0]->height != fheight)
+        {
+            ReleaseAttachments();
+            CreateAttachments();
+        }
+
         m_FrameBuffers.resize(backbufferViews.size());
         for (uint32 i = 0; i < m_FrameBuffers.size(); ++i)
         {
@@ -135,6 +150,25 @@ protected:
         m_AttachsNormal.clear();
     }
 
+    void ReleaseAttachments()
+    {
+        // 之前提交的帧可能仍在使用旧的attachment，执行完毕之后再释放
+        DVKTextureArray textures;
+        textures.insert(textures.end(), m_AttachsColor.begin(), m_AttachsColor.end());
+        textures.insert(textures.end(), m_AttachsNormal.begin(), m_AttachsNormal.end());
+        textures.insert(textures.end(), m_AttachsDepth.begin(), m_AttachsDepth.end());
+        m_AttachsColor.clear();
+        m_AttachsNormal.clear();
+        m_AttachsDepth.clear();
+
+        m_Scheduler->DeferRelease([=]() {
+            for (int32 i = 0; i < textures.size(); ++i)
+            {
+                delete textures[i];
+            }
+        });
+    }
+
     void CreateAttachments()
     {
         auto swapChain  = GetVulkanRHI()->GetSwapChain();
@@ -550,14 +584,23 @@ private:
         m_DescriptorSet0->WriteBuffer("uboViewProj", m_ViewProjBuffer);
         m_DescriptorSet0->WriteBuffer("uboModel",    &m_ModelBufferInfo);
 
-        m_DescriptorSets.resize(m_AttachsColor.size());
-        for (int32 i = 0; i < m_DescriptorSets.size(); ++i)
+        UpdateAttachmentDescriptorSets();
+    }
+
+    void UpdateAttachmentDescriptorSets()
+    {
+        // backbuffer数量增加时补充DescriptorSet，已有的只改写attachment
+        for (int32 i = m_DescriptorSets.size(); i < m_AttachsColor.size(); ++i)
+        {
+            m_DescriptorSets.push_back(m_Shader1->AllocateDescriptorSet());
+            m_DescriptorSets[i]->WriteBuffer("param", m_DebugBuffer);
+        }
+
+        for (int32 i = 0; i < m_AttachsColor.size(); ++i)
         {
-            m_DescriptorSets[i] = m_Shader1->AllocateDescriptorSet();
             m_DescriptorSets[i]->WriteImage("inputColor", m_AttachsColor[i]);
             m_DescriptorSets[i]->WriteImage("inputNormal", m_AttachsNormal[i]);
             m_DescriptorSets[i]->WriteImage("inputDepth", m_AttachsDepth[i]);
-            m_DescriptorSets[i]->WriteBuffer("param", m_DebugBuffer);
         }
     }
 
@@ -84,6 +84,13 @@ protected:
 
         const std::vector<VkImageView>& backbufferViews = GetVulkanRHI()->GetBackbufferViews();
 
+        // swapchain重建之后attachment的尺寸与数量需要与backbuffer保持一致
+        if (m_AttachsColor.size() != backbufferViews.size() || m_AttachsColor[0]->width != fwidth || m_AttachsColor[0]->height != fheight)
+        {
+            ReleaseAttachments();
+            CreateAttachments();
+        }
+
         m_FrameBuffers.resize(backbufferViews.size());
         for (uint32 i = 0; i < m_FrameBuffers.size(); ++i)
         {
@@ -129,6 +136,25 @@ protected:
         m_AttachsNormal.clear();
     }
 
+    void ReleaseAttachments()
+    {
+        // 之前提交的帧可能仍在使用旧的attachment，执行完毕之后再释放
+        DVKTextureArray textures;
+        textures.insert(textures.end(), m_AttachsColor.begin(), m_AttachsColor.end());
+        textures.insert(textures.end(), m_AttachsNormal.begin(), m_AttachsNormal.end());
+        textures.insert(textures.end(), m_AttachsDepth.begin(), m_AttachsDepth.end());
+        m_AttachsColor.clear();
+        m_AttachsNormal.clear();
+        m_AttachsDepth.clear();
+
+        m_Scheduler->DeferRelease([=]() {
+            for (int32 i = 0; i < textures.size(); ++i)
+            {
+                delete textures[i];
+            }
+        });
+    }
+
     void CreateAttachments()
     {
         auto swapChain  = GetVulkanRHI()->GetSwapChain();
@@ -365,15 +391,27 @@ private:
 
         UpdateUniform(time, delta);
 
-        // 设置model的参数
+        // 不可见的Mesh在间接绘制命令中instanceCount为0
+        m_FrustumCuller.Cull(m_Model, m_ViewCamera.GetFrustum());
+
+        // 设置model的参数，间接绘制时Model矩阵从StorageBuffer中读取
         m_Material0->BeginFrame();
-        for (int32 i = 0; i < m_Model->meshes.size(); ++i)
+        if (m_Indirect)
         {
             m_Material0->BeginObject();
-            m_Material0->SetLocalUniform("uboModel",    &(m_Model->meshes[i]->linkNode->GetGlobalMatrix()), sizeof(Matrix4x4));
-            m_Material0->SetLocalUniform("uboViewProj", &m_ViewProjData,                                    sizeof(m_ViewProjData));
+            m_Material0->SetLocalUniform("uboViewProj", &m_ViewProjData, sizeof(m_ViewProjData));
             m_Material0->EndObject();
         }
+        else
+        {
+            for (int32 i = 0; i < m_Model->meshes.size(); ++i)
+            {
+                m_Material0->BeginObject();
+                m_Material0->SetLocalUniform("uboModel",    &(m_Model->meshes[i]->linkNode->GetGlobalMatrix()), sizeof(Matrix4x4));
+                m_Material0->SetLocalUniform("uboViewProj", &m_ViewProjData,                                    sizeof(m_ViewProjData));
+                m_Material0->EndObject();
+            }
+        }
         m_Material0->EndFrame();
 
         // 设置postprocess的参数
@@ -424,6 +462,8 @@ private:
             ImGui::SliderInt("Index", &index, 0, 3);
             m_VertFragParam.attachmentIndex = index;
 
+            ImGui::Text("Indirect:%s Visible:%d/%d", m_Indirect ? "True" : "False", m_FrustumCuller.visibleCount, (int32)m_Model->meshes.size());
+
             if (ImGui::Button("Random"))
             {
                 vk_demo::DVKBoundingBox bounds = m_Model->rootNode->GetBounds();
@@ -461,22 +501,62 @@ private:
 
     void LoadAssets()
     {
+        // 间接绘制时firstInstance为Mesh的索引，需要drawIndirectFirstInstance
+        m_Indirect = m_VulkanDevice->GetPhysicalFeatures().drawIndirectFirstInstance;
+
         // shader0
         m_Shader0 = vk_demo::DVKShader::Create(
             m_VulkanDevice,
             true,
-            "assets/shaders/20_Material/obj.vert.spv",
+            m_Indirect ? "assets/shaders/20_Material/objIndirect.vert.spv" : "assets/shaders/20_Material/obj.vert.spv",
             "assets/shaders/20_Material/obj.frag.spv"
         );
 
-        // 加载Model
+        // 加载Model，所有Mesh共用一个Vertex Buffer与Index Buffer
         vk_demo::DVKCommandBuffer* cmdBuffer = vk_demo::DVKCommandBuffer::Create(m_VulkanDevice, m_CommandPool);
         m_Model = vk_demo::DVKModel::LoadFromFile(
             "assets/models/Room/miniHouse_FBX.FBX",
             m_VulkanDevice,
             cmdBuffer,
-            m_Shader0->perVertexAttributes
+            m_Shader0->perVertexAttributes,
+            vk_demo::MIF_MergeBuffers
         );
+
+        if (m_Indirect)
+        {
+            std::vector<Matrix4x4> models(m_Model->meshes.size());
+            for (int32 i = 0; i < m_Model->meshes.size(); ++i)
+            {
+                models[i] = m_Model->meshes[i]->linkNode->GetGlobalMatrix();
+            }
+
+            vk_demo::DVKBuffer* stagingBuffer = vk_demo::DVKBuffer::CreateBuffer(
+                m_VulkanDevice,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                models.size() * sizeof(Matrix4x4),
+                models.data()
+            );
+
+            m_ModelBuffer = vk_demo::DVKBuffer::CreateBuffer(
+                m_VulkanDevice,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                models.size() * sizeof(Matrix4x4)
+            );
+
+            cmdBuffer->Begin();
+
+            VkBufferCopy copyRegion = {};
+            copyRegion.size = models.size() * sizeof(Matrix4x4);
+            vkCmdCopyBuffer(cmdBuffer->cmdBuffer, stagingBuffer->buffer, m_ModelBuffer->buffer, 1, &copyRegion);
+
+            cmdBuffer->End();
+            cmdBuffer->Submit();
+
+            delete stagingBuffer;
+        }
+
         delete cmdBuffer;
 
         // 设置gbuffer material
@@ -489,6 +569,10 @@ private:
         // 这里还需要手动指定，以后封装了renderpass之后，可以在内部自动获取
         m_Material0->pipelineInfo.colorAttachmentCount = 2;
         m_Material0->PreparePipeline();
+        if (m_Indirect)
+        {
+            m_Material0->SetStorageBuffer("inModels", m_ModelBuffer);
+        }
 
         // shader1
         m_Shader1 = vk_demo::DVKShader::Create(
@@ -515,6 +599,7 @@ private:
     void DestroyAssets()
     {
         delete m_Model;
+        delete m_ModelBuffer;
 
         delete m_Shader0;
         delete m_Shader1;
@@ -568,6 +653,13 @@ private:
         VkCommandBuffer commandBuffer = m_CommandBuffers[backBufferIndex];
 
         VERIFYVULKANRESULT(vkBeginCommandBuffer(commandBuffer, &cmdBeginInfo));
+
+        // 可见性每帧变化，需要在RenderPass之外更新间接绘制命令
+        if (m_Indirect)
+        {
+            m_Model->UpdateIndirectCommands(commandBuffer, m_FrustumCuller.GetVisibility());
+        }
+
         vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
         vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
@@ -576,10 +668,24 @@ private:
         // pass0
         {
             vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Material0->GetPipeline());
-            for (int32 meshIndex = 0; meshIndex < m_Model->meshes.size(); ++meshIndex)
+            if (m_Indirect)
+            {
+                m_Material0->BindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, 0);
+                m_Model->DrawIndirect(commandBuffer);
+            }
+            else
             {
-                m_Material0->BindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshIndex);
-                m_Model->meshes[meshIndex]->BindDrawCmd(commandBuffer);
+                // 共用的Buffer只需要绑定一次
+                m_Model->BindBuffers(commandBuffer);
+                for (int32 meshIndex = 0; meshIndex < m_Model->meshes.size(); ++meshIndex)
+                {
+                    if (!m_FrustumCuller.IsVisible(meshIndex))
+                    {
+                        continue;
+                    }
+                    m_Material0->BindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshIndex);
+                    m_Model->meshes[meshIndex]->DrawOnly(commandBuffer);
+                }
             }
         }
 
@@ -666,6 +772,9 @@ private:
     LightSpawnBlock                 m_LightInfos;
 
     vk_demo::DVKModel*              m_Model = nullptr;
+    vk_demo::DVKBuffer*             m_ModelBuffer = nullptr;
+    vk_demo::DVKFrustumCuller       m_FrustumCuller;
+    bool                            m_Indirect = false;
 
     vk_demo::DVKShader*             m_Shader0 = nullptr;
     vk_demo::DVKMaterial*           m_Material0 = nullptr;
@@ -96,6 +96,25 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+        UpdateFilterFrameSize();
+
+        // 离屏RenderTarget按窗口尺寸创建。Filter的DescriptorSet不能在使用中改写，等待之前的提交执行完毕后重建
+        DemoBase::WaitIdle();
+        FrameBufferObject renderTarget = m_RenderTarget;
+        m_Scheduler->DeferRelease([=]() mutable {
+            renderTarget.Destroy();
+        });
+
+        CreateRenderTarget();
+        for (int32 i = 0; i < ImageFilterType::FilterCount; ++i)
+        {
+            m_FilterItems[i].material->SetTexture("inputImageTexture", m_RenderTarget.color);
+        }
+    }
+
 private:
 
     struct FilterItem
@@ -1187,13 +1206,9 @@ private:
 
         {
             filter3x3ConvolutionParam.lineSize    = 1.0f;
-            filter3x3ConvolutionParam.texelWidth  = 1.0f / m_FrameWidth;
-            filter3x3ConvolutionParam.texelHeight = 1.0f / m_FrameHeight;
         }
 
         {
-            filterBilateralBlurParam.singleStepOffset.x = 1.0f / m_FrameWidth;
-            filterBilateralBlurParam.singleStepOffset.y = 1.0f / m_FrameHeight;
             filterBilateralBlurParam.distanceNormalizationFactor = 0.8f;
         }
 
@@ -1202,7 +1217,6 @@ private:
         }
 
         {
-            filterBulgeDistortionParam.aspectRatio = (float)m_FrameHeight / m_FrameWidth;
             filterBulgeDistortionParam.radius      = 0.25f;
             filterBulgeDistortionParam.scale       = 0.5f;
             filterBulgeDistortionParam.center.x    = 0.5f;
@@ -1235,8 +1249,6 @@ private:
 
         {
             filterDirectionalSobelEdgeDetectionParam.lineSize    = 1.0f;
-            filterDirectionalSobelEdgeDetectionParam.texelWidth  = 1.0f / m_FrameWidth;
-            filterDirectionalSobelEdgeDetectionParam.texelHeight = 1.0f / m_FrameHeight;
         }
 
         {
@@ -1256,12 +1268,10 @@ private:
             filterGlassSphereParam.center.Set(0.5f, 0.5f, 0.0f, 0.0f);
             filterGlassSphereParam.radius = 0.25f;
             filterGlassSphereParam.refractiveIndex = 0.71f;
-            filterGlassSphereParam.aspectRatio = (float)m_FrameHeight / m_FrameWidth;
         }
 
         {
             filterHalftoneParam.fractionalWidthOfPixel = 0.01f;
-            filterHalftoneParam.aspectRatio = (float)m_FrameHeight / m_FrameWidth;
         }
 
         {
@@ -1301,8 +1311,6 @@ private:
         }
 
         {
-            filterPixelationParam.imageWidthFactor = 1.0f / m_FrameWidth;
-            filterPixelationParam.imageHeightFactor = 1.0f / m_FrameHeight;
             filterPixelationParam.pixel = 5.0f;
         }
 
@@ -1311,8 +1319,6 @@ private:
         }
 
         {
-            filterSharpenParam.imageWidthFactor = 1.0f / m_FrameWidth;
-            filterSharpenParam.imageHeightFactor = 1.0f / m_FrameHeight;
             filterSharpenParam.sharpness = 2.0f;
         }
 
@@ -1324,8 +1330,36 @@ private:
             filterSphereRefractionParam.center.Set(0.5f, 0.5f, 0.0f, 0.0f);
             filterSphereRefractionParam.radius = 0.25f;
             filterSphereRefractionParam.refractiveIndex = 0.71f;
-            filterSphereRefractionParam.aspectRatio = (float)m_FrameHeight / m_FrameWidth;
         }
+
+        UpdateFilterFrameSize();
+    }
+
+    void UpdateFilterFrameSize()
+    {
+        // 与窗口尺寸相关的Filter参数，窗口缩放之后需要重新计算
+        filter3x3ConvolutionParam.texelWidth  = filter3x3ConvolutionParam.lineSize / m_FrameWidth;
+        filter3x3ConvolutionParam.texelHeight = filter3x3ConvolutionParam.lineSize / m_FrameHeight;
+
+        filterBilateralBlurParam.singleStepOffset.x = 1.0f / m_FrameWidth;
+        filterBilateralBlurParam.singleStepOffset.y = 1.0f / m_FrameHeight;
+
+        filterBulgeDistortionParam.aspectRatio = (float)m_FrameHeight / m_FrameWidth;
+
+        filterDirectionalSobelEdgeDetectionParam.texelWidth  = filterDirectionalSobelEdgeDetectionParam.lineSize / m_FrameWidth;
+        filterDirectionalSobelEdgeDetectionParam.texelHeight = filterDirectionalSobelEdgeDetectionParam.lineSize / m_FrameHeight;
+
+        filterGlassSphereParam.aspectRatio = (float)m_FrameHeight / m_FrameWidth;
+
+        filterHalftoneParam.aspectRatio = (float)m_FrameHeight / m_FrameWidth;
+
+        filterPixelationParam.imageWidthFactor  = 1.0f / m_FrameWidth;
+        filterPixelationParam.imageHeightFactor = 1.0f / m_FrameHeight;
+
+        filterSharpenParam.imageWidthFactor  = 1.0f / m_FrameWidth;
+        filterSharpenParam.imageHeightFactor = 1.0f / m_FrameHeight;
+
+        filterSphereRefractionParam.aspectRatio = (float)m_FrameHeight / m_FrameWidth;
     }
 
     void CreateGUI()
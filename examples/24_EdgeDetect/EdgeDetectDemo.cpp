@@ -60,6 +60,30 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+        m_FilterParam.width  = width;
+        m_FilterParam.height = height;
+
+        // 离屏RenderTarget按窗口尺寸创建。Material的DescriptorSet不能在使用中改写，等待之前的提交执行完毕后重建
+        DemoBase::WaitIdle();
+        vk_demo::DVKRenderTarget* renderTarget = m_RenderTarget;
+        vk_demo::DVKTexture* rtColor  = m_RTColor;
+        vk_demo::DVKTexture* rtNormal = m_RTNormal;
+        vk_demo::DVKTexture* rtDepth  = m_RTDepth;
+        m_Scheduler->DeferRelease([=]() {
+            delete renderTarget;
+            delete rtColor;
+            delete rtNormal;
+            delete rtDepth;
+        });
+
+        CreateRenderTarget();
+        m_FilterMaterial->SetTexture("diffuseTexture", m_RTColor);
+        m_FilterMaterial->SetTexture("normalsTexture", m_RTNormal);
+    }
+
 private:
 
     struct ModelViewProjectionBlock
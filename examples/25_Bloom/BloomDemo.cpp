@@ -60,6 +60,39 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+        m_FilterParam.width  = width / 4.0f;
+        m_FilterParam.height = height / 4.0f;
+
+        // 离屏RenderTarget按窗口尺寸创建。Material的DescriptorSet不能在使用中改写，等待之前的提交执行完毕后重建
+        DemoBase::WaitIdle();
+        vk_demo::DVKRenderTarget* rttNormal  = m_RTTNormal;
+        vk_demo::DVKRenderTarget* rttQuater0 = m_RTTQuater0;
+        vk_demo::DVKRenderTarget* rttQuater1 = m_RTTQuater1;
+        vk_demo::DVKTexture* rtColor        = m_RTColor;
+        vk_demo::DVKTexture* rtColorQuater0 = m_RTColorQuater0;
+        vk_demo::DVKTexture* rtColorQuater1 = m_RTColorQuater1;
+        vk_demo::DVKTexture* rtDepth        = m_RTDepth;
+        m_Scheduler->DeferRelease([=]() {
+            delete rttNormal;
+            delete rttQuater0;
+            delete rttQuater1;
+            delete rtColor;
+            delete rtColorQuater0;
+            delete rtColorQuater1;
+            delete rtDepth;
+        });
+
+        CreateRenderTarget();
+        m_BrightMaterial->SetTexture("diffuseTexture", m_RTColor);
+        m_BlurHMaterial->SetTexture("diffuseTexture", m_RTColorQuater0);
+        m_BlurVMateria->SetTexture("diffuseTexture", m_RTColorQuater1);
+        m_CombineMaterial->SetTexture("originTexture", m_RTColor);
+        m_CombineMaterial->SetTexture("filterTexture", m_RTColorQuater0);
+    }
+
 private:
 
     struct ModelViewProjectionBlock
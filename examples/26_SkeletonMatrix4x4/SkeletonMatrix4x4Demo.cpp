@@ -58,6 +58,11 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+    }
+
 private:
 
     struct ModelViewProjectionBlock
@@ -88,6 +93,20 @@ private:
 
         UpdateAnimation(time, delta);
 
+        // 非阻塞获取之前帧的结果
+        m_StatsQuery->Poll();
+
+        // 蒙皮之后的顶点位于模型空间
+        if (m_ComputeSkin)
+        {
+            m_MVPData.model.SetIdentity();
+            m_StaticMaterial->BeginFrame();
+            m_StaticMaterial->BeginObject();
+            m_StaticMaterial->SetLocalUniform("uboMVP", &m_MVPData, sizeof(ModelViewProjectionBlock));
+            m_StaticMaterial->EndObject();
+            m_StaticMaterial->EndFrame();
+        }
+
         // 设置Room参数
         // m_RoleModel->rootNode->localMatrix.AppendRotation(delta * 90.0f, Vector3::UpVector);
         m_RoleMaterial->BeginFrame();
@@ -161,6 +180,21 @@ private:
                 ImGui::SliderFloat("Time", &m_AnimTime, 0.0f, m_AnimDuration);
             }
 
+            if (ImGui::Checkbox("ComputeSkin", &m_ComputeSkin) && m_ComputeSkin && !m_ComputeSkinner)
+            {
+                CreateComputeSkinner();
+            }
+
+            // 模拟Shadow、深度预渲染以及主Pass多次绘制角色
+            ImGui::SliderInt("Passes", &m_DrawPasses, 1, 4);
+            ImGui::Text("VS Invocations:%d", (int32)m_StatsQuery->GetResult(0, 0));
+            ImGui::Text("CS Invocations:%d", (int32)m_StatsQuery->GetResult(1, 1));
+
+            const vk_demo::DVKAnimationCompressStats& compressStats = m_RoleModel->animCompressStats;
+            ImGui::Text("Anim Keys:%d -> %d", compressStats.keyCountBefore, compressStats.keyCountAfter);
+            ImGui::Text("Anim Size:%.1fKB -> %.1fKB", compressStats.sizeBefore / 1024.0f, compressStats.sizeAfter / 1024.0f);
+            ImGui::Text("Max Error:%.4f %.4frad", compressStats.maxPositionError, compressStats.maxRotationError);
+
             ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
             ImGui::End();
         }
@@ -196,7 +230,8 @@ private:
                 VertexAttribute::VA_Normal,
                 VertexAttribute::VA_SkinIndex,
                 VertexAttribute::VA_SkinWeight
-            }
+            },
+            vk_demo::MIF_CompressAnimation
         );
         m_RoleModel->rootNode->localMatrix.AppendRotation(180, Vector3::UpVector);
 
@@ -227,6 +262,52 @@ private:
         m_RoleMaterial->PreparePipeline();
         m_RoleMaterial->SetTexture("diffuseMap", m_RoleDiffuse);
 
+        // query 0:角色绘制 query 1:计算蒙皮
+        m_StatsQuery = vk_demo::DVKQueryPool::Create(
+            m_VulkanDevice,
+            VK_QUERY_TYPE_PIPELINE_STATISTICS,
+            2,
+            m_CommandBuffers.size(),
+            VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT
+        );
+
+        delete cmdBuffer;
+    }
+
+    // 第一次开启时才创建，计算蒙皮的资源不影响默认的绘制流程
+    void CreateComputeSkinner()
+    {
+        vk_demo::DVKCommandBuffer* cmdBuffer = vk_demo::DVKCommandBuffer::Create(m_VulkanDevice, m_CommandPool);
+
+        m_SkinShader = vk_demo::DVKShader::Create(
+            m_VulkanDevice,
+            "assets/shaders/26_SkeletonMatrix4x4/SkinCompute.comp.spv"
+        );
+
+        m_ComputeSkinner = vk_demo::DVKComputeSkinner::Create(
+            m_VulkanDevice,
+            m_PipelineCache,
+            m_SkinShader,
+            m_RoleModel,
+            cmdBuffer
+        );
+
+        m_StaticShader = vk_demo::DVKShader::Create(
+            m_VulkanDevice,
+            true,
+            "assets/shaders/26_SkeletonMatrix4x4/obj_static.vert.spv",
+            "assets/shaders/26_SkeletonMatrix4x4/obj.frag.spv"
+        );
+
+        m_StaticMaterial = vk_demo::DVKMaterial::Create(
+            m_VulkanDevice,
+            m_RenderPass,
+            m_PipelineCache,
+            m_StaticShader
+        );
+        m_StaticMaterial->PreparePipeline();
+        m_StaticMaterial->SetTexture("diffuseMap", m_RoleDiffuse);
+
         delete cmdBuffer;
     }
 
@@ -236,6 +317,13 @@ private:
         delete m_RoleDiffuse;
         delete m_RoleMaterial;
         delete m_RoleModel;
+
+        delete m_SkinShader;
+        delete m_ComputeSkinner;
+        delete m_StaticShader;
+        delete m_StaticMaterial;
+
+        delete m_StatsQuery;
     }
 
     void SetupCommandBuffers(int32 backBufferIndex)
@@ -260,6 +348,16 @@ private:
         ZeroVulkanStruct(cmdBeginInfo, VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO);
         VERIFYVULKANRESULT(vkBeginCommandBuffer(commandBuffer, &cmdBeginInfo));
 
+        m_StatsQuery->BeginFrame(commandBuffer, backBufferIndex);
+
+        // 每帧只蒙皮一次，之后所有Pass都当作静态模型绘制
+        if (m_ComputeSkin)
+        {
+            m_StatsQuery->BeginQuery(commandBuffer, 1);
+            m_ComputeSkinner->Skin(commandBuffer);
+            m_StatsQuery->EndQuery(commandBuffer, 1);
+        }
+
         VkClearValue clearValues[2];
         clearValues[0].color        = {
             { 0.2f, 0.2f, 0.2f, 1.0f }
@@ -281,12 +379,25 @@ private:
         vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
         vkCmdSetScissor(commandBuffer,  0, 1, &scissor);
 
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_RoleMaterial->GetPipeline());
-        for (int32 j = 0; j < m_RoleModel->meshes.size(); ++j)
+        m_StatsQuery->BeginQuery(commandBuffer, 0);
+        for (int32 pass = 0; pass < m_DrawPasses; ++pass)
         {
-            m_RoleMaterial->BindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, j);
-            m_RoleModel->meshes[j]->BindDrawCmd(commandBuffer);
+            if (m_ComputeSkin)
+            {
+                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_StaticMaterial->GetPipeline());
+                m_StaticMaterial->BindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, 0);
+                m_ComputeSkinner->Draw(commandBuffer);
+                continue;
+            }
+
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_RoleMaterial->GetPipeline());
+            for (int32 j = 0; j < m_RoleModel->meshes.size(); ++j)
+            {
+                m_RoleMaterial->BindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, j);
+                m_RoleModel->meshes[j]->BindDrawCmd(commandBuffer);
+            }
         }
+        m_StatsQuery->EndQuery(commandBuffer, 0);
 
         m_GUI->BindDrawCmd(commandBuffer, m_RenderPass);
 
@@ -335,12 +446,20 @@ private:
     vk_demo::DVKTexture*        m_RoleDiffuse = nullptr;
     vk_demo::DVKMaterial*       m_RoleMaterial = nullptr;
 
+    vk_demo::DVKShader*         m_SkinShader = nullptr;
+    vk_demo::DVKComputeSkinner* m_ComputeSkinner = nullptr;
+    vk_demo::DVKShader*         m_StaticShader = nullptr;
+    vk_demo::DVKMaterial*       m_StaticMaterial = nullptr;
+    vk_demo::DVKQueryPool*      m_StatsQuery = nullptr;
+
     ImageGUIContext*            m_GUI = nullptr;
 
     bool                        m_AutoAnimation = true;
     float                       m_AnimDuration = 0.0f;
     float                       m_AnimTime = 0.0f;
     int32                       m_AnimIndex = 0;
+    bool                        m_ComputeSkin = false;
+    int32                       m_DrawPasses = 1;
 };
 
 std::shared_ptr<AppModuleBase> CreateAppMode(const std::vector<std::string>& cmdLine)
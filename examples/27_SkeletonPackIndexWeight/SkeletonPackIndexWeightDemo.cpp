@@ -58,6 +58,11 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+    }
+
 private:
 
     struct ModelViewProjectionBlock
@@ -161,6 +166,11 @@ private:
                 ImGui::SliderFloat("Time", &m_AnimTime, 0.0f, m_AnimDuration);
             }
 
+            const vk_demo::DVKAnimationCompressStats& compressStats = m_RoleModel->animCompressStats;
+            ImGui::Text("Anim Keys:%d -> %d", compressStats.keyCountBefore, compressStats.keyCountAfter);
+            ImGui::Text("Anim Size:%.1fKB -> %.1fKB", compressStats.sizeBefore / 1024.0f, compressStats.sizeAfter / 1024.0f);
+            ImGui::Text("Max Error:%.4f %.4frad", compressStats.maxPositionError, compressStats.maxRotationError);
+
             ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
             ImGui::End();
         }
@@ -196,7 +206,8 @@ private:
                 VertexAttribute::VA_Normal,
                 VertexAttribute::VA_SkinIndex,
                 VertexAttribute::VA_SkinWeight
-            }
+            },
+            vk_demo::MIF_CompressAnimation
         );
         m_RoleModel->rootNode->localMatrix.AppendRotation(180, Vector3::UpVector);
 
@@ -257,7 +268,7 @@ private:
                 delete primitive->vertexBuffer;
                 delete primitive->indexBuffer;
                 primitive->vertexBuffer = vk_demo::DVKVertexBuffer::Create(m_VulkanDevice, cmdBuffer, primitive->vertices, m_RoleModel->attributes);
-                primitive->indexBuffer  = vk_demo::DVKIndexBuffer::Create(m_VulkanDevice,  cmdBuffer, primitive->indices);
+                primitive->indexBuffer  = vk_demo::DVKIndexBuffer::Create(m_VulkanDevice,  cmdBuffer, primitive->indices, primitive->indexType);
             }
         }
 
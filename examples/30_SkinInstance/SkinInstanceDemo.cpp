@@ -60,6 +60,11 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+    }
+
 private:
 
     struct ParamDataBlock
@@ -88,23 +93,13 @@ private:
             m_AnimTime = m_AnimTime - m_RoleModel->GetAnimation(0).duration;
         }
 
-        // 计算出动画的索引
-        int32 index = 0;
-        for (int32 i = 0; i < m_Keys.size(); ++i)
-        {
-            if (m_AnimTime <= m_Keys[i])
-            {
-                index = i;
-                break;
-            }
-        }
-
-        vk_demo::DVKMesh* mesh = m_RoleModel->meshes[0];
+        // 计算出动画所在的行
+        int32 index = (int32)m_AnimTexture->GetFrame(0, m_AnimTime);
 
         m_ParamData.animIndex.x = m_AnimTexture->width;
         m_ParamData.animIndex.y = m_AnimTexture->height;
-        m_ParamData.animIndex.z = index * mesh->bones.size() * 2;
-        m_ParamData.animIndex.w = m_Keys.size() * mesh->bones.size() * 2;
+        m_ParamData.animIndex.z = index * m_AnimTexture->width;
+        m_ParamData.animIndex.w = m_AnimTexture->animations[0].frameCount * m_AnimTexture->width;
     }
 
     void Draw(float time, float delta)
@@ -189,93 +184,23 @@ private:
 
     void CreateAnimTexture(vk_demo::DVKCommandBuffer* cmdBuffer)
     {
-        std::vector<float> animData(64 * 64 * 4); // 21个骨骼 * 30帧动画数据 * 8
-        vk_demo::DVKAnimation& animation = m_RoleModel->GetAnimation();
-
-        // 获取关键帧信息
-        m_Keys.push_back(0);
-        for (auto it = animation.clips.begin(); it != animation.clips.end(); ++it)
-        {
-            vk_demo::DVKAnimationClip& clip = it->second;
-            for (int32 i = 0; i < clip.positions.keys.size(); ++i)
-            {
-                if (m_Keys.back() < clip.positions.keys[i])
-                {
-                    m_Keys.push_back(clip.positions.keys[i]);
-                }
-            }
-            for (int32 i = 0; i < clip.rotations.keys.size(); ++i)
-            {
-                if (m_Keys.back() < clip.rotations.keys[i])
-                {
-                    m_Keys.push_back(clip.rotations.keys[i]);
-                }
-            }
-            for (int32 i = 0; i < clip.scales.keys.size(); ++i)
-            {
-                if (m_Keys.back() < clip.scales.keys[i])
-                {
-                    m_Keys.push_back(clip.scales.keys[i]);
-                }
-            }
-        }
-
         vk_demo::DVKMesh* mesh = m_RoleModel->meshes[0];
 
-        // 存储每一帧所对应的动画数据
-        for (int32 i = 0; i < m_Keys.size(); ++i)
-        {
-            m_RoleModel->GotoAnimation(m_Keys[i]);
-            // 数据步长，一个节点的动画数据需要两个Vector存储。
-            int32 step = i * mesh->bones.size() * 8;
+        // 每帧一行，一个骨骼占两个像素(对偶四元数)，结果缓存在模型旁边
+        vk_demo::DVKAnimationBakeSettings settings;
+        settings.sampleRate    = 30.0f;
+        settings.paletteFormat = vk_demo::BPF_DualQuat;
+        settings.format        = VK_FORMAT_R32G32B32A32_SFLOAT;
+        settings.postMatrix    = mesh->linkNode->GetGlobalMatrix().Inverse();
+        settings.postMatrix.AppendRotation(180, Vector3::ForwardVector);
 
-            for (int32 j = 0; j < mesh->bones.size(); ++j)
-            {
-                int32 boneIndex = mesh->bones[j];
-                vk_demo::DVKBone* bone = m_RoleModel->bones[boneIndex];
-                // 获取骨骼的最终Transform矩阵
-                // 也可以使用对偶四元素来替换矩阵的计算
-                Matrix4x4 boneTransform = bone->finalTransform;
-                boneTransform.Append(mesh->linkNode->GetGlobalMatrix().Inverse());
-                boneTransform.AppendRotation(180, Vector3::ForwardVector);
-                // 从Transform矩阵中获取四元数以及位移信息
-                Quat quat   = boneTransform.ToQuat();
-                Vector3 pos = boneTransform.GetOrigin();
-                // 转为使用对偶四元数
-                float dx = (+0.5) * ( pos.x * quat.w + pos.y * quat.z - pos.z * quat.y);
-                float dy = (+0.5) * (-pos.x * quat.z + pos.y * quat.w + pos.z * quat.x);
-                float dz = (+0.5) * ( pos.x * quat.y - pos.y * quat.x + pos.z * quat.w);
-                float dw = (-0.5) * ( pos.x * quat.x + pos.y * quat.y + pos.z * quat.z);
-                // 计算出当前帧当前骨骼在Texture中的坐标
-                int32 index = step + j * 8;
-                animData[index + 0] = quat.x;
-                animData[index + 1] = quat.y;
-                animData[index + 2] = quat.z;
-                animData[index + 3] = quat.w;
-                animData[index + 4] = dx;
-                animData[index + 5] = dy;
-                animData[index + 6] = dz;
-                animData[index + 7] = dw;
-            }
-        }
-
-        // 创建Texture
-        m_AnimTexture = vk_demo::DVKTexture::Create2D(
-            (const uint8*)animData.data(),
-            animData.size() * sizeof(float),
-            VK_FORMAT_R32G32B32A32_SFLOAT,
-            64,
-            64,
+        m_AnimTexture = vk_demo::DVKAnimationTexture::Create(
             m_VulkanDevice,
-            cmdBuffer
-        );
-        m_AnimTexture->UpdateSampler(
-            VK_FILTER_NEAREST,
-            VK_FILTER_NEAREST,
-            VK_SAMPLER_MIPMAP_MODE_NEAREST,
-            VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-            VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-            VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
+            cmdBuffer,
+            m_RoleModel,
+            mesh->bones,
+            settings,
+            "assets/models/xiaonan/nvhai.fbx"
         );
     }
 
@@ -341,7 +266,7 @@ private:
             primitive->instanceDatas[index + 5] = dy;
             primitive->instanceDatas[index + 6] = dz;
             primitive->instanceDatas[index + 7] = dw;
-            primitive->instanceDatas[index + 8] = MMath::RandRange(0, m_Keys.size()) * mesh->bones.size() * 2;
+            primitive->instanceDatas[index + 8] = MMath::RandRange(0, m_AnimTexture->animations[0].frameCount - 1) * m_AnimTexture->width;
         }
 
         primitive->indexBuffer->instanceCount = 1024;
@@ -363,7 +288,7 @@ private:
         );
         m_RoleMaterial->PreparePipeline();
         m_RoleMaterial->SetTexture("diffuseMap", m_RoleDiffuse);
-        m_RoleMaterial->SetTexture("animMap", m_AnimTexture);
+        m_RoleMaterial->SetTexture("animMap", m_AnimTexture->texture);
 
         delete cmdBuffer;
     }
@@ -467,8 +392,7 @@ private:
 
     ImageGUIContext*            m_GUI = nullptr;
 
-    vk_demo::DVKTexture*        m_AnimTexture = nullptr;
-    std::vector<float>          m_Keys;
+    vk_demo::DVKAnimationTexture* m_AnimTexture = nullptr;
     bool                        m_AutoAnimation = true;
     float                       m_AnimDuration = 0.0f;
     float                       m_AnimTime = 0.0f;
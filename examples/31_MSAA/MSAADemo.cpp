@@ -58,6 +58,11 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+    }
+
     void CreateMSAATexture()
     {
         // msaa color texture
@@ -98,6 +103,25 @@ public:
         }
     }
 
+    void ReleaseMSAATexture()
+    {
+        if (m_MSAAColorTexture == nullptr)
+        {
+            return;
+        }
+
+        // 窗口缩放时之前提交的帧可能仍在使用，执行完毕之后再释放
+        vk_demo::DVKTexture* colorTexture = m_MSAAColorTexture;
+        vk_demo::DVKTexture* depthTexture = m_MSAADepthTexture;
+        m_MSAAColorTexture = nullptr;
+        m_MSAADepthTexture = nullptr;
+
+        m_Scheduler->DeferRelease([=]() {
+            delete colorTexture;
+            delete depthTexture;
+        });
+    }
+
     void CreateMSAAFrameBuffers()
     {
         DestroyMSAATexture();
@@ -135,7 +159,7 @@ public:
     void CreateFrameBuffers() override
     {
         DestroyFrameBuffers();
-        DestroyMSAATexture();
+        ReleaseMSAATexture();
 
         if (m_MSAAEnable)
         {
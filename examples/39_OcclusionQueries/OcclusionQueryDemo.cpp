@@ -62,6 +62,12 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height * 0.5f);
+        m_TopCamera.SetAspect(width, height * 0.5f);
+    }
+
 private:
 
     struct ModelViewProjectionBlock
@@ -83,20 +89,12 @@ private:
             m_ViewCamera.Update(time, delta);
         }
 
+        // 非阻塞获取之前帧的结果
+        m_OcclusionQuery->Poll();
+
         SetupCommandBuffers(bufferIndex);
 
         DemoBase::Present(bufferIndex);
-
-        vkGetQueryPoolResults(
-            m_Device,
-            m_QueryPool,
-            0,
-            OBJECT_COUNT,
-            sizeof(uint64) * OBJECT_COUNT,
-            m_QuerySamples,
-            sizeof(uint64),
-            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT
-        );
     }
 
     bool UpdateUI(float time, float delta)
@@ -126,11 +124,15 @@ private:
     {
         vk_demo::DVKCommandBuffer* cmdBuffer = vk_demo::DVKCommandBuffer::Create(m_VulkanDevice, m_CommandPool);
 
-        VkQueryPoolCreateInfo queryPoolCreateInfo;
-        ZeroVulkanStruct(queryPoolCreateInfo, VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO);
-        queryPoolCreateInfo.queryType  = VK_QUERY_TYPE_OCCLUSION;
-        queryPoolCreateInfo.queryCount = OBJECT_COUNT;
-        VERIFYVULKANRESULT(vkCreateQueryPool(m_Device, &queryPoolCreateInfo, VULKAN_CPU_ALLOCATOR, &m_QueryPool));
+        // 结果返回之前默认可见
+        m_OcclusionQuery = vk_demo::DVKQueryPool::Create(
+            m_VulkanDevice,
+            VK_QUERY_TYPE_OCCLUSION,
+            OBJECT_COUNT,
+            m_CommandBuffers.size(),
+            0,
+            MAX_uint64
+        );
 
         m_ModelSphere = vk_demo::DVKModel::LoadFromFile(
             "assets/models/sphere.obj",
@@ -217,7 +219,7 @@ private:
         delete m_Material;
         delete m_Shader;
 
-        vkDestroyQueryPool(m_Device, m_QueryPool, VULKAN_CPU_ALLOCATOR);
+        delete m_OcclusionQuery;
     }
 
     void RenderOcclusions(VkCommandBuffer commandBuffer, vk_demo::DVKCamera& camera)
@@ -238,12 +240,12 @@ private:
             m_SimpleMaterial->SetLocalUniform("uboMVP",      &m_MVPParam,         sizeof(ModelViewProjectionBlock));
             m_SimpleMaterial->EndObject();
 
-            vkCmdBeginQuery(commandBuffer, m_QueryPool, i, VK_QUERY_CONTROL_PRECISE_BIT);
+            m_OcclusionQuery->BeginQuery(commandBuffer, i, VK_QUERY_CONTROL_PRECISE_BIT);
 
             m_SimpleMaterial->BindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, i);
             m_ModelSphere->meshes[0]->DrawOnly(commandBuffer);
 
-            vkCmdEndQuery(commandBuffer, m_QueryPool, i);
+            m_OcclusionQuery->EndQuery(commandBuffer, i);
         }
 
         m_SimpleMaterial->EndFrame();
@@ -279,7 +281,7 @@ private:
         int32 count = 0;
         for (int32 i = 0; i < OBJECT_COUNT; ++i)
         {
-            bool occluded = m_QuerySamples[i] <= 50; // precise: m_QuerySamples[i] == 0
+            bool occluded = m_OcclusionQuery->GetResult(i) <= 50; // precise: GetResult(i) == 0
             if (occluded && m_EnableQuery)
             {
                 continue;
@@ -345,7 +347,7 @@ private:
         ZeroVulkanStruct(cmdBeginInfo, VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO);
         VERIFYVULKANRESULT(vkBeginCommandBuffer(commandBuffer, &cmdBeginInfo));
 
-        vkCmdResetQueryPool(commandBuffer, m_QueryPool, 0, OBJECT_COUNT);
+        m_OcclusionQuery->BeginFrame(commandBuffer, backBufferIndex);
 
         BeginMainPass(commandBuffer, backBufferIndex);
 
@@ -417,8 +419,6 @@ private:
         m_TopCamera.SetPosition(-500, 1500, 0);
         m_TopCamera.LookAt(0, 0, 0);
         m_TopCamera.Perspective(PI / 4, (float)GetWidth(), (float)GetHeight() * 0.5f, 1.0f, 3000.0f);
-
-        memset(m_QuerySamples, 65535, sizeof(uint64) * OBJECT_COUNT);
     }
 
     void CreateGUI()
@@ -441,7 +441,7 @@ private:
 
     bool                        m_Ready = false;
 
-    VkQueryPool                 m_QueryPool;
+    vk_demo::DVKQueryPool*      m_OcclusionQuery = nullptr;
 
     vk_demo::DVKModel*          m_ModelSphere = nullptr;
     vk_demo::DVKModel*          m_ModelGround = nullptr;
@@ -451,7 +451,6 @@ private:
     vk_demo::DVKShader*         m_SimpleShader = nullptr;
 
     Matrix4x4                   m_ObjModels[OBJECT_COUNT];
-    uint64                      m_QuerySamples[OBJECT_COUNT];
     Vector3                     m_SphereCenter;
     float                       m_SphereRadius;
     bool                        m_EnableQuery = true;
@@ -60,6 +60,11 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+    }
+
 private:
 
     struct ModelViewProjectionBlock
@@ -81,20 +86,12 @@ private:
             m_ViewCamera.Update(time, delta);
         }
 
+        // 非阻塞获取之前帧的结果
+        m_StatsQuery->Poll();
+
         SetupCommandBuffers(bufferIndex);
 
         DemoBase::Present(bufferIndex);
-
-        vkGetQueryPoolResults(
-            m_Device,
-            m_QueryPool,
-            0,
-            1,
-            sizeof(uint64) * QUERY_STATS_COUNT,
-            m_QueryStats,
-            sizeof(uint64),
-            VK_QUERY_RESULT_64_BIT
-        );
     }
 
     bool UpdateUI(float time, float delta)
@@ -108,7 +105,7 @@ private:
 
             for (int32 i = 0; i < m_StatNames.size(); ++i)
             {
-                ImGui::Text("%s : %d", m_StatNames[i], m_QueryStats[i]);
+                ImGui::Text("%s : %d", m_StatNames[i], (int32)m_StatsQuery->GetResult(0, i));
             }
 
             ImGui::Text("%.3f ms/frame (%d FPS)", 1000.0f / m_LastFPS, m_LastFPS);
@@ -127,11 +124,7 @@ private:
     {
         vk_demo::DVKCommandBuffer* cmdBuffer = vk_demo::DVKCommandBuffer::Create(m_VulkanDevice, m_CommandPool);
 
-        VkQueryPoolCreateInfo queryPoolCreateInfo;
-        ZeroVulkanStruct(queryPoolCreateInfo, VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO);
-        queryPoolCreateInfo.queryType  = VK_QUERY_TYPE_PIPELINE_STATISTICS;
-        queryPoolCreateInfo.queryCount = QUERY_STATS_COUNT;
-        queryPoolCreateInfo.pipelineStatistics =
+        VkQueryPipelineStatisticFlags statistics =
             VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
             VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
             VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
@@ -140,7 +133,13 @@ private:
             VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
             VK_QUERY_PIPELINE_STATISTIC_TESSELLATION_CONTROL_SHADER_PATCHES_BIT |
             VK_QUERY_PIPELINE_STATISTIC_TESSELLATION_EVALUATION_SHADER_INVOCATIONS_BIT;
-        VERIFYVULKANRESULT(vkCreateQueryPool(m_Device, &queryPoolCreateInfo, VULKAN_CPU_ALLOCATOR, &m_QueryPool));
+        m_StatsQuery = vk_demo::DVKQueryPool::Create(
+            m_VulkanDevice,
+            VK_QUERY_TYPE_PIPELINE_STATISTICS,
+            1,
+            m_CommandBuffers.size(),
+            statistics
+        );
 
         m_StatNames.resize(QUERY_STATS_COUNT);
         m_StatNames[0] = "Vertex count";
@@ -187,7 +186,7 @@ private:
         delete m_Material;
         delete m_Shader;
 
-        vkDestroyQueryPool(m_Device, m_QueryPool, VULKAN_CPU_ALLOCATOR);
+        delete m_StatsQuery;
     }
 
     void SetupCommandBuffers(int32 backBufferIndex)
@@ -212,7 +211,7 @@ private:
         ZeroVulkanStruct(cmdBeginInfo, VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO);
         VERIFYVULKANRESULT(vkBeginCommandBuffer(commandBuffer, &cmdBeginInfo));
 
-        vkCmdResetQueryPool(commandBuffer, m_QueryPool, 0, QUERY_STATS_COUNT);
+        m_StatsQuery->BeginFrame(commandBuffer, backBufferIndex);
 
         VkClearValue clearValues[2];
         clearValues[0].color        = {
@@ -235,7 +234,7 @@ private:
         vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
         vkCmdSetScissor(commandBuffer,  0, 1, &scissor);
 
-        vkCmdBeginQuery(commandBuffer, m_QueryPool, 0, 0);
+        m_StatsQuery->BeginQuery(commandBuffer, 0);
         vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Material->GetPipeline());
 
         m_Material->BeginFrame();
@@ -253,7 +252,7 @@ private:
             m_Model->meshes[i]->BindDrawCmd(commandBuffer);
         }
         m_Material->EndFrame();
-        vkCmdEndQuery(commandBuffer, m_QueryPool, 0);
+        m_StatsQuery->EndQuery(commandBuffer, 0);
 
         m_GUI->BindDrawCmd(commandBuffer, m_RenderPass);
         vkCmdEndRenderPass(commandBuffer);
@@ -265,8 +264,6 @@ private:
         m_ViewCamera.SetPosition(0, 500, -700.0f);
         m_ViewCamera.LookAt(0, 250, 0);
         m_ViewCamera.Perspective(PI / 4, (float)GetWidth(), (float)GetHeight(), 1.0f, 1500.0f);
-
-        memset(m_QueryStats, 65535, sizeof(uint64) * QUERY_STATS_COUNT);
     }
 
     void CreateGUI()
@@ -285,7 +282,7 @@ private:
 
     bool                        m_Ready = false;
 
-    VkQueryPool                 m_QueryPool;
+    vk_demo::DVKQueryPool*      m_StatsQuery = nullptr;
 
     vk_demo::DVKModel*          m_Model = nullptr;
     vk_demo::DVKMaterial*       m_Material = nullptr;
@@ -293,7 +290,6 @@ private:
 
     vk_demo::DVKCamera          m_ViewCamera;
 
-    uint64                      m_QueryStats[QUERY_STATS_COUNT];
     std::vector<const char*>    m_StatNames;
     ModelViewProjectionBlock    m_MVPParam;
 
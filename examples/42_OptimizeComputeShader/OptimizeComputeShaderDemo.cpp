@@ -59,6 +59,11 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+    }
+
 private:
 
     struct ModelViewProjectionBlock
@@ -157,17 +162,46 @@ private:
             m_ComputeProcessors[i]->SetStorageTexture("outputImage", m_ComputeTargets[i]);
         }
 
+        // 只在加载时处理一次，直接阻塞提交。原图在图形队列上创建，结果由图形队列采样，需要转移所有权
+        uint32 computeFamily  = m_VulkanDevice->GetComputeQueue()->GetFamilyIndex();
+        uint32 graphicsFamily = m_VulkanDevice->GetGraphicsQueue()->GetFamilyIndex();
+        vk_demo::DVKCommandBuffer* gfxCmdBuffer = vk_demo::DVKCommandBuffer::Create(m_VulkanDevice, m_CommandPool);
+
+        gfxCmdBuffer->Begin();
+        vk_demo::DVKCompute::ReleaseImage(gfxCmdBuffer->cmdBuffer, m_Texture, graphicsFamily, computeFamily, 0, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+        gfxCmdBuffer->End();
+        gfxCmdBuffer->Submit();
+
         // compute command
         cmdBuffer->Begin();
 
+        vk_demo::DVKCompute::AcquireImage(cmdBuffer->cmdBuffer, m_Texture, graphicsFamily, computeFamily, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
         for (int32 i = 0; i < 3; ++i)
         {
             m_ComputeProcessors[i]->BindDispatch(cmdBuffer->cmdBuffer, m_ComputeTargets[i]->width / 16, m_ComputeTargets[i]->height / 16, 1);
         }
 
+        vk_demo::DVKCompute::ReleaseImage(cmdBuffer->cmdBuffer, m_Texture, computeFamily, graphicsFamily, 0, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        for (int32 i = 0; i < 3; ++i)
+        {
+            vk_demo::DVKCompute::ReleaseImage(cmdBuffer->cmdBuffer, m_ComputeTargets[i], computeFamily, graphicsFamily, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        }
+
         cmdBuffer->End();
         cmdBuffer->Submit();
 
+        gfxCmdBuffer->Begin();
+        vk_demo::DVKCompute::AcquireImage(gfxCmdBuffer->cmdBuffer, m_Texture, computeFamily, graphicsFamily, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        for (int32 i = 0; i < 3; ++i)
+        {
+            vk_demo::DVKCompute::AcquireImage(gfxCmdBuffer->cmdBuffer, m_ComputeTargets[i], computeFamily, graphicsFamily, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        }
+        gfxCmdBuffer->End();
+        gfxCmdBuffer->Submit();
+
+        delete gfxCmdBuffer;
+
         m_FilterIndex = 0;
         m_FilterNames.resize(4);
         m_FilterNames[0] = "Original";
@@ -9,6 +9,7 @@
 #include <vector>
 
 #define PARTICLE_COUNT (1024 * 1024)
+#define TIMING_HISTORY 8
 
 class ComputeParticlesDemo : public DemoBase
 {
@@ -45,6 +46,7 @@ public:
 
     virtual void Exist() override
     {
+        DemoBase::WaitIdle();
         DestroyAssets();
         DestroyGUI();
         DemoBase::Release();
@@ -73,18 +75,82 @@ private:
         Vector4 data1;
     };
 
+    struct FrameTiming
+    {
+        uint64  frame = 0;
+        double  begin = 0.0;
+        double  end   = 0.0;
+    };
+
     void Draw(float time, float delta)
     {
+        m_FrameIndex += 1;
+
+        // 先提交本帧的计算，与上一帧仍在执行的光栅化重叠
+        SetupComputeCommand();
+
         int32 bufferIndex = DemoBase::AcquireBackbufferIndex();
+        if (bufferIndex < 0)
+        {
+            return;
+        }
 
         UpdateFPS(time, delta);
+        UpdateTimeline();
         UpdateUI(time, delta);
 
-        SetupComputeCommand();
-
         SetupGfxCommand(bufferIndex);
 
         DemoBase::Present(bufferIndex);
+
+        m_RenderValues[m_RenderIndex] = m_Scheduler->GetSubmittedValue(vk_demo::DVKFrameScheduler::QueueType::Graphics);
+    }
+
+    void CollectTiming(vk_demo::DVKQueryPool* queryPool, FrameTiming* timings)
+    {
+        queryPool->Poll();
+
+        uint64 frame = queryPool->GetResultFrame(0);
+        if (frame == 0 || frame != queryPool->GetResultFrame(1))
+        {
+            return;
+        }
+
+        FrameTiming& timing = timings[frame % TIMING_HISTORY];
+        timing.frame = frame;
+        timing.begin = queryPool->GetTimestampMS(0);
+        timing.end   = queryPool->GetTimestampMS(1);
+    }
+
+    void UpdateTimeline()
+    {
+        if (!m_TimestampSupported)
+        {
+            return;
+        }
+
+        CollectTiming(m_ComputeTimestamps, m_ComputeTimings);
+        CollectTiming(m_GfxTimestamps, m_GfxTimings);
+
+        // 找到最近的一组：第N帧的计算与第N-1帧的图形
+        for (int32 i = 0; i < TIMING_HISTORY; ++i)
+        {
+            const FrameTiming& compute = m_ComputeTimings[i];
+            if (compute.frame < 2 || compute.frame <= m_TimelineFrame)
+            {
+                continue;
+            }
+
+            const FrameTiming& graphics = m_GfxTimings[(compute.frame - 1) % TIMING_HISTORY];
+            if (graphics.frame != compute.frame - 1)
+            {
+                continue;
+            }
+
+            m_TimelineFrame   = compute.frame;
+            m_TimelineCompute = compute;
+            m_TimelineGfx     = graphics;
+        }
     }
 
     bool UpdateUI(float time, float delta)
@@ -124,9 +190,18 @@ private:
 
             m_ParticleParams.data0.w = PARTICLE_COUNT;
 
-            m_ComputeProcessor->SetUniform("param", &m_ParticleParams, sizeof(ParticleParam));
-
             ImGui::Text("%.3f ms/frame (%d FPS)", 1000.0f / m_LastFPS, m_LastFPS);
+
+            if (m_TimestampSupported && m_TimelineFrame > 0)
+            {
+                double base = MMath::Min(m_TimelineGfx.begin, m_TimelineCompute.begin);
+                double overlap = MMath::Min(m_TimelineGfx.end, m_TimelineCompute.end) - MMath::Max(m_TimelineGfx.begin, m_TimelineCompute.begin);
+
+                ImGui::Separator();
+                ImGui::Text("Graphics N-1 : %.3f - %.3f ms", m_TimelineGfx.begin - base, m_TimelineGfx.end - base);
+                ImGui::Text("Compute  N   : %.3f - %.3f ms", m_TimelineCompute.begin - base, m_TimelineCompute.end - base);
+                ImGui::Text("Overlap      : %.3f ms", MMath::Max(overlap, 0.0));
+            }
             ImGui::End();
         }
 
@@ -149,6 +224,9 @@ private:
 
         vk_demo::DVKCommandBuffer* cmdBuffer = vk_demo::DVKCommandBuffer::Create(m_VulkanDevice, m_CommandPool);
 
+        m_ComputeFamily  = m_VulkanDevice->GetComputeQueue()->GetFamilyIndex();
+        m_GraphicsFamily = m_VulkanDevice->GetGraphicsQueue()->GetFamilyIndex();
+
         {
             std::vector<ParticleVertex> vertices(PARTICLE_COUNT);
             for (int32 i = 0; i < PARTICLE_COUNT; ++i)
@@ -172,21 +250,33 @@ private:
                 vertices.data()
             );
 
+            // 模拟数据只在计算队列上使用，直接在计算队列上上传，避免所有权转移
             m_ParticleBuffer = vk_demo::DVKBuffer::CreateBuffer(
                 m_VulkanDevice,
-                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                 vertices.size() * sizeof(ParticleVertex)
             );
 
-            cmdBuffer->Begin();
+            // 渲染用的两份拷贝，计算写入一份的同时图形读取另一份
+            for (int32 i = 0; i < 2; ++i)
+            {
+                m_RenderBuffers[i] = vk_demo::DVKBuffer::CreateBuffer(
+                    m_VulkanDevice,
+                    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                    vertices.size() * sizeof(ParticleVertex)
+                );
+            }
+
+            m_ComputeCommand->Begin();
 
             VkBufferCopy copyRegion = {};
             copyRegion.size = vertices.size() * sizeof(ParticleVertex);
-            vkCmdCopyBuffer(cmdBuffer->cmdBuffer, stagingBuffer->buffer, m_ParticleBuffer->buffer, 1, &copyRegion);
+            vkCmdCopyBuffer(m_ComputeCommand->cmdBuffer, stagingBuffer->buffer, m_ParticleBuffer->buffer, 1, &copyRegion);
 
-            cmdBuffer->End();
-            cmdBuffer->Submit();
+            m_ComputeCommand->End();
+            m_ComputeCommand->Submit();
 
             delete stagingBuffer;
         }
@@ -252,11 +342,32 @@ private:
         m_ComputeProcessor->SetStorageBuffer("inVertex", m_ParticleBuffer);
 
         delete cmdBuffer;
+
+        // 两个队列族都支持时间戳时才显示重叠的时间线
+        const std::vector<VkQueueFamilyProperties>& familyProps = m_VulkanDevice->GetQueueFamilyProperties();
+        uint32 computeBits  = familyProps[m_ComputeFamily].timestampValidBits;
+        uint32 graphicsBits = familyProps[m_GraphicsFamily].timestampValidBits;
+        m_TimestampSupported = computeBits > 0 && graphicsBits > 0;
+
+        if (m_TimestampSupported)
+        {
+            m_ComputeTimestamps = vk_demo::DVKQueryPool::Create(m_VulkanDevice, VK_QUERY_TYPE_TIMESTAMP, 2, 3);
+            m_ComputeTimestamps->timestampMask = computeBits >= 64 ? MAX_uint64 : ((1ULL << computeBits) - 1);
+
+            m_GfxTimestamps = vk_demo::DVKQueryPool::Create(m_VulkanDevice, VK_QUERY_TYPE_TIMESTAMP, 2, m_CommandBuffers.size());
+            m_GfxTimestamps->timestampMask = graphicsBits >= 64 ? MAX_uint64 : ((1ULL << graphicsBits) - 1);
+        }
     }
 
     void DestroyAssets()
     {
         delete m_ParticleBuffer;
+        delete m_RenderBuffers[0];
+        delete m_RenderBuffers[1];
+
+        delete m_ComputeTimestamps;
+        delete m_GfxTimestamps;
+
         delete m_ParticleMaterial;
         delete m_ParticleShader;
 
@@ -271,20 +382,34 @@ private:
 
     void SetupComputeCommand()
     {
+        m_RenderIndex = (m_RenderIndex + 1) % 2;
+        m_RenderCounts[m_RenderIndex] = m_PointCount;
+
+        vk_demo::DVKBuffer* renderBuffer = m_RenderBuffers[m_RenderIndex];
+
+        m_ComputeProcessor->SetUniform("param", &m_ParticleParams, sizeof(ParticleParam));
+
         m_ComputeCommand->Begin();
 
+        if (m_TimestampSupported)
+        {
+            m_ComputeTimestamps->BeginFrame(m_ComputeCommand->cmdBuffer, m_FrameIndex);
+            m_ComputeTimestamps->WriteTimestamp(m_ComputeCommand->cmdBuffer, 0, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+        }
+
+        // 上一次的模拟与拷贝都在计算队列上，普通的内存屏障即可
         VkBufferMemoryBarrier bufferBarrier;
         ZeroVulkanStruct(bufferBarrier, VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER);
         bufferBarrier.buffer = m_ParticleBuffer->buffer;
         bufferBarrier.size   = m_ParticleBuffer->size;
-        bufferBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        bufferBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-        bufferBarrier.srcQueueFamilyIndex = m_VulkanDevice->GetGraphicsQueue()->GetFamilyIndex();
-        bufferBarrier.dstQueueFamilyIndex = m_VulkanDevice->GetComputeQueue()->GetFamilyIndex();
+        bufferBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        bufferBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 
         vkCmdPipelineBarrier(
             m_ComputeCommand->cmdBuffer,
-            VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
             0,
             0,
@@ -298,14 +423,12 @@ private:
         m_ComputeProcessor->BindDispatch(m_ComputeCommand->cmdBuffer, 32, 32, 1);
 
         bufferBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-        bufferBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        bufferBarrier.srcQueueFamilyIndex = m_VulkanDevice->GetComputeQueue()->GetFamilyIndex();
-        bufferBarrier.dstQueueFamilyIndex = m_VulkanDevice->GetGraphicsQueue()->GetFamilyIndex();
+        bufferBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
 
         vkCmdPipelineBarrier(
             m_ComputeCommand->cmdBuffer,
             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-            VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
             0,
             0,
             nullptr,
@@ -315,7 +438,30 @@ private:
             nullptr
         );
 
-        m_ComputeCommand->Submit();
+        // 渲染拷贝的内容会被完全覆盖，不需要从图形队列取回所有权
+        VkBufferCopy copyRegion = {};
+        copyRegion.size = m_RenderCounts[m_RenderIndex] * sizeof(ParticleVertex);
+        vkCmdCopyBuffer(m_ComputeCommand->cmdBuffer, m_ParticleBuffer->buffer, renderBuffer->buffer, 1, &copyRegion);
+
+        vk_demo::DVKCompute::ReleaseBuffer(m_ComputeCommand->cmdBuffer, renderBuffer, m_ComputeFamily, m_GraphicsFamily, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+        if (m_TimestampSupported)
+        {
+            m_ComputeTimestamps->WriteTimestamp(m_ComputeCommand->cmdBuffer, 1, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+        }
+
+        // 只需等待两帧之前读取该拷贝的图形提交，上一帧的光栅化可以继续执行
+        if (m_RenderValues[m_RenderIndex] > 0)
+        {
+            m_Scheduler->AddWait(
+                vk_demo::DVKFrameScheduler::QueueType::Compute,
+                vk_demo::DVKFrameScheduler::QueueType::Graphics,
+                m_RenderValues[m_RenderIndex],
+                VK_PIPELINE_STAGE_TRANSFER_BIT
+            );
+        }
+
+        vk_demo::DVKCompute::SubmitAsync(m_ComputeCommand, m_Scheduler, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
     }
 
     void SetupGfxCommand(int32 backBufferIndex)
@@ -340,6 +486,16 @@ private:
         ZeroVulkanStruct(cmdBeginInfo, VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO);
         VERIFYVULKANRESULT(vkBeginCommandBuffer(commandBuffer, &cmdBeginInfo));
 
+        vk_demo::DVKBuffer* renderBuffer = m_RenderBuffers[m_RenderIndex];
+
+        if (m_TimestampSupported)
+        {
+            m_GfxTimestamps->BeginFrame(commandBuffer, backBufferIndex);
+            m_GfxTimestamps->WriteTimestamp(commandBuffer, 0, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+        }
+
+        vk_demo::DVKCompute::AcquireBuffer(commandBuffer, renderBuffer, m_ComputeFamily, m_GraphicsFamily, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+
         VkClearValue clearValues[2];
         clearValues[0].color        = {
             { 0.2f, 0.2f, 0.2f, 1.0f }
@@ -371,13 +527,19 @@ private:
         m_ParticleMaterial->EndObject();
 
         m_ParticleMaterial->BindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, 0);
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &(m_ParticleBuffer->buffer), offsets);
-        vkCmdDraw(commandBuffer, m_PointCount, 1, 0, 0);
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &(renderBuffer->buffer), offsets);
+        vkCmdDraw(commandBuffer, m_RenderCounts[m_RenderIndex], 1, 0, 0);
 
         m_ParticleMaterial->EndFrame();
 
         m_GUI->BindDrawCmd(commandBuffer, m_RenderPass);
         vkCmdEndRenderPass(commandBuffer);
+
+        if (m_TimestampSupported)
+        {
+            m_GfxTimestamps->WriteTimestamp(commandBuffer, 1, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+        }
+
         VERIFYVULKANRESULT(vkEndCommandBuffer(commandBuffer));
     }
 
@@ -413,6 +575,10 @@ private:
     bool                            m_Ready = false;
 
     vk_demo::DVKBuffer*             m_ParticleBuffer = nullptr;
+    vk_demo::DVKBuffer*             m_RenderBuffers[2] = { nullptr, nullptr };
+    uint64                          m_RenderValues[2] = { 0, 0 };
+    int32                           m_RenderCounts[2] = { 0, 0 };
+    int32                           m_RenderIndex = 0;
     vk_demo::DVKShader*             m_ParticleShader = nullptr;
     vk_demo::DVKMaterial*           m_ParticleMaterial = nullptr;
 
@@ -423,6 +589,19 @@ private:
     vk_demo::DVKCompute*            m_ComputeProcessor = nullptr;
     vk_demo::DVKCommandBuffer*      m_ComputeCommand = nullptr;
 
+    uint32                          m_ComputeFamily = 0;
+    uint32                          m_GraphicsFamily = 0;
+
+    bool                            m_TimestampSupported = false;
+    int32                           m_FrameIndex = 0;
+    vk_demo::DVKQueryPool*          m_ComputeTimestamps = nullptr;
+    vk_demo::DVKQueryPool*          m_GfxTimestamps = nullptr;
+    FrameTiming                     m_ComputeTimings[TIMING_HISTORY];
+    FrameTiming                     m_GfxTimings[TIMING_HISTORY];
+    uint64                          m_TimelineFrame = 0;
+    FrameTiming                     m_TimelineCompute;
+    FrameTiming                     m_TimelineGfx;
+
     ParticleParam                   m_ParticleParams;
     int32                           m_PointCount = 0;
     bool                            m_Animation = false;
@@ -60,6 +60,21 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        // 光追结果与窗口等大。DescriptorSet不能在使用中更新，等待之前的提交执行完毕后重建
+        DemoBase::WaitIdle();
+        vk_demo::DVKTexture* computeTarget = m_ComputeTarget;
+        m_Scheduler->DeferRelease([=]() {
+            delete computeTarget;
+        });
+
+        CreateComputeTarget(width, height);
+
+        InitParmas();
+        SetupComputeCommand();
+    }
+
 private:
 
     struct Material
@@ -244,51 +259,60 @@ private:
             bufferDatas.size() * sizeof(float)
         );
 
-        cmdBuffer->Begin();
+        // compute command
+        m_ComputeFamily  = m_VulkanDevice->GetComputeQueue()->GetFamilyIndex();
+        m_GraphicsFamily = m_VulkanDevice->GetGraphicsQueue()->GetFamilyIndex();
+        m_ComputeCommand = vk_demo::DVKCommandBuffer::Create(
+            m_VulkanDevice,
+            m_ComputeCommandPool,
+            VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            m_VulkanDevice->GetComputeQueue()
+        );
+
+        // 场景数据只在计算队列上使用，直接在计算队列上上传，避免所有权转移
+        m_ComputeCommand->Begin();
 
         VkBufferCopy copyRegion = {};
         copyRegion.size = bufferDatas.size() * sizeof(float);
-        vkCmdCopyBuffer(cmdBuffer->cmdBuffer, stagingBuffer->buffer, m_SceneBuffer->buffer, 1, &copyRegion);
+        vkCmdCopyBuffer(m_ComputeCommand->cmdBuffer, stagingBuffer->buffer, m_SceneBuffer->buffer, 1, &copyRegion);
 
-        cmdBuffer->End();
-        cmdBuffer->Submit();
+        m_ComputeCommand->End();
+        m_ComputeCommand->Submit();
 
         delete stagingBuffer;
 
         // compute resources
+        m_ComputeShader = vk_demo::DVKShader::Create(
+            m_VulkanDevice,
+            "assets/shaders/44_ComputeRaytracing/Raytracing.comp.spv"
+        );
+        m_ComputeProcessor = vk_demo::DVKCompute::Create(m_VulkanDevice, m_PipelineCache, m_ComputeShader);
+        m_ComputeProcessor->SetStorageBuffer("inSceneData", m_SceneBuffer);
+
+        CreateComputeTarget(m_FrameWidth, m_FrameHeight);
+
+        delete cmdBuffer;
+    }
+
+    void CreateComputeTarget(int32 width, int32 height)
+    {
         // create target image
         m_ComputeTarget = vk_demo::DVKTexture::Create2D(
             m_VulkanDevice,
-            cmdBuffer,
+            m_ComputeCommand,
             VK_FORMAT_R8G8B8A8_UNORM,
             VK_IMAGE_ASPECT_COLOR_BIT,
-            1024,
-            512,
+            width,
+            height,
             VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
             VK_SAMPLE_COUNT_1_BIT,
             ImageLayoutBarrier::ComputeGeneralRW
         );
 
-        m_ComputeShader = vk_demo::DVKShader::Create(
-            m_VulkanDevice,
-            "assets/shaders/44_ComputeRaytracing/Raytracing.comp.spv"
-        );
-        m_ComputeProcessor = vk_demo::DVKCompute::Create(m_VulkanDevice, m_PipelineCache, m_ComputeShader);
         m_ComputeProcessor->SetStorageTexture("outputImage", m_ComputeTarget);
-        m_ComputeProcessor->SetStorageBuffer("inSceneData", m_SceneBuffer);
 
         // bind compute output texture
         m_Material->SetTexture("diffuseMap", m_ComputeTarget);
-
-        // compute command
-        m_ComputeCommand = vk_demo::DVKCommandBuffer::Create(
-            m_VulkanDevice,
-            m_ComputeCommandPool,
-            VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-            m_VulkanDevice->GetComputeQueue()
-        );
-
-        delete cmdBuffer;
     }
 
     void DestroyAssets()
@@ -310,9 +334,14 @@ private:
         m_ComputeCommand->Begin();
 
         m_ComputeProcessor->SetUniform("uboParam", &m_RaytracingParam, sizeof(RaytracingParamBlock));
-        m_ComputeProcessor->BindDispatch(m_ComputeCommand->cmdBuffer, m_ComputeTarget->width / 16, m_ComputeTarget->height / 16, 1);
+        m_ComputeProcessor->BindDispatch(m_ComputeCommand->cmdBuffer, (m_ComputeTarget->width + 15) / 16, (m_ComputeTarget->height + 15) / 16, 1);
 
-        m_ComputeCommand->Submit();
+        // 结果由图形队列采样，在下一帧的图形命令里获取所有权
+        vk_demo::DVKCompute::ReleaseImage(m_ComputeCommand->cmdBuffer, m_ComputeTarget, m_ComputeFamily, m_GraphicsFamily, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+        // 不阻塞，下一帧的图形提交在片元着色器阶段等待计算完成
+        vk_demo::DVKCompute::SubmitAsync(m_ComputeCommand, m_Scheduler, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        m_TargetAcquired = false;
     }
 
     void SetupGfxCommand(int32 backBufferIndex)
@@ -337,6 +366,12 @@ private:
         ZeroVulkanStruct(cmdBeginInfo, VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO);
         VERIFYVULKANRESULT(vkBeginCommandBuffer(commandBuffer, &cmdBeginInfo));
 
+        if (!m_TargetAcquired)
+        {
+            vk_demo::DVKCompute::AcquireImage(commandBuffer, m_ComputeTarget, m_ComputeFamily, m_GraphicsFamily, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+            m_TargetAcquired = true;
+        }
+
         VkClearValue clearValues[2];
         clearValues[0].color        = {
             { 0.2f, 0.2f, 0.2f, 1.0f }
@@ -414,6 +449,9 @@ private:
     vk_demo::DVKShader*             m_ComputeShader = nullptr;
     vk_demo::DVKCompute*            m_ComputeProcessor = nullptr;
     vk_demo::DVKCommandBuffer*      m_ComputeCommand = nullptr;
+    bool                            m_TargetAcquired = true;
+    uint32                          m_ComputeFamily = 0;
+    uint32                          m_GraphicsFamily = 0;
 
     RaytracingParamBlock            m_RaytracingParam;
 
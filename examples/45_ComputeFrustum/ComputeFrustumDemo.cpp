@@ -60,6 +60,12 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height * 0.5f);
+        m_TopCamera.SetAspect(width, height * 0.5f);
+    }
+
 private:
 
     struct ModelViewProjectionBlock
@@ -176,6 +182,13 @@ private:
         );
         m_Material->PreparePipeline();
 
+        m_ComputeCommand = vk_demo::DVKCommandBuffer::Create(
+            m_VulkanDevice,
+            m_ComputeCommandPool,
+            VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            m_VulkanDevice->GetComputeQueue()
+        );
+
         {
             m_CullingBuffer = vk_demo::DVKBuffer::CreateBuffer(
                 m_VulkanDevice,
@@ -200,14 +213,15 @@ private:
                 OBJECT_COUNT * sizeof(Matrix4x4)
             );
 
-            cmdBuffer->Begin();
+            // 矩阵只在计算队列上使用，直接在计算队列上上传，避免所有权转移
+            m_ComputeCommand->Begin();
 
             VkBufferCopy copyRegion = {};
             copyRegion.size = OBJECT_COUNT * sizeof(Matrix4x4);
-            vkCmdCopyBuffer(cmdBuffer->cmdBuffer, stagingBuffer->buffer, m_MatrixBuffer->buffer, 1, &copyRegion);
+            vkCmdCopyBuffer(m_ComputeCommand->cmdBuffer, stagingBuffer->buffer, m_MatrixBuffer->buffer, 1, &copyRegion);
 
-            cmdBuffer->End();
-            cmdBuffer->Submit();
+            m_ComputeCommand->End();
+            m_ComputeCommand->Submit();
 
             delete stagingBuffer;
         }
@@ -225,13 +239,6 @@ private:
         m_ComputeProcessor->SetStorageBuffer("inMatrix",   m_MatrixBuffer);
         m_ComputeProcessor->SetStorageBuffer("outCulling", m_CullingBuffer);
 
-        m_ComputeCommand = vk_demo::DVKCommandBuffer::Create(
-            m_VulkanDevice,
-            m_ComputeCommandPool,
-            VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-            m_VulkanDevice->GetComputeQueue()
-        );
-
         m_FrustumParam.count.x = OBJECT_COUNT;
         m_FrustumParam.count.y = m_Radius;
 
@@ -257,6 +264,8 @@ private:
     {
         if (m_UseGPU)
         {
+            // CPU真正需要剔除结果时才等待
+            m_Scheduler->Wait(vk_demo::DVKFrameScheduler::QueueType::Compute, m_ComputeCommand->submittedValue);
             Vector4* cullData = (Vector4*)m_CullingBuffer->mapped;
             return cullData[index].x > 0.0f;
         }
@@ -316,7 +325,30 @@ private:
         m_ComputeProcessor->SetUniform("paramData", &m_FrustumParam, sizeof(FrustumParamBlock));
         m_ComputeProcessor->BindDispatch(m_ComputeCommand->cmdBuffer, 32, 32, 1);
 
-        m_ComputeCommand->Submit();
+        // 剔除结果只由CPU读取，不经过图形队列，只需要对Host可见
+        VkBufferMemoryBarrier bufferBarrier;
+        ZeroVulkanStruct(bufferBarrier, VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER);
+        bufferBarrier.buffer = m_CullingBuffer->buffer;
+        bufferBarrier.size   = m_CullingBuffer->size;
+        bufferBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+
+        vkCmdPipelineBarrier(
+            m_ComputeCommand->cmdBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_HOST_BIT,
+            0,
+            0,
+            nullptr,
+            1,
+            &bufferBarrier,
+            0,
+            nullptr
+        );
+
+        m_ComputeCommand->SubmitAsync(m_Scheduler, vk_demo::DVKFrameScheduler::QueueType::Compute);
     }
 
     void SetupGfxCommand(int32 backBufferIndex)
@@ -388,54 +420,7 @@ private:
 
     void UpdateFrustumPlanes()
     {
-        Matrix4x4 matrix = m_ViewCamera.GetViewProjection();
-
-        Vector4* frustumPlanes = &(m_FrustumParam.frustumPlanes[0]);
-
-        // left
-        frustumPlanes[0].x = matrix.m[0][3] + matrix.m[0][0];
-        frustumPlanes[0].y = matrix.m[1][3] + matrix.m[1][0];
-        frustumPlanes[0].z = matrix.m[2][3] + matrix.m[2][0];
-        frustumPlanes[0].w = matrix.m[3][3] + matrix.m[3][0];
-
-        // right
-        frustumPlanes[1].x = matrix.m[0][3] - matrix.m[0][0];
-        frustumPlanes[1].y = matrix.m[1][3] - matrix.m[1][0];
-        frustumPlanes[1].z = matrix.m[2][3] - matrix.m[2][0];
-        frustumPlanes[1].w = matrix.m[3][3] - matrix.m[3][0];
-
-        // top
-        frustumPlanes[2].x = matrix.m[0][3] + matrix.m[0][1];
-        frustumPlanes[2].y = matrix.m[1][3] + matrix.m[1][1];
-        frustumPlanes[2].z = matrix.m[2][3] + matrix.m[2][1];
-        frustumPlanes[2].w = matrix.m[3][3] + matrix.m[3][1];
-
-        // bottom
-        frustumPlanes[3].x = matrix.m[0][3] - matrix.m[0][1];
-        frustumPlanes[3].y = matrix.m[1][3] - matrix.m[1][1];
-        frustumPlanes[3].z = matrix.m[2][3] - matrix.m[2][1];
-        frustumPlanes[3].w = matrix.m[3][3] - matrix.m[3][1];
-
-        // near
-        frustumPlanes[4].x = matrix.m[0][2];
-        frustumPlanes[4].y = matrix.m[1][2];
-        frustumPlanes[4].z = matrix.m[2][2];
-        frustumPlanes[4].w = matrix.m[3][2];
-
-        // far
-        frustumPlanes[5].x = matrix.m[0][3] - matrix.m[0][2];
-        frustumPlanes[5].y = matrix.m[1][3] - matrix.m[1][2];
-        frustumPlanes[5].z = matrix.m[2][3] - matrix.m[2][2];
-        frustumPlanes[5].w = matrix.m[3][3] - matrix.m[3][2];
-
-        for (auto i = 0; i < 6; i++)
-        {
-            float length = MMath::Sqrt(frustumPlanes[i].x * frustumPlanes[i].x + frustumPlanes[i].y * frustumPlanes[i].y + frustumPlanes[i].z * frustumPlanes[i].z);
-            frustumPlanes[i].x /= length;
-            frustumPlanes[i].y /= length;
-            frustumPlanes[i].z /= length;
-            frustumPlanes[i].w /= length;
-        }
+        m_ViewCamera.GetFrustum().GetPlanes(m_FrustumParam.frustumPlanes);
     }
 
     void InitParmas()
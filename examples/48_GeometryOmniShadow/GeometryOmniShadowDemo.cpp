@@ -59,6 +59,11 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_MVPData.projection.Perspective(MMath::DegreesToRadians(75.0f), (float)width, (float)height, 10.0f, 1000.0f);
+    }
+
 private:
 
     struct ModelViewProjectionBlock
@@ -58,6 +58,11 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+    }
+
 private:
 
     struct SimpleLine
@@ -246,10 +251,18 @@ private:
         Vector3 triV1;
         Vector3 triV2;
 
-        // collision test
-        for (int32 meshID = 0; meshID < m_Model->meshes.size(); ++meshID)
-        {
-            auto mesh = m_Model->meshes[meshID];
+        // collision test, only meshes whose world bounds are hit by the ray, nearest first
+        vk_demo::DVKMesh* hitMesh = nullptr;
+        int32 proxy = m_SceneBVH.RayCast(pos, ray, MAX_flt, [&](int32 proxyID, void* userData, const Vector3& origin, const Vector3& direction, float maxDist) -> float {
+            vk_demo::DVKMesh* mesh = (vk_demo::DVKMesh*)userData;
+
+            // world space to mesh space, direction is not normalized so t stays in world units
+            Matrix4x4 invModel = mesh->linkNode->GetGlobalMatrix();
+            invModel.SetInverse();
+            Vector3 localPos = invModel.TransformPosition(origin);
+            Vector3 localRay = invModel.DeltaTransformVector(direction);
+
+            float meshDist = -1.0f;
             for (int32 primitiveID = 0; primitiveID < mesh->primitives.size(); ++primitiveID)
             {
                 auto pritimive = mesh->primitives[primitiveID];
@@ -266,12 +279,13 @@ private:
                     v1.Set(pritimive->vertices[index1 + 0], pritimive->vertices[index1 + 1], pritimive->vertices[index1 + 2]);
                     v2.Set(pritimive->vertices[index2 + 0], pritimive->vertices[index2 + 1], pritimive->vertices[index2 + 2]);
 
-                    if (IntersectTriangle(pos, ray, v0, v1, v2, &t, &u, &v))
+                    if (IntersectTriangle(localPos, localRay, v0, v1, v2, &t, &u, &v))
                     {
-                        if (t <= dist)
+                        if (t >= 0 && t < maxDist)
                         {
-                            dist  = t;
-                            found = true;
+                            maxDist  = t;
+                            meshDist = t;
+                            hitMesh  = mesh;
                             triV0 = v0;
                             triV1 = v1;
                             triV2 = v2;
@@ -279,6 +293,18 @@ private:
                     }
                 }
             }
+
+            return meshDist;
+        }, &dist);
+
+        if (proxy >= 0)
+        {
+            // mesh space to world space
+            Matrix4x4 model = hitMesh->linkNode->GetGlobalMatrix();
+            triV0 = model.TransformPosition(triV0);
+            triV1 = model.TransformPosition(triV1);
+            triV2 = model.TransformPosition(triV2);
+            found = true;
         }
 
         m_SimpleLine.Clear();
@@ -328,6 +354,23 @@ private:
         );
         m_Material->PreparePipeline();
 
+        // world bounds of meshes, the scene is static so the tree is built once
+        BoundsArray localBounds;
+        BoundsArray worldBounds;
+        localBounds.Resize(m_Model->meshes.size());
+        worldBounds.Resize(m_Model->meshes.size());
+        for (int32 i = 0; i < m_Model->meshes.size(); ++i)
+        {
+            vk_demo::DVKMesh* mesh = m_Model->meshes[i];
+            localBounds.Set(i, mesh->bounding.min, mesh->bounding.max);
+            VectorBatch::TransformBounds(mesh->linkNode->GetGlobalMatrix(), localBounds, worldBounds, i, 1);
+
+            Vector3 boundMin(worldBounds.min.x[i], worldBounds.min.y[i], worldBounds.min.z[i]);
+            Vector3 boundMax(worldBounds.max.x[i], worldBounds.max.y[i], worldBounds.max.z[i]);
+            m_SceneBVH.AddProxy(boundMin, boundMax, mesh);
+        }
+        m_SceneBVH.Update();
+
         m_SimpleLine.Resize(6 * 128);
         m_ModelLine = vk_demo::DVKBuffer::CreateBuffer(
             m_VulkanDevice,
@@ -363,6 +406,8 @@ private:
 
     void DestroyAssets()
     {
+        m_SceneBVH.Clear();
+
         delete m_Model;
         delete m_Material;
         delete m_Shader;
@@ -489,6 +534,8 @@ private:
     vk_demo::DVKMaterial*       m_Material = nullptr;
     vk_demo::DVKShader*         m_Shader = nullptr;
 
+    vk_demo::DVKSceneBVH        m_SceneBVH;
+
     vk_demo::DVKCamera          m_ViewCamera;
 
     ModelViewProjectionBlock    m_MVPParam;
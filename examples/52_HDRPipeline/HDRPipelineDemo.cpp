@@ -60,6 +60,43 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+
+        // 除了固定尺寸的Luminance，其余RenderTarget都按窗口尺寸创建。Material的DescriptorSet不能在使用中改写，等待之前的提交执行完毕后重建
+        DemoBase::WaitIdle();
+        std::vector<vk_demo::DVKTexture*> textures = { m_TexSourceColor, m_TexSourceDepth, m_TexBright, m_TexBlurH, m_TexBlurV, m_TexLuminances[6] };
+        std::vector<vk_demo::DVKRenderTarget*> renderTargets = { m_RTSource, m_RTBright, m_RTBlurH, m_RTBlurV, m_RTLuminances[6] };
+        m_Scheduler->DeferRelease([=]() {
+            for (int32 i = 0; i < textures.size(); ++i)
+            {
+                delete textures[i];
+            }
+            for (int32 i = 0; i < renderTargets.size(); ++i)
+            {
+                delete renderTargets[i];
+            }
+        });
+
+        CreateSourceRT();
+        CreateBrightTarget();
+        CreateBlurTargets();
+        CreateLuminanceDownsampleTarget();
+
+        m_BrightMaterial->SetTexture("originTexture", m_TexSourceColor);
+        m_BlurHMaterial->SetTexture("originTexture", m_TexBright);
+        m_BlurVMaterial->SetTexture("originTexture", m_TexBlurH);
+        m_LuminanceMaterials[6]->SetTexture("originTexture", m_TexSourceColor);
+        m_LuminanceMaterials[5]->SetTexture("originTexture", m_TexLuminances[6]);
+        m_FinalMaterial->SetTexture("originTexture", m_TexSourceColor);
+        m_FinalMaterial->SetTexture("bloomTexture",  m_TexBlurV);
+        m_DebugBright->SetTexture("originTexture", m_TexBright);
+        m_DebugBlurH->SetTexture("originTexture", m_TexBlurH);
+        m_DebugBlurV->SetTexture("originTexture", m_TexBlurV);
+        m_DebugLumDownsample->SetTexture("originTexture", m_TexLuminances[6]);
+    }
+
 private:
 
     struct ModelViewProjectionBlock
@@ -117,7 +154,7 @@ private:
         return hovered;
     }
 
-    void CreateLuminanceRT()
+    void CreateLuminanceDownsampleTarget()
     {
         // down sample
         m_TexLuminances[6] = vk_demo::DVKTexture::CreateRenderTarget(
@@ -129,6 +166,16 @@ private:
             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
         );
 
+        vk_demo::DVKRenderPassInfo rttInfo(
+            m_TexLuminances[6], VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE, nullptr
+        );
+        m_RTLuminances[6] = vk_demo::DVKRenderTarget::Create(m_VulkanDevice, rttInfo);
+    }
+
+    void CreateLuminanceRT()
+    {
+        CreateLuminanceDownsampleTarget();
+
         // Luminance
         for (int32 i = 0; i < 6; ++i)
         {
@@ -153,7 +200,7 @@ private:
         }
 
         // render target pass
-        for (int32 i = 0; i < 7; ++i)
+        for (int32 i = 0; i < 6; ++i)
         {
             vk_demo::DVKRenderPassInfo rttInfo(
                 m_TexLuminances[i], VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE, nullptr
@@ -199,7 +246,7 @@ private:
         }
     }
 
-    void CreateBlurRT()
+    void CreateBlurTargets()
     {
         // blurH
         m_TexBlurH = vk_demo::DVKTexture::CreateRenderTarget(
@@ -216,6 +263,27 @@ private:
         );
         m_RTBlurH = vk_demo::DVKRenderTarget::Create(m_VulkanDevice, rttInfoH);
 
+        // blurV
+        m_TexBlurV = vk_demo::DVKTexture::CreateRenderTarget(
+            m_VulkanDevice,
+            m_TexBlurH->format,
+            VK_IMAGE_ASPECT_COLOR_BIT,
+            m_TexBlurH->width,
+            m_TexBlurH->height,
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
+        );
+
+        vk_demo::DVKRenderPassInfo rttInfoV(
+            m_TexBlurV, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE, nullptr
+        );
+        m_RTBlurV = vk_demo::DVKRenderTarget::Create(m_VulkanDevice, rttInfoV);
+    }
+
+    void CreateBlurRT()
+    {
+        CreateBlurTargets();
+
+        // blurH
         m_BlurHShader = vk_demo::DVKShader::Create(
             m_VulkanDevice,
             true,
@@ -233,20 +301,6 @@ private:
         m_BlurHMaterial->SetTexture("originTexture", m_TexBright);
 
         // blurV
-        m_TexBlurV = vk_demo::DVKTexture::CreateRenderTarget(
-            m_VulkanDevice,
-            m_TexBlurH->format,
-            VK_IMAGE_ASPECT_COLOR_BIT,
-            m_TexBlurH->width,
-            m_TexBlurH->height,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
-        );
-
-        vk_demo::DVKRenderPassInfo rttInfoV(
-            m_TexBlurV, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE, nullptr
-        );
-        m_RTBlurV = vk_demo::DVKRenderTarget::Create(m_VulkanDevice, rttInfoV);
-
         m_BlurVShader = vk_demo::DVKShader::Create(
             m_VulkanDevice,
             true,
@@ -264,7 +318,7 @@ private:
         m_BlurVMaterial->SetTexture("originTexture", m_TexBlurH);
     }
 
-    void CreateBrightRT()
+    void CreateBrightTarget()
     {
         m_TexBright = vk_demo::DVKTexture::CreateRenderTarget(
             m_VulkanDevice,
@@ -279,6 +333,11 @@ private:
             m_TexBright, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE, nullptr
         );
         m_RTBright = vk_demo::DVKRenderTarget::Create(m_VulkanDevice, rttInfo);
+    }
+
+    void CreateBrightRT()
+    {
+        CreateBrightTarget();
 
         m_BrightShader = vk_demo::DVKShader::Create(
             m_VulkanDevice,
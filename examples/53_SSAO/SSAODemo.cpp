@@ -59,6 +59,34 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+
+        // 场景RenderTarget与AO的中间纹理都按窗口尺寸创建。DescriptorSet不能在使用中改写，等待之前的提交执行完毕后重建
+        DemoBase::WaitIdle();
+        vk_demo::DVKRenderTarget* renderTarget = m_RTSource;
+        std::vector<vk_demo::DVKTexture*> textures = {
+            m_TexSourceColor, m_TexSourceLinearDepth, m_TexSourceDepth,
+            m_TexLinearDepth, m_TexDepthDownSize, m_TexDepthTiled, m_TexAoMerge, m_TexAoFullScreen
+        };
+        m_Scheduler->DeferRelease([=]() {
+            delete renderTarget;
+            for (int32 i = 0; i < textures.size(); ++i)
+            {
+                delete textures[i];
+            }
+        });
+
+        CreateSourceRT();
+
+        vk_demo::DVKCommandBuffer* cmdBuffer = vk_demo::DVKCommandBuffer::Create(m_VulkanDevice, m_CommandPool);
+        CreateAoTextures(cmdBuffer);
+        delete cmdBuffer;
+
+        UpdateAoTextures();
+    }
+
 private:
 
     struct ModelViewProjectionBlock
@@ -224,7 +252,7 @@ private:
         }
     }
 
-    void LoadPreDepthRes(vk_demo::DVKCommandBuffer* cmdBuffer)
+    void CreateAoTextures(vk_demo::DVKCommandBuffer* cmdBuffer)
     {
         m_TexLinearDepth = vk_demo::DVKTexture::Create2D(
             m_VulkanDevice,
@@ -263,36 +291,66 @@ private:
             ImageLayoutBarrier::ComputeGeneralRW
         );
 
-        m_ShaderDepthPrepare = vk_demo::DVKShader::Create(
+        m_TexAoMerge = vk_demo::DVKTexture::Create2D(
             m_VulkanDevice,
-            "assets/shaders/53_SSAO/DepthPrepare.comp.spv"
+            cmdBuffer,
+            VK_FORMAT_R8_UNORM,
+            VK_IMAGE_ASPECT_COLOR_BIT,
+            m_TexSourceColor->width / 2,
+            m_TexSourceColor->height / 2,
+            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
+            VK_SAMPLE_COUNT_1_BIT,
+            ImageLayoutBarrier::ComputeGeneralRW
         );
 
-        m_ComputeDepthPrepare = vk_demo::DVKCompute::Create(
+        m_TexAoFullScreen = vk_demo::DVKTexture::Create2D(
             m_VulkanDevice,
-            m_PipelineCache,
-            m_ShaderDepthPrepare
+            cmdBuffer,
+            VK_FORMAT_R8_UNORM,
+            VK_IMAGE_ASPECT_COLOR_BIT,
+            m_TexSourceColor->width,
+            m_TexSourceColor->height,
+            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
+            VK_SAMPLE_COUNT_1_BIT,
+            ImageLayoutBarrier::ComputeGeneralRW
         );
+    }
+
+    void UpdateAoTextures()
+    {
         m_ComputeDepthPrepare->SetStorageTexture("depthImage",  m_TexSourceLinearDepth);
         m_ComputeDepthPrepare->SetStorageTexture("linearImage", m_TexLinearDepth);
         m_ComputeDepthPrepare->SetStorageTexture("down2xImage", m_TexDepthDownSize);
         m_ComputeDepthPrepare->SetStorageTexture("down2xAtlas", m_TexDepthTiled);
+
+        m_ComputeAoMerge->SetStorageTexture("depthImage", m_TexDepthTiled);
+        m_ComputeAoMerge->SetStorageTexture("outAoImage", m_TexAoMerge);
+
+        m_ComputeBlurAndUpsample->SetStorageTexture("texLowDepth",      m_TexDepthDownSize);
+        m_ComputeBlurAndUpsample->SetStorageTexture("texHighDepth",     m_TexLinearDepth);
+        m_ComputeBlurAndUpsample->SetStorageTexture("texintervalDepth", m_TexAoMerge);
+        m_ComputeBlurAndUpsample->SetStorageTexture("texOutAO",         m_TexAoFullScreen);
+
+        m_CombineMaterial->SetTexture("ssaoTexture",    m_TexAoFullScreen);
+        m_CombineMaterial->SetTexture("originTexture",  m_TexSourceColor);
     }
 
-    void LoadComputeAoRes(vk_demo::DVKCommandBuffer* cmdBuffer)
+    void LoadPreDepthRes(vk_demo::DVKCommandBuffer* cmdBuffer)
     {
-        m_TexAoMerge = vk_demo::DVKTexture::Create2D(
+        m_ShaderDepthPrepare = vk_demo::DVKShader::Create(
             m_VulkanDevice,
-            cmdBuffer,
-            VK_FORMAT_R8_UNORM,
-            VK_IMAGE_ASPECT_COLOR_BIT,
-            m_TexSourceColor->width / 2,
-            m_TexSourceColor->height / 2,
-            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
-            VK_SAMPLE_COUNT_1_BIT,
-            ImageLayoutBarrier::ComputeGeneralRW
+            "assets/shaders/53_SSAO/DepthPrepare.comp.spv"
+        );
+
+        m_ComputeDepthPrepare = vk_demo::DVKCompute::Create(
+            m_VulkanDevice,
+            m_PipelineCache,
+            m_ShaderDepthPrepare
         );
+    }
 
+    void LoadComputeAoRes(vk_demo::DVKCommandBuffer* cmdBuffer)
+    {
         m_ShaderAoMerge = vk_demo::DVKShader::Create(
             m_VulkanDevice,
             "assets/shaders/53_SSAO/ComputeAO.comp.spv"
@@ -303,8 +361,6 @@ private:
             m_PipelineCache,
             m_ShaderAoMerge
         );
-        m_ComputeAoMerge->SetStorageTexture("depthImage", m_TexDepthTiled);
-        m_ComputeAoMerge->SetStorageTexture("outAoImage", m_TexAoMerge);
     }
 
     void LoadCombineRes(vk_demo::DVKCommandBuffer* cmdBuffer)
@@ -323,24 +379,10 @@ private:
             m_CombineShader
         );
         m_CombineMaterial->PreparePipeline();
-        m_CombineMaterial->SetTexture("ssaoTexture",    m_TexAoFullScreen);
-        m_CombineMaterial->SetTexture("originTexture",  m_TexSourceColor);
     }
 
     void LoadBlurAndUpsampleRes(vk_demo::DVKCommandBuffer* cmdBuffer)
     {
-        m_TexAoFullScreen = vk_demo::DVKTexture::Create2D(
-            m_VulkanDevice,
-            cmdBuffer,
-            VK_FORMAT_R8_UNORM,
-            VK_IMAGE_ASPECT_COLOR_BIT,
-            m_TexSourceColor->width,
-            m_TexSourceColor->height,
-            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
-            VK_SAMPLE_COUNT_1_BIT,
-            ImageLayoutBarrier::ComputeGeneralRW
-        );
-
         m_ShaderBlurAndUpsample = vk_demo::DVKShader::Create(
             m_VulkanDevice,
             "assets/shaders/53_SSAO/AoBlurUpsample.comp.spv"
@@ -351,10 +393,6 @@ private:
             m_PipelineCache,
             m_ShaderBlurAndUpsample
         );
-        m_ComputeBlurAndUpsample->SetStorageTexture("texLowDepth",      m_TexDepthDownSize);
-        m_ComputeBlurAndUpsample->SetStorageTexture("texHighDepth",     m_TexLinearDepth);
-        m_ComputeBlurAndUpsample->SetStorageTexture("texintervalDepth", m_TexAoMerge);
-        m_ComputeBlurAndUpsample->SetStorageTexture("texOutAO",         m_TexAoFullScreen);
     }
 
     void LoadAssets()
@@ -364,10 +402,12 @@ private:
         m_Quad = vk_demo::DVKDefaultRes::fullQuad;
 
         LoadSceneRes(cmdBuffer);
+        CreateAoTextures(cmdBuffer);
         LoadPreDepthRes(cmdBuffer);
         LoadComputeAoRes(cmdBuffer);
         LoadBlurAndUpsampleRes(cmdBuffer);
         LoadCombineRes(cmdBuffer);
+        UpdateAoTextures();
 
         delete cmdBuffer;
     }
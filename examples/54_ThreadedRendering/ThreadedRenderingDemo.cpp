@@ -269,6 +269,27 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+
+        // backbuffer数量可能随swapchain变化，补齐每个backbuffer对应的Secondary CommandBuffer
+        int32 frameCount = m_SwapChain->GetBackBufferCount();
+        for (int32 i = m_UICommandBuffers.size(); i < frameCount; ++i)
+        {
+            m_UICommandBuffers.push_back(vk_demo::DVKCommandBuffer::Create(m_VulkanDevice, m_CommandPool, VK_COMMAND_BUFFER_LEVEL_SECONDARY));
+        }
+
+        for (int32 i = 0; i < m_ThreadDatas.size(); ++i)
+        {
+            std::vector<vk_demo::DVKCommandBuffer*>& threadCommandBuffers = m_ThreadDatas[i]->threadCommandBuffers;
+            for (int32 j = threadCommandBuffers.size(); j < frameCount; ++j)
+            {
+                threadCommandBuffers.push_back(vk_demo::DVKCommandBuffer::Create(m_VulkanDevice, m_ThreadDatas[i]->commandPool, VK_COMMAND_BUFFER_LEVEL_SECONDARY));
+            }
+        }
+    }
+
 private:
 
     void Draw(float time, float delta)
@@ -58,6 +58,31 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+
+        // 离屏RenderTarget按窗口尺寸创建。Material的DescriptorSet不能在使用中改写，等待之前的提交执行完毕后重建
+        DemoBase::WaitIdle();
+        vk_demo::DVKRenderTarget* rtSource = m_RTSource;
+        vk_demo::DVKRenderTarget* rtLight  = m_RTLight;
+        vk_demo::DVKTexture* texSourceColor = m_TexSourceColor;
+        vk_demo::DVKTexture* texSourceDepth = m_TexSourceDepth;
+        vk_demo::DVKTexture* texLight       = m_TexLight;
+        m_Scheduler->DeferRelease([=]() {
+            delete rtSource;
+            delete rtLight;
+            delete texSourceColor;
+            delete texSourceDepth;
+            delete texLight;
+        });
+
+        CreateSourceRT();
+        CreateSunRT();
+        m_CombineMaterial->SetTexture("originTexture", m_TexSourceColor);
+        m_CombineMaterial->SetTexture("lightTexture",  m_TexLight);
+    }
+
 private:
 
     struct ModelViewProjectionBlock
@@ -63,6 +63,28 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+
+        // 离屏RenderTarget按窗口尺寸创建。Material的DescriptorSet不能在使用中改写，等待之前的提交执行完毕后重建
+        DemoBase::WaitIdle();
+        vk_demo::DVKRenderTarget* rtSource = m_RTSource;
+        vk_demo::DVKTexture* texSourceColor    = m_TexSourceColor;
+        vk_demo::DVKTexture* texSourceVelocity = m_TexSourceVelocity;
+        vk_demo::DVKTexture* texSourceDepth    = m_TexSourceDepth;
+        m_Scheduler->DeferRelease([=]() {
+            delete rtSource;
+            delete texSourceColor;
+            delete texSourceVelocity;
+            delete texSourceDepth;
+        });
+
+        CreateSourceRT();
+        m_CombineMaterial->SetTexture("originTexture",    m_TexSourceColor);
+        m_CombineMaterial->SetTexture("velocityTexture",  m_TexSourceVelocity);
+    }
+
 private:
 
     struct ModelViewProjectionBlock
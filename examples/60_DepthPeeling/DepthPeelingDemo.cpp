@@ -57,6 +57,42 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+
+        // 离屏RenderTarget按窗口尺寸创建。Material的DescriptorSet不能在使用中改写，等待之前的提交执行完毕后重建
+        DemoBase::WaitIdle();
+        std::vector<vk_demo::DVKTexture*> textures = {
+            m_TexSourceColor, m_TexSourceDepth, m_TexDepth0, m_TexDepth1,
+            m_TexPeel0, m_TexPeel1, m_TexPeel2, m_TexPeel3, m_TexPeel4
+        };
+        std::vector<vk_demo::DVKRenderTarget*> renderTargets = { m_RTSource, m_RTPeel0, m_RTPeel1, m_RTPeel2, m_RTPeel3, m_RTPeel4 };
+        m_Scheduler->DeferRelease([=]() {
+            for (int32 i = 0; i < textures.size(); ++i)
+            {
+                delete textures[i];
+            }
+            for (int32 i = 0; i < renderTargets.size(); ++i)
+            {
+                delete renderTargets[i];
+            }
+        });
+
+        CreateRendertarget();
+        m_PeelMaterials[0]->SetTexture("peelMap", m_TexSourceDepth);
+        m_PeelMaterials[1]->SetTexture("peelMap", m_TexDepth0);
+        m_PeelMaterials[2]->SetTexture("peelMap", m_TexDepth1);
+        m_PeelMaterials[3]->SetTexture("peelMap", m_TexDepth0);
+        m_PeelMaterials[4]->SetTexture("peelMap", m_TexDepth1);
+        m_CombineMaterial->SetTexture("originTexture",   m_TexSourceColor);
+        m_CombineMaterial->SetTexture("peel0Texture",    m_TexPeel0);
+        m_CombineMaterial->SetTexture("peel1Texture",    m_TexPeel1);
+        m_CombineMaterial->SetTexture("peel2Texture",    m_TexPeel2);
+        m_CombineMaterial->SetTexture("peel3Texture",    m_TexPeel3);
+        m_CombineMaterial->SetTexture("peel4Texture",    m_TexPeel4);
+    }
+
 private:
 
     struct ModelViewProjectionBlock
@@ -27,6 +27,20 @@ HitInfo Sphere::HitTest(const Ray& ray)
     return hitInfo;
 }
 
+void Scene::Build()
+{
+    bvh.Clear();
+
+    for (int32 i = 0; i < spheres.size(); ++i)
+    {
+        Sphere& sphere = spheres[i];
+        Vector3 extent(sphere.radius, sphere.radius, sphere.radius);
+        bvh.AddProxy(sphere.center - extent, sphere.center + extent, &sphere);
+    }
+
+    bvh.Update();
+}
+
 Vector4 Raytracing::HitScene()
 {
     color.Set(0, 0, 0, 0);
@@ -73,16 +87,19 @@ HitInfo Raytracing::IntersectScene(Scene* scene, const Ray& ray)
     info.dist = MAX_int32;
     info.hit  = false;
 
-    for (int32 i = 0; i < scene->spheres.size(); ++i)
-    {
-        Sphere& sphere  = scene->spheres[i];
-        HitInfo tempHit = sphere.HitTest(ray);
+    // only spheres whose bounds are hit by the ray, nearest first
+    scene->bvh.RayCast(ray.start, ray.direction, MAX_int32, [&](int32 proxy, void* userData, const Vector3& origin, const Vector3& direction, float maxDist) -> float {
+        Sphere* sphere  = (Sphere*)userData;
+        HitInfo tempHit = sphere->HitTest(ray);
 
-        if (tempHit.hit && tempHit.dist < info.dist)
+        if (tempHit.hit && tempHit.dist < maxDist)
         {
             info = tempHit;
+            return tempHit.dist;
         }
-    }
+
+        return -1.0f;
+    });
 
     return info;
 }
@@ -3,6 +3,7 @@
 #include "Common/Common.h"
 #include "Math/Vector3.h"
 #include "Demo/DVKCamera.h"
+#include "Demo/DVKSceneBVH.h"
 #include "ThreadTask.h"
 #include "Material.h"
 
@@ -47,7 +48,11 @@ struct Sphere
 
 struct Scene
 {
-    std::vector<Sphere> spheres;
+    std::vector<Sphere>     spheres;
+    vk_demo::DVKSceneBVH    bvh;
+
+    // spheres must not change after build
+    void Build();
 };
 
 class Raytracing : public ThreadTask
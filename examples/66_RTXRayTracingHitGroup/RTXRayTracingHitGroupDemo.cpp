@@ -216,6 +216,25 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+
+        // 光追输出的StorageImage按窗口尺寸创建。DescriptorSet不能在使用中改写，等待之前的提交执行完毕后重建
+        DemoBase::WaitIdle();
+        vk_demo::DVKTexture* storageImage = m_StorageImage;
+        m_Scheduler->DeferRelease([=]() {
+            delete storageImage;
+        });
+
+        vk_demo::DVKCommandBuffer* cmdBuffer = vk_demo::DVKCommandBuffer::Create(m_VulkanDevice, m_CommandPool);
+        CreateStorageImage(cmdBuffer);
+        delete cmdBuffer;
+
+        UpdateStorageImageDescriptor();
+        m_Material->SetTexture("diffuseMap", m_StorageImage);
+    }
+
 private:
 
     void Draw(float time, float delta)
@@ -1027,17 +1046,7 @@ private:
 
         m_Quad = vk_demo::DVKDefaultRes::fullQuad;
 
-        m_StorageImage = vk_demo::DVKTexture::Create2D(
-            m_VulkanDevice,
-            cmdBuffer,
-            m_SwapChain->GetColorFormat(),
-            VK_IMAGE_ASPECT_COLOR_BIT,
-            m_FrameWidth,
-            m_FrameHeight,
-            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
-            VK_SAMPLE_COUNT_1_BIT,
-            ImageLayoutBarrier::ComputeGeneralRW
-        );
+        CreateStorageImage(cmdBuffer);
 
         m_Shader = vk_demo::DVKShader::Create(
             m_VulkanDevice,
@@ -1058,6 +1067,36 @@ private:
         delete cmdBuffer;
     }
 
+    void CreateStorageImage(vk_demo::DVKCommandBuffer* cmdBuffer)
+    {
+        m_StorageImage = vk_demo::DVKTexture::Create2D(
+            m_VulkanDevice,
+            cmdBuffer,
+            m_SwapChain->GetColorFormat(),
+            VK_IMAGE_ASPECT_COLOR_BIT,
+            m_FrameWidth,
+            m_FrameHeight,
+            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
+            VK_SAMPLE_COUNT_1_BIT,
+            ImageLayoutBarrier::ComputeGeneralRW
+        );
+    }
+
+    void UpdateStorageImageDescriptor()
+    {
+        VkDescriptorImageInfo imageInfo;
+        imageInfo.imageView = m_StorageImage->imageView;
+        imageInfo.imageLayout = m_StorageImage->imageLayout;
+        VkWriteDescriptorSet imageWriteDescriptorSet;
+        ZeroVulkanStruct(imageWriteDescriptorSet, VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET);
+        imageWriteDescriptorSet.pImageInfo = &imageInfo;
+        imageWriteDescriptorSet.dstSet = m_DescriptorSets[0];
+        imageWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        imageWriteDescriptorSet.dstBinding = 1;
+        imageWriteDescriptorSet.descriptorCount = 1;
+        vkUpdateDescriptorSets(m_VulkanDevice->GetInstanceHandle(), 1, &imageWriteDescriptorSet, 0, nullptr);
+    }
+
     void LoadExtensions()
     {
         VkDevice device = m_VulkanDevice->GetInstanceHandle();
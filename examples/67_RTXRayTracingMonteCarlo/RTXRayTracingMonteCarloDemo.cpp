@@ -217,6 +217,28 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+
+        // 光追输出的StorageImage按窗口尺寸创建。DescriptorSet不能在使用中改写，等待之前的提交执行完毕后重建
+        DemoBase::WaitIdle();
+        vk_demo::DVKTexture* storageImage = m_StorageImage;
+        m_Scheduler->DeferRelease([=]() {
+            delete storageImage;
+        });
+
+        vk_demo::DVKCommandBuffer* cmdBuffer = vk_demo::DVKCommandBuffer::Create(m_VulkanDevice, m_CommandPool);
+        CreateStorageImage(cmdBuffer);
+        delete cmdBuffer;
+
+        UpdateStorageImageDescriptor();
+        m_Material->SetTexture("diffuseMap", m_StorageImage);
+
+        // 新的StorageImage内容未定义，重新开始累积
+        m_ResetAccumulation = true;
+    }
+
 private:
 
     void Draw(float time, float delta)
@@ -231,8 +253,9 @@ private:
             m_ViewCamera.Update(time, delta);
         }
 
-        if (InputManager::IsMouseDown(MouseType::MOUSE_BUTTON_LEFT) || InputManager::GetMouseDelta() > 0 || InputManager::IsKeyDown(KeyboardType::KEY_SPACE))
+        if (m_ResetAccumulation || InputManager::IsMouseDown(MouseType::MOUSE_BUTTON_LEFT) || InputManager::GetMouseDelta() > 0 || InputManager::IsKeyDown(KeyboardType::KEY_SPACE))
         {
+            m_ResetAccumulation = false;
             m_FrameCount.x = 0;
             m_CameraParam.param.x = 1;
         }
@@ -1043,17 +1066,7 @@ private:
 
         m_Quad = vk_demo::DVKDefaultRes::fullQuad;
 
-        m_StorageImage = vk_demo::DVKTexture::Create2D(
-            m_VulkanDevice,
-            cmdBuffer,
-            VK_FORMAT_R32G32B32A32_SFLOAT,
-            VK_IMAGE_ASPECT_COLOR_BIT,
-            m_FrameWidth,
-            m_FrameHeight,
-            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
-            VK_SAMPLE_COUNT_1_BIT,
-            ImageLayoutBarrier::ComputeGeneralRW
-        );
+        CreateStorageImage(cmdBuffer);
 
         m_Shader = vk_demo::DVKShader::Create(
             m_VulkanDevice,
@@ -1074,6 +1087,36 @@ private:
         delete cmdBuffer;
     }
 
+    void CreateStorageImage(vk_demo::DVKCommandBuffer* cmdBuffer)
+    {
+        m_StorageImage = vk_demo::DVKTexture::Create2D(
+            m_VulkanDevice,
+            cmdBuffer,
+            VK_FORMAT_R32G32B32A32_SFLOAT,
+            VK_IMAGE_ASPECT_COLOR_BIT,
+            m_FrameWidth,
+            m_FrameHeight,
+            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
+            VK_SAMPLE_COUNT_1_BIT,
+            ImageLayoutBarrier::ComputeGeneralRW
+        );
+    }
+
+    void UpdateStorageImageDescriptor()
+    {
+        VkDescriptorImageInfo imageInfo;
+        imageInfo.imageView = m_StorageImage->imageView;
+        imageInfo.imageLayout = m_StorageImage->imageLayout;
+        VkWriteDescriptorSet imageWriteDescriptorSet;
+        ZeroVulkanStruct(imageWriteDescriptorSet, VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET);
+        imageWriteDescriptorSet.pImageInfo = &imageInfo;
+        imageWriteDescriptorSet.dstSet = m_DescriptorSets[0];
+        imageWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        imageWriteDescriptorSet.dstBinding = 1;
+        imageWriteDescriptorSet.descriptorCount = 1;
+        vkUpdateDescriptorSets(m_VulkanDevice->GetInstanceHandle(), 1, &imageWriteDescriptorSet, 0, nullptr);
+    }
+
     void LoadExtensions()
     {
         VkDevice device = m_VulkanDevice->GetInstanceHandle();
@@ -1526,6 +1569,7 @@ private:
 
     vk_demo::DVKTexture*                                m_StorageImage = nullptr;
     Vector4                                             m_FrameCount;
+    bool                                                m_ResetAccumulation = false;
 
     VkPipeline                                          m_Pipeline = VK_NULL_HANDLE;
     VkPipelineLayout                                    m_PipelineLayout = VK_NULL_HANDLE;
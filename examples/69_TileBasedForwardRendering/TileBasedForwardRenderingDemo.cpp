@@ -120,6 +120,27 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+
+        // 深度和剔除结果按窗口尺寸分块。DescriptorSet不能在使用中改写，等待之前的提交执行完毕后重建
+        DemoBase::WaitIdle();
+
+        vk_demo::DVKTexture*      depthTexture  = m_PreDepthTexture;
+        vk_demo::DVKRenderTarget* depthRTT      = m_PreDepthRTT;
+        vk_demo::DVKBuffer*       cullingBuffer = m_LightsCullingBuffer;
+        m_Scheduler->DeferRelease([=]() {
+            delete depthTexture;
+            delete depthRTT;
+            delete cullingBuffer;
+        });
+
+        UpdateTileParams();
+        CreateTileTargets();
+        UpdateTileBindings();
+    }
+
 private:
 
     void Draw(float time, float delta)
@@ -141,6 +162,9 @@ private:
 
         m_CullingParam.pos = m_ViewCamera.GetTransform().GetOrigin();
 
+        // 深度预渲染与光源剔除各自提交，剔除在计算队列上执行，最终Pass的顶点处理可以与剔除重叠
+        SetupDepthCommand();
+        SetupComputeCommand();
         SetupCommandBuffers(bufferIndex);
         DemoBase::Present(bufferIndex);
     }
@@ -217,7 +241,10 @@ private:
 
             m_LightInfo.position[i] = position;
         }
+    }
 
+    void UpdateTileParams()
+    {
         m_TileCountPerRow = (m_FrameWidth - 1) / TILE_SIZE + 1;
         m_TileCountPerCol = (m_FrameHeight - 1) / TILE_SIZE + 1;
 
@@ -232,6 +259,17 @@ private:
     {
         vk_demo::DVKCommandBuffer* cmdBuffer = vk_demo::DVKCommandBuffer::Create(m_VulkanDevice, m_CommandPool);
 
+        m_DepthCommand = vk_demo::DVKCommandBuffer::Create(m_VulkanDevice, m_CommandPool);
+        m_ComputeCommand = vk_demo::DVKCommandBuffer::Create(
+            m_VulkanDevice,
+            m_ComputeCommandPool,
+            VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            m_VulkanDevice->GetComputeQueue()
+        );
+
+        m_ComputeFamily  = m_VulkanDevice->GetComputeQueue()->GetFamilyIndex();
+        m_GraphicsFamily = m_VulkanDevice->GetGraphicsQueue()->GetFamilyIndex();
+
         // scene
         m_Model = vk_demo::DVKModel::LoadFromFile(
             "assets/models/scene1.obj",
@@ -263,18 +301,9 @@ private:
         // lights
         InitLights();
 
-        // depth
-        m_PreDepthTexture = vk_demo::DVKTexture::CreateRenderTarget(
-            m_VulkanDevice,
-            PixelFormatToVkFormat(m_DepthFormat, false),
-            VK_IMAGE_ASPECT_DEPTH_BIT,
-            m_FrameWidth,
-            m_FrameHeight,
-            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
-        );
-
-        vk_demo::DVKRenderPassInfo passInfo(m_PreDepthTexture, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE);
-        m_PreDepthRTT = vk_demo::DVKRenderTarget::Create(m_VulkanDevice, passInfo);
+        // depth & tiles
+        UpdateTileParams();
+        CreateTileTargets();
 
         m_DepthShader = vk_demo::DVKShader::Create(
             m_VulkanDevice,
@@ -293,14 +322,6 @@ private:
         m_DepthMaterial->pipelineInfo.colorAttachmentCount = 0;
         m_DepthMaterial->PreparePipeline();
 
-        // tiles
-        m_LightsCullingBuffer = vk_demo::DVKBuffer::CreateBuffer(
-            m_VulkanDevice,
-            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            sizeof(LightVisiblity) * m_TileCountPerRow * m_TileCountPerCol
-        );
-
         m_ComputeShader = vk_demo::DVKShader::Create(
             m_VulkanDevice,
             "assets/shaders/69_TileBasedForwardRendering/lightCulling.comp.spv"
@@ -311,12 +332,39 @@ private:
             m_PipelineCache,
             m_ComputeShader
         );
+        UpdateTileBindings();
+
+        delete cmdBuffer;
+    }
+
+    void CreateTileTargets()
+    {
+        m_PreDepthTexture = vk_demo::DVKTexture::CreateRenderTarget(
+            m_VulkanDevice,
+            PixelFormatToVkFormat(m_DepthFormat, false),
+            VK_IMAGE_ASPECT_DEPTH_BIT,
+            m_FrameWidth,
+            m_FrameHeight,
+            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
+        );
+
+        vk_demo::DVKRenderPassInfo passInfo(m_PreDepthTexture, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE);
+        m_PreDepthRTT = vk_demo::DVKRenderTarget::Create(m_VulkanDevice, passInfo);
+
+        m_LightsCullingBuffer = vk_demo::DVKBuffer::CreateBuffer(
+            m_VulkanDevice,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            sizeof(LightVisiblity) * m_TileCountPerRow * m_TileCountPerCol
+        );
+    }
+
+    void UpdateTileBindings()
+    {
         m_ComputeProcessor->SetStorageBuffer("lightsCullingBuffer", m_LightsCullingBuffer);
         m_ComputeProcessor->SetTexture("depthTexture", m_PreDepthTexture);
 
         m_Material->SetStorageBuffer("lightsCullingBuffer", m_LightsCullingBuffer);
-
-        delete cmdBuffer;
     }
 
     void DestroyAssets()
@@ -333,12 +381,13 @@ private:
         delete m_ComputeShader;
         delete m_ComputeProcessor;
         delete m_LightsCullingBuffer;
+
+        delete m_DepthCommand;
+        delete m_ComputeCommand;
     }
 
-    void PreDepthPass(int backBufferIndex)
+    void PreDepthPass(VkCommandBuffer commandBuffer)
     {
-        VkCommandBuffer commandBuffer = m_CommandBuffers[backBufferIndex];
-
         m_PreDepthRTT->BeginRenderPass(commandBuffer);
 
         vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_DepthMaterial->GetPipeline());
@@ -430,53 +479,49 @@ private:
         vkCmdEndRenderPass(commandBuffer);
     }
 
-    void SetupComputeCommand(int32 backBufferIndex)
+    void SetupDepthCommand()
     {
-        VkCommandBuffer commandBuffer = m_CommandBuffers[backBufferIndex];
+        // 深度每帧清除，内容不需要保留，不从计算队列取回所有权，但需要等待上一帧的剔除读取完毕
+        if (m_ComputeCommand->submittedValue > 0)
+        {
+            m_Scheduler->AddWait(
+                vk_demo::DVKFrameScheduler::QueueType::Graphics,
+                vk_demo::DVKFrameScheduler::QueueType::Compute,
+                m_ComputeCommand->submittedValue,
+                VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT
+            );
+        }
+
+        m_DepthCommand->Begin();
+
+        PreDepthPass(m_DepthCommand->cmdBuffer);
+
+        vk_demo::DVKCompute::ReleaseImage(m_DepthCommand->cmdBuffer, m_PreDepthTexture, m_GraphicsFamily, m_ComputeFamily, 0, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
 
-        VkBufferMemoryBarrier bufferBarrier;
-        ZeroVulkanStruct(bufferBarrier, VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER);
-        bufferBarrier.buffer = m_LightsCullingBuffer->buffer;
-        bufferBarrier.size   = m_LightsCullingBuffer->size;
-        bufferBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        bufferBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-        bufferBarrier.srcQueueFamilyIndex = m_VulkanDevice->GetGraphicsQueue()->GetFamilyIndex();
-        bufferBarrier.dstQueueFamilyIndex = m_VulkanDevice->GetComputeQueue()->GetFamilyIndex();
-
-        vkCmdPipelineBarrier(
-            commandBuffer,
-            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-            0,
-            0,
-            nullptr,
-            1,
-            &bufferBarrier,
-            0,
-            nullptr
+        uint64 depthValue = m_DepthCommand->SubmitAsync(m_Scheduler, vk_demo::DVKFrameScheduler::QueueType::Graphics);
+
+        m_Scheduler->AddWait(
+            vk_demo::DVKFrameScheduler::QueueType::Compute,
+            vk_demo::DVKFrameScheduler::QueueType::Graphics,
+            depthValue,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
         );
+    }
+
+    void SetupComputeCommand()
+    {
+        m_ComputeCommand->Begin();
+
+        vk_demo::DVKCompute::AcquireImage(m_ComputeCommand->cmdBuffer, m_PreDepthTexture, m_GraphicsFamily, m_ComputeFamily, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
 
+        // 剔除结果会被完全覆盖，不需要从图形队列取回所有权。上一帧的读取在深度提交之前，已由semaphore保证完成
         m_ComputeProcessor->SetUniform("uboCulling", &m_CullingParam, sizeof(CullingParamBlock));
         m_ComputeProcessor->SetUniform("uboLights", &m_LightParam, sizeof(LightsParamBlock));
-        m_ComputeProcessor->BindDispatch(commandBuffer, m_TileCountPerRow, m_TileCountPerCol, 1);
-
-        bufferBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-        bufferBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        bufferBarrier.srcQueueFamilyIndex = m_VulkanDevice->GetComputeQueue()->GetFamilyIndex();
-        bufferBarrier.dstQueueFamilyIndex = m_VulkanDevice->GetGraphicsQueue()->GetFamilyIndex();
-
-        vkCmdPipelineBarrier(
-            commandBuffer,
-            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-            0,
-            0,
-            nullptr,
-            1,
-            &bufferBarrier,
-            0,
-            nullptr
-        );
+        m_ComputeProcessor->BindDispatch(m_ComputeCommand->cmdBuffer, m_TileCountPerRow, m_TileCountPerCol, 1);
+
+        vk_demo::DVKCompute::ReleaseBuffer(m_ComputeCommand->cmdBuffer, m_LightsCullingBuffer, m_ComputeFamily, m_GraphicsFamily, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+        vk_demo::DVKCompute::SubmitAsync(m_ComputeCommand, m_Scheduler, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
     }
 
     void SetupCommandBuffers(int32 backBufferIndex)
@@ -487,8 +532,8 @@ private:
         ZeroVulkanStruct(cmdBeginInfo, VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO);
         VERIFYVULKANRESULT(vkBeginCommandBuffer(commandBuffer, &cmdBeginInfo));
 
-        PreDepthPass(backBufferIndex);
-        SetupComputeCommand(backBufferIndex);
+        vk_demo::DVKCompute::AcquireBuffer(commandBuffer, m_LightsCullingBuffer, m_ComputeFamily, m_GraphicsFamily, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
         FinnalPass(backBufferIndex);
 
         VERIFYVULKANRESULT(vkEndCommandBuffer(commandBuffer));
@@ -533,6 +578,10 @@ private:
     vk_demo::DVKShader*         m_ComputeShader = nullptr;
     vk_demo::DVKCompute*        m_ComputeProcessor = nullptr;
     vk_demo::DVKBuffer*         m_LightsCullingBuffer = nullptr;
+    vk_demo::DVKCommandBuffer*  m_DepthCommand = nullptr;
+    vk_demo::DVKCommandBuffer*  m_ComputeCommand = nullptr;
+    uint32                      m_ComputeFamily = 0;
+    uint32                      m_GraphicsFamily = 0;
 
     vk_demo::DVKCamera          m_ViewCamera;
 
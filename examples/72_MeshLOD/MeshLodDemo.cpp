@@ -6,18 +6,8 @@
 #include "Math/Vector4.h"
 #include "Math/Matrix4x4.h"
 
-#include "meshoptimizer.h"
-
 #include <vector>
 
-#define LOD_GROUP_SIZE 15
-
-struct LodGroup
-{
-    uint32 start;
-    uint32 count;
-};
-
 struct ModelViewProjectionBlock
 {
     Matrix4x4 model;
@@ -75,12 +65,20 @@ public:
         Draw(time, delta);
     }
 
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+    }
+
 private:
 
     void Draw(float time, float delta)
     {
         int32 bufferIndex = DemoBase::AcquireBackbufferIndex();
 
+        // 之前帧的可见Meshlet数量回读完成后在这里回调
+        m_Readback->Update();
+
         UpdateFPS(time, delta);
         bool hovered = UpdateUI(time, delta);
 
@@ -92,6 +90,32 @@ private:
         SetupCommandBuffers(bufferIndex);
 
         DemoBase::Present(bufferIndex);
+
+        if (m_MeshletCull)
+        {
+            ReadVisibleMeshlets();
+        }
+    }
+
+    void ReadVisibleMeshlets()
+    {
+        // 回读在本帧之后提交，不阻塞渲染，结果延迟几帧显示
+        vk_demo::DVKBuffer* countBuffer = m_MeshletCuller->countBuffer;
+        m_Readback->ReadBuffer(
+            countBuffer->buffer,
+            0,
+            countBuffer->size,
+            [this](const void* data, VkDeviceSize size) {
+                const uint32* counts = (const uint32*)data;
+                m_VisibleMeshlets = 0;
+                for (int32 i = 0; i < size / sizeof(uint32); ++i)
+                {
+                    m_VisibleMeshlets += counts[i];
+                }
+            },
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_ACCESS_SHADER_WRITE_BIT
+        );
     }
 
     bool UpdateUI(float time, float delta)
@@ -103,10 +127,29 @@ private:
             ImGui::SetNextWindowSize(ImVec2(0, 0), ImGuiSetCond_FirstUseEver);
             ImGui::Begin("MeshLodDemo", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove);
 
-            int32 totalCount = m_IndexBuffer->indexCount;
+            vk_demo::DVKMesh* mesh = m_Model->meshes[0];
 
-            ImGui::SliderInt("LOD", &m_LodIndex, 0, LOD_GROUP_SIZE - 1);
-            ImGui::Text("Tri:%d\n", m_LodGroups[m_LodIndex].count / 3);
+            ImGui::Checkbox("MeshletCull", &m_MeshletCull);
+            if (m_MeshletCull)
+            {
+                ImGui::Text("Meshlets:%d/%d", m_VisibleMeshlets, m_MeshletCuller->GetMeshletCount());
+            }
+
+            ImGui::Checkbox("AutoLOD", &m_AutoLod);
+            if (m_AutoLod)
+            {
+                ImGui::SliderFloat("PixelError", &m_LodSelector.pixelError, 0.25f, 8.0f);
+            }
+            else
+            {
+                ImGui::SliderInt("LOD", &m_LodIndex, 0, mesh->GetLodCount() - 1);
+            }
+            ImGui::Text("LOD:%d Tri:%d\n", mesh->lodIndex, m_TriangleCount);
+
+            ImGui::Checkbox("FrustumCull", &m_FrustumCull);
+            ImGui::SameLine();
+            ImGui::Checkbox("BVH", &m_FrustumCuller.useBVH);
+            ImGui::Text("Visible:%d Culled:%d", m_FrustumCuller.visibleCount, m_FrustumCuller.culledCount);
 
             ImGui::Text("%.3f ms/frame (%d FPS)", 1000.0f / m_LastFPS, m_LastFPS);
             ImGui::End();
@@ -120,132 +163,6 @@ private:
         return hovered;
     }
 
-    void ProcessMesh(vk_demo::DVKCommandBuffer* cmdBuffer)
-    {
-        const uint32 VertexStride = 6;
-
-        std::vector<float> tempVertices;
-        std::vector<uint32> tempIndices;
-
-        for (int32 m = 0; m < m_Model->meshes.size(); ++m)
-        {
-            vk_demo::DVKMesh* mesh = m_Model->meshes[m];
-            for (int32 p = 0; p < mesh->primitives.size(); ++p)
-            {
-                vk_demo::DVKPrimitive* primitive = mesh->primitives[p];
-                uint32 indexStart = tempVertices.size() / VertexStride;
-
-                for (int32 i = 0; i < primitive->vertices.size(); ++i)
-                {
-                    tempVertices.push_back(primitive->vertices[i]);
-                }
-
-                for (int32 i = 0; i < primitive->indices.size(); ++i)
-                {
-                    tempIndices.push_back(primitive->indices[i] + indexStart);
-                }
-            }
-        }
-
-        // Indexing
-        std::vector<uint32> remap;
-        remap.resize(tempVertices.size() / VertexStride);
-        size_t totalVertices = meshopt_generateVertexRemap(
-            remap.data(),
-            tempIndices.data(),
-            tempIndices.size(),
-            tempVertices.data(),
-            tempVertices.size() / VertexStride,
-            sizeof(float) * VertexStride
-        );
-
-        std::vector<uint32> indices;
-        indices.resize(tempIndices.size());
-        meshopt_remapIndexBuffer(
-            indices.data(),
-            tempIndices.data(),
-            tempIndices.size(),
-            remap.data()
-        );
-
-        std::vector<float> vertices;
-        vertices.resize(totalVertices * VertexStride);
-        meshopt_remapVertexBuffer(
-            vertices.data(),
-            tempVertices.data(),
-            tempVertices.size() / VertexStride,
-            sizeof(float) * VertexStride,
-            remap.data()
-        );
-
-        // Vertex cache optimization
-        meshopt_optimizeVertexCache(
-            indices.data(),
-            indices.data(),
-            indices.size(),
-            vertices.size() / VertexStride
-        );
-
-        // Overdraw optimization
-        meshopt_optimizeOverdraw(
-            indices.data(),
-            indices.data(),
-            indices.size(),
-            vertices.data(),
-            vertices.size() / VertexStride,
-            sizeof(float) * VertexStride,
-            3.0f
-        );
-
-        // Vertex fetch optimization
-        meshopt_optimizeVertexFetch(
-            vertices.data(),
-            indices.data(),
-            indices.size(),
-            vertices.data(),
-            vertices.size() / VertexStride,
-            sizeof(float) * VertexStride
-        );
-
-        // Simplification
-        uint32 indexCount = indices.size();
-
-        m_LodGroups[0].start = 0;
-        m_LodGroups[0].count = indices.size();
-
-        float bias = 1.0f / LOD_GROUP_SIZE;
-        for (int lodIdx = 1; lodIdx < LOD_GROUP_SIZE; ++lodIdx)
-        {
-            float threshold = 1.0f - lodIdx * bias;
-            uint32 lodIndexCount = indexCount * threshold / 3 * 3;
-
-            std::vector<uint32> lodIndices;
-            lodIndices.resize(lodIndexCount);
-
-            uint32 realCount = meshopt_simplifySloppy(
-                lodIndices.data(),
-                indices.data(),
-                indexCount,
-                vertices.data(),
-                vertices.size() / VertexStride,
-                sizeof(float) * VertexStride,
-                lodIndexCount
-            );
-            lodIndices.resize(realCount);
-
-            m_LodGroups[lodIdx].start = indices.size();
-            m_LodGroups[lodIdx].count = lodIndices.size();
-
-            for (int32 i = 0; i < lodIndices.size(); ++i)
-            {
-                indices.push_back(lodIndices[i]);
-            }
-        }
-
-        m_VertexBuffer = vk_demo::DVKVertexBuffer::Create(m_VulkanDevice, cmdBuffer, vertices, { VertexAttribute::VA_Position, VertexAttribute::VA_Normal });
-        m_IndexBuffer  = vk_demo::DVKIndexBuffer::Create(m_VulkanDevice, cmdBuffer, indices);
-    }
-
     void LoadAssets()
     {
         vk_demo::DVKCommandBuffer* cmdBuffer = vk_demo::DVKCommandBuffer::Create(m_VulkanDevice, m_CommandPool);
@@ -257,7 +174,8 @@ private:
             {
                 VertexAttribute::VA_Position,
                 VertexAttribute::VA_Normal
-            }
+            },
+            vk_demo::MIF_GenerateLods | vk_demo::MIF_BuildMeshlets
         );
 
         m_Shader = vk_demo::DVKShader::Create(
@@ -276,20 +194,25 @@ private:
         );
         m_Material->PreparePipeline();
 
-        ProcessMesh(cmdBuffer);
+        m_CullShader = vk_demo::DVKShader::Create(m_VulkanDevice, "assets/shaders/72_MeshLOD/MeshletCull.comp.spv");
+        m_MeshletCuller = vk_demo::DVKMeshletCuller::Create(m_VulkanDevice, m_PipelineCache, m_CullShader, m_Model, cmdBuffer);
+
+        // 调度器在DemoBase::Release中先于资源销毁，这里使用独立的Fence
+        m_Readback = vk_demo::DVKReadback::Create(m_VulkanDevice);
 
         delete cmdBuffer;
     }
 
     void DestroyAssets()
     {
+        delete m_Readback;
+        delete m_MeshletCuller;
+        delete m_CullShader;
+
         delete m_Model;
 
         delete m_Material;
         delete m_Shader;
-
-        delete m_VertexBuffer;
-        delete m_IndexBuffer;
     }
 
     void SetupCommandBuffers(int32 backBufferIndex)
@@ -314,6 +237,17 @@ private:
         ZeroVulkanStruct(cmdBeginInfo, VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO);
         VERIFYVULKANRESULT(vkBeginCommandBuffer(commandBuffer, &cmdBeginInfo));
 
+        m_MVPParam.model.SetIdentity();
+        m_MVPParam.model.RotateY(180);
+        m_MVPParam.view  = m_ViewCamera.GetView();
+        m_MVPParam.proj  = m_ViewCamera.GetProjection();
+
+        // Meshlet剔除需要在RenderPass之外录制
+        if (m_MeshletCull)
+        {
+            m_MeshletCuller->Cull(commandBuffer, m_ViewCamera, m_MVPParam.model);
+        }
+
         VkClearValue clearValues[2];
         clearValues[0].color        = {
             { 0.2f, 0.2f, 0.2f, 1.0f }
@@ -337,23 +271,21 @@ private:
 
         vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Material->GetPipeline());
         m_Material->BeginFrame();
-        m_MVPParam.model.SetIdentity();
-        m_MVPParam.model.RotateY(180);
-        m_MVPParam.view  = m_ViewCamera.GetView();
-        m_MVPParam.proj  = m_ViewCamera.GetProjection();
-
         m_Material->BeginObject();
         m_Material->SetLocalUniform("uboMVP",      &m_MVPParam,         sizeof(ModelViewProjectionBlock));
         m_Material->EndObject();
 
         m_Material->BindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, 0);
 
-        int32 indexCount = m_LodGroups[m_LodIndex].count;
-        int32 indexStart = m_LodGroups[m_LodIndex].start;
-
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &(m_VertexBuffer->dvkBuffer->buffer), &(m_VertexBuffer->offset));
-        vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer->dvkBuffer->buffer, 0, m_IndexBuffer->indexType);
-        vkCmdDrawIndexed(commandBuffer, indexCount, 1, indexStart, 0, 0);
+        // Meshlet在LOD0上构建，只绘制剔除后剩下的Meshlet
+        if (m_MeshletCull)
+        {
+            m_MeshletCuller->Draw(commandBuffer);
+        }
+        else
+        {
+            DrawMeshes(commandBuffer);
+        }
 
         m_Material->EndFrame();
 
@@ -362,6 +294,44 @@ private:
         VERIFYVULKANRESULT(vkEndCommandBuffer(commandBuffer));
     }
 
+    void DrawMeshes(VkCommandBuffer commandBuffer)
+    {
+        // 自动模式下按屏幕覆盖选择LOD
+        if (m_AutoLod)
+        {
+            m_LodSelector.screenHeight = m_FrameHeight;
+            m_TriangleCount = m_LodSelector.Update(m_Model, m_ViewCamera, m_MVPParam.model);
+        }
+        else
+        {
+            m_TriangleCount = 0;
+            for (int32 i = 0; i < m_Model->meshes.size(); ++i)
+            {
+                m_Model->meshes[i]->SetLod(m_LodIndex);
+                m_TriangleCount += m_Model->meshes[i]->GetLodTriangleCount();
+            }
+        }
+
+        if (m_FrustumCull)
+        {
+            m_FrustumCuller.Cull(m_Model, m_ViewCamera.GetFrustum(), m_MVPParam.model);
+        }
+        else
+        {
+            m_FrustumCuller.visibleCount = (int32)m_Model->meshes.size();
+            m_FrustumCuller.culledCount  = 0;
+        }
+
+        for (int32 i = 0; i < m_Model->meshes.size(); ++i)
+        {
+            if (m_FrustumCull && !m_FrustumCuller.IsVisible(i))
+            {
+                continue;
+            }
+            m_Model->meshes[i]->BindDrawCmd(commandBuffer);
+        }
+    }
+
     void InitParmas()
     {
         m_ViewCamera.SetPosition(0, 0, -50.0f);
@@ -392,10 +362,20 @@ private:
     vk_demo::DVKCamera              m_ViewCamera;
     ModelViewProjectionBlock        m_MVPParam;
 
-    LodGroup                        m_LodGroups[LOD_GROUP_SIZE];
+    vk_demo::DVKLodSelector         m_LodSelector;
+    bool                            m_AutoLod = true;
     int32                           m_LodIndex = 0;
-    vk_demo::DVKVertexBuffer*       m_VertexBuffer = nullptr;
-    vk_demo::DVKIndexBuffer*        m_IndexBuffer = nullptr;
+    int32                           m_TriangleCount = 0;
+
+    vk_demo::DVKFrustumCuller       m_FrustumCuller;
+    bool                            m_FrustumCull = true;
+
+    vk_demo::DVKShader*             m_CullShader = nullptr;
+    vk_demo::DVKMeshletCuller*      m_MeshletCuller = nullptr;
+    bool                            m_MeshletCull = false;
+
+    vk_demo::DVKReadback*           m_Readback = nullptr;
+    int32                           m_VisibleMeshlets = 0;
 
     ImageGUIContext*                m_GUI = nullptr;
 };
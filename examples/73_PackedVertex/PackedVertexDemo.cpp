@@ -0,0 +1,323 @@
+﻿#include "Common/Common.h"
+#include "Common/Log.h"
+
+#include "Demo/DVKCommon.h"
+
+#include "Math/Vector4.h"
+#include "Math/Matrix4x4.h"
+
+#include <vector>
+
+struct ModelViewProjectionBlock
+{
+    Matrix4x4 model;
+    Matrix4x4 view;
+    Matrix4x4 proj;
+};
+
+class PackedVertexDemo : public DemoBase
+{
+public:
+    PackedVertexDemo(int32 width, int32 height, const char* title, const std::vector<std::string>& cmdLine)
+        : DemoBase(width, height, title, cmdLine)
+    {
+
+    }
+
+    virtual ~PackedVertexDemo()
+    {
+
+    }
+
+    virtual bool PreInit() override
+    {
+        return true;
+    }
+
+    virtual bool Init() override
+    {
+        DemoBase::Setup();
+        DemoBase::Prepare();
+
+        CreateGUI();
+        LoadAssets();
+        InitParmas();
+
+        m_Ready = true;
+
+        return true;
+    }
+
+    virtual void Exist() override
+    {
+        DemoBase::Release();
+
+        DestroyAssets();
+        DestroyGUI();
+    }
+
+    virtual void Loop(float time, float delta) override
+    {
+        if (!m_Ready)
+        {
+            return;
+        }
+        Draw(time, delta);
+    }
+
+    virtual void OnResize(int32 width, int32 height) override
+    {
+        m_ViewCamera.SetAspect(width, height);
+    }
+
+private:
+
+    void Draw(float time, float delta)
+    {
+        int32 bufferIndex = DemoBase::AcquireBackbufferIndex();
+
+        UpdateFPS(time, delta);
+        bool hovered = UpdateUI(time, delta);
+
+        if (!hovered)
+        {
+            m_ViewCamera.Update(time, delta);
+        }
+
+        SetupCommandBuffers(bufferIndex);
+
+        DemoBase::Present(bufferIndex);
+    }
+
+    bool UpdateUI(float time, float delta)
+    {
+        m_GUI->StartFrame();
+
+        {
+            ImGui::SetNextWindowPos(ImVec2(0, 0));
+            ImGui::SetNextWindowSize(ImVec2(0, 0), ImGuiSetCond_FirstUseEver);
+            ImGui::Begin("PackedVertexDemo", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove);
+
+            ImGui::Checkbox("Packed", &m_Packed);
+            ImGui::Text("Float :%.1fKB", GetVertexMemory(m_Model) / 1024.0f);
+            ImGui::Text("Packed:%.1fKB", GetVertexMemory(m_PackedModel) / 1024.0f);
+
+            ImGui::Text("%.3f ms/frame (%d FPS)", 1000.0f / m_LastFPS, m_LastFPS);
+            ImGui::End();
+        }
+
+        bool hovered = ImGui::IsAnyWindowHovered() || ImGui::IsAnyItemHovered() || ImGui::IsRootWindowOrAnyChildHovered();
+
+        m_GUI->EndFrame();
+        m_GUI->Update();
+
+        return hovered;
+    }
+
+    int32 GetVertexMemory(vk_demo::DVKModel* model)
+    {
+        int32 stride = 0;
+        for (int32 i = 0; i < model->attributes.size(); ++i)
+        {
+            stride += vk_demo::VertexAttributeToSize(model->attributes[i]);
+        }
+
+        int32 vertexCount = 0;
+        for (int32 i = 0; i < model->meshes.size(); ++i)
+        {
+            vertexCount += model->meshes[i]->vertexCount;
+        }
+
+        return vertexCount * stride;
+    }
+
+    void LoadAssets()
+    {
+        vk_demo::DVKCommandBuffer* cmdBuffer = vk_demo::DVKCommandBuffer::Create(m_VulkanDevice, m_CommandPool);
+
+        m_Shader = vk_demo::DVKShader::Create(
+            m_VulkanDevice,
+            true,
+            "assets/shaders/73_PackedVertex/obj.vert.spv",
+            "assets/shaders/73_PackedVertex/obj.frag.spv",
+            nullptr
+        );
+
+        // 压缩格式：VA_PositionQ + VA_NormalOct，位置需要每个Mesh各自的还原参数
+        m_PackedShader = vk_demo::DVKShader::Create(
+            m_VulkanDevice,
+            true,
+            "assets/shaders/73_PackedVertex/obj_packed.vert.spv",
+            "assets/shaders/73_PackedVertex/obj.frag.spv",
+            nullptr
+        );
+
+        m_Model = vk_demo::DVKModel::LoadFromFile(
+            "assets/models/Room/miniHouse_FBX.FBX",
+            m_VulkanDevice,
+            cmdBuffer,
+            m_Shader->perVertexAttributes
+        );
+
+        m_PackedModel = vk_demo::DVKModel::LoadFromFile(
+            "assets/models/Room/miniHouse_FBX.FBX",
+            m_VulkanDevice,
+            cmdBuffer,
+            m_PackedShader->perVertexAttributes
+        );
+
+        m_Material = vk_demo::DVKMaterial::Create(
+            m_VulkanDevice,
+            m_RenderPass,
+            m_PipelineCache,
+            m_Shader
+        );
+        m_Material->PreparePipeline();
+
+        m_PackedMaterial = vk_demo::DVKMaterial::Create(
+            m_VulkanDevice,
+            m_RenderPass,
+            m_PipelineCache,
+            m_PackedShader
+        );
+        m_PackedMaterial->PreparePipeline();
+
+        delete cmdBuffer;
+    }
+
+    void DestroyAssets()
+    {
+        delete m_Model;
+        delete m_PackedModel;
+
+        delete m_Material;
+        delete m_PackedMaterial;
+
+        delete m_Shader;
+        delete m_PackedShader;
+    }
+
+    void SetupCommandBuffers(int32 backBufferIndex)
+    {
+        VkViewport viewport = {};
+        viewport.x        = 0;
+        viewport.y        = m_FrameHeight;
+        viewport.width    = m_FrameWidth;
+        viewport.height   = -(float)m_FrameHeight;    // flip y axis
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+
+        VkRect2D scissor = {};
+        scissor.extent.width  = m_FrameWidth;
+        scissor.extent.height = m_FrameHeight;
+        scissor.offset.x = 0;
+        scissor.offset.y = 0;
+
+        VkCommandBuffer commandBuffer = m_CommandBuffers[backBufferIndex];
+
+        VkCommandBufferBeginInfo cmdBeginInfo;
+        ZeroVulkanStruct(cmdBeginInfo, VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO);
+        VERIFYVULKANRESULT(vkBeginCommandBuffer(commandBuffer, &cmdBeginInfo));
+
+        VkClearValue clearValues[2];
+        clearValues[0].color        = {
+            { 0.2f, 0.2f, 0.2f, 1.0f }
+        };
+        clearValues[1].depthStencil = { 1.0f, 0 };
+
+        VkRenderPassBeginInfo renderPassBeginInfo;
+        ZeroVulkanStruct(renderPassBeginInfo, VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO);
+        renderPassBeginInfo.renderPass               = m_RenderPass;
+        renderPassBeginInfo.framebuffer              = m_FrameBuffers[backBufferIndex];
+        renderPassBeginInfo.clearValueCount          = 2;
+        renderPassBeginInfo.pClearValues             = clearValues;
+        renderPassBeginInfo.renderArea.offset.x      = 0;
+        renderPassBeginInfo.renderArea.offset.y      = 0;
+        renderPassBeginInfo.renderArea.extent.width  = m_FrameWidth;
+        renderPassBeginInfo.renderArea.extent.height = m_FrameHeight;
+        vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(commandBuffer,  0, 1, &scissor);
+
+        vk_demo::DVKModel* model       = m_Packed ? m_PackedModel    : m_Model;
+        vk_demo::DVKMaterial* material = m_Packed ? m_PackedMaterial : m_Material;
+
+        m_MVPParam.view = m_ViewCamera.GetView();
+        m_MVPParam.proj = m_ViewCamera.GetProjection();
+
+        material->BeginFrame();
+        for (int32 i = 0; i < model->meshes.size(); ++i)
+        {
+            vk_demo::DVKMesh* mesh = model->meshes[i];
+            m_MVPParam.model = mesh->linkNode->GetGlobalMatrix();
+
+            material->BeginObject();
+            material->SetLocalUniform("uboMVP", &m_MVPParam, sizeof(ModelViewProjectionBlock));
+            if (m_Packed)
+            {
+                vk_demo::DVKPositionDequant dequant = mesh->GetPositionDequant();
+                material->SetLocalUniform("uboDequant", &dequant, sizeof(vk_demo::DVKPositionDequant));
+            }
+            material->EndObject();
+        }
+        material->EndFrame();
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, material->GetPipeline());
+        for (int32 i = 0; i < model->meshes.size(); ++i)
+        {
+            material->BindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, i);
+            model->meshes[i]->BindDrawCmd(commandBuffer);
+        }
+
+        m_GUI->BindDrawCmd(commandBuffer, m_RenderPass);
+        vkCmdEndRenderPass(commandBuffer);
+        VERIFYVULKANRESULT(vkEndCommandBuffer(commandBuffer));
+    }
+
+    void InitParmas()
+    {
+        vk_demo::DVKBoundingBox bounds = m_Model->rootNode->GetBounds();
+        Vector3 boundSize   = bounds.max - bounds.min;
+        Vector3 boundCenter = bounds.min + boundSize * 0.5f;
+
+        m_ViewCamera.Perspective(PI / 4, (float)GetWidth(), (float)GetHeight(), 10.0f, boundSize.Size() * 4.0f);
+        m_ViewCamera.SetPosition(boundCenter.x, boundCenter.y + boundSize.Size() * 0.5f, boundCenter.z - boundSize.Size());
+        m_ViewCamera.LookAt(boundCenter);
+    }
+
+    void CreateGUI()
+    {
+        m_GUI = new ImageGUIContext();
+        m_GUI->Init("assets/fonts/Ubuntu-Regular.ttf");
+    }
+
+    void DestroyGUI()
+    {
+        m_GUI->Destroy();
+        delete m_GUI;
+    }
+
+private:
+
+    bool                            m_Ready = false;
+
+    vk_demo::DVKModel*              m_Model = nullptr;
+    vk_demo::DVKMaterial*           m_Material = nullptr;
+    vk_demo::DVKShader*             m_Shader = nullptr;
+
+    vk_demo::DVKModel*              m_PackedModel = nullptr;
+    vk_demo::DVKMaterial*           m_PackedMaterial = nullptr;
+    vk_demo::DVKShader*             m_PackedShader = nullptr;
+    bool                            m_Packed = true;
+
+    vk_demo::DVKCamera              m_ViewCamera;
+    ModelViewProjectionBlock        m_MVPParam;
+
+    ImageGUIContext*                m_GUI = nullptr;
+};
+
+std::shared_ptr<AppModuleBase> CreateAppMode(const std::vector<std::string>& cmdLine)
+{
+    return std::make_shared<PackedVertexDemo>(1400, 900, "PackedVertexDemo", cmdLine);
+}
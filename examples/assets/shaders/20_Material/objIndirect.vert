@@ -0,0 +1,36 @@
+#version 450
+
+layout (location = 0) in vec3 inPosition;
+layout (location = 1) in vec3 inNormal;
+layout (location = 2) in vec3 inColor;
+
+layout (binding = 0) uniform ViewProjBlock 
+{
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+} uboViewProj;
+
+// 间接绘制时firstInstance为Mesh的索引
+layout (std140, binding = 1) readonly buffer ModelBuffer 
+{
+	mat4 models[ ];
+} inModels;
+
+layout (location = 0) out vec3 outNormal;
+layout (location = 1) out vec3 outColor;
+
+out gl_PerVertex 
+{
+    vec4 gl_Position;   
+};
+
+void main() 
+{
+	mat4 modelMatrix  = inModels.models[gl_InstanceIndex];
+	mat3 normalMatrix = transpose(inverse(mat3(modelMatrix)));
+	vec3 normal = normalize(normalMatrix * inNormal);
+
+	gl_Position = uboViewProj.projectionMatrix * uboViewProj.viewMatrix * modelMatrix * vec4(inPosition.xyz, 1.0);
+	outNormal   = normal;
+	outColor	= inColor;
+}
@@ -0,0 +1,29 @@
+#version 450
+
+layout (location = 0) in vec3 inPosition;
+layout (location = 1) in vec3 inNormal;
+
+layout (binding = 0) uniform MVPBlock 
+{
+	mat4 modelMatrix;
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+} uboMVP;
+
+layout (location = 0) out vec3 outColor;
+
+out gl_PerVertex 
+{
+    vec4  gl_Position;
+};
+
+void main() 
+{
+	mat3 normalMatrix = transpose(inverse(mat3(uboMVP.modelMatrix)));
+	vec3 normal  = normalize(normalMatrix * inNormal.xyz);
+
+	float diffuse = clamp(dot(normal, normalize(vec3(0, 1, -1))), 0, 1);
+	outColor = vec3(diffuse, diffuse, diffuse);
+
+	gl_Position = uboMVP.projectionMatrix * uboMVP.viewMatrix * uboMVP.modelMatrix * vec4(inPosition, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#version 450
+
+layout (location = 0) in vec4 inPositionQ;
+layout (location = 1) in vec2 inNormalOct;
+
+layout (binding = 0) uniform MVPBlock
+{
+	mat4 modelMatrix;
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+} uboMVP;
+
+layout (binding = 1) uniform DequantBlock
+{
+	vec4 positionMin;
+	vec4 positionExtent;
+} uboDequant;
+
+layout (location = 0) out vec3 outColor;
+
+out gl_PerVertex
+{
+    vec4  gl_Position;
+};
+
+vec3 DecodeOctahedron(vec2 e)
+{
+	vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+	if (n.z < 0.0)
+	{
+		vec2 s = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+		n.xy = (1.0 - abs(n.yx)) * s;
+	}
+	return normalize(n);
+}
+
+void main()
+{
+	vec3 position = uboDequant.positionMin.xyz + inPositionQ.xyz * uboDequant.positionExtent.xyz;
+
+	mat3 normalMatrix = transpose(inverse(mat3(uboMVP.modelMatrix)));
+	vec3 normal  = normalize(normalMatrix * DecodeOctahedron(inNormalOct));
+
+	float diffuse = clamp(dot(normal, normalize(vec3(0, 1, -1))), 0, 1);
+	outColor = vec3(diffuse, diffuse, diffuse);
+
+	gl_Position = uboMVP.projectionMatrix * uboMVP.viewMatrix * uboMVP.modelMatrix * vec4(position, 1.0);
+}
\ No newline at end of file
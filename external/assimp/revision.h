@@ -1,7 +1,7 @@
 #ifndef ASSIMP_REVISION_H_INC
 #define ASSIMP_REVISION_H_INC
 
-#define GitVersion 0x0612725d
+#define GitVersion 0xcda5de67
 #define GitBranch "master"
 
 #endif // ASSIMP_REVISION_H_INC
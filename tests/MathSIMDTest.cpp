@@ -0,0 +1,301 @@
+#include "Common/Common.h"
+
+#include "Math/Math.h"
+#include "Math/Vector3.h"
+#include "Math/Vector4.h"
+#include "Math/Matrix4x4.h"
+#include "Math/Quat.h"
+#include "Math/VectorBatch.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// 同一份源码分别以SIMD与MONKEY_MATH_SCALAR=1编译为两个程序：
+// 标量程序把结果写入文件(dump)，SIMD程序重新计算并逐项对比(compare)。
+
+#define TEST_CASE_COUNT 256
+
+// 固定种子的线性同余随机数，两个程序得到完全相同的输入
+struct TestRandom
+{
+    uint32 seed = 20201019;
+
+    float Range(float minValue, float maxValue)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return minValue + (maxValue - minValue) * ((seed >> 8) / 16777216.0f);
+    }
+
+    Vector3 RangeVector(float minValue, float maxValue)
+    {
+        float x = Range(minValue, maxValue);
+        float y = Range(minValue, maxValue);
+        float z = Range(minValue, maxValue);
+        return Vector3(x, y, z);
+    }
+
+    Quat RangeQuat()
+    {
+        Vector3 axis = RangeVector(-1.0f, 1.0f) + Vector3(0.0f, 0.0f, 0.01f);
+        axis.Normalize();
+        return Quat(axis, Range(-PI, PI));
+    }
+
+    Matrix4x4 RangeMatrix(float minValue, float maxValue)
+    {
+        Matrix4x4 matrix;
+        for (int32 row = 0; row < 4; ++row)
+        {
+            for (int32 col = 0; col < 4; ++col)
+            {
+                matrix.m[row][col] = Range(minValue, maxValue);
+            }
+        }
+        return matrix;
+    }
+
+    // 旋转、缩放与平移组成的仿射矩阵，条件数较小
+    Matrix4x4 RangeTransform()
+    {
+        Matrix4x4 matrix;
+        RangeQuat().ToMatrix(matrix);
+        matrix.AppendScale(RangeVector(0.5f, 2.0f));
+        Vector3 translation = RangeVector(-10.0f, 10.0f);
+        matrix.m[3][0] = translation.x;
+        matrix.m[3][1] = translation.y;
+        matrix.m[3][2] = translation.z;
+        return matrix;
+    }
+};
+
+struct TestGroup
+{
+    const char*         name;
+    // 相对误差：|a - b| <= tolerance * max(1, |a|, |b|)，为0时要求逐位相同
+    float               tolerance;
+    std::vector<float>  values;
+
+    TestGroup(const char* inName, float inTolerance)
+        : name(inName)
+        , tolerance(inTolerance)
+    {
+
+    }
+
+    void Add(const float* data, int32 count)
+    {
+        values.insert(values.end(), data, data + count);
+    }
+
+    void Add(const Vector3& v)
+    {
+        Add(&v.x, 3);
+    }
+
+    void Add(const Vector4& v)
+    {
+        Add(&v.x, 4);
+    }
+
+    void Add(const Quat& q)
+    {
+        Add(&q.x, 4);
+    }
+
+    void Add(const Matrix4x4& matrix)
+    {
+        Add(&matrix.m[0][0], 16);
+    }
+};
+
+static void RunTests(std::vector<TestGroup>& groups)
+{
+    TestRandom random;
+
+    // 矩阵乘法的累加顺序与标量实现一致
+    groups.push_back(TestGroup("MatrixMultiply", 0.0f));
+    for (int32 i = 0; i < TEST_CASE_COUNT; ++i)
+    {
+        Matrix4x4 a = random.RangeMatrix(-2.0f, 2.0f);
+        Matrix4x4 b = random.RangeMatrix(-2.0f, 2.0f);
+        groups.back().Add(a * b);
+    }
+
+    // SIMD使用2x2分块求逆，与余子式展开相差若干ulp
+    groups.push_back(TestGroup("MatrixInverse", 1e-4f));
+    for (int32 i = 0; i < TEST_CASE_COUNT; ++i)
+    {
+        groups.back().Add(random.RangeTransform().Inverse());
+
+        Matrix4x4 matrix = random.RangeMatrix(-1.0f, 1.0f);
+        for (int32 j = 0; j < 4; ++j)
+        {
+            matrix.m[j][j] += 4.0f;
+        }
+        groups.back().Add(matrix.InverseFast());
+    }
+
+    groups.push_back(TestGroup("MatrixTransform", 0.0f));
+    for (int32 i = 0; i < TEST_CASE_COUNT; ++i)
+    {
+        Matrix4x4 matrix = random.RangeTransform();
+        Vector3 v = random.RangeVector(-10.0f, 10.0f);
+        groups.back().Add(matrix.TransformPosition(v));
+        groups.back().Add(matrix.TransformVector(v));
+        groups.back().Add(matrix.TransformVector4(Vector4(v, random.Range(-1.0f, 1.0f))));
+        groups.back().Add(matrix.DeltaTransformVector(Vector4(v, 0.0f)));
+    }
+
+    // 批量变换与逐个TransformPosition的结果完全相同
+    groups.push_back(TestGroup("VectorBatch", 0.0f));
+    {
+        Matrix4x4 matrix = random.RangeTransform();
+
+        Vector3Array positions;
+        BoundsArray bounds;
+        positions.Resize(TEST_CASE_COUNT);
+        bounds.Resize(TEST_CASE_COUNT);
+        for (int32 i = 0; i < TEST_CASE_COUNT; ++i)
+        {
+            Vector3 center = random.RangeVector(-10.0f, 10.0f);
+            Vector3 extent = random.RangeVector(0.1f, 2.0f);
+            positions.Set(i, center);
+            bounds.Set(i, center - extent, center + extent);
+        }
+
+        VectorBatch::TransformPositions(matrix, positions, positions);
+        VectorBatch::TransformBounds(matrix, bounds, bounds);
+        for (int32 i = 0; i < TEST_CASE_COUNT; ++i)
+        {
+            groups.back().Add(positions.Get(i));
+            groups.back().Add(bounds.min.Get(i));
+            groups.back().Add(bounds.max.Get(i));
+        }
+    }
+
+    // SIMD直接展开Hamilton乘积，与标量实现相差若干ulp
+    groups.push_back(TestGroup("QuatMultiply", 1e-5f));
+    for (int32 i = 0; i < TEST_CASE_COUNT; ++i)
+    {
+        Quat a = random.RangeQuat();
+        Quat b = random.RangeQuat();
+        groups.back().Add(a * b);
+        groups.back().Add(a.RotateVector(random.RangeVector(-10.0f, 10.0f)));
+    }
+
+    groups.push_back(TestGroup("QuatToMatrix", 0.0f));
+    for (int32 i = 0; i < TEST_CASE_COUNT; ++i)
+    {
+        Matrix4x4 matrix;
+        random.RangeQuat().ToMatrix(matrix);
+        groups.back().Add(matrix);
+    }
+
+    groups.push_back(TestGroup("QuatSlerp", 0.0f));
+    for (int32 i = 0; i < TEST_CASE_COUNT; ++i)
+    {
+        Quat a = random.RangeQuat();
+        Quat b = random.RangeQuat();
+        float alpha = random.Range(0.0f, 1.0f);
+        groups.back().Add(Quat::slerp(a, b, alpha));
+        groups.back().Add(Quat::SlerpFullPath(a, b, alpha));
+    }
+}
+
+static bool Dump(const char* filename, const std::vector<TestGroup>& groups)
+{
+    FILE* file = fopen(filename, "wb");
+    if (file == nullptr)
+    {
+        printf("Can't open %s\n", filename);
+        return false;
+    }
+
+    for (int32 i = 0; i < groups.size(); ++i)
+    {
+        int32 count = (int32)groups[i].values.size();
+        fwrite(&count, sizeof(int32), 1, file);
+        fwrite(groups[i].values.data(), sizeof(float), count, file);
+    }
+
+    fclose(file);
+    return true;
+}
+
+static bool Compare(const char* filename, const std::vector<TestGroup>& groups)
+{
+    FILE* file = fopen(filename, "rb");
+    if (file == nullptr)
+    {
+        printf("Can't open %s\n", filename);
+        return false;
+    }
+
+    bool passed = true;
+    for (int32 i = 0; i < groups.size(); ++i)
+    {
+        const TestGroup& group = groups[i];
+
+        int32 count = 0;
+        std::vector<float> expected;
+        if (fread(&count, sizeof(int32), 1, file) == 1 && count == group.values.size())
+        {
+            expected.resize(count);
+            if (fread(expected.data(), sizeof(float), count, file) != count)
+            {
+                expected.clear();
+            }
+        }
+
+        if (expected.size() != group.values.size())
+        {
+            printf("%-16s FAILED: scalar result does not match this build\n", group.name);
+            passed = false;
+            break;
+        }
+
+        float maxError = 0.0f;
+        int32 failures = 0;
+        for (int32 j = 0; j < count; ++j)
+        {
+            float a = expected[j];
+            float b = group.values[j];
+            float error = MMath::Abs(a - b) / MMath::Max(1.0f, MMath::Max(MMath::Abs(a), MMath::Abs(b)));
+            maxError = MMath::Max(maxError, error);
+
+            bool equal = group.tolerance == 0.0f ? memcmp(&a, &b, sizeof(float)) == 0 : error <= group.tolerance;
+            if (!equal)
+            {
+                if (failures < 4)
+                {
+                    printf("%-16s [%d] scalar %.9g simd %.9g\n", group.name, j, a, b);
+                }
+                failures += 1;
+            }
+        }
+
+        printf("%-16s %s values:%d maxError:%g tolerance:%g\n", group.name, failures == 0 ? "OK    " : "FAILED", count, maxError, group.tolerance);
+        passed = passed && failures == 0;
+    }
+
+    fclose(file);
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3 || (strcmp(argv[1], "dump") != 0 && strcmp(argv[1], "compare") != 0))
+    {
+        printf("Usage: %s dump|compare <file>\n", argv[0]);
+        return 1;
+    }
+
+    printf("MONKEY_MATH_SIMD=%d\n", MONKEY_MATH_SIMD);
+
+    std::vector<TestGroup> groups;
+    RunTests(groups);
+
+    bool result = strcmp(argv[1], "dump") == 0 ? Dump(argv[2], groups) : Compare(argv[2], groups);
+    return result ? 0 : 1;
+}